@@ -0,0 +1,171 @@
+//
+//  raster_jni.c
+//  JNI bindings of cpp/raster.h for cn.jystudio.bluetooth.escpos.command.sdk.RasterCore
+//
+
+#include <jni.h>
+#include <stdlib.h>
+#include "raster.h"
+
+JNIEXPORT void JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_luma(JNIEnv *env, jclass clazz,
+        jintArray argb, jint offset, jint count, jbyteArray grey, jint greyOffset)
+{
+    jint *src = (*env)->GetPrimitiveArrayCritical(env, argb, NULL);
+    jbyte *dst = (*env)->GetPrimitiveArrayCritical(env, grey, NULL);
+    if (src && dst) {
+        // java ints are little endian ARGB on every android abi
+        raster_luma((const uint8_t *) (src + offset), (size_t) count, RASTER_BGRX, (uint8_t *) dst + greyOffset);
+    }
+    if (dst) (*env)->ReleasePrimitiveArrayCritical(env, grey, dst, 0);
+    if (src) (*env)->ReleasePrimitiveArrayCritical(env, argb, src, JNI_ABORT);
+}
+
+JNIEXPORT void JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_pack(JNIEnv *env, jclass clazz,
+        jbyteArray bits, jint offset, jint nbytes, jboolean invert, jbyteArray out, jint outOffset)
+{
+    jbyte *src = (*env)->GetPrimitiveArrayCritical(env, bits, NULL);
+    jbyte *dst = (*env)->GetPrimitiveArrayCritical(env, out, NULL);
+    if (src && dst) {
+        raster_pack((const uint8_t *) src + offset, (size_t) nbytes, invert, (uint8_t *) dst + outOffset);
+    }
+    if (dst) (*env)->ReleasePrimitiveArrayCritical(env, out, dst, 0);
+    if (src) (*env)->ReleasePrimitiveArrayCritical(env, bits, src, JNI_ABORT);
+}
+
+static int check_grey(JNIEnv *env, jbyteArray grey, jint width, jint height)
+{
+    if (width <= 0 || height <= 0 || (*env)->GetArrayLength(env, grey) < (jlong) width * height) {
+        jclass iae = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
+        (*env)->ThrowNew(env, iae, "grey pixels do not match width x height");
+        return 0;
+    }
+    return 1;
+}
+
+static jbyteArray to_java(JNIEnv *env, const uint8_t *data, size_t length)
+{
+    jbyteArray result = (*env)->NewByteArray(env, (jsize) length);
+    if (result) (*env)->SetByteArrayRegion(env, result, 0, (jsize) length, (const jbyte *) data);
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_encodeEscPos(JNIEnv *env, jclass clazz,
+        jbyteArray grey, jint width, jint height, jint left, jint dither, jint rowsPerCommand, jint mode)
+{
+    if (!check_grey(env, grey, width, height)) return NULL;
+    raster_options options = {0};
+    options.width = (size_t) width;
+    options.left = left > 0 ? (size_t) left : 0;
+    options.dither = (raster_dither_mode) dither;
+    options.rows_per_command = rowsPerCommand > 0 ? (size_t) rowsPerCommand : 0;
+    options.escpos_mode = (uint8_t) mode;
+    size_t length = raster_escpos_size(&options, (size_t) height);
+    uint8_t *out = malloc(length);
+    jbyte *src = out ? (*env)->GetByteArrayElements(env, grey, NULL) : NULL;
+    jbyteArray result = NULL;
+    if (src) {
+        length = raster_escpos_encode((const uint8_t *) src, (size_t) height, &options, out);
+        (*env)->ReleaseByteArrayElements(env, grey, src, JNI_ABORT);
+        result = to_java(env, out, length);
+    }
+    free(out);
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_encodeTsc(JNIEnv *env, jclass clazz,
+        jbyteArray grey, jint width, jint height, jint dither)
+{
+    if (!check_grey(env, grey, width, height)) return NULL;
+    size_t length = raster_tsc_size((size_t) width, (size_t) height);
+    uint8_t *out = malloc(length);
+    jbyte *src = out ? (*env)->GetByteArrayElements(env, grey, NULL) : NULL;
+    jbyteArray result = NULL;
+    if (src) {
+        length = raster_tsc_encode((const uint8_t *) src, (size_t) width, (size_t) height, (raster_dither_mode) dither, out);
+        (*env)->ReleaseByteArrayElements(env, grey, src, JNI_ABORT);
+        result = to_java(env, out, length);
+    }
+    free(out);
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_encodeNvDefine(JNIEnv *env, jclass clazz,
+        jbyteArray grey, jint width, jint height, jint dither, jint kc1, jint kc2)
+{
+    if (!check_grey(env, grey, width, height)) return NULL;
+    size_t length = raster_nv_define_size((size_t) width, (size_t) height);
+    if (!length) {
+        jclass iae = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
+        (*env)->ThrowNew(env, iae, "image too large for NV graphics");
+        return NULL;
+    }
+    uint8_t *out = malloc(length);
+    jbyte *src = out ? (*env)->GetByteArrayElements(env, grey, NULL) : NULL;
+    jbyteArray result = NULL;
+    if (src) {
+        length = raster_nv_define((const uint8_t *) src, (size_t) width, (size_t) height, (raster_dither_mode) dither,
+                                  (uint8_t) kc1, (uint8_t) kc2, out);
+        (*env)->ReleaseByteArrayElements(env, grey, src, JNI_ABORT);
+        result = to_java(env, out, length);
+    }
+    free(out);
+    return result;
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_nvPrint(JNIEnv *env, jclass clazz, jint kc1, jint kc2)
+{
+    uint8_t out[RASTER_NV_PRINT_SIZE];
+    return to_java(env, out, raster_nv_print((uint8_t) kc1, (uint8_t) kc2, out));
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_nvDelete(JNIEnv *env, jclass clazz, jint kc1, jint kc2)
+{
+    uint8_t out[RASTER_NV_DELETE_SIZE];
+    return to_java(env, out, raster_nv_delete((uint8_t) kc1, (uint8_t) kc2, out));
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_nvDeleteAll(JNIEnv *env, jclass clazz)
+{
+    uint8_t out[RASTER_NV_DELETE_ALL_SIZE];
+    return to_java(env, out, raster_nv_delete_all(out));
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_RasterCore_encodeSymbol(JNIEnv *env, jclass clazz,
+        jintArray bits, jint rowWords, jint width, jint height, jint scale,
+        jint left, jint boxWidth, jint boxHeight, jint rowsPerCommand)
+{
+    if (width <= 0 || height <= 0 || rowWords < (width + 31) / 32
+        || (*env)->GetArrayLength(env, bits) < (jlong) rowWords * height) {
+        jclass iae = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
+        (*env)->ThrowNew(env, iae, "bits do not match width x height");
+        return NULL;
+    }
+    raster_symbol_options options = {0};
+    options.scale = scale > 0 ? (size_t) scale : 1;
+    options.left = left > 0 ? (size_t) left : 0;
+    options.width = boxWidth > 0 ? (size_t) boxWidth : 0;
+    options.height = boxHeight > 0 ? (size_t) boxHeight : 0;
+    options.rows_per_command = rowsPerCommand > 0 ? (size_t) rowsPerCommand : 0;
+    raster_matrix matrix = {NULL, (size_t) rowWords, (size_t) width, (size_t) height};
+    size_t length = raster_symbol_escpos_size(&matrix, &options);
+    uint8_t *out = malloc(length);
+    jint *src = out ? (*env)->GetPrimitiveArrayCritical(env, bits, NULL) : NULL;
+    jbyteArray result = NULL;
+    if (src) {
+        matrix.bits = (const uint32_t *) src;
+        length = raster_symbol_escpos_encode(&matrix, &options, out);
+        (*env)->ReleasePrimitiveArrayCritical(env, bits, src, JNI_ABORT);
+        result = to_java(env, out, length);
+    }
+    free(out);
+    return result;
+}
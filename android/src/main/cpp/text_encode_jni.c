@@ -0,0 +1,36 @@
+//
+//  text_encode_jni.c
+//  JNI bindings of cpp/text_encode.h for cn.jystudio.bluetooth.escpos.command.sdk.TextEncoder
+//
+
+#include <jni.h>
+#include <stdlib.h>
+#include "text_encode.h"
+
+JNIEXPORT jbyteArray JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_TextEncoder_encode(JNIEnv *env, jclass clazz,
+        jstring text, jstring encoding, jint fallback)
+{
+    if (!text || !encoding) return NULL;
+    const char *name = (*env)->GetStringUTFChars(env, encoding, NULL);
+    if (!name) return NULL;
+    text_encoding e = text_encoding_named(name);
+    (*env)->ReleaseStringUTFChars(env, encoding, name);
+    if (e == TEXT_ENCODING_UNKNOWN) return NULL;
+
+    jsize length = (*env)->GetStringLength(env, text);
+    uint8_t *out = malloc(length ? text_encode_size(e, (size_t) length) : 1);
+    if (!out) return NULL;
+    const jchar *chars = (*env)->GetStringCritical(env, text, NULL);
+    if (!chars) {
+        free(out);
+        return NULL;
+    }
+    size_t written = text_encode(e, (const uint16_t *) chars, (size_t) length, fallback, out);
+    (*env)->ReleaseStringCritical(env, text, chars);
+
+    jbyteArray result = (*env)->NewByteArray(env, (jsize) written);
+    if (result) (*env)->SetByteArrayRegion(env, result, 0, (jsize) written, (const jbyte *) out);
+    free(out);
+    return result;
+}
@@ -0,0 +1,68 @@
+//
+//  text_layout_jni.c
+//  JNI bindings of cpp/text_layout.h for cn.jystudio.bluetooth.escpos.command.sdk.TextLayout
+//
+
+#include <jni.h>
+#include <stdlib.h>
+#include "text_layout.h"
+
+static void throw_iae(JNIEnv *env, const char *message)
+{
+    jclass iae = (*env)->FindClass(env, "java/lang/IllegalArgumentException");
+    (*env)->ThrowNew(env, iae, message);
+}
+
+JNIEXPORT jstring JNICALL
+Java_cn_jystudio_bluetooth_escpos_command_sdk_TextLayout_columns(JNIEnv *env, jclass clazz,
+        jobjectArray texts, jintArray widths, jintArray aligns)
+{
+    jsize count = (*env)->GetArrayLength(env, texts);
+    if ((*env)->GetArrayLength(env, widths) != count || (*env)->GetArrayLength(env, aligns) != count) {
+        throw_iae(env, "COLUMN_WIDTHS_ALIGNS_AND_TEXTS_NOT_MATCH");
+        return NULL;
+    }
+    text_column *columns = calloc(count ? (size_t) count : 1, sizeof(text_column));
+    jstring *strings = calloc(count ? (size_t) count : 1, sizeof(jstring));
+    jint *w = (*env)->GetIntArrayElements(env, widths, NULL);
+    jint *a = (*env)->GetIntArrayElements(env, aligns, NULL);
+    jstring result = NULL;
+    jsize pinned = 0;
+    if (!columns || !strings || !w || !a) goto done;
+
+    for (; pinned < count; pinned++) {
+        jstring text = (jstring) (*env)->GetObjectArrayElement(env, texts, pinned);
+        if (!text || w[pinned] < 0) {
+            throw_iae(env, "INVALID_PARAMETER");
+            goto done;
+        }
+        strings[pinned] = text;
+        columns[pinned].text = (const uint16_t *) (*env)->GetStringChars(env, text, NULL);
+        columns[pinned].length = (size_t) (*env)->GetStringLength(env, text);
+        columns[pinned].width = (size_t) w[pinned];
+        columns[pinned].align = (text_align) a[pinned];
+        if (!columns[pinned].text) {
+            pinned++;
+            goto done;
+        }
+    }
+
+    size_t length = text_layout_columns(columns, (size_t) count, NULL, NULL);
+    uint16_t *out = length == (size_t) -1 ? NULL : malloc(length ? length * sizeof(uint16_t) : 1);
+    if (out) {
+        text_layout_columns(columns, (size_t) count, out, NULL);
+        result = (*env)->NewString(env, (const jchar *) out, (jsize) length);
+        free(out);
+    }
+
+done:
+    for (jsize i = 0; i < pinned; i++) {
+        if (columns[i].text) (*env)->ReleaseStringChars(env, strings[i], (const jchar *) columns[i].text);
+        (*env)->DeleteLocalRef(env, strings[i]);
+    }
+    if (a) (*env)->ReleaseIntArrayElements(env, aligns, a, JNI_ABORT);
+    if (w) (*env)->ReleaseIntArrayElements(env, widths, w, JNI_ABORT);
+    free(strings);
+    free(columns);
+    return result;
+}
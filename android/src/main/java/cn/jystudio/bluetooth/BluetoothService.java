@@ -8,9 +8,11 @@ import android.bluetooth.BluetoothSocket;
 import android.content.Context;
 import android.util.Log;
 
+import javax.annotation.Nullable;
 import java.io.IOException;
 import java.io.InputStream;
 import java.io.OutputStream;
+import java.io.UnsupportedEncodingException;
 import java.util.*;
 import java.lang.reflect.Method;
 
@@ -22,6 +24,7 @@ public class BluetoothService {
     // Debugging
     private static final String TAG = "BluetoothService";
     private static final boolean DEBUG = true;
+    private static final String WRITE_TAG = "BTPWRITE";
 
 
     // Name for the SDP record when creating server socket
@@ -158,17 +161,34 @@ public class BluetoothService {
      * Write to the ConnectedThread in an unsynchronized manner
      *
      * @param out The bytes to write
-     * @see ConnectedThread#write(byte[])
+     * @see ConnectedThread#write(byte[], int, WriteQueue.Callback)
      */
     public void write(byte[] out) {
+        write(out, null);
+    }
+
+    /**
+     * Queues the bytes for the writer thread, waits while the write queue is full.
+     *
+     * @param callback told on the writer thread when the bytes are flushed or failed
+     * @return false when not connected, the callback is not called then
+     */
+    public boolean write(byte[] out, @Nullable WriteQueue.Callback callback) {
+        return write(out, out.length, callback);
+    }
+
+    /**
+     * Queues out[0..length) without copying it, out must not change until the callback.
+     */
+    public boolean write(byte[] out, int length, @Nullable WriteQueue.Callback callback) {
         // Create temporary object
         ConnectedThread r;
         // Synchronize a copy of the ConnectedThread
         synchronized (this) {
-            if (mState != STATE_CONNECTED) return;
+            if (mState != STATE_CONNECTED) return false;
             r = mConnectedThread;
         }
-        r.write(out);
+        return r.write(out, length, callback);
     }
 
     /**
@@ -196,6 +216,7 @@ public class BluetoothService {
         private BluetoothSocket mmSocket;
         private InputStream mmInStream;
         private OutputStream mmOutStream;
+        private volatile WriteQueue mmWriter;
 
         public ConnectedThread(BluetoothDevice device) {
             mmDevice = device;
@@ -273,6 +294,10 @@ public class BluetoothService {
 
             mmInStream = tmpIn;
             mmOutStream = tmpOut;
+            if (mmOutStream != null) {
+                mmWriter = new WriteQueue(mmOutStream);
+                mmWriter.start();
+            }
 
             bundle.put(DEVICE_NAME, mmDevice.getName());
             bundle.put(DEVICE_ADDRESS, mmDevice.getAddress());
@@ -306,30 +331,38 @@ public class BluetoothService {
                     break;
                 }
             }
+            if (mmWriter != null) mmWriter.close();
             Log.i(TAG, "ConnectedThread End");
         }
 
         /**
-         * Write to the connected OutStream.
+         * Queue to the connected OutStream.
          *
          * @param buffer The bytes to write
          */
-        public void write(byte[] buffer) {
-            try {
-                mmOutStream.write(buffer);
-                mmOutStream.flush();//清空缓存
-               /* if (buffer.length > 3000) //
-                {
-                  byte[] readata = new byte[1];
-                  SPPReadTimeout(readata, 1, 5000);
-                }*/
-                Log.i("BTPWRITE", new String(buffer, "GBK"));
-                Map<String, Object> bundle = new HashMap<String, Object>();
-                bundle.put("bytes", buffer);
-                infoObervers(MESSAGE_WRITE, bundle);
-            } catch (IOException e) {
-                Log.e(TAG, "Exception during write", e);
-            }
+        public boolean write(final byte[] buffer, final int length, @Nullable final WriteQueue.Callback callback) {
+            WriteQueue writer = mmWriter;
+            if (writer == null) return false;
+            // the GBK dump only with adb shell setprop log.tag.BTPWRITE DEBUG
+            final boolean dump = Log.isLoggable(WRITE_TAG, Log.DEBUG);
+            return writer.write(buffer, length, new WriteQueue.Callback() {
+                @Override
+                public void onWritten(boolean flushed) {
+                    if (dump) {
+                        try {
+                            Log.d(WRITE_TAG, new String(buffer, 0, length, "GBK"));
+                        } catch (UnsupportedEncodingException e) {
+                            Log.d(WRITE_TAG, length + " bytes");
+                        }
+                    }
+                    if (flushed) {
+                        Map<String, Object> bundle = new HashMap<String, Object>();
+                        bundle.put("bytes", Arrays.copyOf(buffer, length));
+                        infoObervers(MESSAGE_WRITE, bundle);
+                    }
+                    if (callback != null) callback.onWritten(flushed);
+                }
+            });
         }
 
         public BluetoothDevice bluetoothDevice() {
@@ -341,6 +374,7 @@ public class BluetoothService {
         }
 
         public void cancel() {
+            if (mmWriter != null) mmWriter.close();
             try {
                 mmSocket.close();
                 connectionLost();
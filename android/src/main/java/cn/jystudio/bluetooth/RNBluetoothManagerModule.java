@@ -43,6 +43,7 @@ public class RNBluetoothManagerModule extends ReactContextBaseJavaModule
     public static final String EVENT_UNABLE_CONNECT = "EVENT_UNABLE_CONNECT";
     public static final String EVENT_CONNECTED = "EVENT_CONNECTED";
     public static final String EVENT_BLUETOOTH_NOT_SUPPORT = "EVENT_BLUETOOTH_NOT_SUPPORT";
+    public static final String EVENT_LABEL_PRINTED = "EVENT_LABEL_PRINTED";
 
 
     // Intent request codes
@@ -99,6 +100,7 @@ public class RNBluetoothManagerModule extends ReactContextBaseJavaModule
         constants.put(EVENT_CONNECTION_LOST, EVENT_CONNECTION_LOST);
         constants.put(EVENT_UNABLE_CONNECT, EVENT_UNABLE_CONNECT);
         constants.put(EVENT_CONNECTED, EVENT_CONNECTED);
+        constants.put(EVENT_LABEL_PRINTED, EVENT_LABEL_PRINTED);
         constants.put(EVENT_BLUETOOTH_NOT_SUPPORT, EVENT_BLUETOOTH_NOT_SUPPORT);
         constants.put(DEVICE_NAME, DEVICE_NAME);
         constants.put(EVENT_BLUETOOTH_NOT_SUPPORT, EVENT_BLUETOOTH_NOT_SUPPORT);
@@ -0,0 +1,167 @@
+package cn.jystudio.bluetooth;
+
+import android.util.Log;
+
+import javax.annotation.Nullable;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.List;
+
+/**
+ * The bytes on their way to the printer, written by a thread of its own so the module thread
+ * never waits on the socket. Small writes queued back to back go out as one frame of up to
+ * FRAME_SIZE bytes with one flush. write() blocks while CAPACITY bytes are still queued.
+ */
+public class WriteQueue extends Thread {
+    private static final String TAG = "WriteQueue";
+
+    public static final int FRAME_SIZE = 4096;
+    public static final int CAPACITY = 256 * 1024;
+
+    public interface Callback {
+        /**
+         * Called on the writer thread, flushed is false when the bytes did not reach the stream.
+         */
+        void onWritten(boolean flushed);
+    }
+
+    private static class Entry {
+        final byte[] data;
+        final int length;
+        final @Nullable Callback callback;
+
+        Entry(byte[] data, int length, @Nullable Callback callback) {
+            this.data = data;
+            this.length = length;
+            this.callback = callback;
+        }
+    }
+
+    private final OutputStream mOut;
+    private final int mFrameSize;
+    private final int mCapacity;
+    private final ArrayDeque<Entry> mQueue = new ArrayDeque<Entry>();
+    private int mQueuedBytes; // queued and being written
+    private boolean mClosed;
+
+    public WriteQueue(OutputStream out) {
+        this(out, FRAME_SIZE, CAPACITY);
+    }
+
+    public WriteQueue(OutputStream out, int frameSize, int capacity) {
+        mOut = out;
+        mFrameSize = frameSize;
+        mCapacity = capacity;
+        setName("WriteThread");
+    }
+
+    public boolean write(byte[] data, @Nullable Callback callback) {
+        return write(data, data.length, callback);
+    }
+
+    /**
+     * Queues data[0..length), waiting while the queue is full. The array is not copied,
+     * it must not change until the callback.
+     * @return false when the queue is closed, the callback is not called then
+     */
+    public boolean write(byte[] data, int length, @Nullable Callback callback) {
+        synchronized (this) {
+            try {
+                while (!mClosed && mQueuedBytes > 0 && mQueuedBytes + length > mCapacity) {
+                    wait();
+                }
+            } catch (InterruptedException e) {
+                Thread.currentThread().interrupt();
+                return false;
+            }
+            if (mClosed) return false;
+            mQueue.add(new Entry(data, length, callback));
+            mQueuedBytes += length;
+            notifyAll();
+        }
+        return true;
+    }
+
+    /**
+     * Stops the thread, the writes still queued are reported as not flushed.
+     */
+    public void close() {
+        List<Entry> dropped;
+        synchronized (this) {
+            mClosed = true;
+            dropped = new ArrayList<Entry>(mQueue);
+            mQueue.clear();
+            notifyAll();
+        }
+        report(dropped, false);
+    }
+
+    @Override
+    public void run() {
+        byte[] frame = new byte[mFrameSize];
+        List<Entry> batch = new ArrayList<Entry>();
+        while (true) {
+            byte[] data = frame;
+            int length = 0;
+            boolean interrupted = false;
+            batch.clear();
+            synchronized (this) {
+                try {
+                    while (mQueue.isEmpty() && !mClosed) {
+                        wait();
+                    }
+                } catch (InterruptedException e) {
+                    interrupted = true;
+                }
+                if (mClosed) return;
+                if (!interrupted) {
+                    Entry first = mQueue.peek();
+                    if (first.length >= mFrameSize) {
+                        // too big to join, written as it is
+                        batch.add(mQueue.poll());
+                        data = first.data;
+                        length = first.length;
+                    } else {
+                        Entry next;
+                        while ((next = mQueue.peek()) != null && length + next.length <= mFrameSize) {
+                            batch.add(mQueue.poll());
+                            System.arraycopy(next.data, 0, frame, length, next.length);
+                            length += next.length;
+                        }
+                    }
+                }
+            }
+            if (interrupted) {
+                // a write may have been queued while the interrupt was pending, close() settles it
+                close();
+                return;
+            }
+
+            boolean flushed = true;
+            try {
+                mOut.write(data, 0, length);
+                mOut.flush();
+            } catch (IOException e) {
+                Log.e(TAG, "Exception during write", e);
+                flushed = false;
+            }
+            synchronized (this) {
+                mQueuedBytes -= length;
+                notifyAll();
+            }
+            report(batch, flushed);
+            if (!flushed) {
+                close();
+                return;
+            }
+        }
+    }
+
+    private static void report(List<Entry> entries, boolean flushed) {
+        for (Entry entry : entries) {
+            if (entry.callback != null) entry.callback.onWritten(flushed);
+        }
+    }
+}
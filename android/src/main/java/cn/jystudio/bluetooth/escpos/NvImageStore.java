@@ -0,0 +1,66 @@
+package cn.jystudio.bluetooth.escpos;
+
+import android.content.Context;
+import android.content.SharedPreferences;
+import org.json.JSONException;
+import org.json.JSONObject;
+
+import javax.annotation.Nullable;
+import java.util.ArrayList;
+import java.util.Iterator;
+import java.util.List;
+
+/**
+ * Remembers which NV graphics were stored in which printer, by printer address.
+ * Every key maps to the hash of the image it was defined with, so an unchanged
+ * image is not written to the printer's flash again.
+ */
+public class NvImageStore {
+    private static final String PREFERENCES = "RNBluetoothEscposPrinter.nvImages";
+    private final SharedPreferences preferences;
+
+    public NvImageStore(Context context) {
+        this.preferences = context.getSharedPreferences(PREFERENCES, Context.MODE_PRIVATE);
+    }
+
+    private JSONObject images(String address) {
+        try {
+            return new JSONObject(preferences.getString(address, "{}"));
+        } catch (JSONException e) {
+            return new JSONObject();
+        }
+    }
+
+    public synchronized @Nullable String hashOf(String address, String key) {
+        return images(address).optString(key, null);
+    }
+
+    public synchronized void put(String address, String key, String hash) {
+        JSONObject images = images(address);
+        try {
+            images.put(key, hash);
+        } catch (JSONException e) {
+            return;
+        }
+        preferences.edit().putString(address, images.toString()).apply();
+    }
+
+    public synchronized void remove(String address, String key) {
+        JSONObject images = images(address);
+        images.remove(key);
+        preferences.edit().putString(address, images.toString()).apply();
+    }
+
+    public synchronized void clear(String address) {
+        preferences.edit().remove(address).apply();
+    }
+
+    public synchronized List<String> keys(String address) {
+        List<String> keys = new ArrayList<>();
+        Iterator<String> it = images(address).keys();
+        while (it.hasNext()) {
+            keys.add(it.next());
+        }
+        return keys;
+    }
+}
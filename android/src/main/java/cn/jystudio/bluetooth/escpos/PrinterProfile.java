@@ -0,0 +1,42 @@
+package cn.jystudio.bluetooth.escpos;
+
+import com.facebook.react.bridge.ReadableMap;
+
+import javax.annotation.Nullable;
+
+/**
+ * Capabilities of the connected ESC/POS printer, set from javascript with setPrinterProfile.
+ */
+public class PrinterProfile {
+    /**
+     * Rows packed under one GS v 0 header: 1 for printers that only take a scanline per command,
+     * 0 for the whole image in one command.
+     */
+    public int rasterRows = 24;
+
+    /**
+     * Whether the printer renders QR codes and PDF417 symbols itself from GS ( k, used by the
+     * symbol methods in auto mode.
+     */
+    public boolean nativeQRCode = false;
+    public boolean nativePDF417 = false;
+
+    /**
+     * Missing keys keep the default values.
+     */
+    public static PrinterProfile fromMap(@Nullable ReadableMap options) {
+        PrinterProfile profile = new PrinterProfile();
+        if (options != null) {
+            if (options.hasKey("rasterRows")) {
+                profile.rasterRows = Math.max(0, Math.min(options.getInt("rasterRows"), 0xffff));
+            }
+            if (options.hasKey("nativeQRCode")) {
+                profile.nativeQRCode = options.getBoolean("nativeQRCode");
+            }
+            if (options.hasKey("nativePDF417")) {
+                profile.nativePDF417 = options.getBoolean("nativePDF417");
+            }
+        }
+        return profile;
+    }
+}
@@ -0,0 +1,118 @@
+package cn.jystudio.bluetooth.escpos;
+
+import cn.jystudio.bluetooth.escpos.command.sdk.Command;
+import cn.jystudio.bluetooth.escpos.command.sdk.PrinterCommand;
+
+import javax.annotation.Nullable;
+import java.io.ByteArrayOutputStream;
+
+/**
+ * The print mode the printer is in, as far as the commands built since the connection tell.
+ * The mode commands only send the settings that differ from it, e.g. the GS ! / ESC t / ESC M
+ * in front of every text is dropped when the previous text used the same options.
+ */
+public class PrinterState {
+    private static final int UNKNOWN = -1;
+
+    private int size;
+    private int codePage;
+    private int font;
+    private int bold;
+    private int underline;
+    private int align;
+
+    public PrinterState() {
+        invalidate();
+    }
+
+    /**
+     * Forgets the mode, after a reconnect or a write that may not have reached the printer.
+     */
+    public synchronized void invalidate() {
+        size = codePage = font = bold = underline = align = UNKNOWN;
+    }
+
+    /**
+     * The power-on mode ESC @ returns to.
+     */
+    public synchronized void reset() {
+        size = codePage = font = bold = underline = align = 0;
+    }
+
+    public synchronized PrinterState copy() {
+        PrinterState state = new PrinterState();
+        state.restore(this);
+        return state;
+    }
+
+    public synchronized void restore(PrinterState other) {
+        synchronized (other) {
+            size = other.size;
+            codePage = other.codePage;
+            font = other.font;
+            bold = other.bold;
+            underline = other.underline;
+            align = other.align;
+        }
+    }
+
+    /**
+     * GS ! n, ESC t n and ESC M n of a text, only those that change.
+     * @return null when an option is out of range
+     */
+    public synchronized @Nullable byte[] textMode(int widthTimes, int heightTimes, int codePage, int font) {
+        if (codePage < 0 || codePage > 255) return null;
+        int size = (Math.max(0, Math.min(widthTimes, 3)) << 4) | Math.max(0, Math.min(heightTimes, 3));
+        ByteArrayOutputStream data = new ByteArrayOutputStream();
+        if (this.size != size) {
+            write(data, Command.GS_ExclamationMark, size);
+            this.size = size;
+        }
+        if (this.codePage != codePage) {
+            write(data, Command.ESC_t, codePage);
+            this.codePage = codePage;
+        }
+        if (this.font != (font & 0xff)) {
+            write(data, Command.ESC_M, font);
+            this.font = font & 0xff;
+        }
+        return data.toByteArray();
+    }
+
+    /**
+     * ESC E n / ESC G n, empty when the printer is already in that weight.
+     */
+    public synchronized byte[] bold(int bold) {
+        if (this.bold == (bold & 1)) return new byte[0];
+        this.bold = bold & 1;
+        return PrinterCommand.POS_Set_Bold(bold);
+    }
+
+    /**
+     * ESC - n / FS - n, empty when unchanged, null when line is not 0-2.
+     */
+    public synchronized @Nullable byte[] underline(int line) {
+        byte[] command = PrinterCommand.POS_Set_UnderLine(line);
+        if (command == null) return null;
+        if (this.underline == line) return new byte[0];
+        this.underline = line;
+        return command;
+    }
+
+    /**
+     * ESC a n, 0/48 left, 1/49 center, 2/50 right. Empty when unchanged, null for other values.
+     */
+    public synchronized @Nullable byte[] align(int align) {
+        byte[] command = PrinterCommand.POS_S_Align(align);
+        if (command == null) return null;
+        int value = align >= 48 ? align - 48 : align;
+        if (this.align == value) return new byte[0];
+        this.align = value;
+        return command;
+    }
+
+    private static void write(ByteArrayOutputStream data, byte[] command, int n) {
+        data.write(command, 0, command.length - 1);
+        data.write(n);
+    }
+}
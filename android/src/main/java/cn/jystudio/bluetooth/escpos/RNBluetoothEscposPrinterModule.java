@@ -7,23 +7,36 @@ import android.util.Base64;
 import android.util.Log;
 import cn.jystudio.bluetooth.BluetoothService;
 import cn.jystudio.bluetooth.BluetoothServiceStateObserver;
+import cn.jystudio.bluetooth.WriteQueue;
 import cn.jystudio.bluetooth.escpos.command.sdk.Command;
+import cn.jystudio.bluetooth.escpos.command.sdk.ImageDither;
 import cn.jystudio.bluetooth.escpos.command.sdk.PrintPicture;
 import cn.jystudio.bluetooth.escpos.command.sdk.PrinterCommand;
+import cn.jystudio.bluetooth.escpos.command.sdk.RasterCore;
+import cn.jystudio.bluetooth.escpos.command.sdk.TextEncoder;
+import cn.jystudio.bluetooth.escpos.command.sdk.TextLayout;
 import com.facebook.react.bridge.*;
 import com.google.zxing.BarcodeFormat;
 import com.google.zxing.EncodeHintType;
+import com.google.zxing.WriterException;
+import com.google.zxing.common.BitArray;
 import com.google.zxing.common.BitMatrix;
+import com.google.zxing.pdf417.PDF417Writer;
 import com.google.zxing.qrcode.QRCodeWriter;
 import com.google.zxing.qrcode.decoder.ErrorCorrectionLevel;
+import com.google.zxing.qrcode.encoder.Encoder;
 
 import javax.annotation.Nullable;
+import java.io.ByteArrayOutputStream;
+import java.io.UnsupportedEncodingException;
 import java.nio.charset.Charset;
 import java.util.*;
 
 public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         implements BluetoothServiceStateObserver {
     private static final String TAG = "BluetoothEscposPrinter";
+    private static final Charset UTF8 = Charset.forName("UTF-8");
+    private static final int QR_QUIET_ZONE = 4; // modules, kept blank inside the size of a raster QR code
 
     public static final int WIDTH_58 = 384;
     public static final int WIDTH_80 = 576;
@@ -31,6 +44,10 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
     /******************************************************************************************************/
 
     private int deviceWidth = WIDTH_58;
+    private PrinterProfile profile = new PrinterProfile();
+    private final PrinterState printerState = new PrinterState();
+    private final RasterCache rasterCache = new RasterCache();
+    private final NvImageStore nvImages;
     private BluetoothService mService;
 
 
@@ -39,6 +56,7 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         super(reactContext);
         this.reactContext = reactContext;
         this.mService = bluetoothService;
+        this.nvImages = new NvImageStore(reactContext);
         this.mService.addStateObserver(this);
     }
 
@@ -58,31 +76,24 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         return constants;
     }
 
+    private byte[] initData() {
+        printerState.reset();
+        return PrinterCommand.POS_Set_PrtInit();
+    }
+
     @ReactMethod
     public void printerInit(final Promise promise){
-        if(sendDataByte(PrinterCommand.POS_Set_PrtInit())){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(initData(), promise);
     }
 
     @ReactMethod
     public void printAndFeed(int feed,final Promise promise){
-        if(sendDataByte(PrinterCommand.POS_Set_PrtAndFeedPaper(feed))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(PrinterCommand.POS_Set_PrtAndFeedPaper(feed), promise);
     }
 
     @ReactMethod
     public void printerLeftSpace(int sp,final Promise promise){
-        if(sendDataByte(PrinterCommand.POS_Set_LeftSP(sp))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(PrinterCommand.POS_Set_LeftSP(sp), promise);
     }
 
     @ReactMethod
@@ -91,11 +102,7 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         if(sp>0){
             command = PrinterCommand.POS_Set_LineSpace(sp);
         }
-        if(command==null || !sendDataByte(command)){
-            promise.reject("COMMAND_NOT_SEND");
-        }else{
-            promise.resolve(null);
-        }
+        send(command, promise);
     }
 
     /**
@@ -104,11 +111,7 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
      */
     @ReactMethod
     public void printerUnderLine(int line,final Promise promise){
-        if(sendDataByte(PrinterCommand.POS_Set_UnderLine(line))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(printerState.underline(line), promise);
     }
 
     /**
@@ -121,202 +124,111 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
     @ReactMethod
     public void printerAlign(int align,final Promise promise){
         Log.d(TAG,"Align:"+align);
-        if(sendDataByte(PrinterCommand.POS_S_Align(align))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(printerState.align(align), promise);
     }
 
 
-    @ReactMethod
-    public void printText(String text, @Nullable  ReadableMap options, final Promise promise) {
-        try {
-            String encoding = "GBK";
-            int codepage = 0;
-            int widthTimes = 0;
-            int heigthTimes=0;
-            int fonttype=0;
-            boolean cut = false;
-            if(options!=null) {
-                encoding = options.hasKey("encoding") ? options.getString("encoding") : "GBK";
-                codepage = options.hasKey("codepage") ? options.getInt("codepage") : 0;
-                widthTimes = options.hasKey("widthtimes") ? options.getInt("widthtimes") : 0;
-                heigthTimes = options.hasKey("heigthtimes") ? options.getInt("heigthtimes") : 0;
-                fonttype = options.hasKey("fonttype") ? options.getInt("fonttype") : 0;
-                cut = options.hasKey("cut") && options.getBoolean("cut");
-            }
-            String toPrint = text;
-//            if ("UTF-8".equalsIgnoreCase(encoding)) {
-//                byte[] b = text.getBytes("UTF-8");
-//                toPrint = new String(b, Charset.forName(encoding));
-//            }
-
-            byte[] bytes = PrinterCommand.POS_Print_Text(toPrint, encoding, codepage, widthTimes, heigthTimes, fonttype);
-            boolean sent = sendDataByte(bytes);
-
-            if (sent && cut) {
-                sendDataByte(PrinterCommand.POS_Set_PrtAndFeedPaper(30));
-                sendDataByte(PrinterCommand.POS_Set_Cut(1));
-            }
-
-            if (sent) {
-                promise.resolve(null);
-            } else {
-                promise.reject("COMMAND_NOT_SEND");
-            }
-        }catch (Exception e){
-            promise.reject(e.getMessage(),e);
-        }
-    }
-
-    @ReactMethod
-    public void printColumn(ReadableArray columnWidths,ReadableArray columnAligns,ReadableArray columnTexts,
-                            @Nullable ReadableMap options,final Promise promise){
-        if(columnWidths.size()!=columnTexts.size() || columnWidths.size()!=columnAligns.size()){
-            promise.reject("COLUMN_WIDTHS_ALIGNS_AND_TEXTS_NOT_MATCH");
-            return;
-        }
-            int totalLen = 0;
-            for(int i=0;i<columnWidths.size();i++){
-                totalLen+=columnWidths.getInt(i);
-            }
-            int maxLen = deviceWidth/8;
-            if(totalLen>maxLen){
-                promise.reject("COLUNM_WIDTHS_TOO_LARGE");
-                return;
-            }
-
+    /**
+     * @return the text with the mode commands that differ from the printer's, a cut after the text
+     * with options.cut, null for text that can not be encoded.
+     */
+    private @Nullable byte[] textData(String text, @Nullable ReadableMap options) {
         String encoding = "GBK";
         int codepage = 0;
         int widthTimes = 0;
-        int heigthTimes = 0;
-        int fonttype = 0;
-        if (options != null) {
+        int heigthTimes=0;
+        int fonttype=0;
+        int fallback = '?';
+        boolean cut = false;
+        if(options!=null) {
             encoding = options.hasKey("encoding") ? options.getString("encoding") : "GBK";
             codepage = options.hasKey("codepage") ? options.getInt("codepage") : 0;
             widthTimes = options.hasKey("widthtimes") ? options.getInt("widthtimes") : 0;
             heigthTimes = options.hasKey("heigthtimes") ? options.getInt("heigthtimes") : 0;
             fonttype = options.hasKey("fonttype") ? options.getInt("fonttype") : 0;
+            cut = options.hasKey("cut") && options.getBoolean("cut");
+            fallback = TextEncoder.fallback(options.hasKey("fallback") ? options.getString("fallback") : null);
         }
-        Log.d(TAG,"encoding: "+encoding);
-
-        /**
-         * [column1-1,
-         * column1-2,
-         * column1-3 ... column1-n]
-         * ,
-         *  [column2-1,
-         * column2-2,
-         * column2-3 ... column2-n]
-         *
-         * ...
-         *
-         */
-        List<List<String>> table = new ArrayList<List<String>>();
-
-        /**splits the column text to few rows and applies the alignment **/
-        int padding = 1;
-        for(int i=0;i<columnWidths.size();i++){
-            int width =columnWidths.getInt(i)-padding;//1 char padding
-            String text = String.copyValueOf(columnTexts.getString(i).toCharArray());
-            List<ColumnSplitedString> splited = new ArrayList<ColumnSplitedString>();
-            int shorter = 0;
-            int counter = 0;
-            String temp = "";
-            for(int c=0;c<text.length();c++){
-                char ch = text.charAt(c);
-                int l = isChinese(ch)?2:1;
-                if (l==2){
-                    shorter++;
-                }
-                temp=temp+ch;
-
-                if(counter+l<width){
-                   counter = counter+l;
-                }else{
-                    splited.add(new ColumnSplitedString(shorter,temp));
-                    temp = "";
-                    counter=0;
-                    shorter=0;
-                }
-            }
-            if(temp.length()>0) {
-                splited.add(new ColumnSplitedString(shorter,temp));
-            }
-            int align = columnAligns.getInt(i);
-
-            List<String> formated = new ArrayList<String>();
-            for(ColumnSplitedString s: splited){
-                StringBuilder empty = new StringBuilder();
-                for(int w=0;w<(width+padding-s.getShorter());w++){
-                    empty.append(" ");
-                }
-                int startIdx = 0;
-                String ss = s.getStr();
-                if(align == 1 && ss.length()<(width-s.getShorter())){
-                    startIdx = (width-s.getShorter()-ss.length())/2;
-                    if(startIdx+ss.length()>width-s.getShorter()){
-                        startIdx--;
-                    }
-                    if(startIdx<0){
-                        startIdx=0;
-                    }
-                }else if(align==2 && ss.length()<(width-s.getShorter())){
-                    startIdx =width - s.getShorter()-ss.length();
-                }
-                Log.d(TAG,"empty.replace("+startIdx+","+(startIdx+ss.length())+","+ss+")");
-                empty.replace(startIdx,startIdx+ss.length(),ss);
-                formated.add(empty.toString());
+        if (text == null || text.isEmpty()) {
+            return null;
+        }
+        // the code pages TextEncoder has tables for skip the Charset lookup and its encoder
+        byte[] encoded = TextEncoder.encode(text, encoding, fallback);
+        if (encoded == null) {
+            try {
+                encoded = text.getBytes(encoding);
+            } catch (UnsupportedEncodingException e) {
+                return null;
             }
-            table.add(formated);
+        }
+        byte[] mode = printerState.textMode(widthTimes, heigthTimes, codepage, fonttype);
+        if (mode == null) {
+            return null;
+        }
+        byte[] bytes = PrinterCommand.concatAll(mode, encoded);
+        if (cut) {
+            bytes = PrinterCommand.concatAll(bytes, PrinterCommand.POS_Set_PrtAndFeedPaper(30), PrinterCommand.POS_Set_Cut(1));
+        }
+        return bytes;
+    }
 
+    @ReactMethod
+    public void printText(String text, @Nullable  ReadableMap options, final Promise promise) {
+        try {
+            send(textData(text, options), promise);
+        }catch (Exception e){
+            promise.reject(e.getMessage(),e);
         }
+    }
 
-        /**  try to find the max row count of the table **/
-        int maxRowCount = 0;
-        for(int i=0;i<table.size()/*column count*/;i++){
-            List<String> rows = table.get(i); // row data in current column
-            if(rows.size()>maxRowCount){maxRowCount = rows.size();}// try to find the max row count;
+    /**
+     * The text rows of a table, laid out by TextLayout and encoded as one printText with the options.
+     * @throws IllegalArgumentException with the error code as message
+     */
+    private byte[] columnData(ReadableArray columnWidths,ReadableArray columnAligns,ReadableArray columnTexts,
+                              @Nullable ReadableMap options) {
+        if(columnWidths.size()!=columnTexts.size() || columnWidths.size()!=columnAligns.size()){
+            throw new IllegalArgumentException("COLUMN_WIDTHS_ALIGNS_AND_TEXTS_NOT_MATCH");
+        }
+        int count = columnWidths.size();
+        int[] widths = new int[count];
+        int[] aligns = new int[count];
+        String[] texts = new String[count];
+        int totalLen = 0;
+        for(int i=0;i<count;i++){
+            widths[i] = columnWidths.getInt(i);
+            aligns[i] = columnAligns.getInt(i);
+            texts[i] = columnTexts.getString(i);
+            totalLen+=widths[i];
+        }
+        int maxLen = deviceWidth/8;
+        if(totalLen>maxLen){
+            throw new IllegalArgumentException("COLUNM_WIDTHS_TOO_LARGE");
         }
 
-        /** loop table again to fill the rows **/
-        StringBuilder[] rowsToPrint = new StringBuilder[maxRowCount];
-        for(int column=0;column<table.size()/*column count*/;column++){
-            List<String> rows = table.get(column); // row data in current column
-            for(int row=0;row<maxRowCount;row++){
-                if(rowsToPrint[row]==null){
-                    rowsToPrint[row] = new StringBuilder();
-                }
-                if(row<rows.size()){
-                    //got the row of this column
-                    rowsToPrint[row].append(rows.get(row));
-                }else{
-                    int w =columnWidths.getInt(column);
-                    StringBuilder empty = new StringBuilder();
-                   for(int i=0;i<w;i++){
-                       empty.append(" ");
-                   }
-                    rowsToPrint[row].append(empty.toString());//Append spaces to ensure the format
-                }
-            }
+        /** all rows in one payload **/
+        String table = TextLayout.columns(texts, widths, aligns);
+        if (table != null && table.isEmpty()) {
+            return new byte[0];
         }
+        byte[] data = textData(table, options);
+        if (data == null) {
+            throw new IllegalArgumentException("INVALID_PARAMETER");
+        }
+        return data;
+    }
 
-        /** loops the rows and print **/
-        for(int i=0;i<rowsToPrint.length;i++){
-            rowsToPrint[i].append("\n\r");//wrap line..
-            try {
-//                byte[] toPrint = rowsToPrint[i].toString().getBytes("UTF-8");
-//                String text = new String(toPrint, Charset.forName(encoding));
-                if (!sendDataByte(PrinterCommand.POS_Print_Text(rowsToPrint[i].toString(), encoding, codepage, widthTimes, heigthTimes, fonttype))) {
-                    promise.reject("COMMAND_NOT_SEND");
-                    return;
-                }
-            }catch (Exception e){
-                e.printStackTrace();
-            }
+    @ReactMethod
+    public void printColumn(ReadableArray columnWidths,ReadableArray columnAligns,ReadableArray columnTexts,
+                            @Nullable ReadableMap options,final Promise promise){
+        byte[] data;
+        try {
+            data = columnData(columnWidths, columnAligns, columnTexts, options);
+        } catch (IllegalArgumentException e) {
+            promise.reject(e.getMessage());
+            return;
         }
-        promise.resolve(null);
+        send(data, promise);
     }
 
     @ReactMethod
@@ -324,21 +236,34 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         deviceWidth = width;
     }
 
+    /**
+     * Sets what the connected printer supports, e.g. {rasterRows:24}
+     */
     @ReactMethod
-    public void printPic(String base64encodeStr, @Nullable  ReadableMap options) {
+    public void setPrinterProfile(@Nullable ReadableMap options) {
+        profile = PrinterProfile.fromMap(options);
+    }
+
+    private static class PicOptions {
         int width = 0;
         int leftPadding = 0;
         boolean autoCut = true;
+        int dither = ImageDither.THRESHOLD;
+    }
+
+    private PicOptions picOptions(@Nullable ReadableMap options) {
+        PicOptions pic = new PicOptions();
         boolean center = true;
         int paperSize = 58;
         int paperWidthDots = WIDTH_58;
 
         if(options!=null){
-            width = options.hasKey("width") ? options.getInt("width") : 0;
-            leftPadding = options.hasKey("left")?options.getInt("left") : 0;
-            autoCut = options.hasKey("autoCut") ? options.getBoolean("autoCut") : true;
+            pic.width = options.hasKey("width") ? options.getInt("width") : 0;
+            pic.leftPadding = options.hasKey("left")?options.getInt("left") : 0;
+            pic.autoCut = options.hasKey("autoCut") ? options.getBoolean("autoCut") : true;
             center = options.hasKey("center") ? options.getBoolean("center") : true;
             paperSize = options.hasKey("paperSize") ? options.getInt("paperSize") : 58;
+            pic.dither = ImageDither.modeWithName(options.hasKey("dither") ? options.getString("dither") : null, ImageDither.THRESHOLD);
         }
 
         if (paperSize == 80) {
@@ -347,40 +272,248 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
             paperWidthDots = WIDTH_58; // 58mm = 384 dots
         }
 
-        if (width > paperWidthDots || width == 0) {
-            width = paperWidthDots;
+        if (pic.width > paperWidthDots || pic.width == 0) {
+            pic.width = paperWidthDots;
         }
 
         if (center) {
-            leftPadding = (paperWidthDots - width) / 2;
-            if (leftPadding < 0) leftPadding = 0;
+            pic.leftPadding = (paperWidthDots - pic.width) / 2;
+            if (pic.leftPadding < 0) pic.leftPadding = 0;
         }
+        return pic;
+    }
+
+    /**
+     * The raster also depends on the width, padding, dither and rows per command, they are part of the key.
+     */
+    private String picKey(String base64encodeStr, PicOptions pic) {
+        return RasterCache.keyFor(base64encodeStr,
+                "|pic|" + pic.width + "|" + pic.leftPadding + "|" + pic.dither + "|" + profile.rasterRows);
+    }
 
+    /**
+     * @return the GS v 0 commands of the image, null if it can not be decoded.
+     */
+    private @Nullable byte[] encodePic(String base64encodeStr, PicOptions pic) {
         byte[] bytes = Base64.decode(base64encodeStr, Base64.DEFAULT);
         Bitmap mBitmap = BitmapFactory.decodeByteArray(bytes, 0, bytes.length);
         int nMode = 0;
 
-        if (mBitmap != null) {
-            /**
-             * Parameters:
-             * mBitmap  要打印的图片
-             * nWidth   打印宽度（58和80）
-             * nMode    打印模式
-             * Returns: byte[]
-             */
-            byte[] data = PrintPicture.POS_PrintBMP(mBitmap, width, nMode, leftPadding);
-            //  SendDataByte(buffer);
-            sendDataByte(Command.ESC_Init);
-            // sendDataByte(Command.LF);
-            sendDataByte(data);
-            sendDataByte(PrinterCommand.POS_Set_PrtAndFeedPaper(30));
-            if (autoCut) {
-                sendDataByte(PrinterCommand.POS_Set_Cut(1));
+        if (mBitmap == null) {
+            return null;
+        }
+        /**
+         * Parameters:
+         * mBitmap  要打印的图片
+         * nWidth   打印宽度（58和80）
+         * nMode    打印模式
+         * Returns: byte[]
+         */
+        return PrintPicture.POS_PrintBMP(mBitmap, pic.width, nMode, pic.leftPadding, profile.rasterRows, pic.dither);
+    }
+
+    private byte[] picCommands(byte[] data, boolean autoCut) {
+        //  SendDataByte(buffer);
+        // sendDataByte(Command.LF);
+        // starts and ends with ESC @
+        printerState.reset();
+        return PrinterCommand.concatAll(Command.ESC_Init, data, PrinterCommand.POS_Set_PrtAndFeedPaper(30),
+                autoCut ? PrinterCommand.POS_Set_Cut(1) : new byte[0], PrinterCommand.POS_Set_PrtInit());
+    }
+
+    /**
+     * @return the commands that print the image, from the cache when it was printed before.
+     */
+    private @Nullable byte[] picData(String base64encodeStr, @Nullable ReadableMap options) {
+        PicOptions pic = picOptions(options);
+        String key = picKey(base64encodeStr, pic);
+        byte[] data = rasterCache.get(key);
+        if (data == null) {
+            data = encodePic(base64encodeStr, pic);
+            if (data == null) {
+                return null;
             }
-            sendDataByte(PrinterCommand.POS_Set_PrtInit());
+            rasterCache.put(key, data);
         }
+        return picCommands(data, pic.autoCut);
     }
 
+    @ReactMethod
+    public void printPic(String base64encodeStr, @Nullable  ReadableMap options) {
+        sendDataByte(picData(base64encodeStr, options));
+    }
+
+    /**
+     * Encodes an image once and keeps it under imageId, e.g. the header logo,
+     * printRegisteredPic then sends it without any image work.
+     */
+    @ReactMethod
+    public void registerPic(String imageId, String base64encodeStr, @Nullable ReadableMap options, final Promise promise) {
+        byte[] data = imageId == null ? null : encodePic(base64encodeStr, picOptions(options));
+        if (data == null) {
+            promise.reject("INVALID_PARAMETER");
+            return;
+        }
+        rasterCache.register(imageId, data);
+        promise.resolve(null);
+    }
+
+    private @Nullable byte[] registeredPicData(String imageId, @Nullable ReadableMap options) {
+        byte[] data = rasterCache.getRegistered(imageId);
+        return data == null ? null : picCommands(data, picOptions(options).autoCut);
+    }
+
+    @ReactMethod
+    public void printRegisteredPic(String imageId, @Nullable ReadableMap options, final Promise promise) {
+        byte[] data = registeredPicData(imageId, options);
+        if (data == null) {
+            promise.reject("IMAGE_NOT_REGISTERED");
+        } else {
+            send(data, promise);
+        }
+    }
+
+    /**
+     * Memory cap in bytes of the recently printed images.
+     */
+    @ReactMethod
+    public void setPicCacheSize(int bytes) {
+        rasterCache.setCapacity(bytes);
+    }
+
+    @ReactMethod
+    public void clearPicCache() {
+        rasterCache.clear();
+    }
+
+    @ReactMethod
+    public void getPicCacheStats(final Promise promise) {
+        promise.resolve(rasterCache.stats());
+    }
+
+    /**
+     * NV graphics keys are two printable ASCII characters, e.g. "L1".
+     */
+    private static boolean isNvKey(@Nullable String key) {
+        return key != null && key.length() == 2
+                && PrinterCommand.isNvKey(key.charAt(0)) && PrinterCommand.isNvKey(key.charAt(1));
+    }
+
+    private @Nullable String connectedAddress() {
+        return mService.getState() == BluetoothService.STATE_CONNECTED ? mService.getLastConnectedDeviceAddress() : null;
+    }
+
+    /**
+     * Stores an image in the printer's NV graphics memory under key, printNvImage then prints it
+     * with 11 bytes. Resolves false without writing when the printer already holds the same image,
+     * unless options.force is set. NV memory is flash, avoid redefining images on every receipt.
+     */
+    @ReactMethod
+    public void uploadNvImage(final String key, String base64encodeStr, @Nullable ReadableMap options, final Promise promise) {
+        final String address = connectedAddress();
+        if (address == null) {
+            promise.reject("COMMAND_NOT_SEND");
+            return;
+        }
+        if (!isNvKey(key)) {
+            promise.reject("INVALID_PARAMETER");
+            return;
+        }
+        PicOptions pic = picOptions(options);
+        boolean force = options != null && options.hasKey("force") && options.getBoolean("force");
+        final String hash = RasterCache.keyFor(base64encodeStr, "|nv|" + pic.width + "|" + pic.dither);
+        if (!force && hash.equals(nvImages.hashOf(address, key))) {
+            promise.resolve(false);
+            return;
+        }
+        byte[] bytes = Base64.decode(base64encodeStr, Base64.DEFAULT);
+        Bitmap mBitmap = BitmapFactory.decodeByteArray(bytes, 0, bytes.length);
+        if (mBitmap == null) {
+            promise.reject("INVALID_PARAMETER");
+            return;
+        }
+        try {
+            byte[] data = PrintPicture.POS_DefineNvBMP(mBitmap, pic.width, key.charAt(0), key.charAt(1), pic.dither);
+            send(data, promise, true, new Runnable() {
+                @Override
+                public void run() {
+                    nvImages.put(address, key, hash);
+                }
+            });
+        } catch (IllegalArgumentException e) {
+            promise.reject("INVALID_PARAMETER", e);
+        }
+    }
+
+    private @Nullable byte[] nvImageData(String key) {
+        String address = connectedAddress();
+        if (address == null || !isNvKey(key) || nvImages.hashOf(address, key) == null) {
+            return null;
+        }
+        return RasterCore.nvPrint(key.charAt(0), key.charAt(1));
+    }
+
+    /**
+     * Prints an image stored with uploadNvImage, at the current alignment.
+     */
+    @ReactMethod
+    public void printNvImage(String key, final Promise promise) {
+        byte[] data = nvImageData(key);
+        if (connectedAddress() == null) {
+            promise.reject("COMMAND_NOT_SEND");
+        } else if (data == null) {
+            promise.reject("NV_IMAGE_NOT_STORED");
+        } else {
+            send(data, promise);
+        }
+    }
+
+    @ReactMethod
+    public void deleteNvImage(final String key, final Promise promise) {
+        final String address = connectedAddress();
+        if (address == null) {
+            promise.reject("COMMAND_NOT_SEND");
+        } else if (!isNvKey(key)) {
+            promise.reject("INVALID_PARAMETER");
+        } else {
+            send(RasterCore.nvDelete(key.charAt(0), key.charAt(1)), promise, null, new Runnable() {
+                @Override
+                public void run() {
+                    nvImages.remove(address, key);
+                }
+            });
+        }
+    }
+
+    @ReactMethod
+    public void clearNvImages(final Promise promise) {
+        final String address = connectedAddress();
+        if (address == null) {
+            promise.reject("COMMAND_NOT_SEND");
+            return;
+        }
+        send(RasterCore.nvDeleteAll(), promise, null, new Runnable() {
+            @Override
+            public void run() {
+                nvImages.clear(address);
+            }
+        });
+    }
+
+    /**
+     * Keys of the images stored in the connected printer.
+     */
+    @ReactMethod
+    public void getNvImages(final Promise promise) {
+        String address = connectedAddress();
+        WritableArray keys = Arguments.createArray();
+        if (address != null) {
+            for (String key : nvImages.keys(address)) {
+                keys.pushString(key);
+            }
+        }
+        promise.resolve(keys);
+    }
 
     @ReactMethod
     public void selfTest(@Nullable Callback cb) {
@@ -396,62 +529,122 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
      */
     @ReactMethod
     public void rotate(int rotate,final Promise promise) {
-        if(sendDataByte(PrinterCommand.POS_Set_Rotate(rotate))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
-        }
+        send(PrinterCommand.POS_Set_Rotate(rotate), promise);
     }
 
     @ReactMethod
     public void setBlob(int weight,final Promise promise) {
-        if(sendDataByte(PrinterCommand.POS_Set_Bold(weight))){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_NOT_SEND");
+        send(printerState.bold(weight), promise);
+    }
+
+    /**
+     * Whether a symbol goes out as the printer's own GS ( k command: options.mode is native,
+     * raster or auto, auto follows what the printer profile supports.
+     */
+    private static boolean nativeSymbol(@Nullable ReadableMap options, boolean supported) {
+        String mode = options != null && options.hasKey("mode") ? options.getString("mode") : "auto";
+        if ("native".equals(mode)) return true;
+        if ("raster".equals(mode)) return false;
+        return supported;
+    }
+
+    private static int optInt(@Nullable ReadableMap options, String key, int fallback) {
+        return options != null && options.hasKey(key) ? options.getInt(key) : fallback;
+    }
+
+    private byte[] qrCodeData(String content, int size, int correctionLevel, @Nullable ReadableMap options) throws WriterException {
+        Log.i(TAG, "生成的文本：" + content);
+        ErrorCorrectionLevel level = ErrorCorrectionLevel.forBits(correctionLevel);
+        Hashtable<EncodeHintType, Object> hints = new Hashtable<EncodeHintType, Object>();
+        hints.put(EncodeHintType.CHARACTER_SET, "utf-8");
+        hints.put(EncodeHintType.ERROR_CORRECTION, level);
+        if (nativeSymbol(options, profile.nativeQRCode)) {
+            int moduleSize = optInt(options, "moduleSize", 0);
+            if (moduleSize <= 0) {
+                // the module size that prints the symbol about size dots wide
+                int modules = Encoder.encode(content, level, hints).getVersion().getDimensionForVersion();
+                moduleSize = size / modules;
+            }
+            byte[] command = PrinterCommand.getNativeQRCodeCommand(content.getBytes(UTF8),
+                    Math.max(1, Math.min(moduleSize, 16)), level.ordinal());
+            if (command != null) {
+                return command;
+            }
+        }
+
+        String key = RasterCache.keyFor(content, "|qr|" + size + "|" + correctionLevel + "|" + profile.rasterRows);
+        byte[] cached = rasterCache.get(key);
+        if (cached != null) {
+            return cached;
         }
+        // 把输入的文本转为二维码, one bit per module, scaled while packed
+        hints.put(EncodeHintType.MARGIN, 0);
+        BitMatrix bitMatrix = new QRCodeWriter().encode(content,
+                BarcodeFormat.QR_CODE, 0, 0, hints);
+        int scale = Math.max(1, size / (bitMatrix.getWidth() + 2 * QR_QUIET_ZONE));
+        byte[] data = symbolData(bitMatrix, scale, size, size);
+        rasterCache.put(key, data);
+        return data;
     }
 
-    @ReactMethod
-    public void printQRCode(String content, int size, int correctionLevel, final Promise promise) {
-        try {
-            Log.i(TAG, "生成的文本：" + content);
-            // 把输入的文本转为二维码
-            Hashtable<EncodeHintType, Object> hints = new Hashtable<EncodeHintType, Object>();
-            hints.put(EncodeHintType.CHARACTER_SET, "utf-8");
-            hints.put(EncodeHintType.ERROR_CORRECTION, ErrorCorrectionLevel.forBits(correctionLevel));
-            BitMatrix bitMatrix = new QRCodeWriter().encode(content,
-                    BarcodeFormat.QR_CODE, size, size, hints);
-
-            int width = bitMatrix.getWidth();
-            int height = bitMatrix.getHeight();
-
-            System.out.println("w:" + width + "h:"
-                    + height);
-
-            int[] pixels = new int[width * height];
-            for (int y = 0; y < height; y++) {
-                for (int x = 0; x < width; x++) {
-                    if (bitMatrix.get(x, y)) {
-                        pixels[y * width + x] = 0xff000000;
-                    } else {
-                        pixels[y * width + x] = 0xffffffff;
-                    }
-                }
+    private byte[] pdf417Data(String content, @Nullable ReadableMap options) throws WriterException {
+        int errorCorrection = Math.max(0, Math.min(optInt(options, "errorCorrection", 2), 8));
+        if (nativeSymbol(options, profile.nativePDF417)) {
+            byte[] command = PrinterCommand.getPDF417Command(content.getBytes(UTF8),
+                    optInt(options, "columns", 0), optInt(options, "moduleWidth", 3),
+                    optInt(options, "rowHeight", 3), errorCorrection);
+            if (command != null) {
+                return command;
             }
+        }
+        int width = optInt(options, "width", deviceWidth);
+        Hashtable<EncodeHintType, Object> hints = new Hashtable<EncodeHintType, Object>();
+        hints.put(EncodeHintType.CHARACTER_SET, "utf-8");
+        hints.put(EncodeHintType.ERROR_CORRECTION, errorCorrection);
+        hints.put(EncodeHintType.MARGIN, 0);
+        BitMatrix bitMatrix = new PDF417Writer().encode(content, BarcodeFormat.PDF_417, 0, 0, hints);
+        return symbolData(bitMatrix, Math.max(1, width / bitMatrix.getWidth()), 0, 0);
+    }
 
-            Bitmap bitmap = Bitmap.createBitmap(width, height,
-                    Bitmap.Config.ARGB_8888);
+    /**
+     * GS v 0 rows packed straight from the bits of a symbol, every module scale x scale dots,
+     * centred in boxWidth x boxHeight dots.
+     */
+    private byte[] symbolData(BitMatrix bitMatrix, int scale, int boxWidth, int boxHeight) {
+        int width = bitMatrix.getWidth();
+        int height = bitMatrix.getHeight();
+        int rowWords = (width + 31) / 32;
+        int[] bits = new int[rowWords * height];
+        BitArray row = new BitArray(width);
+        for (int y = 0; y < height; y++) {
+            row = bitMatrix.getRow(y, row);
+            System.arraycopy(row.getBitArray(), 0, bits, y * rowWords, rowWords);
+        }
+        return RasterCore.encodeSymbol(bits, rowWords, width, height, scale, 0, boxWidth, boxHeight, profile.rasterRows);
+    }
 
-            bitmap.setPixels(pixels, 0, width, 0, 0, width, height);
+    /**
+     * options.mode: native sends the printer's GS ( k command, raster an image of the code, auto
+     * (default) the command when the printer profile has nativeQRCode. options.moduleSize sets the
+     * dots per module of the native code, by default the one closest to size.
+     */
+    @ReactMethod
+    public void printQRCode(String content, int size, int correctionLevel, @Nullable ReadableMap options, final Promise promise) {
+        try {
+            send(qrCodeData(content, size, correctionLevel, options), promise);
+        } catch (Exception e) {
+            promise.reject(e.getMessage(), e);
+        }
+    }
 
-            //TODO: may need a left padding to align center.
-            byte[] data = PrintPicture.POS_PrintBMP(bitmap, size, 0, 0);
-            if (sendDataByte(data)) {
-                promise.resolve(null);
-            } else {
-                promise.reject("COMMAND_NOT_SEND");
-            }
+    /**
+     * options: mode as for printQRCode, following nativePDF417 of the profile, columns,
+     * moduleWidth, rowHeight and errorCorrection (0-8) of the native symbol, width of the raster.
+     */
+    @ReactMethod
+    public void printPDF417(String content, @Nullable ReadableMap options, final Promise promise) {
+        try {
+            send(pdf417Data(content, options), promise);
         } catch (Exception e) {
             promise.reject(e.getMessage(), e);
         }
@@ -487,52 +680,179 @@ public class RNBluetoothEscposPrinterModule extends ReactContextBaseJavaModule
         }
     }    
 
-    private boolean sendDataByte(byte[] data) {
-        if (data==null || mService.getState() != BluetoothService.STATE_CONNECTED) {
-            return false;
-        }
-        mService.write(data);
-        return true;
+    private static @Nullable ReadableMap optMap(ReadableArray args, int index) {
+        return args.size() > index && !args.isNull(index) ? args.getMap(index) : null;
     }
 
-    // 根据Unicode编码完美的判断中文汉字和符号
-    private static boolean isChinese(char c) {
-        Character.UnicodeBlock ub = Character.UnicodeBlock.of(c);
-        if (ub == Character.UnicodeBlock.CJK_UNIFIED_IDEOGRAPHS
-                || ub == Character.UnicodeBlock.CJK_COMPATIBILITY_IDEOGRAPHS
-                || ub == Character.UnicodeBlock.CJK_UNIFIED_IDEOGRAPHS_EXTENSION_A
-                || ub == Character.UnicodeBlock.CJK_UNIFIED_IDEOGRAPHS_EXTENSION_B
-                || ub == Character.UnicodeBlock.CJK_SYMBOLS_AND_PUNCTUATION
-                || ub == Character.UnicodeBlock.HALFWIDTH_AND_FULLWIDTH_FORMS
-                || ub == Character.UnicodeBlock.GENERAL_PUNCTUATION) {
-            return true;
+    /**
+     * One operation of printBatch, named after the method it stands for and with the same arguments.
+     * @return null when the operation is invalid
+     * @throws IllegalArgumentException with the error code as message
+     */
+    private @Nullable byte[] batchData(String command, ReadableArray args) throws Exception {
+        switch (command) {
+            case "printerInit":
+                return initData();
+            case "printAndFeed":
+                return PrinterCommand.POS_Set_PrtAndFeedPaper(args.getInt(0));
+            case "printerLeftSpace":
+                return PrinterCommand.POS_Set_LeftSP(args.getInt(0));
+            case "printerLineSpace":
+                return args.getInt(0) > 0 ? PrinterCommand.POS_Set_LineSpace(args.getInt(0)) : PrinterCommand.POS_Set_DefLineSpace();
+            case "printerUnderLine":
+                return printerState.underline(args.getInt(0));
+            case "printerAlign":
+                return printerState.align(args.getInt(0));
+            case "setBlob":
+                return printerState.bold(args.getInt(0));
+            case "rotate":
+                return PrinterCommand.POS_Set_Rotate(args.getInt(0));
+            case "printText":
+                return textData(args.getString(0), optMap(args, 1));
+            case "printColumn":
+                return columnData(args.getArray(0), args.getArray(1), args.getArray(2), optMap(args, 3));
+            case "printPic":
+                return picData(args.getString(0), optMap(args, 1));
+            case "printRegisteredPic":
+                byte[] registered = registeredPicData(args.getString(0), optMap(args, 1));
+                if (registered == null) throw new IllegalArgumentException("IMAGE_NOT_REGISTERED");
+                return registered;
+            case "printNvImage":
+                byte[] nv = nvImageData(args.getString(0));
+                if (nv == null) throw new IllegalArgumentException("NV_IMAGE_NOT_STORED");
+                return nv;
+            case "printQRCode":
+                return qrCodeData(args.getString(0), args.getInt(1), args.getInt(2), optMap(args, 3));
+            case "printPDF417":
+                return pdf417Data(args.getString(0), optMap(args, 1));
+            case "printBarCode":
+                return PrinterCommand.getBarCodeCommand(args.getString(0), args.getInt(1), args.getInt(2),
+                        args.getInt(3), args.getInt(4), args.getInt(5));
+            case "openDrawer":
+                return PrinterCommand.POS_Set_Cashbox(args.getInt(0), args.getInt(1), args.getInt(2));
+            case "cutOnePoint":
+                return PrinterCommand.POS_Cut_One_Point();
+            default:
+                throw new IllegalArgumentException("UNKNOWN_COMMAND");
         }
-        return false;
     }
 
-    @Override
-    public void onBluetoothServiceStateChanged(int state, Map<String, Object> boundle) {
-
+    /**
+     * Encodes a whole receipt, [{command:'printText',args:['Hello\n\r',{}]},...], into one payload
+     * and writes it as a single stream. Nothing is sent when an operation is invalid, the promise is
+     * rejected with INVALID_BATCH and userInfo.errors: [{index,command,code}].
+     */
+    @ReactMethod
+    public void printBatch(ReadableArray ops, final Promise promise) {
+        ByteArrayOutputStream data = new ByteArrayOutputStream();
+        WritableArray errors = Arguments.createArray();
+        PrinterState before = printerState.copy();
+        for (int i = 0; i < ops.size(); i++) {
+            String command = null;
+            String code = "INVALID_PARAMETER";
+            byte[] opData = null;
+            try {
+                ReadableMap op = ops.getMap(i);
+                command = op.hasKey("command") ? op.getString("command") : null;
+                ReadableArray args = op.hasKey("args") && !op.isNull("args") ? op.getArray("args") : Arguments.createArray();
+                if (command == null) {
+                    code = "UNKNOWN_COMMAND";
+                } else {
+                    opData = batchData(command, args);
+                }
+            } catch (IllegalArgumentException e) {
+                if (e.getMessage() != null) code = e.getMessage();
+            } catch (Exception e) {
+                Log.d(TAG, "print batch: " + e.getMessage());
+            }
+            if (opData != null) {
+                data.write(opData, 0, opData.length);
+            } else {
+                WritableMap error = Arguments.createMap();
+                error.putInt("index", i);
+                error.putString("command", command == null ? "" : command);
+                error.putString("code", code);
+                errors.pushMap(error);
+            }
+        }
+        if (errors.size() > 0) {
+            WritableMap userInfo = Arguments.createMap();
+            userInfo.putArray("errors", errors);
+            printerState.restore(before);
+            promise.reject("INVALID_BATCH", "INVALID_BATCH", userInfo);
+            return;
+        }
+        send(data.toByteArray(), promise);
     }
 
-    /****************************************************************************************************/
-
-    private static class ColumnSplitedString{
-        private int shorter;
-        private String str;
+    private boolean sendDataByte(byte[] data) {
+        return sendDataByte(data, null);
+    }
 
-        public ColumnSplitedString(int shorter, String str) {
-            this.shorter = shorter;
-            this.str = str;
+    /**
+     * Queues the data for the writer thread.
+     * @param callback told once the data is flushed or failed, not called when this returns false
+     */
+    private boolean sendDataByte(@Nullable byte[] data, @Nullable final WriteQueue.Callback callback) {
+        if (data == null) {
+            return false;
+        }
+        if (mService.getState() != BluetoothService.STATE_CONNECTED) {
+            // the mode the data was built against never reached the printer
+            printerState.invalidate();
+            return false;
+        }
+        if (data.length == 0) {
+            if (callback != null) callback.onWritten(true);
+            return true;
         }
+        boolean queued = mService.write(data, new WriteQueue.Callback() {
+            @Override
+            public void onWritten(boolean flushed) {
+                if (!flushed) printerState.invalidate();
+                if (callback != null) callback.onWritten(flushed);
+            }
+        });
+        if (!queued) printerState.invalidate();
+        return queued;
+    }
+
+    /**
+     * Sends the data, the promise is resolved once it is flushed to the printer.
+     */
+    private void send(@Nullable byte[] data, final Promise promise) {
+        send(data, promise, null, null);
+    }
 
-        public int getShorter() {
-            return shorter;
+    /**
+     * @param result what the promise is resolved with
+     * @param onFlushed run on the writer thread before the promise is resolved
+     */
+    private void send(@Nullable byte[] data, final Promise promise, @Nullable final Object result,
+                      @Nullable final Runnable onFlushed) {
+        boolean queued = sendDataByte(data, new WriteQueue.Callback() {
+            @Override
+            public void onWritten(boolean flushed) {
+                if (!flushed) {
+                    promise.reject("COMMAND_NOT_SEND");
+                    return;
+                }
+                if (onFlushed != null) onFlushed.run();
+                promise.resolve(result);
+            }
+        });
+        if (!queued) {
+            promise.reject("COMMAND_NOT_SEND");
         }
+    }
 
-        public String getStr() {
-            return str;
+    @Override
+    public void onBluetoothServiceStateChanged(int state, Map<String, Object> boundle) {
+        if (state == BluetoothService.STATE_CONNECTED || state == BluetoothService.STATE_NONE) {
+            printerState.invalidate();
         }
     }
 
+    /****************************************************************************************************/
+
 }
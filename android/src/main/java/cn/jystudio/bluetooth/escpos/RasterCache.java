@@ -0,0 +1,96 @@
+package cn.jystudio.bluetooth.escpos;
+
+import android.util.LruCache;
+import com.facebook.react.bridge.Arguments;
+import com.facebook.react.bridge.WritableMap;
+
+import java.nio.charset.Charset;
+import java.security.MessageDigest;
+import java.security.NoSuchAlgorithmException;
+import java.util.HashMap;
+import java.util.Map;
+
+/**
+ * Encoded GS v 0 rasters of printed images, so a repeated logo or QR code skips the
+ * decode/scale/dither work. Recently used entries are kept up to the byte cap,
+ * images registered by id are kept until the cache is cleared.
+ */
+public class RasterCache {
+    private static final int DEFAULT_CAPACITY = 1024 * 1024;
+
+    private final LruCache<String, byte[]> entries = new LruCache<String, byte[]>(DEFAULT_CAPACITY) {
+        @Override
+        protected int sizeOf(String key, byte[] value) {
+            return value.length;
+        }
+    };
+    private final Map<String, byte[]> registered = new HashMap<>();
+
+    /**
+     * SHA-1 of the source content and everything else the raster depends on.
+     */
+    public static String keyFor(String content, String params) {
+        try {
+            MessageDigest digest = MessageDigest.getInstance("SHA-1");
+            digest.update(content.getBytes(Charset.forName("UTF-8")));
+            digest.update(params.getBytes(Charset.forName("UTF-8")));
+            StringBuilder key = new StringBuilder();
+            for (byte b : digest.digest()) {
+                key.append(String.format("%02x", b & 0xff));
+            }
+            return key.toString();
+        } catch (NoSuchAlgorithmException e) {
+            throw new IllegalStateException(e);
+        }
+    }
+
+    public byte[] get(String key) {
+        return entries.get(key);
+    }
+
+    /**
+     * Rasters larger than the cap are not kept.
+     */
+    public void put(String key, byte[] data) {
+        if (data != null && data.length <= entries.maxSize()) {
+            entries.put(key, data);
+        }
+    }
+
+    public int capacity() {
+        return entries.maxSize();
+    }
+
+    public void setCapacity(int bytes) {
+        entries.resize(Math.max(bytes, 1));
+    }
+
+    public synchronized byte[] getRegistered(String imageId) {
+        return registered.get(imageId);
+    }
+
+    public synchronized void register(String imageId, byte[] data) {
+        registered.put(imageId, data);
+    }
+
+    public synchronized void clear() {
+        entries.evictAll();
+        registered.clear();
+    }
+
+    public synchronized WritableMap stats() {
+        int registeredSize = 0;
+        for (byte[] data : registered.values()) {
+            registeredSize += data.length;
+        }
+        WritableMap stats = Arguments.createMap();
+        stats.putInt("hits", entries.hitCount());
+        stats.putInt("misses", entries.missCount());
+        stats.putInt("entries", entries.snapshot().size());
+        stats.putInt("size", entries.size());
+        stats.putInt("capacity", entries.maxSize());
+        stats.putInt("registered", registered.size());
+        stats.putInt("registeredSize", registeredSize);
+        return stats;
+    }
+}
@@ -0,0 +1,36 @@
+package cn.jystudio.bluetooth.escpos.command.sdk;
+
+/**
+ * 图片二值化方式, 与cpp/raster.h中的raster_dither_mode一致, 由RasterCore实现.
+ */
+public class ImageDither {
+    public static final int THRESHOLD = 0;//global mean threshold, the original behaviour
+    public static final int FLOYD_STEINBERG = 1;
+    public static final int ATKINSON = 2;
+    public static final int BAYER4 = 3;
+    public static final int BAYER8 = 4;
+    public static final int BAYER16 = 5;
+
+    /**
+     * "threshold","floyd-steinberg","atkinson","bayer4","bayer8","bayer16", unknown names give fallback.
+     */
+    public static int modeWithName(String name, int fallback) {
+        if (name == null) return fallback;
+        switch (name.toLowerCase()) {
+            case "threshold":
+                return THRESHOLD;
+            case "floyd-steinberg":
+                return FLOYD_STEINBERG;
+            case "atkinson":
+                return ATKINSON;
+            case "bayer4":
+                return BAYER4;
+            case "bayer8":
+                return BAYER8;
+            case "bayer16":
+                return BAYER16;
+            default:
+                return fallback;
+        }
+    }
+}
@@ -12,7 +12,6 @@ public class PrintPicture {
     private static int[] p4 = new int[]{0, 8};
     private static int[] p5 = new int[]{0, 4};
     private static int[] p6 = new int[]{0, 2};
-    private static int[][] Floyd16x16 = new int[][]{{0, 128, 32, 160, 8, 136, 40, 168, 2, 130, 34, 162, 10, 138, 42, 170}, {192, 64, 224, 96, 200, 72, 232, 104, 194, 66, 226, 98, 202, 74, 234, 106}, {48, 176, 16, 144, 56, 184, 24, 152, 50, 178, 18, 146, 58, 186, 26, 154}, {240, 112, 208, 80, 248, 120, 216, 88, 242, 114, 210, 82, 250, 122, 218, 90}, {12, 140, 44, 172, 4, 132, 36, 164, 14, 142, 46, 174, 6, 134, 38, 166}, {204, 76, 236, 108, 196, 68, 228, 100, 206, 78, 238, 110, 198, 70, 230, 102}, {60, 188, 28, 156, 52, 180, 20, 148, 62, 190, 30, 158, 54, 182, 22, 150}, {252, 124, 220, 92, 244, 116, 212, 84, 254, 126, 222, 94, 246, 118, 214, 86}, {3, 131, 35, 163, 11, 139, 43, 171, 1, 129, 33, 161, 9, 137, 41, 169}, {195, 67, 227, 99, 203, 75, 235, 107, 193, 65, 225, 97, 201, 73, 233, 105}, {51, 179, 19, 147, 59, 187, 27, 155, 49, 177, 17, 145, 57, 185, 25, 153}, {243, 115, 211, 83, 251, 123, 219, 91, 241, 113, 209, 81, 249, 121, 217, 89}, {15, 143, 47, 175, 7, 135, 39, 167, 13, 141, 45, 173, 5, 133, 37, 165}, {207, 79, 239, 111, 199, 71, 231, 103, 205, 77, 237, 109, 197, 69, 229, 101}, {63, 191, 31, 159, 55, 183, 23, 151, 61, 189, 29, 157, 53, 181, 21, 149}, {254, 127, 223, 95, 247, 119, 215, 87, 253, 125, 221, 93, 245, 117, 213, 85}};
 
 
     public static Bitmap resizeImage(Bitmap bitmap, int w, int h) {
@@ -45,6 +44,20 @@ public class PrintPicture {
      * @return
      */
     public static byte[] POS_PrintBMP(Bitmap mBitmap, int nWidth, int nMode, int leftPadding) {
+        return POS_PrintBMP(mBitmap, nWidth, nMode, leftPadding, 1);
+    }
+
+    /**
+     * rowsPerCommand: 每个GS v 0指令包含的行数，1为逐行打印，0为整张图片一个指令
+     */
+    public static byte[] POS_PrintBMP(Bitmap mBitmap, int nWidth, int nMode, int leftPadding, int rowsPerCommand) {
+        return POS_PrintBMP(mBitmap, nWidth, nMode, leftPadding, rowsPerCommand, ImageDither.THRESHOLD);
+    }
+
+    /**
+     * dither: ImageDither中的二值化方式
+     */
+    public static byte[] POS_PrintBMP(Bitmap mBitmap, int nWidth, int nMode, int leftPadding, int rowsPerCommand, int dither) {
         // 先转黑白，再调用函数缩放位图
         int width = ((nWidth + 7) / 8) * 8;
         int height = mBitmap.getHeight() * width / mBitmap.getWidth();
@@ -56,16 +69,36 @@ public class PrintPicture {
             rszBitmap = Bitmap.createScaledBitmap(mBitmap, width, height, true);
         }
 
-        Bitmap grayBitmap = toGrayscale(rszBitmap);
-        if(left>0){
-            grayBitmap = pad(grayBitmap,left,0);
+        //transparent areas are drawn on white, the left padding is added by the encoder.
+        if(rszBitmap.hasAlpha()){
+            rszBitmap = pad(rszBitmap,0,0);
         }
 
-        byte[] dithered = thresholdToBWPic(grayBitmap);
-
-        byte[] data = eachLinePixToCmd(dithered, width+left, nMode);
+        return RasterCore.encodeEscPos(toGreyPixels(rszBitmap), rszBitmap.getWidth(), rszBitmap.getHeight(),
+                left, dither, rowsPerCommand, nMode & 1);
+    }
 
-        return data;
+    /**
+     * 把图片定义为NV图形(GS ( L), 打印机断电后仍保存
+     *
+     * @param mBitmap 图片
+     * @param nWidth  宽度(点)
+     * @param kc1     图形键码 32~126
+     * @param kc2     图形键码 32~126
+     * @param dither  ImageDither
+     * @return
+     */
+    public static byte[] POS_DefineNvBMP(Bitmap mBitmap, int nWidth, int kc1, int kc2, int dither) {
+        int height = Math.max(1, mBitmap.getHeight() * nWidth / mBitmap.getWidth());
+        Bitmap rszBitmap = mBitmap;
+        if (mBitmap.getWidth() != nWidth) {
+            rszBitmap = Bitmap.createScaledBitmap(mBitmap, nWidth, height, true);
+        }
+        if (rszBitmap.hasAlpha()) {
+            rszBitmap = pad(rszBitmap, 0, 0);
+        }
+        return RasterCore.encodeNvDefine(toGreyPixels(rszBitmap), rszBitmap.getWidth(), rszBitmap.getHeight(),
+                dither, kc1, kc2);
     }
 
     /**
@@ -140,97 +173,17 @@ public class PrintPicture {
         return bmpGrayscale;
     }
 
-    public static byte[] thresholdToBWPic(Bitmap mBitmap) {
+    public static byte[] toGreyPixels(Bitmap mBitmap) {
         int[] pixels = new int[mBitmap.getWidth() * mBitmap.getHeight()];
-        byte[] data = new byte[mBitmap.getWidth() * mBitmap.getHeight()];
+        byte[] grey = new byte[pixels.length];
         mBitmap.getPixels(pixels, 0, mBitmap.getWidth(), 0, 0, mBitmap.getWidth(), mBitmap.getHeight());
-        format_K_threshold(pixels, mBitmap.getWidth(), mBitmap.getHeight(), data);
-        return data;
-    }
-
-    private static void format_K_threshold(int[] orgpixels, int xsize, int ysize, byte[] despixels) {
-        int graytotal = 0;
-        boolean grayave = true;
-        int k = 0;
-
-        int i;
-        int j;
-        int gray;
-        for (i = 0; i < ysize; ++i) {
-            for (j = 0; j < xsize; ++j) {
-                gray = orgpixels[k] & 255;
-                graytotal += gray;
-                ++k;
-            }
-        }
-
-        int var10 = graytotal / ysize / xsize;
-        k = 0;
-
-        for (i = 0; i < ysize; ++i) {
-            for (j = 0; j < xsize; ++j) {
-                gray = orgpixels[k] & 255;
-                if (gray > var10) {
-                    despixels[k] = 0;
-                } else {
-                    despixels[k] = 1;
-                }
-
-                ++k;
-            }
-        }
-
+        RasterCore.luma(pixels, 0, pixels.length, grey, 0);
+        return grey;
     }
 
-    public static byte[] eachLinePixToCmd(byte[] src, int nWidth, int nMode) {
-        int nHeight = src.length / nWidth;
-        int nBytesPerLine = nWidth / 8;
-        byte[] data = new byte[nHeight * (8 + nBytesPerLine)];
-        boolean offset = false;
-        int k = 0;
-
-        for (int i = 0; i < nHeight; ++i) {
-            int var10 = i * (8 + nBytesPerLine);
-            //GS v 0 m xL xH yL yH d1....dk 打印光栅位图
-            data[var10 + 0] = 29;//GS
-            data[var10 + 1] = 118;//v
-            data[var10 + 2] = 48;//0
-            data[var10 + 3] = (byte) (nMode & 1);
-            data[var10 + 4] = (byte) (nBytesPerLine % 256);//xL
-            data[var10 + 5] = (byte) (nBytesPerLine / 256);//xH
-            data[var10 + 6] = 1;//yL
-            data[var10 + 7] = 0;//yH
-
-            for (int j = 0; j < nBytesPerLine; ++j) {
-                data[var10 + 8 + j] = (byte) (p0[src[k]] + p1[src[k + 1]] + p2[src[k + 2]] + p3[src[k + 3]] + p4[src[k + 4]] + p5[src[k + 5]] + p6[src[k + 6]] + src[k + 7]);
-                k += 8;
-            }
-        }
-
-        return data;
-    }
-
-    public static byte[] pixToTscCmd(byte[] src) {
-        byte[] data = new byte[src.length / 8];
-        int k = 0;
-
-        for (int j = 0; k < data.length; ++k) {
-            byte temp = (byte) (p0[src[j]] + p1[src[j + 1]] + p2[src[j + 2]] + p3[src[j + 3]] + p4[src[j + 4]] + p5[src[j + 5]] + p6[src[j + 6]] + src[j + 7]);
-            data[k] = (byte) (~temp);
-            j += 8;
-        }
-
-        return data;
-    }
     public static byte[] pixToEscRastBitImageCmd(byte[] src) {
         byte[] data = new byte[src.length / 8];
-        int i = 0;
-
-        for (int k = 0; i < data.length; ++i) {
-            data[i] = (byte) (p0[src[k]] + p1[src[k + 1]] + p2[src[k + 2]] + p3[src[k + 3]] + p4[src[k + 4]] + p5[src[k + 5]] + p6[src[k + 6]] + src[k + 7]);
-            k += 8;
-        }
-
+        RasterCore.pack(src, 0, data.length, false, data, 0);
         return data;
     }
     public static byte[] pixToEscNvBitImageCmd(byte[] src, int width, int height) {
@@ -252,30 +205,4 @@ public class PrintPicture {
 
         return data;
     }
-    public static byte[] bitmapToBWPix(Bitmap mBitmap) {
-        int[] pixels = new int[mBitmap.getWidth() * mBitmap.getHeight()];
-        byte[] data = new byte[mBitmap.getWidth() * mBitmap.getHeight()];
-        Bitmap grayBitmap = toGrayscale(mBitmap);
-        grayBitmap.getPixels(pixels, 0, mBitmap.getWidth(), 0, 0, mBitmap.getWidth(), mBitmap.getHeight());
-        format_K_dither16x16(pixels, grayBitmap.getWidth(), grayBitmap.getHeight(), data);
-        return data;
-    }
-
-    private static void format_K_dither16x16(int[] orgpixels, int xsize, int ysize, byte[] despixels) {
-        int k = 0;
-
-        for (int y = 0; y < ysize; ++y) {
-            for (int x = 0; x < xsize; ++x) {
-                if ((orgpixels[k] & 255) > Floyd16x16[x & 15][y & 15]) {
-                    despixels[k] = 0;
-                } else {
-                    despixels[k] = 1;
-                }
-
-                ++k;
-            }
-        }
-
-    }
-
 }
@@ -1,5 +1,6 @@
 package cn.jystudio.bluetooth.escpos.command.sdk;
 
+import java.io.ByteArrayOutputStream;
 import java.io.UnsupportedEncodingException;
 import java.util.Arrays;
 
@@ -77,6 +78,13 @@ public class PrinterCommand {
         return data;
     }
 
+    /**
+     * NV图形键码, 32~126. 打印和删除指令由RasterCore.nvPrint/nvDelete生成
+     */
+    public static boolean isNvKey(int kc) {
+        return kc >= 32 && kc <= 126;
+    }
+
     /**
      * 钱箱指令
      *
@@ -395,6 +403,86 @@ public class PrinterCommand {
         return command;
     }
 
+    /**
+     * GS ( k QR code, model 2: select the model, module size and error correction level,
+     * store the data and print it.
+     *
+     * @param data            the symbol data
+     * @param moduleSize      dots per module, 1-16
+     * @param errorCorrection 0-3 for L, M, Q, H
+     * @return null when the data does not fit one command
+     */
+    public static byte[] getNativeQRCodeCommand(byte[] data, int moduleSize, int errorCorrection) {
+        if (data.length == 0 || data.length > 7089 || moduleSize < 1 || moduleSize > 16
+                || errorCorrection < 0 || errorCorrection > 3) {
+            return null;
+        }
+        ByteArrayOutputStream command = new ByteArrayOutputStream(data.length + 36);
+        symbolFunction(command, 49, 65, 50, 0);                // model 2
+        symbolFunction(command, 49, 67, moduleSize);
+        symbolFunction(command, 49, 69, 48 + errorCorrection);
+        symbolStore(command, 49, data);
+        symbolFunction(command, 49, 81, 48);
+        return command.toByteArray();
+    }
+
+    /**
+     * GS ( k PDF417: columns, module width, row height and error correction level, then the data.
+     *
+     * @param data            the symbol data
+     * @param columns         data columns, 0 lets the printer choose, at most 30
+     * @param moduleWidth     dots per module, 2-8
+     * @param rowHeight       row height in module widths, 2-8
+     * @param errorCorrection level 0-8
+     * @return null when an option is out of range or the data does not fit one command
+     */
+    public static byte[] getPDF417Command(byte[] data, int columns, int moduleWidth, int rowHeight,
+                                          int errorCorrection) {
+        if (data.length == 0 || data.length > 0xffff - 3 || columns < 0 || columns > 30
+                || moduleWidth < 2 || moduleWidth > 8 || rowHeight < 2 || rowHeight > 8
+                || errorCorrection < 0 || errorCorrection > 8) {
+            return null;
+        }
+        ByteArrayOutputStream command = new ByteArrayOutputStream(data.length + 48);
+        symbolFunction(command, 48, 65, columns);
+        symbolFunction(command, 48, 66, 0);                    // rows as needed
+        symbolFunction(command, 48, 67, moduleWidth);
+        symbolFunction(command, 48, 68, rowHeight);
+        symbolFunction(command, 48, 69, 48, 48 + errorCorrection);
+        symbolStore(command, 48, data);
+        symbolFunction(command, 48, 81, 48);
+        return command.toByteArray();
+    }
+
+    // GS ( k pL pH cn fn params
+    private static void symbolFunction(ByteArrayOutputStream command, int cn, int fn, int... params) {
+        int length = params.length + 2;
+        command.write(29);
+        command.write('(');
+        command.write('k');
+        command.write(length & 0xff);
+        command.write(length >> 8);
+        command.write(cn);
+        command.write(fn);
+        for (int param : params) {
+            command.write(param);
+        }
+    }
+
+    // GS ( k pL pH cn 80 48 data
+    private static void symbolStore(ByteArrayOutputStream command, int cn, byte[] data) {
+        int length = data.length + 3;
+        command.write(29);
+        command.write('(');
+        command.write('k');
+        command.write(length & 0xff);
+        command.write(length >> 8);
+        command.write(cn);
+        command.write(80);
+        command.write(48);
+        command.write(data, 0, data.length);
+    }
+
     /**
      * 打印一维条码
      *
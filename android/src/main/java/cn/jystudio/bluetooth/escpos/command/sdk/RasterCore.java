@@ -0,0 +1,59 @@
+package cn.jystudio.bluetooth.escpos.command.sdk;
+
+/**
+ * 图片处理的native实现(cpp/raster.c), 与iOS共用, 支持NEON/SSE2.
+ */
+public class RasterCore {
+    static {
+        System.loadLibrary("escposraster");
+    }
+
+    /**
+     * grey = (77*R + 150*G + 29*B) >> 8 for Bitmap.getPixels pixels.
+     */
+    public static native void luma(int[] argb, int offset, int count, byte[] grey, int greyOffset);
+
+    /**
+     * Packs 8*nbytes 0/1 pixels, the first one in the highest bit. invert for TSC, where 0 prints.
+     */
+    public static native void pack(byte[] bits, int offset, int nbytes, boolean invert, byte[] out, int outOffset);
+
+    /**
+     * GS v 0 commands of a grey image, rowsPerCommand rows per header (0 for as many as allowed),
+     * left blank dots in front of every row, dither one of ImageDither.
+     */
+    public static native byte[] encodeEscPos(byte[] grey, int width, int height, int left, int dither, int rowsPerCommand, int mode);
+
+    /**
+     * TSC BITMAP data of a grey image, (width+7)/8 bytes per row.
+     */
+    public static native byte[] encodeTsc(byte[] grey, int width, int height, int dither);
+
+    /**
+     * GS ( L / GS 8 L command that stores a grey image as NV graphics under the key kc1 kc2.
+     */
+    public static native byte[] encodeNvDefine(byte[] grey, int width, int height, int dither, int kc1, int kc2);
+
+    /**
+     * GS ( L command that prints the NV graphics kc1 kc2 at normal size.
+     */
+    public static native byte[] nvPrint(int kc1, int kc2);
+
+    /**
+     * GS ( L command that deletes the NV graphics kc1 kc2.
+     */
+    public static native byte[] nvDelete(int kc1, int kc2);
+
+    /**
+     * GS ( L command that deletes every NV graphics.
+     */
+    public static native byte[] nvDeleteAll();
+
+    /**
+     * GS v 0 commands of a symbol matrix, bits as ZXing's BitMatrix keeps them (rowWords ints per row,
+     * module x in bit x%32 of int x/32). Every module is scale x scale dots, the symbol is centred in
+     * boxWidth x boxHeight dots (0 for the symbol size) after left blank dots.
+     */
+    public static native byte[] encodeSymbol(int[] bits, int rowWords, int width, int height, int scale,
+                                             int left, int boxWidth, int boxHeight, int rowsPerCommand);
+}
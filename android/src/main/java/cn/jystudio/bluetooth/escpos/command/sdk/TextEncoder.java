@@ -0,0 +1,32 @@
+package cn.jystudio.bluetooth.escpos.command.sdk;
+
+import javax.annotation.Nullable;
+
+/**
+ * printText的编码, 用预编译的码表(cpp/text_encode.c)代替String.getBytes, 与iOS共用.
+ */
+public class TextEncoder {
+    static {
+        System.loadLibrary("escposraster");
+    }
+
+    /** fallback that drops the characters the code page does not have */
+    public static final int FALLBACK_SKIP = -1;
+
+    /**
+     * The text in UTF-8, GB18030, GBK, BIG5, CP437, CP850, CP858, CP866 or CP1252 (case is ignored).
+     * A character the code page does not have is written as the fallback byte, or dropped with FALLBACK_SKIP.
+     * @return null for other encodings
+     */
+    public static native @Nullable byte[] encode(String text, String encoding, int fallback);
+
+    /**
+     * options.fallback: "" drops unknown characters, otherwise its first character (ASCII) replaces them.
+     */
+    public static int fallback(@Nullable String option) {
+        if (option == null) return '?';
+        if (option.isEmpty()) return FALLBACK_SKIP;
+        char c = option.charAt(0);
+        return c < 0x80 ? c : '?';
+    }
+}
@@ -0,0 +1,17 @@
+package cn.jystudio.bluetooth.escpos.command.sdk;
+
+/**
+ * printColumn的表格排版, native实现(cpp/text_layout.c), 与iOS共用.
+ */
+public class TextLayout {
+    static {
+        System.loadLibrary("escposraster");
+    }
+
+    /**
+     * The rows of a table, each column wrapped within widths[i]-1 printed columns
+     * (East Asian Wide characters count 2) and aligned 0-left, 1-center, 2-right.
+     * Every row ends with "\n\r".
+     */
+    public static native String columns(String[] texts, int[] widths, int[] aligns);
+}
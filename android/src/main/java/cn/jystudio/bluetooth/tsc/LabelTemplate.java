@@ -0,0 +1,87 @@
+package cn.jystudio.bluetooth.tsc;
+
+import javax.annotation.Nullable;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Map;
+
+/**
+ * A label compiled once by compileLabelTemplate: the setup commands (SIZE, GAP, DIRECTION, ...)
+ * and the body from CLS on, images already rasterized. The text, QR code and barcode entries
+ * that name a slot are compiled with empty content, a print copies the slot values in at their
+ * offsets and sends the rest of the program as it is.
+ */
+public class LabelTemplate {
+    private final byte[] setup;
+    private final byte[] body;
+    private final int[] offsets;
+    private final String[] names;
+    private final byte[][] defaults;
+    private final boolean sound;
+
+    private LabelTemplate(byte[] setup, byte[] body, Builder builder, boolean sound) {
+        this.setup = setup;
+        this.body = body;
+        int count = builder.offsets.size();
+        this.offsets = new int[count];
+        this.names = builder.names.toArray(new String[count]);
+        this.defaults = builder.defaults.toArray(new byte[count][]);
+        for (int i = 0; i < count; i++) {
+            this.offsets[i] = builder.offsets.get(i);
+        }
+        this.sound = sound;
+    }
+
+    /**
+     * Slots in the order of their offsets, marked while the body is built.
+     */
+    public static class Builder {
+        private final List<Integer> offsets = new ArrayList<Integer>();
+        private final List<String> names = new ArrayList<String>();
+        private final List<byte[]> defaults = new ArrayList<byte[]>();
+
+        /**
+         * The command just added to tsc ends with the closing quote of its content and "\r\n",
+         * the slot value goes in front of them.
+         */
+        public void markSlot(TscCommand tsc, String name, @Nullable String defaultValue) {
+            offsets.add(tsc.getLength() - 3);
+            names.add(name);
+            defaults.add(TscCommand.encode(defaultValue == null ? "" : defaultValue));
+        }
+
+        public LabelTemplate build(TscCommand setup, TscCommand body, boolean sound) {
+            return new LabelTemplate(copy(setup), copy(body), this, sound);
+        }
+
+        private static byte[] copy(TscCommand tsc) {
+            byte[] bytes = new byte[tsc.getLength()];
+            System.arraycopy(tsc.getCommand(), 0, bytes, 0, bytes.length);
+            return bytes;
+        }
+    }
+
+    public byte[] getSetup() {
+        return setup;
+    }
+
+    public boolean hasSound() {
+        return sound;
+    }
+
+    /**
+     * Appends the body with the slot values, encoded by TscCommand.encode. A slot without a value
+     * keeps the text or code the template was compiled with.
+     */
+    public void addBody(TscCommand tsc, Map<String, byte[]> values) {
+        int at = 0;
+        for (int i = 0; i < offsets.length; i++) {
+            tsc.addBytes(body, at, offsets[i] - at);
+            byte[] value = values.get(names[i]);
+            if (value == null) value = defaults[i];
+            tsc.addBytes(value, 0, value.length);
+            at = offsets[i];
+        }
+        tsc.addBytes(body, at, body.length - at);
+    }
+}
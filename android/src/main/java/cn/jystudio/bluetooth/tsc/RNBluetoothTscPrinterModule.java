@@ -5,10 +5,17 @@ import android.graphics.BitmapFactory;
 import android.util.Base64;
 import cn.jystudio.bluetooth.BluetoothService;
 import cn.jystudio.bluetooth.BluetoothServiceStateObserver;
+import cn.jystudio.bluetooth.RNBluetoothManagerModule;
+import cn.jystudio.bluetooth.WriteQueue;
+import cn.jystudio.bluetooth.escpos.command.sdk.ImageDither;
 import com.facebook.react.bridge.*;
+import com.facebook.react.modules.core.DeviceEventManagerModule;
 
+import javax.annotation.Nullable;
+import java.util.Arrays;
+import java.util.HashMap;
 import java.util.Map;
-import java.util.Vector;
+import java.util.concurrent.atomic.AtomicBoolean;
 
 /**
  * Created by januslo on 2018/9/22.
@@ -17,6 +24,7 @@ public class RNBluetoothTscPrinterModule extends ReactContextBaseJavaModule
 implements BluetoothServiceStateObserver{
     private static final String TAG="BluetoothTscPrinter";
     private BluetoothService mService;
+    private final Map<String, LabelTemplate> templates = new HashMap<String, LabelTemplate>();
 
     public RNBluetoothTscPrinterModule(ReactApplicationContext reactContext,BluetoothService bluetoothService) {
         super(reactContext);
@@ -31,6 +39,149 @@ implements BluetoothServiceStateObserver{
 
     @ReactMethod
     public void printLabel(final ReadableMap options, final Promise promise) {
+        TscCommand tsc = new TscCommand();
+        addSetup(tsc, options);
+        try {
+            addBody(tsc, options, null);
+        } catch (IllegalArgumentException e) {
+            promise.reject(e.getMessage(), e);
+            return;
+        }
+        addPrint(tsc, options);
+        sendDataByte(tsc.getCommand(), tsc.getLength(), promise);
+    }
+
+    /**
+     * Prints a list of printLabel options as one job. The setup is sent with the first label and
+     * again only when a label's setup differs from the one before, every label is CLS, its body and
+     * PRINT. Each label is queued as it is built, so a long list waits on the write queue instead of
+     * being built up front. EVENT_LABEL_PRINTED {index, total} is emitted as each label is flushed,
+     * the promise is resolved with the last one. On an error the labels already queued still print.
+     */
+    @ReactMethod
+    public void printLabels(final ReadableArray labels, final Promise promise) {
+        final int total = labels.size();
+        final AtomicBoolean failed = new AtomicBoolean();
+        byte[] lastSetup = null;
+        if (total == 0) {
+            promise.resolve(null);
+            return;
+        }
+        for (int i = 0; i < total && !failed.get(); i++) {
+            ReadableMap options = labels.getMap(i);
+            TscCommand tsc = new TscCommand();
+            addSetup(tsc, options);
+            byte[] setup = Arrays.copyOf(tsc.getCommand(), tsc.getLength());
+            if (Arrays.equals(setup, lastSetup)) {
+                tsc.clrCommand();
+            }
+            lastSetup = setup;
+            try {
+                addBody(tsc, options, null);
+            } catch (IllegalArgumentException e) {
+                if (!failed.getAndSet(true)) promise.reject(e.getMessage(), e);
+                return;
+            }
+            addPrint(tsc, options);
+
+            final int index = i;
+            boolean queued = mService.write(tsc.getCommand(), tsc.getLength(), new WriteQueue.Callback() {
+                @Override
+                public void onWritten(boolean flushed) {
+                    if (!flushed) {
+                        if (!failed.getAndSet(true)) promise.reject("COMMAND_SEND_ERROR");
+                        return;
+                    }
+                    if (failed.get()) return;
+                    WritableMap params = Arguments.createMap();
+                    params.putInt("index", index);
+                    params.putInt("total", total);
+                    getReactApplicationContext().getJSModule(DeviceEventManagerModule.RCTDeviceEventEmitter.class)
+                            .emit(RNBluetoothManagerModule.EVENT_LABEL_PRINTED, params);
+                    if (index == total - 1) {
+                        promise.resolve(null);
+                    }
+                }
+            });
+            if (!queued && !failed.getAndSet(true)) {
+                promise.reject("COMMAND_SEND_ERROR");
+            }
+        }
+    }
+
+    /**
+     * Compiles the printLabel options once, images included. Text, QR code and barcode entries
+     * with a slot name get their text/code from the values of printLabelTemplate.
+     */
+    @ReactMethod
+    public void compileLabelTemplate(String templateId, final ReadableMap options, final Promise promise) {
+        boolean sound = options.hasKey("sound") && options.getInt("sound") == 1;
+        TscCommand setup = new TscCommand();
+        TscCommand body = new TscCommand();
+        LabelTemplate.Builder builder = new LabelTemplate.Builder();
+        addSetup(setup, options);
+        try {
+            addBody(body, options, builder);
+        } catch (IllegalArgumentException e) {
+            promise.reject(e.getMessage(), e);
+            return;
+        }
+        templates.put(templateId, builder.build(setup, body, sound));
+        promise.resolve(null);
+    }
+
+    /**
+     * Prints a compiled label, values maps slot names to their text.
+     */
+    @ReactMethod
+    public void printLabelTemplate(String templateId, @Nullable ReadableMap values, final Promise promise) {
+        LabelTemplate template = templates.get(templateId);
+        if (template == null) {
+            promise.reject("TEMPLATE_NOT_COMPILED");
+            return;
+        }
+        TscCommand tsc = new TscCommand();
+        tsc.addBytes(template.getSetup(), 0, template.getSetup().length);
+        template.addBody(tsc, slotValues(values));
+        tsc.addPrint(1, 1);
+        if (template.hasSound()) {
+            tsc.addSound(2, 100);
+        }
+        sendDataByte(tsc.getCommand(), tsc.getLength(), promise);
+    }
+
+    @ReactMethod
+    public void removeLabelTemplate(String templateId, final Promise promise) {
+        templates.remove(templateId);
+        promise.resolve(null);
+    }
+
+    private static Map<String, byte[]> slotValues(@Nullable ReadableMap values) {
+        Map<String, byte[]> encoded = new HashMap<String, byte[]>();
+        if (values == null) {
+            return encoded;
+        }
+        ReadableMapKeySetIterator keys = values.keySetIterator();
+        while (keys.hasNextKey()) {
+            String key = keys.nextKey();
+            String value = null;
+            if (values.getType(key) == ReadableType.String) {
+                value = values.getString(key);
+            } else if (values.getType(key) == ReadableType.Number) {
+                double number = values.getDouble(key);
+                value = number == Math.rint(number) ? String.valueOf((long) number) : String.valueOf(number);
+            }
+            if (value != null) {
+                encoded.put(key, TscCommand.encode(value));
+            }
+        }
+        return encoded;
+    }
+
+    /**
+     * SIZE, GAP, DIRECTION and the other settings sent before the first CLS.
+     */
+    private void addSetup(TscCommand tsc, ReadableMap options) {
         int width = options.getInt("width");
         int height = options.getInt("height");
         int gap = options.hasKey("gap") ? options.getInt("gap") : 0;
@@ -38,11 +189,6 @@ implements BluetoothServiceStateObserver{
         TscCommand.ENABLE enable = options.hasKey("tear") ?
                 options.getString("tear").equalsIgnoreCase(TscCommand.ENABLE.ON.getValue()) ? TscCommand.ENABLE.ON : TscCommand.ENABLE.OFF
                 : TscCommand.ENABLE.OFF;
-        ReadableArray texts = options.hasKey("text")? options.getArray("text"):null;
-        ReadableArray qrCodes = options.hasKey("qrcode")? options.getArray("qrcode"):null;
-        ReadableArray barCodes = options.hasKey("barcode")? options.getArray("barcode"):null;
-        ReadableArray images = options.hasKey("image")? options.getArray("image"):null;
-        ReadableArray reverses = options.hasKey("reverse")? options.getArray("reverse"):null;
 
         TscCommand.DIRECTION direction = options.hasKey("direction") ?
                 TscCommand.DIRECTION.BACKWARD.getValue() == options.getInt("direction") ? TscCommand.DIRECTION.BACKWARD : TscCommand.DIRECTION.FORWARD
@@ -54,15 +200,10 @@ implements BluetoothServiceStateObserver{
         TscCommand.DENSITY density = options.hasKey("density")?this.findDensity(options.getInt("density")):null;
         ReadableArray reference = options.hasKey("reference")?options.getArray("reference"):null;
 
-        boolean sound = false;
-        if (options.hasKey("sound") && options.getInt("sound") == 1) {
-            sound = true;
-        }
         boolean home = false;
         if(options.hasKey("home") && options.getInt("home")== 1){
             home = true;
         }
-        TscCommand tsc = new TscCommand();
         if(speed != null){
             tsc.addSpeed(speed);//设置打印速度
         }
@@ -83,11 +224,37 @@ implements BluetoothServiceStateObserver{
             tsc.addBackFeed(16);
             tsc.addHome();//走纸到开始位置
         }
+    }
+
+    /**
+     * PRINT sets,copies and the beep after it, both counts default to 1.
+     */
+    private static void addPrint(TscCommand tsc, ReadableMap options) {
+        int sets = options.hasKey("sets") ? Math.max(1, options.getInt("sets")) : 1;
+        int copies = options.hasKey("copies") ? Math.max(1, options.getInt("copies")) : 1;
+        tsc.addPrint(sets, copies); // 打印标签
+        if (options.hasKey("sound") && options.getInt("sound") == 1) {
+            tsc.addSound(2, 100); //打印标签后 蜂鸣器响
+        }
+    }
+
+    /**
+     * CLS and the label content, with slots marked in template when compiling one.
+     * @throws IllegalArgumentException with the error code as message
+     */
+    private void addBody(TscCommand tsc, ReadableMap options, @Nullable LabelTemplate.Builder template) {
+        ReadableArray texts = options.hasKey("text")? options.getArray("text"):null;
+        ReadableArray qrCodes = options.hasKey("qrcode")? options.getArray("qrcode"):null;
+        ReadableArray barCodes = options.hasKey("barcode")? options.getArray("barcode"):null;
+        ReadableArray images = options.hasKey("image")? options.getArray("image"):null;
+        ReadableArray reverses = options.hasKey("reverse")? options.getArray("reverse"):null;
+
         tsc.addCls();// 清除打印缓冲区
         //绘制简体中文
         for (int i = 0;texts!=null&& i < texts.size(); i++) {
             ReadableMap text = texts.getMap(i);
-            String t = text.getString("text");
+            String slot = slotOf(text, template);
+            String t = text.hasKey("text") ? text.getString("text") : "";
             int x = text.getInt("x");
             int y = text.getInt("y");
             TscCommand.FONTTYPE fonttype = this.findFontType(text.getString("fonttype"));
@@ -101,18 +268,21 @@ implements BluetoothServiceStateObserver{
                 String temStr = new String(temp, "UTF-8");
                 t = new String(temStr.getBytes("GB2312"), "GB2312");//打印的文字
             } catch (Exception e) {
-                promise.reject("INVALID_TEXT", e);
-                return;
+                throw new IllegalArgumentException("INVALID_TEXT", e);
             }
+            String content = slot != null ? "" : t;
 
             tsc.addText(x, y, fonttype/*字体类型*/,
-                    rotation/*旋转角度*/, xscal/*横向放大*/, yscal/*纵向放大*/, t);
+                    rotation/*旋转角度*/, xscal/*横向放大*/, yscal/*纵向放大*/, content);
+            if (slot != null) template.markSlot(tsc, slot, t);
 
             if(bold){
                 tsc.addText(x+1, y, fonttype,
-                        rotation, xscal, yscal, t/*这里的t可能需要替换成同等长度的空格*/);
+                        rotation, xscal, yscal, content/*这里的t可能需要替换成同等长度的空格*/);
+                if (slot != null) template.markSlot(tsc, slot, t);
                 tsc.addText(x, y+1, fonttype,
-                        rotation, xscal, yscal, t/*这里的t可能需要替换成同等长度的空格*/);
+                        rotation, xscal, yscal, content/*这里的t可能需要替换成同等长度的空格*/);
+                if (slot != null) template.markSlot(tsc, slot, t);
             }
         }
 
@@ -127,35 +297,40 @@ implements BluetoothServiceStateObserver{
                 String image  = img.getString("image");
                 byte[] decoded = Base64.decode(image, Base64.DEFAULT);
                 Bitmap b = BitmapFactory.decodeByteArray(decoded, 0, decoded.length);
-                tsc.addBitmap(x,y, mode, imgWidth,b);
+                int dither = ImageDither.modeWithName(img.hasKey("dither") ? img.getString("dither") : null, ImageDither.BAYER16);
+                tsc.addBitmap(x,y, mode, imgWidth,b, dither);
             }
         }
 
         if (qrCodes != null) {
             for (int i = 0; i < qrCodes.size(); i++) {
                 ReadableMap qr = qrCodes.getMap(i);
+                String slot = slotOf(qr, template);
                 int x = qr.getInt("x");
                 int y = qr.getInt("y");
                 int qrWidth = qr.getInt("width");
                 TscCommand.EEC level = this.findEEC(qr.getString("level"));
                 TscCommand.ROTATION rotation = this.findRotation(qr.getInt("rotation"));
-                String code = qr.getString("code");
-                tsc.addQRCode(x, y, level, qrWidth, rotation, code);
+                String code = qr.hasKey("code") ? qr.getString("code") : "";
+                tsc.addQRCode(x, y, level, qrWidth, rotation, slot != null ? "" : code);
+                if (slot != null) template.markSlot(tsc, slot, code);
             }
         }
         if (barCodes != null) {
             for (int i = 0; i < barCodes.size(); i++) {
                 ReadableMap bar = barCodes.getMap(i);
+                String slot = slotOf(bar, template);
                 int x = bar.hasKey("x") ? bar.getInt("x") : 0;
                 int y = bar.hasKey("y") ? bar.getInt("y") : 0;
                 int barHeight = bar.hasKey("height") ? bar.getInt("height") : 200;
                 int barWide = bar.hasKey("wide") ? bar.getInt("wide") : 2;
                 int narrow = bar.hasKey("narrow") ? bar.getInt("narrow") : 1;
                 TscCommand.ROTATION rotation = this.findRotation(bar.getInt("rotation"));
-                String code = bar.getString("code");
+                String code = bar.hasKey("code") ? bar.getString("code") : "";
                 TscCommand.BARCODETYPE type = this.findBarcodeType(bar.getString("type"));
                 TscCommand.READABLE readable = this.findReadable(bar.getInt("readable"));
-                tsc.add1DBarcode(x, y, type, barHeight, barWide, narrow, readable, rotation, code);
+                tsc.add1DBarcode(x, y, type, barHeight, barWide, narrow, readable, rotation, slot != null ? "" : code);
+                if (slot != null) template.markSlot(tsc, slot, code);
             }
         }
 
@@ -169,21 +344,10 @@ implements BluetoothServiceStateObserver{
                 tsc.addReverse(ax,ay,aWidth,aHeight);
             }
         }
+    }
 
-        tsc.addPrint(1, 1); // 打印标签
-        if (sound) {
-            tsc.addSound(2, 100); //打印标签后 蜂鸣器响
-        }
-        Vector<Byte> bytes = tsc.getCommand();
-        byte[] tosend = new byte[bytes.size()];
-        for(int i=0;i<bytes.size();i++){
-            tosend[i]= bytes.get(i);
-        }
-        if(sendDataByte(tosend)){
-            promise.resolve(null);
-        }else{
-            promise.reject("COMMAND_SEND_ERROR");
-        }
+    private static @Nullable String slotOf(ReadableMap entry, @Nullable LabelTemplate.Builder template) {
+        return template != null && entry.hasKey("slot") ? entry.getString("slot") : null;
     }
 
     private TscCommand.BARCODETYPE findBarcodeType(String type) {
@@ -290,12 +454,23 @@ implements BluetoothServiceStateObserver{
         return bm;
     }
 
-    private boolean sendDataByte(byte[] data) {
-        if (mService.getState() != BluetoothService.STATE_CONNECTED) {
-            return false;
+    /**
+     * Queues the label, the promise is resolved once it is flushed to the printer.
+     */
+    private void sendDataByte(byte[] data, int length, final Promise promise) {
+        boolean queued = mService.write(data, length, new WriteQueue.Callback() {
+            @Override
+            public void onWritten(boolean flushed) {
+                if (flushed) {
+                    promise.resolve(null);
+                } else {
+                    promise.reject("COMMAND_SEND_ERROR");
+                }
+            }
+        });
+        if (!queued) {
+            promise.reject("COMMAND_SEND_ERROR");
         }
-        mService.write(data);
-        return true;
     }
 
     @Override
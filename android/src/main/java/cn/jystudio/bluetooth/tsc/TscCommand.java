@@ -2,14 +2,17 @@ package cn.jystudio.bluetooth.tsc;
 
 import android.graphics.Bitmap;
 import android.util.Log;
+import cn.jystudio.bluetooth.escpos.command.sdk.ImageDither;
 import cn.jystudio.bluetooth.escpos.command.sdk.PrintPicture;
+import cn.jystudio.bluetooth.escpos.command.sdk.RasterCore;
 
 import java.io.UnsupportedEncodingException;
-import java.util.Vector;
 
 public class TscCommand {
     private static final String DEBUG_TAG = "TSCCommand";
-    private Vector<Byte> Command = null;
+    // the label program, Command[0..length) is sent as it is
+    private byte[] Command = null;
+    private int length;
 
     public static enum FOOT {
         F2(0), F5(1);
@@ -215,30 +218,61 @@ public class TscCommand {
 //    }
 
     public TscCommand() {
-        this.Command = new Vector(4096, 1024);
+        this.Command = new byte[4096];
     }
 
     public TscCommand(int width, int height, int gap) {
-        this.Command = new Vector(4096, 1024);
+        this();
         addSize(width, height);
         addGap(gap);
     }
 
     public void clrCommand() {
-        this.Command.clear();
+        this.length = 0;
+    }
+
+    private void ensureCapacity(int extra) {
+        if (this.length + extra > this.Command.length) {
+            byte[] grown = new byte[Math.max(this.Command.length * 2, this.length + extra)];
+            System.arraycopy(this.Command, 0, grown, 0, this.length);
+            this.Command = grown;
+        }
+    }
+
+    private void addBytesToCommand(byte[] bs) {
+        addBytes(bs, 0, bs.length);
+    }
+
+    public void addBytes(byte[] bs, int offset, int count) {
+        ensureCapacity(count);
+        System.arraycopy(bs, offset, this.Command, this.length, count);
+        this.length += count;
+    }
+
+    /**
+     * The bytes addStrToCommand writes for str.
+     */
+    public static byte[] encode(String str) {
+        try {
+            return str.getBytes("GB2312");
+        } catch (UnsupportedEncodingException e) {
+            e.printStackTrace();
+            return new byte[0];
+        }
     }
 
     private void addStrToCommand(String str) {
-        byte[] bs = null;
-        if (!str.equals("")) {
-            try {
-                bs = str.getBytes("GB2312");
-            } catch (UnsupportedEncodingException e) {
-                e.printStackTrace();
-            }
-            for (int i = 0; i < bs.length; i++) {
-                this.Command.add(Byte.valueOf(bs[i]));
+        int n = str.length();
+        ensureCapacity(n);
+        for (int i = 0; i < n; i++) {
+            char c = str.charAt(i);
+            if (c >= 0x80) {
+                // text with Chinese in it, the ASCII copied so far is encoded again with the rest
+                this.length -= i;
+                addBytesToCommand(encode(str));
+                return;
             }
+            this.Command[this.length++] = (byte) c;
         }
     }
 
@@ -410,29 +444,34 @@ public class TscCommand {
 
 
     public void addBitmap(int x, int y, TscCommand.BITMAP_MODE mode, int nWidth, Bitmap b) {
+        addBitmap(x, y, mode, nWidth, b, ImageDither.BAYER16);
+    }
+
+    public void addBitmap(int x, int y, TscCommand.BITMAP_MODE mode, int nWidth, Bitmap b, int dither) {
         if (b != null) {
             int width = (nWidth + 7) / 8 * 8;
             int height = b.getHeight() * width / b.getWidth();
             Log.d("BMP", "bmp.getWidth() " + b.getWidth());
-            Bitmap grayBitmap = PrintPicture.toGrayscale(b);
-            Bitmap rszBitmap = PrintPicture.resizeImage(grayBitmap, width, height);
-            byte[] src = PrintPicture.bitmapToBWPix(rszBitmap);
-            height = src.length / width;
-            width /= 8;
-            String str = "BITMAP " + x + "," + y + "," + width + "," + height + "," + mode.getValue() + ",";
-            this.addStrToCommand(str);
-            byte[] codecontent = PrintPicture.pixToTscCmd(src);
-
-            for (int k = 0; k < codecontent.length; ++k) {
-                this.Command.add(Byte.valueOf(codecontent[k]));
+            Bitmap rszBitmap = Bitmap.createScaledBitmap(b, width, height, true);
+            if (rszBitmap.hasAlpha()) {
+                rszBitmap = PrintPicture.pad(rszBitmap, 0, 0);
             }
-
-            Log.d("TSCCommand", "codecontent" + codecontent);
-            addStrToCommand("\r\n");
+            byte[] codecontent = RasterCore.encodeTsc(PrintPicture.toGreyPixels(rszBitmap), width, height, dither);
+            addBitmapData(x, y, mode, width / 8, height, codecontent);
         }
 
     }
 
+    /**
+     * BITMAP with rows already packed, widthBytes bytes a row and a 0 bit printed.
+     */
+    public void addBitmapData(int x, int y, TscCommand.BITMAP_MODE mode, int widthBytes, int height, byte[] data) {
+        String str = "BITMAP " + x + "," + y + "," + widthBytes + "," + height + "," + mode.getValue() + ",";
+        this.addStrToCommand(str);
+        this.addBytesToCommand(data);
+        addStrToCommand("\r\n");
+    }
+
     public void addBox(int x, int y, int xend, int yend) {
         String str = new String();
         str = "BAR " + x + "," + y + "," + xend + "," + yend + "\r\n";
@@ -451,10 +490,17 @@ public class TscCommand {
         addStrToCommand(str);
     }
 
-    public Vector<Byte> getCommand() {
+    /**
+     * The label program is getCommand()[0..getLength()), the array is not copied.
+     */
+    public byte[] getCommand() {
         return this.Command;
     }
 
+    public int getLength() {
+        return this.length;
+    }
+
     public void queryPrinterType() {
         String str = new String();
         str = "~!T\r\n";
@@ -462,15 +508,11 @@ public class TscCommand {
     }
 
     public void queryPrinterStatus() {
-        this.Command.add(Byte.valueOf((byte) 27));
-        this.Command.add(Byte.valueOf((byte) 33));
-        this.Command.add(Byte.valueOf((byte) 63));
+        addBytesToCommand(new byte[]{27, 33, 63});
     }
 
     public void resetPrinter() {
-        this.Command.add(Byte.valueOf((byte) 27));
-        this.Command.add(Byte.valueOf((byte) 33));
-        this.Command.add(Byte.valueOf((byte) 82));
+        addBytesToCommand(new byte[]{27, 33, 82});
     }
 
     public void queryPrinterLife() {
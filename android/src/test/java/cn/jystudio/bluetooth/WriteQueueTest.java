@@ -0,0 +1,209 @@
+package cn.jystudio.bluetooth;
+
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.concurrent.CountDownLatch;
+import java.util.concurrent.TimeUnit;
+import java.util.concurrent.atomic.AtomicBoolean;
+import java.util.concurrent.atomic.AtomicInteger;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertFalse;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * WriteQueue over a loopback stream that keeps every write as one frame.
+ */
+public class WriteQueueTest {
+    private static final long TIMEOUT = 5;
+
+    /** Every write call as a frame, optionally held until release() */
+    private static class LoopbackStream extends OutputStream {
+        final List<byte[]> frames = new ArrayList<byte[]>();
+        final ByteArrayOutputStream all = new ByteArrayOutputStream();
+        final CountDownLatch writing = new CountDownLatch(1);
+        final CountDownLatch released;
+        int flushes;
+
+        LoopbackStream(boolean held) {
+            released = new CountDownLatch(held ? 1 : 0);
+        }
+
+        void release() {
+            released.countDown();
+        }
+
+        @Override
+        public void write(int b) throws IOException {
+            write(new byte[]{(byte) b}, 0, 1);
+        }
+
+        @Override
+        public void write(byte[] b, int off, int len) throws IOException {
+            writing.countDown();
+            try {
+                released.await();
+            } catch (InterruptedException e) {
+                throw new IOException(e);
+            }
+            synchronized (this) {
+                frames.add(Arrays.copyOfRange(b, off, off + len));
+                all.write(b, off, len);
+            }
+        }
+
+        @Override
+        public synchronized void flush() {
+            flushes++;
+        }
+    }
+
+    /** Counts the callbacks and how many were flushed */
+    private static class Counter implements WriteQueue.Callback {
+        final CountDownLatch done;
+        final AtomicInteger flushed = new AtomicInteger();
+        final AtomicInteger dropped = new AtomicInteger();
+
+        Counter(int count) {
+            done = new CountDownLatch(count);
+        }
+
+        @Override
+        public void onWritten(boolean ok) {
+            (ok ? flushed : dropped).incrementAndGet();
+            done.countDown();
+        }
+
+        boolean await() throws InterruptedException {
+            return done.await(TIMEOUT, TimeUnit.SECONDS);
+        }
+    }
+
+    private static byte[] bytes(int length, int first) {
+        byte[] data = new byte[length];
+        for (int i = 0; i < length; i++) data[i] = (byte) (first + i);
+        return data;
+    }
+
+    @Test
+    public void joinsSmallWritesIntoFrames() throws Exception {
+        LoopbackStream out = new LoopbackStream(false);
+        WriteQueue queue = new WriteQueue(out, 16, 1024);
+        Counter counter = new Counter(5);
+        // queued before the thread starts, so the framing does not depend on timing
+        assertTrue(queue.write(bytes(5, 0), counter));
+        assertTrue(queue.write(bytes(5, 5), counter));
+        assertTrue(queue.write(bytes(6, 10), counter));
+        assertTrue(queue.write(bytes(20, 16), counter));
+        assertTrue(queue.write(bytes(3, 36), 2, counter));
+        queue.start();
+        assertTrue(counter.await());
+        queue.close();
+        queue.join(TIMEOUT * 1000);
+
+        assertEquals(5, counter.flushed.get());
+        assertEquals(3, out.frames.size());
+        assertArrayEquals(bytes(16, 0), out.frames.get(0));
+        assertArrayEquals(bytes(20, 16), out.frames.get(1));
+        assertArrayEquals(bytes(2, 36), out.frames.get(2));
+        assertArrayEquals(bytes(38, 0), out.all.toByteArray());
+        assertEquals(3, out.flushes);
+    }
+
+    @Test
+    public void writeWaitsWhileTheQueueIsFull() throws Exception {
+        final LoopbackStream out = new LoopbackStream(true);
+        final WriteQueue queue = new WriteQueue(out, 16, 10);
+        final Counter counter = new Counter(3);
+        queue.start();
+        assertTrue(queue.write(bytes(8, 0), counter));
+        assertTrue(out.writing.await(TIMEOUT, TimeUnit.SECONDS));
+        // 8 bytes are being written, 2 more fit
+        assertTrue(queue.write(bytes(2, 8), counter));
+
+        final CountDownLatch returned = new CountDownLatch(1);
+        final AtomicBoolean accepted = new AtomicBoolean();
+        Thread writer = new Thread() {
+            @Override
+            public void run() {
+                accepted.set(queue.write(bytes(4, 10), counter));
+                returned.countDown();
+            }
+        };
+        writer.start();
+        assertFalse(returned.await(200, TimeUnit.MILLISECONDS));
+
+        out.release();
+        assertTrue(returned.await(TIMEOUT, TimeUnit.SECONDS));
+        assertTrue(accepted.get());
+        assertTrue(counter.await());
+        queue.close();
+        assertEquals(3, counter.flushed.get());
+        assertArrayEquals(bytes(14, 0), out.all.toByteArray());
+    }
+
+    @Test
+    public void closeSettlesWhatIsQueued() throws Exception {
+        LoopbackStream out = new LoopbackStream(true);
+        WriteQueue queue = new WriteQueue(out, 16, 1024);
+        Counter counter = new Counter(3);
+        queue.start();
+        assertTrue(queue.write(bytes(16, 0), counter));
+        assertTrue(out.writing.await(TIMEOUT, TimeUnit.SECONDS));
+        assertTrue(queue.write(bytes(4, 0), counter));
+        assertTrue(queue.write(bytes(4, 0), counter));
+        queue.close();
+        out.release();
+        assertTrue(counter.await());
+        assertEquals(1, counter.flushed.get());
+        assertEquals(2, counter.dropped.get());
+        assertFalse(queue.write(bytes(1, 0), counter));
+    }
+
+    @Test
+    public void interruptSettlesWhatIsQueued() throws Exception {
+        LoopbackStream out = new LoopbackStream(false);
+        WriteQueue queue = new WriteQueue(out, 16, 1024);
+        Counter counter = new Counter(1);
+        queue.start();
+        long deadline = System.currentTimeMillis() + TIMEOUT * 1000;
+        while (queue.getState() != Thread.State.WAITING && System.currentTimeMillis() < deadline) {
+            Thread.sleep(1);
+        }
+        // the write and the interrupt reach the waiting thread together
+        synchronized (queue) {
+            assertTrue(queue.write(bytes(4, 0), counter));
+            queue.interrupt();
+        }
+        assertTrue(counter.await());
+        queue.join(TIMEOUT * 1000);
+        assertFalse(queue.isAlive());
+        assertFalse(queue.write(bytes(1, 0), counter));
+    }
+
+    @Test
+    public void failedWriteClosesTheQueue() throws Exception {
+        OutputStream broken = new OutputStream() {
+            @Override
+            public void write(int b) throws IOException {
+                throw new IOException("socket closed");
+            }
+        };
+        WriteQueue queue = new WriteQueue(broken, 16, 1024);
+        Counter counter = new Counter(2);
+        assertTrue(queue.write(bytes(4, 0), counter));
+        assertTrue(queue.write(bytes(20, 0), counter));
+        queue.start();
+        assertTrue(counter.await());
+        assertEquals(2, counter.dropped.get());
+        queue.join(TIMEOUT * 1000);
+        assertFalse(queue.write(bytes(1, 0), counter));
+    }
+}
@@ -0,0 +1,133 @@
+package cn.jystudio.bluetooth.escpos;
+
+import org.junit.Test;
+
+import java.io.ByteArrayOutputStream;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.assertNull;
+
+/**
+ * PrinterState sends a mode command only when the setting changes.
+ */
+public class PrinterStateTest {
+    private static final byte ESC = 27, GS = 29, FS = 28;
+
+    // GS ! 0, ESC t 0, ESC M 0
+    private static final byte[] TEXT_MODE = {GS, '!', 0, ESC, 't', 0, ESC, 'M', 0};
+
+    @Test
+    public void unknownStateSendsEverything() {
+        PrinterState state = new PrinterState();
+        assertArrayEquals(TEXT_MODE, state.textMode(0, 0, 0, 0));
+        assertArrayEquals(new byte[]{ESC, 'E', 1, ESC, 'G', 1}, state.bold(1));
+        assertArrayEquals(new byte[]{ESC, '-', 1, FS, '-', 1}, state.underline(1));
+        assertArrayEquals(new byte[]{ESC, 'a', 1}, state.align(1));
+    }
+
+    @Test
+    public void repeatedSettingsSendNothing() {
+        PrinterState state = new PrinterState();
+        state.textMode(1, 1, 18, 1);
+        state.bold(1);
+        state.underline(2);
+        state.align(2);
+        for (int i = 0; i < 3; i++) {
+            assertEquals(0, state.textMode(1, 1, 18, 1).length);
+            assertEquals(0, state.bold(1).length);
+            assertEquals(0, state.underline(2).length);
+            assertEquals(0, state.align(2).length);
+            // 50 is the ASCII form of 2
+            assertEquals(0, state.align(50).length);
+        }
+    }
+
+    @Test
+    public void onlyTheChangedCommandsAreSent() {
+        PrinterState state = new PrinterState();
+        state.textMode(0, 0, 0, 0);
+        assertArrayEquals(new byte[]{GS, '!', 0x11}, state.textMode(1, 1, 0, 0));
+        assertArrayEquals(new byte[]{ESC, 't', 18}, state.textMode(1, 1, 18, 0));
+        assertArrayEquals(new byte[]{ESC, 'M', 1}, state.textMode(1, 1, 18, 1));
+        assertArrayEquals(new byte[]{GS, '!', 0, ESC, 'M', 0}, state.textMode(0, 0, 18, 0));
+        state.align(0);
+        assertArrayEquals(new byte[]{ESC, 'a', 49}, state.align(49));
+        assertEquals(0, state.align(1).length);
+    }
+
+    @Test
+    public void resetAndInvalidateSendEverythingAgain() {
+        PrinterState state = new PrinterState();
+        state.textMode(1, 1, 18, 1);
+        state.bold(1);
+        state.align(2);
+
+        // ESC @: back to the power-on mode, only what differs from it is sent
+        state.reset();
+        assertEquals(0, state.textMode(0, 0, 0, 0).length);
+        assertEquals(0, state.bold(0).length);
+        assertArrayEquals(new byte[]{ESC, 'a', 2}, state.align(2));
+
+        // after a failed write nothing is known, everything is sent
+        state.invalidate();
+        assertArrayEquals(TEXT_MODE, state.textMode(0, 0, 0, 0));
+        assertArrayEquals(new byte[]{ESC, 'E', 0, ESC, 'G', 0}, state.bold(0));
+        assertArrayEquals(new byte[]{ESC, 'a', 2}, state.align(2));
+    }
+
+    @Test
+    public void copyAndRestore() {
+        PrinterState state = new PrinterState();
+        state.textMode(0, 0, 0, 0);
+        PrinterState before = state.copy();
+        state.textMode(1, 1, 0, 0);
+        state.restore(before);
+        assertArrayEquals(new byte[]{GS, '!', 0x11}, state.textMode(1, 1, 0, 0));
+    }
+
+    @Test
+    public void outOfRangeOptions() {
+        PrinterState state = new PrinterState();
+        assertNull(state.textMode(0, 0, 256, 0));
+        assertNull(state.underline(3));
+        assertNull(state.align(3));
+        // a rejected option leaves the state alone
+        assertArrayEquals(TEXT_MODE, state.textMode(0, 0, 0, 0));
+    }
+
+    /**
+     * The bytes of a receipt of a bold header row, items and a bold total row, every row set
+     * up with align, bold and the text options as printColumn calls from JS do.
+     */
+    private static int receipt(boolean keepState, int items) {
+        PrinterState state = new PrinterState();
+        ByteArrayOutputStream out = new ByteArrayOutputStream();
+        byte[] row = "Item                x1     12.50\n".getBytes();
+        for (int i = 0; i < items + 2; i++) {
+            if (!keepState) state.invalidate();
+            boolean bold = i == 0 || i == items + 1;
+            byte[] a = state.align(0);
+            out.write(a, 0, a.length);
+            byte[] b = state.bold(bold ? 1 : 0);
+            out.write(b, 0, b.length);
+            byte[] mode = state.textMode(0, 0, 0, 0);
+            out.write(mode, 0, mode.length);
+            out.write(row, 0, row.length);
+        }
+        return out.size();
+    }
+
+    @Test
+    public void columnReceiptBytesPerRow() {
+        int items = 40, rows = items + 2, text = 33;
+        int before = receipt(false, items);
+        int after = receipt(true, items);
+        System.out.printf("%d row receipt: %.1f bytes a row before, %.1f after%n",
+                rows, before / (double) rows, after / (double) rows);
+        // ESC a, ESC E ESC G and GS ! ESC t ESC M in front of every row
+        assertEquals(rows * (3 + 6 + 9 + text), before);
+        // all of them once, then ESC E ESC G where the weight changes
+        assertEquals(rows * text + 3 + 6 + 9 + 6 + 6, after);
+    }
+}
@@ -0,0 +1,83 @@
+package cn.jystudio.bluetooth.tsc;
+
+import org.openjdk.jmh.annotations.Benchmark;
+import org.openjdk.jmh.annotations.BenchmarkMode;
+import org.openjdk.jmh.annotations.Fork;
+import org.openjdk.jmh.annotations.Measurement;
+import org.openjdk.jmh.annotations.Mode;
+import org.openjdk.jmh.annotations.OutputTimeUnit;
+import org.openjdk.jmh.annotations.Param;
+import org.openjdk.jmh.annotations.Scope;
+import org.openjdk.jmh.annotations.Setup;
+import org.openjdk.jmh.annotations.State;
+import org.openjdk.jmh.annotations.Warmup;
+import org.openjdk.jmh.runner.Runner;
+import org.openjdk.jmh.runner.RunnerException;
+import org.openjdk.jmh.runner.options.OptionsBuilder;
+
+import java.util.Random;
+import java.util.concurrent.TimeUnit;
+
+/**
+ * A label of text lines and a 384x400 bitmap built by TscCommand and by the Vector&lt;Byte&gt;
+ * builder it replaced, up to the bytes handed to the write queue. Run with ./gradlew tscBenchmark.
+ */
+@State(Scope.Thread)
+@BenchmarkMode(Mode.AverageTime)
+@OutputTimeUnit(TimeUnit.MICROSECONDS)
+@Warmup(iterations = 5, time = 1)
+@Measurement(iterations = 5, time = 1)
+@Fork(1)
+public class TscCommandBenchmark {
+    private static final int WIDTH_BYTES = 48;
+    private static final int HEIGHT = 400;
+
+    @Param({"ascii", "chinese"})
+    public String text;
+
+    private String[] lines;
+    private byte[] rows;
+
+    @Setup
+    public void setup() {
+        lines = new String[40];
+        for (int i = 0; i < lines.length; i++) {
+            lines[i] = text.equals("ascii") ? "Item " + i + " x 2   12.50" : "商品 " + i + " x 2   12.50 元";
+        }
+        rows = new byte[WIDTH_BYTES * HEIGHT];
+        new Random(1).nextBytes(rows);
+    }
+
+    @Benchmark
+    public byte[] byteArray() {
+        TscCommand tsc = new TscCommand(60, 80, 2);
+        tsc.addCls();
+        for (int i = 0; i < lines.length; i++) {
+            tsc.addText(10, 10 + i * 30, TscCommand.FONTTYPE.FONT_CHINESE, TscCommand.ROTATION.ROTATION_0,
+                    TscCommand.FONTMUL.MUL_1, TscCommand.FONTMUL.MUL_1, lines[i]);
+        }
+        tsc.addBitmapData(0, 1300, TscCommand.BITMAP_MODE.OVERWRITE, WIDTH_BYTES, HEIGHT, rows);
+        tsc.addPrint(1, 1);
+        // written as getCommand()[0..getLength()), no copy
+        return tsc.getCommand();
+    }
+
+    @Benchmark
+    public byte[] vector() {
+        VectorTscCommand tsc = new VectorTscCommand();
+        tsc.addSize(60, 80);
+        tsc.addGap(2);
+        tsc.addCls();
+        for (int i = 0; i < lines.length; i++) {
+            tsc.addText(10, 10 + i * 30, TscCommand.FONTTYPE.FONT_CHINESE, TscCommand.ROTATION.ROTATION_0,
+                    TscCommand.FONTMUL.MUL_1, TscCommand.FONTMUL.MUL_1, lines[i]);
+        }
+        tsc.addBitmapData(0, 1300, TscCommand.BITMAP_MODE.OVERWRITE, WIDTH_BYTES, HEIGHT, rows);
+        tsc.addPrint(1, 1);
+        return tsc.toBytes();
+    }
+
+    public static void main(String[] args) throws RunnerException {
+        new Runner(new OptionsBuilder().include(TscCommandBenchmark.class.getSimpleName()).build()).run();
+    }
+}
@@ -0,0 +1,124 @@
+package cn.jystudio.bluetooth.tsc;
+
+import org.junit.Test;
+
+import java.util.Arrays;
+import java.util.Random;
+
+import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertTrue;
+
+/**
+ * TscCommand writes the bytes the Vector&lt;Byte&gt; builder before it wrote, see VectorTscCommand.
+ */
+public class TscCommandTest {
+
+    private static byte[] bytes(TscCommand tsc) {
+        return Arrays.copyOf(tsc.getCommand(), tsc.getLength());
+    }
+
+    private static void header(TscCommand tsc, VectorTscCommand old) {
+        tsc.addSize(60, 40);
+        tsc.addGap(2);
+        tsc.addSpeed(TscCommand.SPEED.SPEED2);
+        tsc.addDensity(TscCommand.DENSITY.DNESITY8);
+        tsc.addDirection(TscCommand.DIRECTION.FORWARD);
+        tsc.addReference(0, 0);
+        tsc.addCls();
+        old.addSize(60, 40);
+        old.addGap(2);
+        old.addSpeed(TscCommand.SPEED.SPEED2);
+        old.addDensity(TscCommand.DENSITY.DNESITY8);
+        old.addDirection(TscCommand.DIRECTION.FORWARD);
+        old.addReference(0, 0);
+        old.addCls();
+    }
+
+    private static void text(TscCommand tsc, VectorTscCommand old, int y, String text) {
+        tsc.addText(10, y, TscCommand.FONTTYPE.FONT_CHINESE, TscCommand.ROTATION.ROTATION_0,
+                TscCommand.FONTMUL.MUL_1, TscCommand.FONTMUL.MUL_1, text);
+        old.addText(10, y, TscCommand.FONTTYPE.FONT_CHINESE, TscCommand.ROTATION.ROTATION_0,
+                TscCommand.FONTMUL.MUL_1, TscCommand.FONTMUL.MUL_1, text);
+    }
+
+    @Test
+    public void asciiLabel() {
+        TscCommand tsc = new TscCommand();
+        VectorTscCommand old = new VectorTscCommand();
+        header(tsc, old);
+        text(tsc, old, 10, "Order #1024");
+        tsc.add1DBarcode(10, 60, TscCommand.BARCODETYPE.CODE128, 40, 2, 2, TscCommand.READABLE.EANBLE,
+                TscCommand.ROTATION.ROTATION_0, "123456789012");
+        old.add1DBarcode(10, 60, TscCommand.BARCODETYPE.CODE128, 40, 2, 2, TscCommand.READABLE.EANBLE,
+                TscCommand.ROTATION.ROTATION_0, "123456789012");
+        tsc.addQRCode(300, 10, TscCommand.EEC.LEVEL_M, 5, TscCommand.ROTATION.ROTATION_90, "https://example.com/1024");
+        old.addQRCode(300, 10, TscCommand.EEC.LEVEL_M, 5, TscCommand.ROTATION.ROTATION_90, "https://example.com/1024");
+        tsc.addBar(0, 120, 400, 2);
+        old.addBar(0, 120, 400, 2);
+        tsc.addPrint(1, 1);
+        old.addPrint(1, 1);
+
+        assertArrayEquals(old.toBytes(), bytes(tsc));
+        byte[] start = "SIZE 60 mm,40 mm\r\nGAP 2 mm,0 mm\r\n".getBytes();
+        assertArrayEquals(start, Arrays.copyOf(tsc.getCommand(), start.length));
+    }
+
+    @Test
+    public void chineseText() {
+        TscCommand tsc = new TscCommand();
+        VectorTscCommand old = new VectorTscCommand();
+        header(tsc, old);
+        // ASCII before, between and after the Chinese, the TEXT line goes through the re-encode
+        text(tsc, old, 10, "商品 Item");
+        text(tsc, old, 40, "Total 合计: 12.50 元");
+        text(tsc, old, 70, "plain ASCII after");
+        text(tsc, old, 100, "");
+        tsc.addQRCode(300, 10, TscCommand.EEC.LEVEL_H, 4, TscCommand.ROTATION.ROTATION_0, "1231你好2421341325454353");
+        old.addQRCode(300, 10, TscCommand.EEC.LEVEL_H, 4, TscCommand.ROTATION.ROTATION_0, "1231你好2421341325454353");
+        tsc.addPrint(1, 1);
+        old.addPrint(1, 1);
+
+        assertArrayEquals(old.toBytes(), bytes(tsc));
+    }
+
+    @Test
+    public void bitmap() {
+        Random random = new Random(7);
+        TscCommand tsc = new TscCommand();
+        VectorTscCommand old = new VectorTscCommand();
+        header(tsc, old);
+        // 0x0d 0x0a and bytes >= 0x80 in the rows are data, not text
+        byte[] rows = new byte[48 * 200];
+        random.nextBytes(rows);
+        rows[0] = '\r';
+        rows[1] = '\n';
+        tsc.addBitmapData(20, 30, TscCommand.BITMAP_MODE.OVERWRITE, 48, 200, rows);
+        old.addBitmapData(20, 30, TscCommand.BITMAP_MODE.OVERWRITE, 48, 200, rows);
+        text(tsc, old, 240, "图片 below");
+        tsc.addBitmapData(0, 260, TscCommand.BITMAP_MODE.XOR, 1, 1, new byte[]{(byte) 0xff});
+        old.addBitmapData(0, 260, TscCommand.BITMAP_MODE.XOR, 1, 1, new byte[]{(byte) 0xff});
+        tsc.addPrint(1, 1);
+        old.addPrint(1, 1);
+
+        // past the 4096 bytes TscCommand starts with
+        assertTrue(tsc.getLength() > 4096);
+        assertArrayEquals(old.toBytes(), bytes(tsc));
+    }
+
+    @Test
+    public void clearedCommandIsReused() {
+        TscCommand tsc = new TscCommand();
+        VectorTscCommand old = new VectorTscCommand();
+        header(tsc, old);
+        text(tsc, old, 10, "第一张 first label");
+        tsc.addPrint(1, 1);
+        old.addPrint(1, 1);
+        tsc.clrCommand();
+        old.clrCommand();
+
+        text(tsc, old, 10, "second");
+        tsc.queryPrinterStatus();
+        old.queryPrinterStatus();
+        assertArrayEquals(old.toBytes(), bytes(tsc));
+    }
+}
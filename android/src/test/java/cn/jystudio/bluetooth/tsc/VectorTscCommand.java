@@ -0,0 +1,140 @@
+package cn.jystudio.bluetooth.tsc;
+
+import java.io.UnsupportedEncodingException;
+import java.util.Vector;
+
+/**
+ * The Vector&lt;Byte&gt; label builder TscCommand replaced, kept as it was for the commands
+ * the tests and the benchmark compare.
+ */
+class VectorTscCommand {
+    private Vector<Byte> Command = null;
+
+    VectorTscCommand() {
+        this.Command = new Vector(4096, 1024);
+    }
+
+    void clrCommand() {
+        this.Command.clear();
+    }
+
+    private void addStrToCommand(String str) {
+        byte[] bs = null;
+        if (!str.equals("")) {
+            try {
+                bs = str.getBytes("GB2312");
+            } catch (UnsupportedEncodingException e) {
+                e.printStackTrace();
+            }
+            for (int i = 0; i < bs.length; i++) {
+                this.Command.add(Byte.valueOf(bs[i]));
+            }
+        }
+    }
+
+    void addGap(int gap) {
+        String str = new String();
+        str = "GAP " + gap + " mm," + 0 + " mm" + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addSize(int width, int height) {
+        String str = new String();
+        str = "SIZE " + width + " mm," + height + " mm" + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addSpeed(TscCommand.SPEED speed) {
+        String str = new String();
+        str = "SPEED " + speed.getValue() + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addDensity(TscCommand.DENSITY density) {
+        String str = new String();
+        str = "DENSITY " + density.getValue() + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addDirection(TscCommand.DIRECTION direction) {
+        String str = new String();
+        str = "DIRECTION " + direction.getValue() + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addReference(int x, int y) {
+        String str = new String();
+        str = "REFERENCE " + x + "," + y + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addCls() {
+        String str = new String();
+        str = "CLS\r\n";
+        addStrToCommand(str);
+    }
+
+    void addPrint(int m, int n) {
+        String str = new String();
+        str = "PRINT " + m + "," + n + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addBar(int x, int y, int width, int height) {
+        String str = new String();
+        str = "BAR " + x + "," + y + "," + width + "," + height + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addText(int x, int y, TscCommand.FONTTYPE font, TscCommand.ROTATION rotation,
+                 TscCommand.FONTMUL Xscal, TscCommand.FONTMUL Yscal, String text) {
+        String str = new String();
+        str = "TEXT " + x + "," + y + "," + "\"" + font.getValue() + "\"" + "," + rotation.getValue() + ","
+                + Xscal.getValue() + "," + Yscal.getValue() + "," + "\"" + text + "\"" + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void add1DBarcode(int x, int y, TscCommand.BARCODETYPE type, int height, int wide, int narrow,
+                      TscCommand.READABLE readable, TscCommand.ROTATION rotation, String content) {
+        String str = new String();
+        str = "BARCODE " + x + "," + y + "," + "\"" + type.getValue() + "\"" + "," + height + "," + readable.getValue()
+                + "," + rotation.getValue() + "," + narrow + "," + wide + "," + "\"" + content + "\"" + "\r\n";
+        addStrToCommand(str);
+    }
+
+    void addQRCode(int x, int y, TscCommand.EEC level, int qrWidth, TscCommand.ROTATION rotation, String code) {
+        String str = "QRCODE " + x + "," + y + "," + level.getValue() + "," + qrWidth + ",A," + rotation.getValue() + ",M2,S1,\"" + code + "\"\r\n";
+        addStrToCommand(str);
+    }
+
+    /** the part of the old addBitmap after RasterCore.encodeTsc */
+    void addBitmapData(int x, int y, TscCommand.BITMAP_MODE mode, int width, int height, byte[] codecontent) {
+        String str = "BITMAP " + x + "," + y + "," + width + "," + height + "," + mode.getValue() + ",";
+        this.addStrToCommand(str);
+
+        for (int k = 0; k < codecontent.length; ++k) {
+            this.Command.add(Byte.valueOf(codecontent[k]));
+        }
+
+        addStrToCommand("\r\n");
+    }
+
+    void queryPrinterStatus() {
+        this.Command.add(Byte.valueOf((byte) 27));
+        this.Command.add(Byte.valueOf((byte) 33));
+        this.Command.add(Byte.valueOf((byte) 63));
+    }
+
+    Vector<Byte> getCommand() {
+        return this.Command;
+    }
+
+    /** what sendDataToDevice did with the Vector before it was written */
+    byte[] toBytes() {
+        byte[] data = new byte[this.Command.size()];
+        for (int i = 0; i < data.length; i++) {
+            data[i] = this.Command.get(i);
+        }
+        return data;
+    }
+}
@@ -0,0 +1,47 @@
+//
+//  bench.h
+//  RNBluetoothEscposPrinter
+//
+//  Wall clock timing for the C core benchmarks. They are built with the tests and run by hand,
+//  the numbers are for comparing two builds on the same Linux machine.
+//
+#ifndef ESCPOS_BENCH_H
+#define ESCPOS_BENCH_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+static inline double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/* xorshift32, the same input on every run */
+static uint32_t bench_seed = 2463534242u;
+
+static inline uint32_t bench_rand(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+/* runs the statement until a quarter second has gone by, prints the best time of one run */
+#define BENCH(name, bytes, stmt) do { \
+        double best_ = 1e30, start_ = bench_now(); \
+        int runs_ = 0; \
+        do { \
+            double t_ = bench_now(); \
+            stmt; \
+            t_ = bench_now() - t_; \
+            if (t_ < best_) best_ = t_; \
+            runs_++; \
+        } while (bench_now() - start_ < 0.25 || runs_ < 3); \
+        printf("%-32s %10.3f ms %10.1f MB/s\n", (name), best_ * 1e3, (bytes) / best_ / 1e6); \
+    } while (0)
+
+#endif
@@ -0,0 +1,43 @@
+//
+//  bench_qr_mask.c
+//  RNBluetoothEscposPrinter
+//
+//  Choosing the mask of a QR symbol of each version: the eight qr_mask_apply and
+//  qr_mask_penalty calls, against the eight masks scored by the four ZXing rule passes.
+//  Only the C kernels are timed, the Objective-C matrix building around them is not.
+//  MB/s is of grid cells for the eight masks.
+//
+
+#define _POSIX_C_SOURCE 199309L
+#include "qr_mask.h"
+#include "qr_mask_reference.h"
+#include "bench.h"
+
+static uint8_t modules[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+static uint8_t data[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+static uint8_t masked[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+
+int main(void)
+{
+    volatile int sink = 0;
+    char name[64];
+    for (int version = 1; version <= 40; version++) {
+        int size = 17 + 4 * version;
+        for (int i = 0; i < size * size; i++) {
+            modules[i] = bench_rand() & 1;
+            data[i] = (bench_rand() & 7) != 0;
+        }
+        double cells = 8.0 * size * size;
+        snprintf(name, sizeof(name), "version %d apply + penalty", version);
+        BENCH(name, cells, for (int p = 0; p < QR_MASK_PATTERNS; p++) {
+            qr_mask_apply(modules, data, (size_t) size, p, masked);
+            sink += qr_mask_penalty(masked, (size_t) size);
+        });
+        snprintf(name, sizeof(name), "version %d apply + rules", version);
+        BENCH(name, cells, for (int p = 0; p < QR_MASK_PATTERNS; p++) {
+            qr_mask_apply(modules, data, (size_t) size, p, masked);
+            sink += reference_penalty(masked, size);
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,50 @@
+//
+//  bench_raster.c
+//  RNBluetoothEscposPrinter
+//
+//  A 576x2000 receipt, the width of an 80mm printer, through luma, every dither mode
+//  and the GS v 0 and TSC BITMAP encoders. MB/s is of grey input.
+//
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+#include "bench.h"
+
+#define W 576
+#define H 2000
+
+static const char *DITHER_NAMES[] = {"threshold", "floyd steinberg", "atkinson", "bayer4", "bayer8", "bayer16"};
+
+int main(void)
+{
+    uint8_t *pixels = malloc((size_t) W * H * 4);
+    uint8_t *grey = malloc((size_t) W * H);
+    uint8_t bits[W];
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = W;
+    uint8_t *out = malloc(raster_escpos_size(&o, H));
+    if (!pixels || !grey || !out) return 1;
+    /* a smooth gradient with noise, like a photo more than a blank receipt */
+    for (size_t i = 0; i < (size_t) W * H * 4; i++) pixels[i] = (uint8_t) ((i / 4 % W) * 255 / W + (bench_rand() & 31));
+
+    BENCH("raster_luma", W * H, raster_luma(pixels, (size_t) W * H, RASTER_RGBX, grey));
+    BENCH("raster_sum", W * H, (void) raster_sum(grey, (size_t) W * H));
+    BENCH("raster_threshold", W * H, for (size_t y = 0; y < H; y++) raster_threshold(grey + y * W, W, 128, bits));
+    BENCH("raster_pack", W * H, for (size_t y = 0; y < H; y++) raster_pack(bits, W / 8, 0, out + y * (W / 8)));
+
+    char name[64];
+    for (int mode = RASTER_DITHER_THRESHOLD; mode <= RASTER_DITHER_BAYER16; mode++) {
+        o.dither = (raster_dither_mode) mode;
+        snprintf(name, sizeof(name), "escpos %s", DITHER_NAMES[mode]);
+        BENCH(name, W * H, raster_escpos_encode(grey, H, &o, out));
+    }
+    BENCH("tsc threshold", W * H, raster_tsc_encode(grey, W, H, RASTER_DITHER_THRESHOLD, out));
+
+    free(out);
+    free(grey);
+    free(pixels);
+    return 0;
+}
@@ -0,0 +1,62 @@
+//
+//  bench_reed_solomon.c
+//  RNBluetoothEscposPrinter
+//
+//  Check words of the largest blocks each symbol makes: QR 40-L (118 data, 30 check),
+//  QR 40-H (15 data, 30 check), Data Matrix 144x144 (156 data, 62 check) and a full
+//  Aztec 32 layer symbol in 12 bit words. The LFSR encoder and the polynomial reference.
+//  MB/s is of data words.
+//
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include "reed_solomon.h"
+#include "reed_solomon_reference.h"
+#include "bench.h"
+
+#define BLOCKS 100
+
+typedef struct {
+    const char *name;
+    int primitive, size, b;
+    int data_words, ec_words;
+} block_spec;
+
+static const block_spec BLOCK_SPECS[] = {
+    {"QR 40-L", 0x011D, 256, 0, 118, 30},
+    {"QR 40-H", 0x011D, 256, 0, 15, 30},
+    {"Data Matrix 144x144", 0x012D, 256, 1, 156, 62},
+    {"Aztec 32 layers", 0x1069, 4096, 1, 1437, 227},
+};
+
+int main(void)
+{
+    char name[64];
+    for (size_t s = 0; s < sizeof(BLOCK_SPECS) / sizeof(BLOCK_SPECS[0]); s++) {
+        const block_spec *spec = &BLOCK_SPECS[s];
+        int n = spec->data_words + spec->ec_words;
+        reed_solomon_field *field = reed_solomon_field_create(spec->primitive, spec->size, spec->b);
+        int32_t *words = malloc((size_t) n * BLOCKS * sizeof(int32_t));
+        uint16_t *generator = malloc((size_t) spec->ec_words * sizeof(uint16_t));
+        if (!field || !words || !generator) return 1;
+        for (int i = 0; i < n * BLOCKS; i++) words[i] = (int32_t) (bench_rand() % (uint32_t) spec->size);
+        double bytes = (double) spec->data_words * BLOCKS;
+
+        snprintf(name, sizeof(name), "%s generator", spec->name);
+        BENCH(name, spec->ec_words, reed_solomon_generator(field, spec->ec_words, generator));
+        snprintf(name, sizeof(name), "%s lfsr", spec->name);
+        BENCH(name, bytes, for (int b = 0; b < BLOCKS; b++) {
+            reed_solomon_encode(field, generator, words + b * n, spec->data_words, spec->ec_words);
+        });
+        snprintf(name, sizeof(name), "%s reference", spec->name);
+        BENCH(name, bytes, for (int b = 0; b < BLOCKS; b++) {
+            reference_encode(spec->primitive, spec->size, spec->b, words + b * n, spec->data_words,
+                             spec->ec_words, words + b * n + spec->data_words);
+        });
+
+        free(generator);
+        free(words);
+        reed_solomon_field_free(field);
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+//
+//  bench_text_layout.c
+//  RNBluetoothEscposPrinter
+//
+//  A 200 row receipt on a 48 column printer through printColumn's layout: one row an item,
+//  a name of Chinese, Korean, emoji and ASCII, a centred quantity and a right aligned price.
+//  Every item is measured with out NULL and then written, as the iOS and Android modules do.
+//  The target is well under a millisecond for the table. MB/s is of UTF-16 input.
+//
+
+#define _POSIX_C_SOURCE 199309L
+#include <stdlib.h>
+#include <string.h>
+#include "text_layout.h"
+#include "bench.h"
+
+#define ITEMS 200
+#define NAME_UNITS 28
+
+typedef struct {
+    uint16_t name[NAME_UNITS];
+    uint16_t qty[4];
+    uint16_t price[8];
+    text_column columns[3];
+} item;
+
+static size_t ascii(const char *s, uint16_t *out)
+{
+    size_t n = strlen(s);
+    for (size_t i = 0; i < n; i++) out[i] = (unsigned char) s[i];
+    return n;
+}
+
+static size_t table(item *items, uint16_t *out)
+{
+    size_t written = 0;
+    for (size_t i = 0; i < ITEMS; i++) {
+        (void) text_layout_columns(items[i].columns, 3, NULL, NULL);
+        written += text_layout_columns(items[i].columns, 3, out + written, NULL);
+    }
+    return written;
+}
+
+int main(void)
+{
+    static const uint16_t words[][2] = {{0x725B, 0}, {0x8089, 0}, {0x9762, 0}, {0xAE40, 0}, {0xCE58, 0},
+                                        {0xD83C, 0xDF5C}, {'B', 0}, {'e', 0}, {'f', 0}, {' ', 0}};
+    item *items = malloc(sizeof(item) * ITEMS);
+    uint16_t *out;
+    size_t input = 0, size = 0, rows = 0;
+    if (!items) return 1;
+
+    for (size_t i = 0; i < ITEMS; i++) {
+        item *it = &items[i];
+        size_t n = 0, chars = 4 + bench_rand() % 10;
+        for (size_t j = 0; j < chars && n + 2 <= NAME_UNITS; j++) {
+            const uint16_t *w = words[bench_rand() % (sizeof(words) / sizeof(words[0]))];
+            it->name[n++] = w[0];
+            if (w[1]) it->name[n++] = w[1];
+        }
+        char number[16];
+        snprintf(number, sizeof(number), "x%u", (unsigned) (1 + bench_rand() % 9));
+        size_t qty = ascii(number, it->qty);
+        snprintf(number, sizeof(number), "%u.%02u", (unsigned) (bench_rand() % 1000), (unsigned) (bench_rand() % 100));
+        size_t price = ascii(number, it->price);
+        it->columns[0] = (text_column) {it->name, n, 30, TEXT_ALIGN_LEFT};
+        it->columns[1] = (text_column) {it->qty, qty, 6, TEXT_ALIGN_CENTER};
+        it->columns[2] = (text_column) {it->price, price, 12, TEXT_ALIGN_RIGHT};
+        input += (n + qty + price) * 2;
+        size_t r = 0;
+        size += text_layout_columns(it->columns, 3, NULL, &r);
+        rows += r;
+    }
+    out = malloc(size * sizeof(uint16_t));
+    if (!out) return 1;
+    printf("%d items, %zu rows of 48 columns, %zu units\n", ITEMS, rows, size);
+
+    BENCH("text_layout_columns 200 rows", input, (void) table(items, out));
+
+    free(out);
+    free(items);
+    return 0;
+}
@@ -0,0 +1,180 @@
+//
+//  bit_matrix.c
+//  RNBluetoothEscposPrinter
+//
+//  Scaling, packing and counting bit rows a word or a table lookup at a time.
+//
+
+#include <string.h>
+#include "bit_matrix.h"
+
+static unsigned popcount32(uint32_t w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_popcount(w);
+#else
+    w = w - ((w >> 1) & 0x55555555u);
+    w = (w & 0x33333333u) + ((w >> 2) & 0x33333333u);
+    return (((w + (w >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#endif
+}
+
+static unsigned popcount64(uint64_t w)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned) __builtin_popcountll(w);
+#else
+    return popcount32((uint32_t) w) + popcount32((uint32_t) (w >> 32));
+#endif
+}
+
+/* two words as one, a single load on little endian targets */
+static uint64_t load64(const uint32_t *words)
+{
+    return words[0] | ((uint64_t) words[1] << 32);
+}
+
+void bit_spread_init(bit_spread *spread, size_t scale, int msb_first)
+{
+    if (scale == 0) scale = 1;
+    spread->scale = scale;
+    spread->modules = scale <= 8 ? 8 : scale <= 16 ? 4 : scale <= 32 ? 2 : 0;
+    spread->msb_first = msb_first;
+    if (!spread->modules) return;
+
+    uint64_t ones = ((uint64_t) 1 << scale) - 1;
+    size_t patterns = (size_t) 1 << spread->modules;
+    for (size_t b = 0; b < patterns; b++) {
+        uint64_t dots = 0;
+        for (size_t j = 0; j < spread->modules; j++) {
+            if (!(b >> j & 1)) continue;
+            dots |= msb_first ? ones << (64 - (j + 1) * scale) : ones << (j * scale);
+        }
+        spread->spread[b] = dots;
+    }
+}
+
+/* ORs the count dots left aligned in dots at dot pos of a byte row */
+static void or_msb(uint8_t *row, size_t pos, uint64_t dots, size_t count)
+{
+    uint8_t *p = row + (pos >> 3);
+    unsigned shift = (unsigned) (pos & 7);
+    size_t bytes = (shift + count + 7) >> 3;
+    uint64_t head = dots >> shift;
+    for (size_t i = 0; i < bytes && i < 8; i++) {
+        p[i] |= (uint8_t) (head >> (56 - 8 * i));
+    }
+    if (bytes > 8) p[8] |= (uint8_t) (dots << (8 - shift));
+}
+
+/* ORs the count dots from bit 0 of dots at dot pos of a word row */
+static void or_lsb(uint32_t *row, size_t pos, uint64_t dots, size_t count)
+{
+    uint32_t *p = row + (pos >> 5);
+    unsigned shift = (unsigned) (pos & 31);
+    size_t words = (shift + count + 31) >> 5;
+    p[0] |= (uint32_t) (dots << shift);
+    if (words > 1) p[1] |= (uint32_t) (dots >> (32 - shift));
+    if (words > 2) p[2] |= (uint32_t) (dots >> (64 - shift));
+}
+
+/* sets count dots from dot start, the first dot of a byte is its most significant bit */
+static void set_run_msb(uint8_t *row, size_t start, size_t count)
+{
+    size_t end = start + count - 1;
+    size_t first = start >> 3, last = end >> 3;
+    uint8_t head = (uint8_t) (0xFF >> (start & 7));
+    uint8_t tail = (uint8_t) (0xFF << (7 - (end & 7)));
+    if (first == last) {
+        row[first] |= head & tail;
+        return;
+    }
+    row[first] |= head;
+    memset(row + first + 1, 0xFF, last - first - 1);
+    row[last] |= tail;
+}
+
+void bit_spread_row(const bit_spread *spread, const uint32_t *words, size_t width, size_t left, void *out)
+{
+    size_t scale = spread->scale, k = spread->modules;
+    if (!k) {
+        for (size_t x = 0; x < width; x++) {
+            if (!(words[x >> 5] >> (x & 31) & 1)) continue;
+            if (spread->msb_first) {
+                set_run_msb(out, left + x * scale, scale);
+            } else {
+                bit_set_range(out, left + x * scale, left + (x + 1) * scale);
+            }
+        }
+        return;
+    }
+    /* k divides 32, a lookup never straddles two words */
+    uint32_t mask = (1u << k) - 1;
+    for (size_t x = 0; x < width; x += k) {
+        uint32_t w = words[x >> 5] >> (x & 31);
+        if (!w) {
+            x = (x | 31) + 1 - k;
+            continue;
+        }
+        size_t n = width - x < k ? width - x : k;
+        uint32_t b = w & mask & ((1u << n) - 1);
+        if (!b) continue;
+        if (spread->msb_first) {
+            or_msb(out, left + x * scale, spread->spread[b], n * scale);
+        } else {
+            or_lsb(out, left + x * scale, spread->spread[b], n * scale);
+        }
+    }
+}
+
+void bit_pack_cells(const int8_t *cells, size_t width, uint32_t *words)
+{
+    for (size_t i = 0; i < width; i += 32) {
+        size_t n = width - i < 32 ? width - i : 32;
+        uint32_t w = 0;
+        for (size_t j = 0; j < n; j++) {
+            w |= (uint32_t) (cells[i + j] == 1) << j;
+        }
+        words[i >> 5] = w;
+    }
+}
+
+void bit_set_range(uint32_t *words, size_t start, size_t end)
+{
+    if (start >= end) return;
+    size_t first = start >> 5, last = (end - 1) >> 5;
+    uint32_t head = ~0u << (start & 31);
+    uint32_t tail = ~0u >> (31 - ((end - 1) & 31));
+    if (first == last) {
+        words[first] |= head & tail;
+        return;
+    }
+    words[first] |= head;
+    for (size_t i = first + 1; i < last; i++) words[i] = ~0u;
+    words[last] |= tail;
+}
+
+size_t bit_count_range(const uint32_t *words, size_t start, size_t end)
+{
+    if (start >= end) return 0;
+    size_t first = start >> 5, last = (end - 1) >> 5;
+    uint32_t head = ~0u << (start & 31);
+    uint32_t tail = ~0u >> (31 - ((end - 1) & 31));
+    if (first == last) return popcount32(words[first] & head & tail);
+
+    size_t count = popcount32(words[first] & head) + popcount32(words[last] & tail);
+    size_t i = first + 1;
+    for (; i + 2 <= last; i += 2) count += popcount64(load64(words + i));
+    if (i < last) count += popcount32(words[i]);
+    return count;
+}
+
+size_t bit_count_region(const uint32_t *bits, size_t row_words,
+                        size_t left, size_t top, size_t width, size_t height)
+{
+    size_t count = 0;
+    for (size_t y = top; y < top + height; y++) {
+        count += bit_count_range(bits + y * row_words, left, left + width);
+    }
+    return count;
+}
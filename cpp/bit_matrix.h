@@ -0,0 +1,56 @@
+//
+//  bit_matrix.h
+//  RNBluetoothEscposPrinter
+//
+//  Word kernels over rows of bits, the first bit of a row in bit 0 of its first 32 bit word.
+//  This is the layout of ZXing's BitMatrix and BitArray.
+//
+#ifndef ESCPOS_BIT_MATRIX_H
+#define ESCPOS_BIT_MATRIX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Every pattern of modules bits spread to scale dots a bit, so a row is scaled a table lookup
+ * at a time. modules is 8 up to scale 8, 4 up to 16, 2 up to 32 and 0 above, where each
+ * module is written as a run.
+ */
+typedef struct {
+    size_t scale;
+    size_t modules;
+    int msb_first;         /* dots for printer bytes, the first dot of a byte is its most significant bit */
+    uint64_t spread[256];  /* msb_first: left aligned in the 64 bits, otherwise from bit 0 */
+} bit_spread;
+
+/* scale 0 is taken as 1 */
+void bit_spread_init(bit_spread *spread, size_t scale, int msb_first);
+
+/*
+ * ORs the modules [0, width) of words into out, module x as dots [left + x * scale,
+ * left + (x + 1) * scale). out is bytes for a msb_first spread, 32 bit words otherwise.
+ */
+void bit_spread_row(const bit_spread *spread, const uint32_t *words, size_t width, size_t left, void *out);
+
+/* words = the cells equal to 1 of cells[0..width), the (width + 31) / 32 words are overwritten */
+void bit_pack_cells(const int8_t *cells, size_t width, uint32_t *words);
+
+/* sets the dots [start, end) of a row of words */
+void bit_set_range(uint32_t *words, size_t start, size_t end);
+
+/* the set bits of [start, end) in a row of words */
+size_t bit_count_range(const uint32_t *words, size_t start, size_t end);
+
+/* the set bits of a region of a matrix of row_words words a row */
+size_t bit_count_region(const uint32_t *bits, size_t row_words,
+                        size_t left, size_t top, size_t width, size_t height);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+#
+#  gen_text_tables.py
+#  RNBluetoothEscposPrinter
+#
+#  Writes text_tables.c from the Python codecs: python3 gen_text_tables.py > text_tables.c
+#
+
+SINGLE_BYTE = ['cp437', 'cp850', 'cp858', 'cp866', 'cp1252']
+DOUBLE_BYTE = [('gb', 'gb18030'), ('big5', 'big5')]
+
+
+def bmp():
+    for cp in range(0x80, 0x10000):
+        if not 0xD800 <= cp < 0xE000:
+            yield cp
+
+
+def encoded(cp, codec):
+    try:
+        return chr(cp).encode(codec)
+    except UnicodeEncodeError:
+        return None
+
+
+def rows(values, per_line, fmt):
+    for i in range(0, len(values), per_line):
+        print('    ' + ', '.join(fmt % v for v in values[i:i + per_line]) + ',')
+
+
+def paged(name, mapping, code_type, code_format, per_line):
+    """mapping: code point -> code, as a page index over the high byte and the spans of the pages."""
+    pages = {}
+    for cp, code in mapping.items():
+        pages.setdefault(cp >> 8, {})[cp & 0xff] = code
+    codes, index = [], []
+    for page in range(256):
+        entries = pages.get(page)
+        if not entries:
+            index.append((1, 0, 0))
+            continue
+        lo, hi = min(entries), max(entries)
+        index.append((lo, hi, len(codes)))
+        codes.extend(entries.get(i, 0) for i in range(lo, hi + 1))
+    print('const text_page text_%s_pages[256] = {' % name)
+    rows(index, 4, '{0x%02X, 0x%02X, %5d}')
+    print('};')
+    print('const %s text_%s_codes[%d] = {' % (code_type, name, len(codes)))
+    rows(codes, per_line, code_format)
+    print('};')
+    print()
+
+
+def single_byte(codec):
+    mapping = {}
+    for b in range(0x80, 0x100):
+        c = bytes([b]).decode(codec, errors='replace')
+        if c != '\ufffd':
+            mapping[ord(c)] = b
+    paged(codec, mapping, 'uint8_t', '0x%02X', 16)
+
+
+def double_byte(name, codec):
+    mapping = {}
+    for cp in bmp():
+        b = encoded(cp, codec)
+        if b is not None and len(b) == 2:
+            mapping[cp] = b[0] << 8 | b[1]
+    paged(name, mapping, 'uint16_t', '0x%04X', 12)
+
+
+def gb18030_ranges():
+    """BMP characters GB18030 writes in four bytes, as runs of consecutive linear indexes."""
+    ranges, last = [], None
+    for cp in bmp():
+        b = encoded(cp, 'gb18030')
+        if len(b) != 4:
+            continue
+        linear = (((b[0] - 0x81) * 10 + (b[1] - 0x30)) * 126 + (b[2] - 0x81)) * 10 + (b[3] - 0x30)
+        if not last or last != (cp - 1, linear - 1):
+            ranges.append((cp, linear))
+        last = (cp, linear)
+    print('const text_gb_range text_gb_ranges[] = {')
+    rows(ranges, 5, '{0x%04X, %5d}')
+    print('};')
+    print('const size_t text_gb_range_count = %d;' % len(ranges))
+
+
+def main():
+    print('//')
+    print('//  text_tables.c')
+    print('//  RNBluetoothEscposPrinter')
+    print('//')
+    print('//  Generated by gen_text_tables.py, do not edit.')
+    print('//')
+    print()
+    print('#include "text_tables.h"')
+    print()
+    for codec in SINGLE_BYTE:
+        single_byte(codec)
+    for name, codec in DOUBLE_BYTE:
+        double_byte(name, codec)
+    gb18030_ranges()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,138 @@
+//
+//  qr_mask.c
+//  RNBluetoothEscposPrinter
+//
+//  Mask selection kernels for the QR encoder, the grid is masked and scored without
+//  rebuilding the function patterns.
+//
+
+#include "qr_mask.h"
+
+/* penalty weights, 6.8.2.1 */
+#define N1 3
+#define N2 3
+#define N3 40
+#define N4 10
+
+/* 1:1:3:1:1 finder-like run in the middle bits of a 15 cell window */
+#define FINDER_RUN 0x5D
+#define WINDOW_MASK 0x7FFF
+
+/* 1 when pattern flips the cell, 8.8.1 table 23. Every mask repeats after 6 columns and 12 rows. */
+static uint8_t flips(int pattern, int x, int y)
+{
+    int product = x * y;
+    switch (pattern) {
+        case 0: return ((y + x) & 1) == 0;
+        case 1: return (y & 1) == 0;
+        case 2: return x % 3 == 0;
+        case 3: return (y + x) % 3 == 0;
+        case 4: return ((y / 2 + x / 3) & 1) == 0;
+        case 5: return (product & 1) + product % 3 == 0;
+        case 6: return (((product & 1) + product % 3) & 1) == 0;
+        case 7: return ((product % 3 + ((y + x) & 1)) & 1) == 0;
+        default: return 0;
+    }
+}
+
+void qr_mask_apply(const uint8_t *modules, const uint8_t *data, size_t size, int pattern, uint8_t *out)
+{
+    uint8_t rows[12][QR_MASK_MAX_SIZE];
+    if (size > QR_MASK_MAX_SIZE) return;
+    for (int y = 0; y < 12; y++) {
+        for (size_t x = 0; x < size; x++) {
+            rows[y][x] = flips(pattern, (int) (x % 6), y);
+        }
+    }
+    for (size_t y = 0; y < size; y++) {
+        const uint8_t *row = modules + y * size;
+        const uint8_t *cells = data + y * size;
+        const uint8_t *flip = rows[y % 12];
+        uint8_t *masked = out + y * size;
+        for (size_t x = 0; x < size; x++) {
+            masked[x] = row[x] ^ (cells[x] & flip[x]);
+        }
+    }
+}
+
+/* N1 for a run that ended, branch free: 3 + (run - 5) from 5 cells on */
+static int run_penalty(unsigned run)
+{
+    return (run >= 5) * (int) (run - 2);
+}
+
+/*
+ * window holds the last 15 cells, the newest in bit 0: 4 cells before the run, the 7 run
+ * cells, 4 after. Cells outside the symbol count as light.
+ */
+static int finder_like(unsigned window)
+{
+    return (((window >> 4) & 0x7F) == FINDER_RUN) & (((window & 0x7800) == 0) | ((window & 0xF) == 0));
+}
+
+/* N1 and N3 along one row, the light cells past the right edge close it */
+static int row_penalty(const uint8_t *row, size_t size, int *finders)
+{
+    int penalty = 0;
+    unsigned run = 1, window = row[0];
+    for (size_t x = 1; x < size; x++) {
+        unsigned same = row[x] == row[x - 1];
+        penalty += same ? 0 : run_penalty(run);
+        run = same ? run + 1 : 1;
+        window = ((window << 1) | row[x]) & WINDOW_MASK;
+        *finders += (x >= 10) & finder_like(window);
+    }
+    for (size_t k = 0; k < 4; k++) {
+        window = (window << 1) & WINDOW_MASK;
+        *finders += size + k >= 10 && finder_like(window);
+    }
+    return penalty + run_penalty(run);
+}
+
+int qr_mask_penalty(const uint8_t *modules, size_t size)
+{
+    uint16_t column_run[QR_MASK_MAX_SIZE];
+    uint16_t column_window[QR_MASK_MAX_SIZE];
+    int rule1 = 0, rule2 = 0, finders = 0;
+    size_t dark = 0;
+    if (size == 0 || size > QR_MASK_MAX_SIZE) return 0;
+
+    for (size_t x = 0; x < size; x++) {
+        column_run[x] = 1;
+        column_window[x] = modules[x];
+        dark += modules[x];
+    }
+    rule1 += row_penalty(modules, size, &finders);
+    for (size_t y = 1; y < size; y++) {
+        const uint8_t *row = modules + y * size;
+        const uint8_t *above = row - size;
+        rule1 += row_penalty(row, size, &finders);
+        /* the columns advance one row, the loop has no branches */
+        unsigned previous_same = 0, left = 2;
+        for (size_t x = 0; x < size; x++) {
+            unsigned bit = row[x];
+            unsigned same = bit == above[x];
+            dark += bit;
+            rule1 += same ? 0 : run_penalty(column_run[x]);
+            column_run[x] = (uint16_t) (same ? column_run[x] + 1 : 1);
+            rule2 += (int) (same & previous_same & (bit == left));
+            previous_same = same;
+            left = bit;
+            column_window[x] = (uint16_t) (((column_window[x] << 1) | bit) & WINDOW_MASK);
+            finders += (y >= 10) & finder_like(column_window[x]);
+        }
+    }
+    for (size_t x = 0; x < size; x++) {
+        unsigned window = column_window[x];
+        rule1 += run_penalty(column_run[x]);
+        for (size_t k = 0; k < 4; k++) {
+            window = (window << 1) & WINDOW_MASK;
+            finders += size + k >= 10 && finder_like(window);
+        }
+    }
+
+    size_t total = size * size;
+    size_t difference = dark * 2 > total ? dark * 2 - total : total - dark * 2;
+    int rule4 = (int) (difference * 10 / total);
+    return rule1 + N2 * rule2 + N3 * finders + N4 * rule4;
+}
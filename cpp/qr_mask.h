@@ -0,0 +1,37 @@
+//
+//  qr_mask.h
+//  RNBluetoothEscposPrinter
+//
+//  QR code data masks and the mask penalty of JIS X 0510:2004 6.8.2.1 over a flat grid.
+//
+#ifndef ESCPOS_QR_MASK_H
+#define ESCPOS_QR_MASK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QR_MASK_MAX_SIZE 177 /* modules per side of version 40 */
+#define QR_MASK_PATTERNS 8
+
+/*
+ * out = modules with the cells where data is 1 flipped by mask pattern 0-7.
+ * All three grids are size x size, row-major, one byte per module, 1 is dark.
+ * size is at most QR_MASK_MAX_SIZE.
+ */
+void qr_mask_apply(const uint8_t *modules, const uint8_t *data, size_t size, int pattern, uint8_t *out);
+
+/*
+ * Penalty rules N1-N4 summed, in one pass over the rows that carries the column state along.
+ * size is at most QR_MASK_MAX_SIZE.
+ */
+int qr_mask_penalty(const uint8_t *modules, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,125 @@
+//
+//  qr_version.c
+//  RNBluetoothEscposPrinter
+//
+//  Version choice from constant tables, without building any version objects.
+//
+
+#include "qr_version.h"
+
+#define QR_MAX_DATA_BITS (8 * 2956) /* version 40-L */
+
+/* data codewords of versions 1-40 at L, M, Q, H, total codewords less the ec codewords */
+static const short DATA_CODEWORDS[QR_VERSION_MAX][4] = {
+    {  19,   16,   13,    9}, /*  1 */
+    {  34,   28,   22,   16}, /*  2 */
+    {  55,   44,   34,   26}, /*  3 */
+    {  80,   64,   48,   36}, /*  4 */
+    { 108,   86,   62,   46}, /*  5 */
+    { 136,  108,   76,   60}, /*  6 */
+    { 156,  124,   88,   66}, /*  7 */
+    { 194,  154,  110,   86}, /*  8 */
+    { 232,  182,  132,  100}, /*  9 */
+    { 274,  216,  154,  122}, /* 10 */
+    { 324,  254,  180,  140}, /* 11 */
+    { 370,  290,  206,  158}, /* 12 */
+    { 428,  334,  244,  180}, /* 13 */
+    { 461,  365,  261,  197}, /* 14 */
+    { 523,  415,  295,  223}, /* 15 */
+    { 589,  453,  325,  253}, /* 16 */
+    { 647,  507,  367,  283}, /* 17 */
+    { 721,  563,  397,  313}, /* 18 */
+    { 795,  627,  445,  341}, /* 19 */
+    { 861,  669,  485,  385}, /* 20 */
+    { 932,  714,  512,  406}, /* 21 */
+    {1006,  782,  568,  442}, /* 22 */
+    {1094,  860,  614,  464}, /* 23 */
+    {1174,  914,  664,  514}, /* 24 */
+    {1276, 1000,  718,  538}, /* 25 */
+    {1370, 1062,  754,  596}, /* 26 */
+    {1468, 1128,  808,  628}, /* 27 */
+    {1531, 1193,  871,  661}, /* 28 */
+    {1631, 1267,  911,  701}, /* 29 */
+    {1735, 1373,  985,  745}, /* 30 */
+    {1843, 1455, 1033,  793}, /* 31 */
+    {1955, 1541, 1115,  845}, /* 32 */
+    {2071, 1631, 1171,  901}, /* 33 */
+    {2191, 1725, 1231,  961}, /* 34 */
+    {2306, 1812, 1286,  986}, /* 35 */
+    {2434, 1914, 1354, 1054}, /* 36 */
+    {2566, 1992, 1426, 1096}, /* 37 */
+    {2702, 2102, 1502, 1142}, /* 38 */
+    {2812, 2216, 1582, 1222}, /* 39 */
+    {2956, 2334, 1666, 1276}, /* 40 */
+};
+
+int qr_version_data_codewords(int version, int ec_level)
+{
+    if (version < 1 || version > QR_VERSION_MAX || ec_level < 0 || ec_level > 3) return 0;
+    return DATA_CODEWORDS[version - 1][ec_level];
+}
+
+int qr_character_count_bits(int version, qr_mode mode)
+{
+    int range = version <= 9 ? 0 : version <= 26 ? 1 : 2;
+    switch (mode) {
+        case QR_MODE_NUMERIC: return 10 + 2 * range;
+        case QR_MODE_ALPHANUMERIC: return 9 + 2 * range;
+        case QR_MODE_BYTE: return range ? 16 : 8;
+        case QR_MODE_KANJI: return 8 + 2 * range;
+        default: return 0;
+    }
+}
+
+long qr_segment_bits(qr_mode mode, long count)
+{
+    switch (mode) {
+        /* 10 bits a group of 3 digits, 4 or 7 for the rest */
+        case QR_MODE_NUMERIC: return 10 * (count / 3) + (count % 3 == 2 ? 7 : count % 3 == 1 ? 4 : 0);
+        case QR_MODE_ALPHANUMERIC: return 11 * (count / 2) + 6 * (count % 2);
+        case QR_MODE_BYTE: return 8 * count;
+        case QR_MODE_KANJI: return 13 * count;
+        default: return 0;
+    }
+}
+
+static int fits(int version, int ec_level, qr_mode mode, long count, int header_bits)
+{
+    long bits = header_bits + qr_character_count_bits(version, mode) + qr_segment_bits(mode, count);
+    return bits <= 8L * DATA_CODEWORDS[version - 1][ec_level];
+}
+
+/*
+ * A version up holds at least 6 more data codewords, more than the 8 bits the count
+ * indicator can grow by, so the versions that fit are a suffix of 1-40.
+ */
+int qr_version_choose(int ec_level, qr_mode mode, long count, int header_bits)
+{
+    if (ec_level < 0 || ec_level > 3 || count < 0 || count > QR_MAX_DATA_BITS / 3) return 0;
+    if (!fits(QR_VERSION_MAX, ec_level, mode, count, header_bits)) return 0;
+    int low = 1, high = QR_VERSION_MAX;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (fits(middle, ec_level, mode, count, header_bits)) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
+
+int qr_version_for_data_bytes(int ec_level, int data_bytes)
+{
+    if (ec_level < 0 || ec_level > 3 || data_bytes > DATA_CODEWORDS[QR_VERSION_MAX - 1][ec_level]) return 0;
+    int low = 1, high = QR_VERSION_MAX;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (DATA_CODEWORDS[middle - 1][ec_level] >= data_bytes) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+    return low;
+}
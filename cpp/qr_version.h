@@ -0,0 +1,48 @@
+//
+//  qr_version.h
+//  RNBluetoothEscposPrinter
+//
+//  QR code data capacity per version and error correction level, JIS X 0510:2004 tables 3 and 7,
+//  and the smallest version a single segment fits in.
+//
+#ifndef ESCPOS_QR_VERSION_H
+#define ESCPOS_QR_VERSION_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QR_VERSION_MAX 40
+
+/* the mode indicators, 8.4 table 2 */
+typedef enum {
+    QR_MODE_NUMERIC = 0x1,
+    QR_MODE_ALPHANUMERIC = 0x2,
+    QR_MODE_BYTE = 0x4,
+    QR_MODE_KANJI = 0x8
+} qr_mode;
+
+/* ec_level is L, M, Q, H as 0-3. Returns 0 outside versions 1-40. */
+int qr_version_data_codewords(int version, int ec_level);
+
+/* bits of the character count indicator, 8.4 table 3 */
+int qr_character_count_bits(int version, qr_mode mode);
+
+/* bits of count characters of mode after the character count indicator */
+long qr_segment_bits(qr_mode mode, long count);
+
+/*
+ * The smallest version whose data codewords hold header_bits (ECI and the mode indicator),
+ * the character count indicator and count characters of mode, found by binary search.
+ * Returns 0 when none does.
+ */
+int qr_version_choose(int ec_level, qr_mode mode, long count, int header_bits);
+
+/* the smallest version with at least data_bytes data codewords, 0 when none has */
+int qr_version_for_data_bytes(int ec_level, int data_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,171 @@
+//
+//  raster.c
+//  RNBluetoothEscposPrinter
+//
+//  Pixel kernels shared by the iOS and Android image pipelines.
+//
+
+#include <string.h>
+#include "raster.h"
+
+#if !defined(RASTER_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+#define RASTER_NEON 1
+#include <arm_neon.h>
+#elif !defined(RASTER_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define RASTER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#define LUMA_R 77
+#define LUMA_G 150
+#define LUMA_B 29
+
+void raster_luma(const uint8_t *pixels, size_t count, raster_pixel_order order, uint8_t *grey)
+{
+    size_t i = 0;
+    int r_at = order == RASTER_BGRX ? 2 : 0;
+    int b_at = 2 - r_at;
+#if RASTER_NEON
+    const uint8x8_t wr = vdup_n_u8(LUMA_R), wg = vdup_n_u8(LUMA_G), wb = vdup_n_u8(LUMA_B);
+    for (; i + 16 <= count; i += 16) {
+        uint8x16x4_t px = vld4q_u8(pixels + i * 4);
+        uint8x16_t r = order == RASTER_BGRX ? px.val[2] : px.val[0];
+        uint8x16_t g = px.val[1];
+        uint8x16_t b = order == RASTER_BGRX ? px.val[0] : px.val[2];
+        uint16x8_t lo = vmull_u8(vget_low_u8(r), wr);
+        lo = vmlal_u8(lo, vget_low_u8(g), wg);
+        lo = vmlal_u8(lo, vget_low_u8(b), wb);
+        uint16x8_t hi = vmull_u8(vget_high_u8(r), wr);
+        hi = vmlal_u8(hi, vget_high_u8(g), wg);
+        hi = vmlal_u8(hi, vget_high_u8(b), wb);
+        vst1q_u8(grey + i, vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+    }
+#elif RASTER_SSE2
+    const __m128i mask = _mm_set1_epi32(0xff);
+    const __m128i wr = _mm_set1_epi32(LUMA_R), wg = _mm_set1_epi32(LUMA_G), wb = _mm_set1_epi32(LUMA_B);
+    for (; i + 16 <= count; i += 16) {
+        __m128i y[4];
+        for (int k = 0; k < 4; k++) {
+            __m128i px = _mm_loadu_si128((const __m128i *) (pixels + (i + 4 * k) * 4));
+            __m128i c0 = _mm_and_si128(px, mask);
+            __m128i g = _mm_and_si128(_mm_srli_epi32(px, 8), mask);
+            __m128i c2 = _mm_and_si128(_mm_srli_epi32(px, 16), mask);
+            __m128i r = order == RASTER_BGRX ? c2 : c0;
+            __m128i b = order == RASTER_BGRX ? c0 : c2;
+            // every product fits the low 16 bits of its lane, the sum is at most 255*256
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg)),
+                                        _mm_mullo_epi16(b, wb));
+            y[k] = _mm_srli_epi32(sum, 8);
+        }
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(y[0], y[1]), _mm_packs_epi32(y[2], y[3]));
+        _mm_storeu_si128((__m128i *) (grey + i), packed);
+    }
+#endif
+    for (; i < count; i++) {
+        const uint8_t *p = pixels + i * 4;
+        grey[i] = (uint8_t) ((LUMA_R * p[r_at] + LUMA_G * p[1] + LUMA_B * p[b_at]) >> 8);
+    }
+}
+
+void raster_threshold(const uint8_t *grey, size_t count, uint8_t threshold, uint8_t *bits)
+{
+    size_t i = 0;
+#if RASTER_NEON
+    const uint8x16_t t = vdupq_n_u8(threshold), one = vdupq_n_u8(1);
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(bits + i, vandq_u8(vcleq_u8(vld1q_u8(grey + i), t), one));
+    }
+#elif RASTER_SSE2
+    const __m128i t = _mm_set1_epi8((char) threshold), one = _mm_set1_epi8(1);
+    for (; i + 16 <= count; i += 16) {
+        __m128i g = _mm_loadu_si128((const __m128i *) (grey + i));
+        // unsigned g <= t is min(g,t) == g
+        __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(g, t), g);
+        _mm_storeu_si128((__m128i *) (bits + i), _mm_and_si128(le, one));
+    }
+#endif
+    for (; i < count; i++) {
+        bits[i] = grey[i] <= threshold;
+    }
+}
+
+#if RASTER_SSE2
+// movemask puts the first pixel in the lowest bit, the printer wants it in the highest.
+static const uint8_t REVERSE_BITS[256] = {
+    0x00,0x80,0x40,0xc0,0x20,0xa0,0x60,0xe0,0x10,0x90,0x50,0xd0,0x30,0xb0,0x70,0xf0,
+    0x08,0x88,0x48,0xc8,0x28,0xa8,0x68,0xe8,0x18,0x98,0x58,0xd8,0x38,0xb8,0x78,0xf8,
+    0x04,0x84,0x44,0xc4,0x24,0xa4,0x64,0xe4,0x14,0x94,0x54,0xd4,0x34,0xb4,0x74,0xf4,
+    0x0c,0x8c,0x4c,0xcc,0x2c,0xac,0x6c,0xec,0x1c,0x9c,0x5c,0xdc,0x3c,0xbc,0x7c,0xfc,
+    0x02,0x82,0x42,0xc2,0x22,0xa2,0x62,0xe2,0x12,0x92,0x52,0xd2,0x32,0xb2,0x72,0xf2,
+    0x0a,0x8a,0x4a,0xca,0x2a,0xaa,0x6a,0xea,0x1a,0x9a,0x5a,0xda,0x3a,0xba,0x7a,0xfa,
+    0x06,0x86,0x46,0xc6,0x26,0xa6,0x66,0xe6,0x16,0x96,0x56,0xd6,0x36,0xb6,0x76,0xf6,
+    0x0e,0x8e,0x4e,0xce,0x2e,0xae,0x6e,0xee,0x1e,0x9e,0x5e,0xde,0x3e,0xbe,0x7e,0xfe,
+    0x01,0x81,0x41,0xc1,0x21,0xa1,0x61,0xe1,0x11,0x91,0x51,0xd1,0x31,0xb1,0x71,0xf1,
+    0x09,0x89,0x49,0xc9,0x29,0xa9,0x69,0xe9,0x19,0x99,0x59,0xd9,0x39,0xb9,0x79,0xf9,
+    0x05,0x85,0x45,0xc5,0x25,0xa5,0x65,0xe5,0x15,0x95,0x55,0xd5,0x35,0xb5,0x75,0xf5,
+    0x0d,0x8d,0x4d,0xcd,0x2d,0xad,0x6d,0xed,0x1d,0x9d,0x5d,0xdd,0x3d,0xbd,0x7d,0xfd,
+    0x03,0x83,0x43,0xc3,0x23,0xa3,0x63,0xe3,0x13,0x93,0x53,0xd3,0x33,0xb3,0x73,0xf3,
+    0x0b,0x8b,0x4b,0xcb,0x2b,0xab,0x6b,0xeb,0x1b,0x9b,0x5b,0xdb,0x3b,0xbb,0x7b,0xfb,
+    0x07,0x87,0x47,0xc7,0x27,0xa7,0x67,0xe7,0x17,0x97,0x57,0xd7,0x37,0xb7,0x77,0xf7,
+    0x0f,0x8f,0x4f,0xcf,0x2f,0xaf,0x6f,0xef,0x1f,0x9f,0x5f,0xdf,0x3f,0xbf,0x7f,0xff
+};
+#endif
+
+void raster_pack(const uint8_t *bits, size_t nbytes, int invert, uint8_t *out)
+{
+    size_t j = 0;
+    uint8_t flip = invert ? 0xff : 0;
+#if RASTER_NEON
+    static const int8_t shifts[16] = {7, 6, 5, 4, 3, 2, 1, 0, 7, 6, 5, 4, 3, 2, 1, 0};
+    const int8x16_t shift = vld1q_s8(shifts);
+    const uint8x16_t one = vdupq_n_u8(1);
+    for (; j + 2 <= nbytes; j += 2) {
+        uint8x16_t v = vshlq_u8(vandq_u8(vld1q_u8(bits + j * 8), one), shift);
+        // three pairwise adds fold each group of 8 lanes into one byte
+        uint8x8_t s = vpadd_u8(vget_low_u8(v), vget_high_u8(v));
+        s = vpadd_u8(s, s);
+        s = vpadd_u8(s, s);
+        out[j] = vget_lane_u8(s, 0) ^ flip;
+        out[j + 1] = vget_lane_u8(s, 1) ^ flip;
+    }
+#elif RASTER_SSE2
+    for (; j + 2 <= nbytes; j += 2) {
+        __m128i v = _mm_loadu_si128((const __m128i *) (bits + j * 8));
+        // moves the 0/1 of every byte to its sign bit, the pixels are 0 or 1 so nothing crosses a byte
+        int m = _mm_movemask_epi8(_mm_slli_epi16(v, 7));
+        out[j] = REVERSE_BITS[m & 0xff] ^ flip;
+        out[j + 1] = REVERSE_BITS[(m >> 8) & 0xff] ^ flip;
+    }
+#endif
+    for (; j < nbytes; j++) {
+        const uint8_t *p = bits + j * 8;
+        uint8_t b = (uint8_t) (p[0] << 7 | p[1] << 6 | p[2] << 5 | p[3] << 4 | p[4] << 3 | p[5] << 2 | p[6] << 1 | p[7]);
+        out[j] = b ^ flip;
+    }
+}
+
+uint64_t raster_sum(const uint8_t *grey, size_t count)
+{
+    uint64_t total = 0;
+    size_t i = 0;
+#if RASTER_SSE2
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= count; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *) (grey + i)), zero));
+    }
+    uint64_t lanes[2];
+    _mm_storeu_si128((__m128i *) lanes, acc);
+    total = lanes[0] + lanes[1];
+#elif RASTER_NEON
+    uint64x2_t acc = vdupq_n_u64(0);
+    for (; i + 16 <= count; i += 16) {
+        acc = vpadalq_u32(acc, vpaddlq_u16(vpaddlq_u8(vld1q_u8(grey + i))));
+    }
+    total = vgetq_lane_u64(acc, 0) + vgetq_lane_u64(acc, 1);
+#endif
+    for (; i < count; i++) {
+        total += grey[i];
+    }
+    return total;
+}
@@ -0,0 +1,141 @@
+//
+//  raster.h
+//  RNBluetoothEscposPrinter
+//
+//  Pixel kernels shared by the iOS and Android image pipelines.
+//  NEON and SSE2 paths are picked at compile time, other targets use the scalar code.
+//
+#ifndef ESCPOS_RASTER_H
+#define ESCPOS_RASTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* byte order of a 32 bit pixel in memory, the 4th byte is ignored. */
+typedef enum {
+    RASTER_RGBX = 0, /* CoreGraphics kCGImageAlphaNoneSkipLast, Android ARGB_8888 buffers */
+    RASTER_BGRX = 1  /* java int ARGB pixels (Bitmap.getPixels) on little endian */
+} raster_pixel_order;
+
+/* grey = (77*R + 150*G + 29*B) >> 8, the BT.601 weights in 8 bit fixed point. */
+void raster_luma(const uint8_t *pixels, size_t count, raster_pixel_order order, uint8_t *grey);
+
+/* bits[i] = grey[i] <= threshold ? 1 : 0, 1 is a printed (black) dot. */
+void raster_threshold(const uint8_t *grey, size_t count, uint8_t threshold, uint8_t *bits);
+
+/*
+ * Packs 8*nbytes 0/1 pixels into nbytes, the first pixel is the most significant bit.
+ * invert flips every bit, TSC BITMAP prints the 0 bits.
+ */
+void raster_pack(const uint8_t *bits, size_t nbytes, int invert, uint8_t *out);
+
+uint64_t raster_sum(const uint8_t *grey, size_t count);
+
+/* ---- dithering, raster_dither.c ---- */
+
+typedef enum {
+    RASTER_DITHER_THRESHOLD = 0, /* grey <= threshold, the callers pass the mean grey */
+    RASTER_DITHER_FLOYD_STEINBERG = 1,
+    RASTER_DITHER_ATKINSON = 2,
+    RASTER_DITHER_BAYER4 = 3,
+    RASTER_DITHER_BAYER8 = 4,
+    RASTER_DITHER_BAYER16 = 5
+} raster_dither_mode;
+
+typedef struct raster_dither raster_dither;
+
+/*
+ * Dithers rows of width grey pixels from the top of the image down. Error diffusion keeps
+ * one buffer of three rows. Returns NULL when out of memory.
+ */
+raster_dither *raster_dither_create(raster_dither_mode mode, size_t width, uint8_t threshold);
+void raster_dither_row(raster_dither *dither, const uint8_t *grey, uint8_t *bits);
+void raster_dither_free(raster_dither *dither);
+
+/* ---- GS v 0 and TSC BITMAP encoding, raster_encode.c ---- */
+
+typedef struct {
+    size_t width;              /* image dots per row */
+    size_t left;               /* blank dots in front of every row */
+    raster_dither_mode dither;
+    uint8_t threshold;         /* for RASTER_DITHER_THRESHOLD */
+    size_t rows_per_command;   /* GS v 0 rows under one header, 0 or more than 65535 means 65535 */
+    uint8_t escpos_mode;       /* m of GS v 0 m xL xH yL yH */
+} raster_options;
+
+typedef struct raster_encoder raster_encoder;
+
+/* Encodes an image of height rows, one grey row at a time. Returns NULL when out of memory. */
+raster_encoder *raster_encoder_create(const raster_options *options, size_t height);
+size_t raster_encoder_bytes_per_line(const raster_encoder *encoder);
+/* the most bytes the next rows calls of raster_encoder_escpos_row can write */
+size_t raster_encoder_max_output(const raster_encoder *encoder, size_t rows);
+/* writes a GS v 0 header when a new command starts, then the packed row. Returns the bytes written. */
+size_t raster_encoder_escpos_row(raster_encoder *encoder, const uint8_t *grey, uint8_t *out);
+/* writes the packed row for TSC BITMAP, a 0 bit prints. Returns the bytes written. */
+size_t raster_encoder_tsc_row(raster_encoder *encoder, const uint8_t *grey, uint8_t *out);
+void raster_encoder_free(raster_encoder *encoder);
+
+/*
+ * Whole image helpers, the threshold for RASTER_DITHER_THRESHOLD is the mean grey.
+ * out must hold raster_escpos_size / raster_tsc_size bytes. Return the bytes written, 0 when out of memory.
+ */
+size_t raster_escpos_size(const raster_options *options, size_t height);
+size_t raster_escpos_encode(const uint8_t *grey, size_t height, const raster_options *options, uint8_t *out);
+size_t raster_tsc_size(size_t width, size_t height);
+size_t raster_tsc_encode(const uint8_t *grey, size_t width, size_t height, raster_dither_mode dither, uint8_t *out);
+
+/*
+ * NV graphics, GS ( L / GS 8 L function 67 in raster format. kc1 kc2 is the key of the
+ * image in the printer (32..126 each), width 1..8192 and height 1..2304 dots.
+ * raster_nv_define_size is 0 for an image the printer can not store.
+ */
+size_t raster_nv_define_size(size_t width, size_t height);
+size_t raster_nv_define(const uint8_t *grey, size_t width, size_t height, raster_dither_mode dither,
+                        uint8_t kc1, uint8_t kc2, uint8_t *out);
+
+/* prints the image kc1 kc2 at normal size, GS ( L function 69. Writes RASTER_NV_PRINT_SIZE bytes. */
+#define RASTER_NV_PRINT_SIZE 11
+size_t raster_nv_print(uint8_t kc1, uint8_t kc2, uint8_t *out);
+/* deletes the image kc1 kc2, GS ( L function 66. Writes RASTER_NV_DELETE_SIZE bytes. */
+#define RASTER_NV_DELETE_SIZE 9
+size_t raster_nv_delete(uint8_t kc1, uint8_t kc2, uint8_t *out);
+/* deletes every image, GS ( L function 65 "CLR". Writes RASTER_NV_DELETE_ALL_SIZE bytes. */
+#define RASTER_NV_DELETE_ALL_SIZE 10
+size_t raster_nv_delete_all(uint8_t *out);
+
+/* ---- 1 bit symbols to GS v 0, raster_symbol.c ---- */
+
+/*
+ * A matrix of modules as ZXing keeps it: rows of row_words 32 bit words, module x of a row
+ * is bit x % 32 of word x / 32, 1 is black.
+ */
+typedef struct {
+    const uint32_t *bits;
+    size_t row_words;
+    size_t width;
+    size_t height;
+} raster_matrix;
+
+typedef struct {
+    size_t scale;              /* dots per module, 0 means 1 */
+    size_t left;               /* blank dots in front of every row */
+    size_t width;              /* dots after left, the symbol is centred in them, 0 for the symbol width */
+    size_t height;             /* rows, the symbol is centred in them, 0 for the symbol height */
+    size_t rows_per_command;   /* as in raster_options */
+    uint8_t escpos_mode;
+} raster_symbol_options;
+
+/* Packs the modules straight into GS v 0 rows, out must hold raster_symbol_escpos_size bytes. */
+size_t raster_symbol_escpos_size(const raster_matrix *matrix, const raster_symbol_options *options);
+size_t raster_symbol_escpos_encode(const raster_matrix *matrix, const raster_symbol_options *options, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESCPOS_RASTER_H */
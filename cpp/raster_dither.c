@@ -0,0 +1,111 @@
+//
+//  raster_dither.c
+//  RNBluetoothEscposPrinter
+//
+//  Row at a time dithering, 1 is a printed (black) dot.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+
+/* ordered dither thresholds, indexed [x][y] as the original PrintPicture.java 16x16 table. */
+static const uint8_t BAYER4[4][4] = {{8,136,40,168},{200,72,232,104},{56,184,24,152},{248,120,216,88}};
+static const uint8_t BAYER8[8][8] = {{2,130,34,162,10,138,42,170},{194,66,226,98,202,74,234,106},{50,178,18,146,58,186,26,154},{242,114,210,82,250,122,218,90},{14,142,46,174,6,134,38,166},{206,78,238,110,198,70,230,102},{62,190,30,158,54,182,22,150},{254,126,222,94,246,118,214,86}};
+static const uint8_t BAYER16[16][16] = {{0,128,32,160,8,136,40,168,2,130,34,162,10,138,42,170},{192,64,224,96,200,72,232,104,194,66,226,98,202,74,234,106},{48,176,16,144,56,184,24,152,50,178,18,146,58,186,26,154},{240,112,208,80,248,120,216,88,242,114,210,82,250,122,218,90},{12,140,44,172,4,132,36,164,14,142,46,174,6,134,38,166},{204,76,236,108,196,68,228,100,206,78,238,110,198,70,230,102},{60,188,28,156,52,180,20,148,62,190,30,158,54,182,22,150},{252,124,220,92,244,116,212,84,254,126,222,94,246,118,214,86},{3,131,35,163,11,139,43,171,1,129,33,161,9,137,41,169},{195,67,227,99,203,75,235,107,193,65,225,97,201,73,233,105},{51,179,19,147,59,187,27,155,49,177,17,145,57,185,25,153},{243,115,211,83,251,123,219,91,241,113,209,81,249,121,217,89},{15,143,47,175,7,135,39,167,13,141,45,173,5,133,37,165},{207,79,239,111,199,71,231,103,205,77,237,109,197,69,229,101},{63,191,31,159,55,183,23,151,61,189,29,157,53,181,21,149},{254,127,223,95,247,119,215,87,253,125,221,93,245,117,213,85}};
+
+/* error rows are padded by 2 on both sides so x-1 and x+2 need no bounds checks. */
+#define ERR_PAD 2
+
+struct raster_dither {
+    raster_dither_mode mode;
+    size_t width;
+    uint8_t threshold;
+    size_t y;
+    int *err; /* three rows: this row, the next one and the one after */
+};
+
+raster_dither *raster_dither_create(raster_dither_mode mode, size_t width, uint8_t threshold)
+{
+    raster_dither *d = calloc(1, sizeof(raster_dither));
+    if (!d) return NULL;
+    d->mode = mode;
+    d->width = width;
+    d->threshold = threshold;
+    if (mode == RASTER_DITHER_FLOYD_STEINBERG || mode == RASTER_DITHER_ATKINSON) {
+        d->err = calloc(3 * (width + 2 * ERR_PAD), sizeof(int));
+        if (!d->err) {
+            free(d);
+            return NULL;
+        }
+    }
+    return d;
+}
+
+void raster_dither_free(raster_dither *d)
+{
+    if (!d) return;
+    free(d->err);
+    free(d);
+}
+
+static int *error_row(raster_dither *d, size_t ahead)
+{
+    return d->err + ((d->y + ahead) % 3) * (d->width + 2 * ERR_PAD) + ERR_PAD;
+}
+
+void raster_dither_row(raster_dither *d, const uint8_t *grey, uint8_t *bits)
+{
+    size_t w = d->width;
+    size_t x;
+    switch (d->mode) {
+        case RASTER_DITHER_FLOYD_STEINBERG: {
+            int *cur = error_row(d, 0);
+            int *next = error_row(d, 1);
+            for (x = 0; x < w; x++) {
+                int v = grey[x] + cur[x];
+                int black = v < 128;
+                int e = black ? v : v - 255;
+                bits[x] = (uint8_t) black;
+                cur[x + 1] += (e * 7) >> 4;
+                next[x - 1] += (e * 3) >> 4;
+                next[x] += (e * 5) >> 4;
+                next[x + 1] += e >> 4;
+            }
+            memset(cur - ERR_PAD, 0, (w + 2 * ERR_PAD) * sizeof(int));
+            break;
+        }
+        case RASTER_DITHER_ATKINSON: {
+            int *cur = error_row(d, 0);
+            int *next = error_row(d, 1);
+            int *next2 = error_row(d, 2);
+            for (x = 0; x < w; x++) {
+                int v = grey[x] + cur[x];
+                int black = v < 128;
+                int e = (black ? v : v - 255) >> 3; /* only 6/8 of the error is spread */
+                bits[x] = (uint8_t) black;
+                cur[x + 1] += e;
+                cur[x + 2] += e;
+                next[x - 1] += e;
+                next[x] += e;
+                next[x + 1] += e;
+                next2[x] += e;
+            }
+            memset(cur - ERR_PAD, 0, (w + 2 * ERR_PAD) * sizeof(int));
+            break;
+        }
+        case RASTER_DITHER_BAYER4:
+            for (x = 0; x < w; x++) bits[x] = grey[x] <= BAYER4[x & 3][d->y & 3];
+            break;
+        case RASTER_DITHER_BAYER8:
+            for (x = 0; x < w; x++) bits[x] = grey[x] <= BAYER8[x & 7][d->y & 7];
+            break;
+        case RASTER_DITHER_BAYER16:
+            for (x = 0; x < w; x++) bits[x] = grey[x] <= BAYER16[x & 15][d->y & 15];
+            break;
+        default:
+            raster_threshold(grey, w, d->threshold, bits);
+            break;
+    }
+    d->y++;
+}
@@ -0,0 +1,285 @@
+//
+//  raster_encode.c
+//  RNBluetoothEscposPrinter
+//
+//  Grey rows to GS v 0 raster commands and TSC BITMAP data.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+
+#define GS_V0_HEADER 8
+#define GS_V0_MAX_ROWS 0xffff
+
+struct raster_encoder {
+    raster_options options;
+    size_t height;
+    size_t bytes_per_line;
+    size_t rows_per_command;
+    size_t y;
+    size_t command_rows; /* rows left under the last GS v 0 header */
+    raster_dither *dither;
+    uint8_t *bits; /* one row of dots, bytes_per_line*8 wide, the padding stays 0 */
+};
+
+raster_encoder *raster_encoder_create(const raster_options *options, size_t height)
+{
+    raster_encoder *e = calloc(1, sizeof(raster_encoder));
+    if (!e) return NULL;
+    e->options = *options;
+    e->height = height;
+    e->bytes_per_line = (options->left + options->width + 7) / 8;
+    e->rows_per_command = (options->rows_per_command == 0 || options->rows_per_command > GS_V0_MAX_ROWS)
+                          ? GS_V0_MAX_ROWS : options->rows_per_command;
+    e->bits = calloc(e->bytes_per_line * 8, 1);
+    e->dither = raster_dither_create(options->dither, options->width, options->threshold);
+    if (!e->bits || !e->dither) {
+        raster_encoder_free(e);
+        return NULL;
+    }
+    return e;
+}
+
+void raster_encoder_free(raster_encoder *e)
+{
+    if (!e) return;
+    raster_dither_free(e->dither);
+    free(e->bits);
+    free(e);
+}
+
+size_t raster_encoder_bytes_per_line(const raster_encoder *e)
+{
+    return e->bytes_per_line;
+}
+
+size_t raster_encoder_max_output(const raster_encoder *e, size_t rows)
+{
+    return rows * (e->bytes_per_line + GS_V0_HEADER);
+}
+
+static void pack_row(raster_encoder *e, const uint8_t *grey, int invert, uint8_t *out)
+{
+    raster_dither_row(e->dither, grey, e->bits + e->options.left);
+    raster_pack(e->bits, e->bytes_per_line, invert, out);
+    e->y++;
+}
+
+/*
+ Raster Image - $1D $76 $30 m xL xH yL yH d1...dk
+ Prints a raster image
+ 
+ Format:
+ Hex       $1D  $76 30  m xL xH yL yH d1...dk
+ 
+ ASCII     GS   v   %   m xL xH yL yH d1...dk
+ 
+ Decimal   29  118  48  m xL xH yL yH d1...dk
+ 
+ Notes:
+ When ​standard mode​ is enabled, this command is only executed when there is no data in the print buffer. (Line is empty)
+ The defined data (​d​) defines each byte of the raster image. Each bit in every byte defines a pixel. A bit set to 1 is printed and a bit set to 0 is not printed.
+ If a raster bit image exceeds one line, the excess data is not printed.
+ This command feeds as much paper as is required to print the entire raster bit image, regardless of line spacing defined by 1/6” or 1/8” commands.
+ After the raster bit image is printed, the print position goes to the beginning of the line.
+ The following commands have no effect on a raster bit image:
+ Emphasized
+ Double Strike
+ Underline
+ White/Black Inverse Printing
+ Upside-Down Printing
+ Rotation
+ Left margin
+ Print Area Width
+ A raster bit image data is printed in the following order:
+ d1    d2    …    dx
+ dx + 1    dx + 2    …    dx * 2
+ .    .    .    .
+ …    dk - 2    dk - 1    dk
+ Defines and prints a raster bit image using the mode specified by ​m​:
+ m    Mode    Width Scalar    Heigh Scalar
+ 0, 48    Normal    x1    x1
+ 1, 49    Double Width    x2    x1
+ 2, 50    Double Height    x1    x2
+ 3, 51    Double Width/Height    x2    x2
+ xL, xH ​defines the raster bit image in the horizontal direction in ​bytes​ using two-byte number definitions. (​xL + (xH * 256)) Bytes
+ yL, yH ​defines the raster bit image in the vertical direction in ​dots​ using two-byte number definitions. (​yL + (yH * 256)) Dots
+ d ​ specifies the bit image data in raster format.
+ k ​indicates the number of bytes in the bit image. ​k ​is not transmitted and is there for explanation only.
+ */
+size_t raster_encoder_escpos_row(raster_encoder *e, const uint8_t *grey, uint8_t *out)
+{
+    size_t written = 0;
+    if (e->y >= e->height) return 0;
+    if (e->command_rows == 0) {
+        size_t rows = e->height - e->y;
+        if (rows > e->rows_per_command) rows = e->rows_per_command;
+        e->command_rows = rows;
+        /* GS v 0 m xL xH yL yH d1....dk */
+        out[0] = 29;
+        out[1] = 118;
+        out[2] = 48;
+        out[3] = e->options.escpos_mode;
+        out[4] = (uint8_t) (e->bytes_per_line % 256);
+        out[5] = (uint8_t) (e->bytes_per_line / 256);
+        out[6] = (uint8_t) (rows % 256);
+        out[7] = (uint8_t) (rows / 256);
+        written = GS_V0_HEADER;
+    }
+    pack_row(e, grey, 0, out + written);
+    e->command_rows--;
+    return written + e->bytes_per_line;
+}
+
+size_t raster_encoder_tsc_row(raster_encoder *e, const uint8_t *grey, uint8_t *out)
+{
+    if (e->y >= e->height) return 0;
+    pack_row(e, grey, 1, out);
+    return e->bytes_per_line;
+}
+
+static uint8_t mean_grey(const uint8_t *grey, size_t count)
+{
+    return count ? (uint8_t) (raster_sum(grey, count) / count) : 0;
+}
+
+size_t raster_escpos_size(const raster_options *options, size_t height)
+{
+    size_t rows = (options->rows_per_command == 0 || options->rows_per_command > GS_V0_MAX_ROWS)
+                  ? GS_V0_MAX_ROWS : options->rows_per_command;
+    size_t commands = (height + rows - 1) / rows;
+    return height * ((options->left + options->width + 7) / 8) + commands * GS_V0_HEADER;
+}
+
+size_t raster_escpos_encode(const uint8_t *grey, size_t height, const raster_options *options, uint8_t *out)
+{
+    raster_options o = *options;
+    if (o.dither == RASTER_DITHER_THRESHOLD) {
+        o.threshold = mean_grey(grey, o.width * height);
+    }
+    raster_encoder *e = raster_encoder_create(&o, height);
+    if (!e) return 0;
+    size_t written = 0;
+    for (size_t y = 0; y < height; y++) {
+        written += raster_encoder_escpos_row(e, grey + y * o.width, out + written);
+    }
+    raster_encoder_free(e);
+    return written;
+}
+
+size_t raster_tsc_size(size_t width, size_t height)
+{
+    return height * ((width + 7) / 8);
+}
+
+size_t raster_tsc_encode(const uint8_t *grey, size_t width, size_t height, raster_dither_mode dither, uint8_t *out)
+{
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = width;
+    o.dither = dither;
+    if (dither == RASTER_DITHER_THRESHOLD) {
+        o.threshold = mean_grey(grey, width * height);
+    }
+    raster_encoder *e = raster_encoder_create(&o, height);
+    if (!e) return 0;
+    size_t written = 0;
+    for (size_t y = 0; y < height; y++) {
+        written += raster_encoder_tsc_row(e, grey + y * width, out + written);
+    }
+    raster_encoder_free(e);
+    return written;
+}
+
+#define NV_MAX_WIDTH 8192
+#define NV_MAX_HEIGHT 2304
+#define NV_PARAMS 11 /* m fn a kc1 kc2 b xL xH yL yH c */
+
+size_t raster_nv_define_size(size_t width, size_t height)
+{
+    if (width < 1 || width > NV_MAX_WIDTH || height < 1 || height > NV_MAX_HEIGHT) return 0;
+    size_t params = NV_PARAMS + raster_tsc_size(width, height);
+    /* GS ( L pL pH up to 65535 parameter bytes, GS 8 L p1 p2 p3 p4 above */
+    return (params <= 0xffff ? 5 : 7) + params;
+}
+
+/*
+ GS ( L pL pH m fn a kc1 kc2 b xL xH yL yH c d1...dk
+ GS 8 L p1 p2 p3 p4 m fn a kc1 kc2 b xL xH yL yH c d1...dk
+ m=48 fn=67 defines NV graphics in raster format, a=48 monochrome, b=1 colour, c=49 colour 1.
+ The rows are (width+7)/8 bytes, a 1 bit prints. The image is written to flash,
+ it stays after power off and is printed with fn=69.
+ */
+size_t raster_nv_define(const uint8_t *grey, size_t width, size_t height, raster_dither_mode dither,
+                        uint8_t kc1, uint8_t kc2, uint8_t *out)
+{
+    size_t size = raster_nv_define_size(width, height);
+    if (!size) return 0;
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = width;
+    o.dither = dither;
+    if (dither == RASTER_DITHER_THRESHOLD) {
+        o.threshold = mean_grey(grey, width * height);
+    }
+    raster_encoder *e = raster_encoder_create(&o, height);
+    if (!e) return 0;
+    size_t params = NV_PARAMS + raster_tsc_size(width, height);
+    size_t n = 0;
+    out[n++] = 29;
+    if (params <= 0xffff) {
+        out[n++] = 40;
+        out[n++] = 76;
+        out[n++] = (uint8_t) (params & 0xff);
+        out[n++] = (uint8_t) (params >> 8);
+    } else {
+        out[n++] = 56;
+        out[n++] = 76;
+        out[n++] = (uint8_t) (params & 0xff);
+        out[n++] = (uint8_t) ((params >> 8) & 0xff);
+        out[n++] = (uint8_t) ((params >> 16) & 0xff);
+        out[n++] = (uint8_t) ((params >> 24) & 0xff);
+    }
+    out[n++] = 48;
+    out[n++] = 67;
+    out[n++] = 48;
+    out[n++] = kc1;
+    out[n++] = kc2;
+    out[n++] = 1;
+    out[n++] = (uint8_t) (width & 0xff);
+    out[n++] = (uint8_t) (width >> 8);
+    out[n++] = (uint8_t) (height & 0xff);
+    out[n++] = (uint8_t) (height >> 8);
+    out[n++] = 49;
+    for (size_t y = 0; y < height; y++) {
+        pack_row(e, grey + y * width, 0, out + n);
+        n += e->bytes_per_line;
+    }
+    raster_encoder_free(e);
+    return n;
+}
+
+/* GS ( L pL pH m fn kc1 kc2 x y, m=48 fn=69, x y the width and height scale 1 or 2 */
+size_t raster_nv_print(uint8_t kc1, uint8_t kc2, uint8_t *out)
+{
+    const uint8_t command[RASTER_NV_PRINT_SIZE] = {29, 40, 76, 6, 0, 48, 69, kc1, kc2, 1, 1};
+    memcpy(out, command, sizeof(command));
+    return sizeof(command);
+}
+
+/* GS ( L pL pH m fn kc1 kc2, m=48 fn=66 */
+size_t raster_nv_delete(uint8_t kc1, uint8_t kc2, uint8_t *out)
+{
+    const uint8_t command[RASTER_NV_DELETE_SIZE] = {29, 40, 76, 4, 0, 48, 66, kc1, kc2};
+    memcpy(out, command, sizeof(command));
+    return sizeof(command);
+}
+
+/* GS ( L pL pH m fn d1 d2 d3, m=48 fn=65 d1 d2 d3 "CLR" */
+size_t raster_nv_delete_all(uint8_t *out)
+{
+    static const uint8_t command[RASTER_NV_DELETE_ALL_SIZE] = {29, 40, 76, 5, 0, 48, 65, 'C', 'L', 'R'};
+    memcpy(out, command, sizeof(command));
+    return sizeof(command);
+}
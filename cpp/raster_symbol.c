@@ -0,0 +1,87 @@
+//
+//  raster_symbol.c
+//  RNBluetoothEscposPrinter
+//
+//  QR code and PDF417 module matrices to GS v 0 rows, without an image in between.
+//
+
+#include <string.h>
+#include "raster.h"
+#include "bit_matrix.h"
+
+#define GS_V0_HEADER 8
+#define GS_V0_MAX_ROWS 0xffff
+
+typedef struct {
+    size_t scale;
+    size_t left;           /* dots in front of the symbol, centring included */
+    size_t top;            /* blank rows above the symbol */
+    size_t symbol_rows;
+    size_t rows;
+    size_t bytes_per_line;
+    size_t rows_per_command;
+} symbol_layout;
+
+static void layout_symbol(const raster_matrix *m, const raster_symbol_options *o, symbol_layout *l)
+{
+    size_t scale = o->scale ? o->scale : 1;
+    size_t width = m->width * scale;
+    size_t box_width = o->width > width ? o->width : width;
+    l->scale = scale;
+    l->symbol_rows = m->height * scale;
+    l->rows = o->height > l->symbol_rows ? o->height : l->symbol_rows;
+    l->left = o->left + (box_width - width) / 2;
+    l->top = (l->rows - l->symbol_rows) / 2;
+    l->bytes_per_line = (o->left + box_width + 7) / 8;
+    l->rows_per_command = (o->rows_per_command == 0 || o->rows_per_command > GS_V0_MAX_ROWS)
+                          ? GS_V0_MAX_ROWS : o->rows_per_command;
+}
+
+size_t raster_symbol_escpos_size(const raster_matrix *matrix, const raster_symbol_options *options)
+{
+    symbol_layout l;
+    layout_symbol(matrix, options, &l);
+    size_t commands = (l.rows + l.rows_per_command - 1) / l.rows_per_command;
+    return l.rows * l.bytes_per_line + commands * GS_V0_HEADER;
+}
+
+size_t raster_symbol_escpos_encode(const raster_matrix *matrix, const raster_symbol_options *options, uint8_t *out)
+{
+    symbol_layout l;
+    size_t written = 0, command_rows = 0;
+    const uint8_t *module_row = NULL; /* the packed row a scaled module row repeats */
+    bit_spread spread;
+    layout_symbol(matrix, options, &l);
+    bit_spread_init(&spread, l.scale, 1);
+    for (size_t y = 0; y < l.rows; y++) {
+        if (command_rows == 0) {
+            size_t rows = l.rows - y;
+            if (rows > l.rows_per_command) rows = l.rows_per_command;
+            command_rows = rows;
+            /* GS v 0 m xL xH yL yH d1....dk */
+            out[written] = 29;
+            out[written + 1] = 118;
+            out[written + 2] = 48;
+            out[written + 3] = options->escpos_mode;
+            out[written + 4] = (uint8_t) (l.bytes_per_line % 256);
+            out[written + 5] = (uint8_t) (l.bytes_per_line / 256);
+            out[written + 6] = (uint8_t) (rows % 256);
+            out[written + 7] = (uint8_t) (rows / 256);
+            written += GS_V0_HEADER;
+        }
+        uint8_t *row = out + written;
+        size_t sy = y - l.top;
+        if (y < l.top || sy >= l.symbol_rows) {
+            memset(row, 0, l.bytes_per_line);
+        } else if (sy % l.scale == 0) {
+            memset(row, 0, l.bytes_per_line);
+            bit_spread_row(&spread, matrix->bits + (sy / l.scale) * matrix->row_words, matrix->width, l.left, row);
+            module_row = row;
+        } else {
+            memcpy(row, module_row, l.bytes_per_line);
+        }
+        written += l.bytes_per_line;
+        command_rows--;
+    }
+    return written;
+}
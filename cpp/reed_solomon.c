@@ -0,0 +1,80 @@
+//
+//  reed_solomon.c
+//  RNBluetoothEscposPrinter
+//
+//  Table driven Reed-Solomon encoding, one LFSR step per data word.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "reed_solomon.h"
+
+reed_solomon_field *reed_solomon_field_create(int primitive, int size, int b)
+{
+    if (size < 2 || size > 32768 || (size & (size - 1))) return NULL;
+    /* the struct, then exp, then log */
+    reed_solomon_field *field = malloc(sizeof(*field) + 4 * (size_t) size * sizeof(uint16_t));
+    if (!field) return NULL;
+    uint16_t *exp = (uint16_t *) (field + 1);
+    uint16_t *log = exp + 3 * size;
+    field->size = size;
+    field->generator_base = b;
+    field->exp = exp;
+    field->log = log;
+
+    int x = 1;
+    for (int i = 0; i < size - 1; i++) {
+        exp[i] = (uint16_t) x;
+        exp[i + size - 1] = (uint16_t) x;
+        log[x] = (uint16_t) i;
+        x <<= 1;
+        if (x >= size) x = (x ^ primitive) & (size - 1);
+    }
+    memset(exp + 2 * (size - 1), 0, (size_t) (size + 2) * sizeof(uint16_t));
+    log[0] = REED_SOLOMON_ZERO_LOG(field);
+    return field;
+}
+
+void reed_solomon_field_free(reed_solomon_field *field)
+{
+    free(field);
+}
+
+void reed_solomon_generator(const reed_solomon_field *field, int degree, uint16_t *out)
+{
+    /* out[0..d) are the coefficients of the degree d product below its leading 1 */
+    for (int d = 0; d < degree; d++) {
+        int root = field->exp[(d + field->generator_base) % (field->size - 1)];
+        int root_log = field->log[root];
+        out[d] = 0;
+        for (int i = d; i > 0; i--) {
+            out[i] = (uint16_t) (out[i] ^ field->exp[field->log[out[i - 1]] + root_log]);
+        }
+        out[0] = (uint16_t) (out[0] ^ root);
+    }
+    for (int i = 0; i < degree; i++) {
+        out[i] = field->log[out[i]];
+    }
+}
+
+void reed_solomon_encode(const reed_solomon_field *field, const uint16_t *generator,
+                         int32_t *words, int data_words, int ec_words)
+{
+    const uint16_t *exp = field->exp;
+    const uint16_t *log = field->log;
+    int32_t *ec = words + data_words;
+    memset(ec, 0, (size_t) ec_words * sizeof(int32_t));
+    for (int i = 0; i < data_words; i++) {
+        int feedback = words[i] ^ ec[0];
+        if (!feedback) {
+            memmove(ec, ec + 1, (size_t) (ec_words - 1) * sizeof(int32_t));
+            ec[ec_words - 1] = 0;
+            continue;
+        }
+        int f = log[feedback];
+        for (int j = 0; j < ec_words - 1; j++) {
+            ec[j] = ec[j + 1] ^ exp[f + generator[j]];
+        }
+        ec[ec_words - 1] = exp[f + generator[ec_words - 1]];
+    }
+}
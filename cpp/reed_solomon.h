@@ -0,0 +1,52 @@
+//
+//  reed_solomon.h
+//  RNBluetoothEscposPrinter
+//
+//  Reed-Solomon error correction words for the GF(2^m) fields of QR, Data Matrix and Aztec.
+//
+#ifndef ESCPOS_REED_SOLOMON_H
+#define ESCPOS_REED_SOLOMON_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * GF(size) built from primitive, alpha = 2. exp covers 3 * size entries so a sum of two logs
+ * needs no modulo: exp[i] = alpha^(i mod (size - 1)) below 2 * (size - 1), 0 from there on.
+ * log[0] is REED_SOLOMON_ZERO_LOG(field), a log that multiplies to 0.
+ */
+typedef struct {
+    int size;
+    int generator_base;  /* b of g(x) = (x + a^b)(x + a^(b+1))..., 0 for QR, 1 for the others */
+    const uint16_t *exp;
+    const uint16_t *log;
+} reed_solomon_field;
+
+#define REED_SOLOMON_ZERO_LOG(field) ((uint16_t) (2 * ((field)->size - 1)))
+
+/* size is a power of two up to 32768. Returns NULL when out of memory. */
+reed_solomon_field *reed_solomon_field_create(int primitive, int size, int b);
+void reed_solomon_field_free(reed_solomon_field *field);
+
+/*
+ * The degree coefficients of the generator below x^degree, highest first, as logs.
+ * out holds degree entries.
+ */
+void reed_solomon_generator(const reed_solomon_field *field, int degree, uint16_t *out);
+
+/*
+ * Writes the ec_words remainder of words[0..data_words) * x^ec_words by the generator
+ * to words[data_words..data_words + ec_words), shifting it through the output as an LFSR.
+ */
+void reed_solomon_encode(const reed_solomon_field *field, const uint16_t *generator,
+                         int32_t *words, int data_words, int ec_words);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
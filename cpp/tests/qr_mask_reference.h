@@ -0,0 +1,121 @@
+//
+//  qr_mask_reference.h
+//  RNBluetoothEscposPrinter
+//
+//  ZXing's MaskUtil penalty rules 1-4 and dataMaskBit, ported line for line from
+//  VZZXQRCodeMaskUtil.m to a row-major grid of one byte a cell.
+//
+#ifndef ESCPOS_QR_MASK_REFERENCE_H
+#define ESCPOS_QR_MASK_REFERENCE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+static inline int reference_rule1_internal(const uint8_t *bytes, int size, int is_horizontal)
+{
+    int penalty = 0;
+    int line_step = is_horizontal ? size : 1;
+    int cell_step = is_horizontal ? 1 : size;
+    for (int i = 0; i < size; i++) {
+        const uint8_t *line = bytes + i * line_step;
+        int num_same_bit_cells = 0;
+        int prev_bit = -1;
+        for (int j = 0; j < size; j++) {
+            int bit = line[j * cell_step];
+            if (bit == prev_bit) {
+                num_same_bit_cells++;
+            } else {
+                if (num_same_bit_cells >= 5) penalty += 3 + (num_same_bit_cells - 5);
+                num_same_bit_cells = 1;
+                prev_bit = bit;
+            }
+        }
+        if (num_same_bit_cells >= 5) penalty += 3 + (num_same_bit_cells - 5);
+    }
+    return penalty;
+}
+
+static inline int reference_rule1(const uint8_t *bytes, int size)
+{
+    return reference_rule1_internal(bytes, size, 1) + reference_rule1_internal(bytes, size, 0);
+}
+
+static inline int reference_rule2(const uint8_t *bytes, int size)
+{
+    int penalty = 0;
+    for (int y = 0; y < size - 1; y++) {
+        const uint8_t *row = bytes + y * size;
+        const uint8_t *below = row + size;
+        for (int x = 0; x < size - 1; x++) {
+            int value = row[x];
+            if (value == row[x + 1] && value == below[x] && value == below[x + 1]) penalty++;
+        }
+    }
+    return 3 * penalty;
+}
+
+static inline int reference_is_white(const uint8_t *bytes, int step, int length, int from, int to)
+{
+    for (int i = from; i < to; i++) {
+        if (i >= 0 && i < length && bytes[i * step] == 1) return 0;
+    }
+    return 1;
+}
+
+static inline int reference_rule3(const uint8_t *bytes, int size)
+{
+    int num_penalties = 0;
+    for (int y = 0; y < size; y++) {
+        const uint8_t *row = bytes + y * size;
+        for (int x = 0; x < size; x++) {
+            if (x + 6 < size &&
+                row[x] == 1 && row[x + 1] == 0 && row[x + 2] == 1 && row[x + 3] == 1 &&
+                row[x + 4] == 1 && row[x + 5] == 0 && row[x + 6] == 1 &&
+                (reference_is_white(row, 1, size, x - 4, x) || reference_is_white(row, 1, size, x + 7, x + 11))) {
+                num_penalties++;
+            }
+            const uint8_t *column = row + x;
+            if (y + 6 < size &&
+                column[0] == 1 && column[size] == 0 && column[2 * size] == 1 && column[3 * size] == 1 &&
+                column[4 * size] == 1 && column[5 * size] == 0 && column[6 * size] == 1 &&
+                (reference_is_white(bytes + x, size, size, y - 4, y) ||
+                 reference_is_white(bytes + x, size, size, y + 7, y + 11))) {
+                num_penalties++;
+            }
+        }
+    }
+    return num_penalties * 40;
+}
+
+static inline int reference_rule4(const uint8_t *bytes, int size)
+{
+    int num_dark_cells = 0;
+    for (int i = 0; i < size * size; i++) num_dark_cells += bytes[i] == 1;
+    int num_total_cells = size * size;
+    int five_percent_variances = abs(num_dark_cells * 2 - num_total_cells) * 10 / num_total_cells;
+    return five_percent_variances * 10;
+}
+
+static inline int reference_penalty(const uint8_t *bytes, int size)
+{
+    return reference_rule1(bytes, size) + reference_rule2(bytes, size) +
+           reference_rule3(bytes, size) + reference_rule4(bytes, size);
+}
+
+static inline int reference_mask_bit(int mask_pattern, int x, int y)
+{
+    int intermediate, temp;
+    switch (mask_pattern) {
+        case 0: intermediate = (y + x) & 0x1; break;
+        case 1: intermediate = y & 0x1; break;
+        case 2: intermediate = x % 3; break;
+        case 3: intermediate = (y + x) % 3; break;
+        case 4: intermediate = ((y / 2) + (x / 3)) & 0x1; break;
+        case 5: temp = y * x; intermediate = (temp & 0x1) + (temp % 3); break;
+        case 6: temp = y * x; intermediate = ((temp & 0x1) + (temp % 3)) & 0x1; break;
+        default: temp = y * x; intermediate = ((temp % 3) + ((y + x) & 0x1)) & 0x1; break;
+    }
+    return intermediate == 0;
+}
+
+#endif
@@ -0,0 +1,65 @@
+//
+//  reed_solomon_reference.h
+//  RNBluetoothEscposPrinter
+//
+//  ZXing's polynomial Reed-Solomon encoder (GenericGF, GenericGFPoly, ReedSolomonEncoder)
+//  ported plainly: products by shift and reduce, the generator built as a product of
+//  (x - a^i) and the check words as the remainder of a long division. No tables are shared
+//  with reed_solomon.c.
+//
+#ifndef ESCPOS_REED_SOLOMON_REFERENCE_H
+#define ESCPOS_REED_SOLOMON_REFERENCE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define REFERENCE_MAX_DEGREE 1024
+
+static inline int reference_multiply(int a, int b, int primitive, int size)
+{
+    int product = 0;
+    while (b) {
+        if (b & 1) product ^= a;
+        b >>= 1;
+        a <<= 1;
+        if (a & size) a ^= primitive;
+    }
+    return product;
+}
+
+static inline int reference_power(int exponent, int primitive, int size)
+{
+    int x = 1;
+    for (int i = 0; i < exponent; i++) x = reference_multiply(x, 2, primitive, size);
+    return x;
+}
+
+/* g(x) = (x - a^b)(x - a^(b+1))...(x - a^(b+degree-1)), degree + 1 coefficients highest first */
+static inline void reference_generator(int primitive, int size, int b, int degree, int *g)
+{
+    g[0] = 1;
+    for (int d = 0; d < degree; d++) {
+        int root = reference_power(d + b, primitive, size);
+        g[d + 1] = 0;
+        for (int i = d + 1; i > 0; i--) g[i] ^= reference_multiply(g[i - 1], root, primitive, size);
+    }
+}
+
+/* ec = the remainder of data * x^ec_words divided by g, as ZXing's ReedSolomonEncoder.encode */
+static inline void reference_encode(int primitive, int size, int b,
+                                    const int32_t *data, int data_words, int ec_words, int32_t *ec)
+{
+    static int g[REFERENCE_MAX_DEGREE + 1];
+    static int r[4096 + REFERENCE_MAX_DEGREE];
+    reference_generator(primitive, size, b, ec_words, g);
+    for (int i = 0; i < data_words; i++) r[i] = data[i];
+    memset(r + data_words, 0, (size_t) ec_words * sizeof(int));
+    for (int i = 0; i < data_words; i++) {
+        int q = r[i];
+        if (!q) continue;
+        for (int j = 0; j <= ec_words; j++) r[i + j] ^= reference_multiply(g[j], q, primitive, size);
+    }
+    for (int j = 0; j < ec_words; j++) ec[j] = r[data_words + j];
+}
+
+#endif
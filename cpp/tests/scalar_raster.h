@@ -0,0 +1,18 @@
+//
+//  scalar_raster.h
+//  RNBluetoothEscposPrinter
+//
+//  raster.c built a second time with RASTER_NO_SIMD, its kernels renamed with a scalar_ prefix
+//  so a test or benchmark can run both paths in one program.
+//
+#ifndef ESCPOS_SCALAR_RASTER_H
+#define ESCPOS_SCALAR_RASTER_H
+
+#include "raster.h"
+
+void scalar_raster_luma(const uint8_t *pixels, size_t count, raster_pixel_order order, uint8_t *grey);
+void scalar_raster_threshold(const uint8_t *grey, size_t count, uint8_t threshold, uint8_t *bits);
+void scalar_raster_pack(const uint8_t *bits, size_t nbytes, int invert, uint8_t *out);
+uint64_t scalar_raster_sum(const uint8_t *grey, size_t count);
+
+#endif
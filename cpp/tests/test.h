@@ -0,0 +1,64 @@
+//
+//  test.h
+//  RNBluetoothEscposPrinter
+//
+//  The checks shared by the C core tests, each test is one executable run by CTest.
+//
+#ifndef ESCPOS_TEST_H
+#define ESCPOS_TEST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static int test_failures;
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+/* compares n bytes, prints the first difference */
+#define CHECK_BYTES(got, want, n) check_bytes((got), (want), (n), __FILE__, __LINE__, #got)
+
+static inline void check_bytes(const uint8_t *got, const uint8_t *want, size_t n,
+                        const char *file, int line, const char *what)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (got[i] == want[i]) continue;
+        fprintf(stderr, "%s:%d: %s differs at byte %zu of %zu: 0x%02x, expected 0x%02x\n",
+                file, line, what, i, n, got[i], want[i]);
+        test_failures++;
+        return;
+    }
+}
+
+/* xorshift32, the tests are repeatable without the C library rand */
+static uint32_t test_seed = 2463534242u;
+
+static inline uint32_t test_rand(void)
+{
+    test_seed ^= test_seed << 13;
+    test_seed ^= test_seed >> 17;
+    test_seed ^= test_seed << 5;
+    return test_seed;
+}
+
+static inline void test_fill(uint8_t *bytes, size_t n)
+{
+    for (size_t i = 0; i < n; i++) bytes[i] = (uint8_t) test_rand();
+}
+
+static inline int test_result(const char *name)
+{
+    if (test_failures) {
+        fprintf(stderr, "%s: %d failed\n", name, test_failures);
+        return 1;
+    }
+    printf("%s: ok\n", name);
+    return 0;
+}
+
+#endif
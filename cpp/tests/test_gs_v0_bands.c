@@ -0,0 +1,150 @@
+//
+//  test_gs_v0_bands.c
+//  RNBluetoothEscposPrinter
+//
+//  Multi-row GS v 0 commands carry the same rows as the old one command a row output
+//  (rows_per_command 1), only the headers differ.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+#include "test.h"
+
+/* 10x3, 2 blank dots in front, one GS v 0 a row as before profiles had rasterRows */
+static const uint8_t PER_ROW[] = {
+    0x1d, 0x76, 0x30, 0x00, 0x02, 0x00, 0x01, 0x00, 0x05, 0x80,
+    0x1d, 0x76, 0x30, 0x00, 0x02, 0x00, 0x01, 0x00, 0x2a, 0x00,
+    0x1d, 0x76, 0x30, 0x00, 0x02, 0x00, 0x01, 0x00, 0x3f, 0xc0,
+};
+
+static const uint8_t BANDED[] = {
+    0x1d, 0x76, 0x30, 0x00, 0x02, 0x00, 0x03, 0x00, 0x05, 0x80, 0x2a, 0x00, 0x3f, 0xc0,
+};
+
+static void test_golden(void)
+{
+    /* row 0 ...X.XX... row 1 X.X.X..... row 2 XXXXXXXX.. where X is grey 0 */
+    static const char *ROWS[3] = {"...X.XX...", "X.X.X.....", "XXXXXXXX.."};
+    uint8_t grey[30];
+    for (size_t i = 0; i < 30; i++) grey[i] = ROWS[i / 10][i % 10] == 'X' ? 0 : 255;
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = 10;
+    o.left = 2;
+    o.dither = RASTER_DITHER_BAYER4;
+    o.rows_per_command = 1;
+    uint8_t out[sizeof(PER_ROW)];
+    CHECK(raster_escpos_size(&o, 3) == sizeof(PER_ROW));
+    CHECK(raster_escpos_encode(grey, 3, &o, out) == sizeof(PER_ROW));
+    CHECK_BYTES(out, PER_ROW, sizeof(PER_ROW));
+
+    o.rows_per_command = 24;
+    CHECK(raster_escpos_size(&o, 3) == sizeof(BANDED));
+    CHECK(raster_escpos_encode(grey, 3, &o, out) == sizeof(BANDED));
+    CHECK_BYTES(out, BANDED, sizeof(BANDED));
+}
+
+/*
+ * Checks every header of banded, then compares its rows with the rows of per_row, which has a
+ * header in front of every row. Returns the commands seen.
+ */
+static size_t check_bands(const uint8_t *banded, size_t banded_size, const uint8_t *per_row,
+                          size_t bytes_per_line, size_t height, size_t rows_per_command, uint8_t mode)
+{
+    size_t at = 0, commands = 0;
+    for (size_t y = 0; y < height; commands++) {
+        size_t rows = height - y < rows_per_command ? height - y : rows_per_command;
+        const uint8_t header[8] = {29, 118, 48, mode, (uint8_t) (bytes_per_line & 0xff), (uint8_t) (bytes_per_line >> 8),
+                                   (uint8_t) (rows & 0xff), (uint8_t) (rows >> 8)};
+        CHECK(at + 8 <= banded_size);
+        if (at + 8 > banded_size) return commands;
+        CHECK_BYTES(banded + at, header, 8);
+        at += 8;
+        for (size_t r = 0; r < rows; r++, y++) {
+            CHECK_BYTES(banded + at, per_row + y * (8 + bytes_per_line) + 8, bytes_per_line);
+            at += bytes_per_line;
+        }
+    }
+    CHECK(at == banded_size);
+    return commands;
+}
+
+static void test_random_images(void)
+{
+    static const size_t ROWS[] = {0, 2, 3, 24, 255, 256, 70000};
+    for (int round = 0; round < 60; round++) {
+        size_t width = 1 + test_rand() % 200, height = 1 + test_rand() % 300;
+        raster_options o;
+        memset(&o, 0, sizeof(o));
+        o.width = width;
+        o.left = test_rand() % 20;
+        o.dither = (raster_dither_mode) (test_rand() % 6);
+        o.escpos_mode = (uint8_t) (test_rand() % 4);
+        uint8_t *grey = malloc(width * height);
+        if (!grey) return;
+        test_fill(grey, width * height);
+
+        o.rows_per_command = 1;
+        size_t bytes_per_line = (o.left + width + 7) / 8;
+        size_t per_row_size = raster_escpos_size(&o, height);
+        CHECK(per_row_size == height * (8 + bytes_per_line));
+        uint8_t *per_row = malloc(per_row_size);
+        if (!per_row) return;
+        CHECK(raster_escpos_encode(grey, height, &o, per_row) == per_row_size);
+
+        for (size_t i = 0; i < sizeof(ROWS) / sizeof(ROWS[0]); i++) {
+            o.rows_per_command = ROWS[i];
+            size_t rows = ROWS[i] == 0 || ROWS[i] > 0xffff ? 0xffff : ROWS[i];
+            size_t size = raster_escpos_size(&o, height);
+            uint8_t *banded = malloc(size);
+            if (!banded) return;
+            CHECK(raster_escpos_encode(grey, height, &o, banded) == size);
+            CHECK(check_bands(banded, size, per_row, bytes_per_line, height, rows, o.escpos_mode)
+                  == (height + rows - 1) / rows);
+            free(banded);
+        }
+        free(per_row);
+        free(grey);
+    }
+}
+
+/* QR and barcode symbols go through raster_symbol.c, banded the same way */
+static void test_random_symbols(void)
+{
+    uint32_t bits[40 * 2];
+    for (int round = 0; round < 60; round++) {
+        raster_matrix m = {bits, 2, 1 + test_rand() % 64, 1 + test_rand() % 40};
+        for (size_t i = 0; i < sizeof(bits) / sizeof(bits[0]); i++) bits[i] = test_rand();
+        raster_symbol_options o;
+        memset(&o, 0, sizeof(o));
+        o.scale = 1 + test_rand() % 6;
+        o.left = test_rand() % 20;
+        o.escpos_mode = (uint8_t) (test_rand() % 4);
+
+        o.rows_per_command = 1;
+        size_t per_row_size = raster_symbol_escpos_size(&m, &o);
+        size_t height = m.height * o.scale;
+        size_t bytes_per_line = per_row_size / height - 8;
+        uint8_t *per_row = malloc(per_row_size);
+        if (!per_row) return;
+        CHECK(raster_symbol_escpos_encode(&m, &o, per_row) == per_row_size);
+
+        o.rows_per_command = 24;
+        size_t size = raster_symbol_escpos_size(&m, &o);
+        uint8_t *banded = malloc(size);
+        if (!banded) return;
+        CHECK(raster_symbol_escpos_encode(&m, &o, banded) == size);
+        CHECK(check_bands(banded, size, per_row, bytes_per_line, height, 24, o.escpos_mode) == (height + 23) / 24);
+        free(banded);
+        free(per_row);
+    }
+}
+
+int main(void)
+{
+    test_golden();
+    test_random_images();
+    test_random_symbols();
+    return test_result("test_gs_v0_bands");
+}
@@ -0,0 +1,260 @@
+//
+//  test_nv_image.c
+//  RNBluetoothEscposPrinter
+//
+//  Defines, prints and deletes NV graphics on a fake printer that parses GS ( L and GS 8 L
+//  the way the ESC/POS manual describes them and keeps the images by key.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+#include "test.h"
+
+#define KEYS 4
+
+typedef struct {
+    uint8_t kc1, kc2;
+    size_t width, height;
+    uint8_t *rows;
+} nv_image;
+
+typedef struct {
+    nv_image images[KEYS];
+    uint8_t *paper;        /* the printed rows one after another */
+    size_t paper_size;
+    int errors;            /* commands the printer would ignore */
+} fake_printer;
+
+static nv_image *find(fake_printer *p, uint8_t kc1, uint8_t kc2)
+{
+    for (int i = 0; i < KEYS; i++) {
+        if (p->images[i].rows && p->images[i].kc1 == kc1 && p->images[i].kc2 == kc2) return &p->images[i];
+    }
+    return NULL;
+}
+
+static void forget(nv_image *image)
+{
+    free(image->rows);
+    memset(image, 0, sizeof(*image));
+}
+
+/* m fn ... of one GS ( L / GS 8 L command, count bytes */
+static void run(fake_printer *p, const uint8_t *c, size_t count)
+{
+    if (count < 2 || c[0] != 48) {
+        p->errors++;
+        return;
+    }
+    switch (c[1]) {
+        case 67: { /* define: a kc1 kc2 b xL xH yL yH c d1...dk */
+            if (count < 11 || c[2] != 48 || c[5] != 1 || c[10] != 49) break;
+            size_t width = c[6] | c[7] << 8, height = c[8] | c[9] << 8;
+            size_t size = (width + 7) / 8 * height;
+            if (count != 11 + size) break;
+            nv_image *image = find(p, c[3], c[4]);
+            if (image) forget(image);
+            for (int i = 0; i < KEYS && !image; i++) {
+                if (!p->images[i].rows) image = &p->images[i];
+            }
+            if (!image) break;
+            image->kc1 = c[3];
+            image->kc2 = c[4];
+            image->width = width;
+            image->height = height;
+            image->rows = malloc(size);
+            if (image->rows) memcpy(image->rows, c + 11, size);
+            return;
+        }
+        case 69: { /* print: kc1 kc2 x y */
+            if (count != 6 || c[4] != 1 || c[5] != 1) break;
+            nv_image *image = find(p, c[2], c[3]);
+            if (!image) break;
+            size_t size = (image->width + 7) / 8 * image->height;
+            p->paper = realloc(p->paper, p->paper_size + size);
+            memcpy(p->paper + p->paper_size, image->rows, size);
+            p->paper_size += size;
+            return;
+        }
+        case 66: { /* delete: kc1 kc2 */
+            if (count != 4) break;
+            nv_image *image = find(p, c[2], c[3]);
+            if (!image) break;
+            forget(image);
+            return;
+        }
+        case 65: { /* delete all: "CLR" */
+            if (count != 5 || memcmp(c + 2, "CLR", 3) != 0) break;
+            for (int i = 0; i < KEYS; i++) forget(&p->images[i]);
+            return;
+        }
+    }
+    p->errors++;
+}
+
+static void receive(fake_printer *p, const uint8_t *data, size_t size)
+{
+    size_t at = 0;
+    while (at < size) {
+        size_t count;
+        if (size - at >= 5 && data[at] == 29 && data[at + 1] == 40 && data[at + 2] == 76) {
+            count = data[at + 3] | data[at + 4] << 8;
+            at += 5;
+        } else if (size - at >= 7 && data[at] == 29 && data[at + 1] == 56 && data[at + 2] == 76) {
+            count = data[at + 3] | data[at + 4] << 8 | (size_t) data[at + 5] << 16 | (size_t) data[at + 6] << 24;
+            at += 7;
+        } else {
+            p->errors++;
+            return;
+        }
+        if (count > size - at) {
+            p->errors++;
+            return;
+        }
+        run(p, data + at, count);
+        at += count;
+    }
+}
+
+static void printer_free(fake_printer *p)
+{
+    for (int i = 0; i < KEYS; i++) forget(&p->images[i]);
+    free(p->paper);
+}
+
+/* the rows GS v 0 would print for the same image, one command and no left margin */
+static uint8_t *escpos_rows(const uint8_t *grey, size_t width, size_t height, raster_dither_mode dither)
+{
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = width;
+    o.dither = dither;
+    size_t size = raster_escpos_size(&o, height);
+    uint8_t *out = malloc(size);
+    if (!out) return NULL;
+    CHECK(raster_escpos_encode(grey, height, &o, out) == size);
+    memmove(out, out + 8, size - 8);
+    return out;
+}
+
+static void define(fake_printer *p, const uint8_t *grey, size_t width, size_t height,
+                   raster_dither_mode dither, uint8_t kc1, uint8_t kc2)
+{
+    size_t size = raster_nv_define_size(width, height);
+    uint8_t *out = malloc(size);
+    if (!out) return;
+    CHECK(raster_nv_define(grey, width, height, dither, kc1, kc2, out) == size);
+    receive(p, out, size);
+    free(out);
+}
+
+static void print(fake_printer *p, uint8_t kc1, uint8_t kc2)
+{
+    uint8_t out[RASTER_NV_PRINT_SIZE];
+    CHECK(raster_nv_print(kc1, kc2, out) == RASTER_NV_PRINT_SIZE);
+    receive(p, out, sizeof(out));
+}
+
+static void delete(fake_printer *p, uint8_t kc1, uint8_t kc2)
+{
+    uint8_t out[RASTER_NV_DELETE_SIZE];
+    CHECK(raster_nv_delete(kc1, kc2, out) == RASTER_NV_DELETE_SIZE);
+    receive(p, out, sizeof(out));
+}
+
+static void test_define_print_delete(void)
+{
+    fake_printer p;
+    memset(&p, 0, sizeof(p));
+
+    /* L1 fits GS ( L, L2 needs more than 65535 parameter bytes and goes as GS 8 L */
+    size_t w1 = 37, h1 = 50, w2 = 576, h2 = 1000;
+    uint8_t *grey1 = malloc(w1 * h1), *grey2 = malloc(w2 * h2);
+    if (!grey1 || !grey2) return;
+    test_fill(grey1, w1 * h1);
+    test_fill(grey2, w2 * h2);
+    CHECK(raster_nv_define_size(w1, h1) == 5 + 11 + 5 * h1);
+    CHECK(raster_nv_define_size(w2, h2) == 7 + 11 + 72 * h2);
+    uint8_t *rows1 = escpos_rows(grey1, w1, h1, RASTER_DITHER_ATKINSON);
+    uint8_t *rows2 = escpos_rows(grey2, w2, h2, RASTER_DITHER_BAYER8);
+    if (!rows1 || !rows2) return;
+
+    define(&p, grey1, w1, h1, RASTER_DITHER_ATKINSON, 'L', '1');
+    define(&p, grey2, w2, h2, RASTER_DITHER_BAYER8, 'L', '2');
+    CHECK(p.errors == 0);
+    CHECK(find(&p, 'L', '1') && find(&p, 'L', '2'));
+
+    print(&p, 'L', '2');
+    print(&p, 'L', '1');
+    print(&p, 'L', '1');
+    CHECK(p.errors == 0);
+    CHECK(p.paper_size == 72 * h2 + 2 * 5 * h1);
+    if (p.paper_size == 72 * h2 + 2 * 5 * h1) {
+        CHECK_BYTES(p.paper, rows2, 72 * h2);
+        CHECK_BYTES(p.paper + 72 * h2, rows1, 5 * h1);
+        CHECK_BYTES(p.paper + 72 * h2 + 5 * h1, rows1, 5 * h1);
+    }
+
+    /* a deleted key prints nothing, the other key is kept */
+    delete(&p, 'L', '1');
+    CHECK(p.errors == 0);
+    CHECK(find(&p, 'L', '1') == NULL);
+    size_t printed = p.paper_size;
+    print(&p, 'L', '1');
+    CHECK(p.errors == 1);
+    CHECK(p.paper_size == printed);
+    print(&p, 'L', '2');
+    CHECK(p.paper_size == printed + 72 * h2);
+
+    /* defining a key again replaces the image */
+    define(&p, grey1, w1, h1, RASTER_DITHER_ATKINSON, 'L', '2');
+    nv_image *image = find(&p, 'L', '2');
+    CHECK(image && image->width == w1 && image->height == h1);
+
+    /* deleting all of them leaves nothing to print */
+    define(&p, grey1, w1, h1, RASTER_DITHER_ATKINSON, 'L', '3');
+    uint8_t clear[RASTER_NV_DELETE_ALL_SIZE];
+    CHECK(raster_nv_delete_all(clear) == RASTER_NV_DELETE_ALL_SIZE);
+    receive(&p, clear, sizeof(clear));
+    CHECK(p.errors == 1);
+    CHECK(find(&p, 'L', '2') == NULL && find(&p, 'L', '3') == NULL);
+
+    free(rows2);
+    free(rows1);
+    free(grey2);
+    free(grey1);
+    printer_free(&p);
+}
+
+static void test_limits(void)
+{
+    CHECK(raster_nv_define_size(0, 1) == 0);
+    CHECK(raster_nv_define_size(1, 0) == 0);
+    CHECK(raster_nv_define_size(8193, 1) == 0);
+    CHECK(raster_nv_define_size(1, 2305) == 0);
+    CHECK(raster_nv_define_size(8192, 2304) == 7 + 11 + 1024 * 2304);
+    uint8_t grey = 0, out[32];
+    CHECK(raster_nv_define(&grey, 0, 1, RASTER_DITHER_THRESHOLD, 'A', 'B', out) == 0);
+
+    /* the smallest image, byte for byte */
+    static const uint8_t ONE_DOT[] = {29, 40, 76, 12, 0, 48, 67, 48, 'A', 'B', 1, 1, 0, 1, 0, 49, 0x80};
+    CHECK(raster_nv_define(&grey, 1, 1, RASTER_DITHER_THRESHOLD, 'A', 'B', out) == sizeof(ONE_DOT));
+    CHECK_BYTES(out, ONE_DOT, sizeof(ONE_DOT));
+    static const uint8_t PRINT[] = {29, 40, 76, 6, 0, 48, 69, 'A', 'B', 1, 1};
+    CHECK(raster_nv_print('A', 'B', out) == sizeof(PRINT));
+    CHECK_BYTES(out, PRINT, sizeof(PRINT));
+    static const uint8_t DELETE[] = {29, 40, 76, 4, 0, 48, 66, 'A', 'B'};
+    CHECK(raster_nv_delete('A', 'B', out) == sizeof(DELETE));
+    CHECK_BYTES(out, DELETE, sizeof(DELETE));
+    static const uint8_t DELETE_ALL[] = {29, 40, 76, 5, 0, 48, 65, 'C', 'L', 'R'};
+    CHECK(raster_nv_delete_all(out) == sizeof(DELETE_ALL));
+    CHECK_BYTES(out, DELETE_ALL, sizeof(DELETE_ALL));
+}
+
+int main(void)
+{
+    test_define_print_delete();
+    test_limits();
+    return test_result("test_nv_image");
+}
@@ -0,0 +1,102 @@
+//
+//  test_qr_mask.c
+//  RNBluetoothEscposPrinter
+//
+//  qr_mask_apply and qr_mask_penalty against the ZXing rules in qr_mask_reference.h,
+//  on random grids of every version size with finder patterns and long runs planted.
+//
+
+#include <string.h>
+#include "qr_mask.h"
+#include "qr_mask_reference.h"
+#include "test.h"
+
+static uint8_t modules[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+static uint8_t data[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+static uint8_t masked[QR_MASK_MAX_SIZE * QR_MASK_MAX_SIZE];
+
+/* 1011101 across or down at x y, with light cells around it when they fit */
+static void plant_finder(uint8_t *grid, int size, int x, int y, int down)
+{
+    static const uint8_t RUN[] = {0, 0, 0, 0, 1, 0, 1, 1, 1, 0, 1, 0, 0, 0, 0};
+    for (int i = 0; i < 15; i++) {
+        int at = (down ? y : x) + i - 4;
+        if (at < 0 || at >= size) continue;
+        grid[down ? at * size + x : y * size + at] = RUN[i];
+    }
+}
+
+static void random_grid(int size, int round)
+{
+    int n = size * size;
+    /* dense, sparse and balanced grids move rule 4 */
+    uint32_t dark = round % 3 == 0 ? 16 : round % 3 == 1 ? 4 : 28;
+    for (int i = 0; i < n; i++) modules[i] = (test_rand() & 31) < dark;
+    for (int k = (int) (test_rand() % 12); k > 0; k--) {
+        plant_finder(modules, size, (int) (test_rand() % (uint32_t) size), (int) (test_rand() % (uint32_t) size),
+                     (int) (test_rand() & 1));
+    }
+    /* runs long enough for rule 1, to the edges at times */
+    for (int k = (int) (test_rand() % 6); k > 0; k--) {
+        int x = (int) (test_rand() % (uint32_t) size), y = (int) (test_rand() % (uint32_t) size);
+        int length = 5 + (int) (test_rand() % 20);
+        uint8_t bit = (uint8_t) (test_rand() & 1);
+        for (int i = 0; i < length && x + i < size; i++) modules[y * size + x + i] = bit;
+    }
+    for (int i = 0; i < n; i++) data[i] = (test_rand() & 3) != 0;
+}
+
+static void test_penalty(void)
+{
+    for (int version = 1; version <= 40; version++) {
+        int size = 17 + 4 * version;
+        for (int round = 0; round < 12; round++) {
+            random_grid(size, round);
+            int got = qr_mask_penalty(modules, (size_t) size);
+            int want = reference_penalty(modules, size);
+            if (got != want) {
+                fprintf(stderr, "version %d: penalty %d, rules %d %d %d %d\n", version, got,
+                        reference_rule1(modules, size), reference_rule2(modules, size),
+                        reference_rule3(modules, size), reference_rule4(modules, size));
+            }
+            CHECK(got == want);
+        }
+    }
+    /* the small grids the window logic treats apart, below one 15 cell window */
+    for (int size = 1; size <= 20; size++) {
+        for (int round = 0; round < 20; round++) {
+            random_grid(size, round);
+            CHECK(qr_mask_penalty(modules, (size_t) size) == reference_penalty(modules, size));
+        }
+    }
+    /* all light: every row and column one run, every 2x2 block, all light cells */
+    memset(modules, 0, 21 * 21);
+    CHECK(qr_mask_penalty(modules, 21) == reference_penalty(modules, 21));
+    CHECK(qr_mask_penalty(modules, 21) == 42 * 19 + 3 * 400 + 100);
+}
+
+static void test_apply(void)
+{
+    for (int version = 1; version <= 40; version += 3) {
+        int size = 17 + 4 * version;
+        random_grid(size, version);
+        for (int pattern = 0; pattern < QR_MASK_PATTERNS; pattern++) {
+            qr_mask_apply(modules, data, (size_t) size, pattern, masked);
+            int same = 1;
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    int i = y * size + x;
+                    same &= masked[i] == (modules[i] ^ (data[i] && reference_mask_bit(pattern, x, y)));
+                }
+            }
+            CHECK(same);
+        }
+    }
+}
+
+int main(void)
+{
+    test_penalty();
+    test_apply();
+    return test_result("test_qr_mask");
+}
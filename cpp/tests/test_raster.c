@@ -0,0 +1,124 @@
+//
+//  test_raster.c
+//  RNBluetoothEscposPrinter
+//
+//  Every dither mode, GS v 0 and TSC BITMAP output against bytes worked out by hand
+//  from the original Java pipeline on a 20x6 grey ramp.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "raster.h"
+#include "test.h"
+
+#define W 20
+#define H 6
+
+static uint8_t grey[W * H];
+
+static void make_grey(void)
+{
+    for (size_t y = 0; y < H; y++) {
+        for (size_t x = 0; x < W; x++) grey[y * W + x] = (uint8_t) ((x * 13 + y * 41 + x * y * 7) % 256);
+    }
+}
+
+/* the packed rows of each mode, 3 bytes a row, the threshold is the mean grey 125 */
+static const uint8_t DITHERED[6][H * 3] = {
+    /* THRESHOLD */
+    {0xff, 0xc0, 0x00, 0xf8, 0x1f, 0xc0, 0xc1, 0xf0, 0xf0, 0x8f, 0x0f, 0x10,
+     0x1c, 0x71, 0xc0, 0x31, 0xce, 0x30},
+    /* FLOYD_STEINBERG */
+    {0xfe, 0xa8, 0x00, 0xd1, 0x1f, 0xd0, 0xa5, 0xe0, 0xe0, 0x4e, 0x0f, 0x10,
+     0x19, 0x79, 0xd0, 0x35, 0xac, 0x20},
+    /* ATKINSON */
+    {0xff, 0x48, 0x00, 0xe0, 0x1f, 0xc0, 0x91, 0xf0, 0xf0, 0x8f, 0x0e, 0x10,
+     0x1c, 0x71, 0xc0, 0x31, 0xce, 0x30},
+    /* BAYER4 */
+    {0xf5, 0x55, 0x10, 0xfa, 0x1f, 0xa0, 0x55, 0x54, 0xd0, 0x8e, 0x8e, 0x90,
+     0x15, 0x55, 0x50, 0x31, 0xae, 0x30},
+    /* BAYER8 */
+    {0xf5, 0x55, 0x00, 0xfa, 0x1f, 0xa0, 0x55, 0x54, 0xd0, 0x8e, 0x8e, 0x90,
+     0x15, 0x55, 0x50, 0x31, 0xae, 0x30},
+    /* BAYER16 */
+    {0xf5, 0x55, 0x00, 0xfa, 0x1f, 0xa0, 0x55, 0x54, 0xd0, 0x8e, 0x8e, 0x90,
+     0x15, 0x55, 0x50, 0x31, 0xae, 0x30},
+};
+
+/* THRESHOLD, 4 blank dots in front, 4 rows a command */
+static const uint8_t ESCPOS[] = {
+    0x1d, 0x76, 0x30, 0x00, 0x03, 0x00, 0x04, 0x00, 0x0f, 0xfc, 0x00, 0x0f,
+    0x81, 0xfc, 0x0c, 0x1f, 0x0f, 0x08, 0xf0, 0xf1, 0x1d, 0x76, 0x30, 0x00,
+    0x03, 0x00, 0x02, 0x00, 0x01, 0xc7, 0x1c, 0x03, 0x1c, 0xe3,
+};
+
+/* BAYER4, a 0 bit prints */
+static const uint8_t TSC[] = {
+    0x0a, 0xaa, 0xef, 0x05, 0xe0, 0x5f, 0xaa, 0xab, 0x2f, 0x71, 0x71, 0x6f,
+    0xea, 0xaa, 0xaf, 0xce, 0x51, 0xcf,
+};
+
+static void test_dither_modes(void)
+{
+    uint8_t bits[24], packed[H * 3];
+    for (int mode = RASTER_DITHER_THRESHOLD; mode <= RASTER_DITHER_BAYER16; mode++) {
+        raster_dither *d = raster_dither_create((raster_dither_mode) mode, W, 125);
+        CHECK(d != NULL);
+        if (!d) continue;
+        memset(bits, 0, sizeof(bits));
+        for (size_t y = 0; y < H; y++) {
+            raster_dither_row(d, grey + y * W, bits);
+            raster_pack(bits, 3, 0, packed + y * 3);
+        }
+        raster_dither_free(d);
+        CHECK_BYTES(packed, DITHERED[mode], sizeof(packed));
+    }
+}
+
+static void test_escpos(void)
+{
+    raster_options o;
+    memset(&o, 0, sizeof(o));
+    o.width = W;
+    o.left = 4;
+    o.dither = RASTER_DITHER_THRESHOLD;
+    o.rows_per_command = 4;
+    uint8_t out[sizeof(ESCPOS)];
+    CHECK(raster_escpos_size(&o, H) == sizeof(ESCPOS));
+    CHECK(raster_escpos_encode(grey, H, &o, out) == sizeof(ESCPOS));
+    CHECK_BYTES(out, ESCPOS, sizeof(ESCPOS));
+
+    /* the row encoder writes the same bytes, the header in front of rows 0 and 4 */
+    o.threshold = 125;
+    raster_encoder *e = raster_encoder_create(&o, H);
+    CHECK(e != NULL);
+    if (!e) return;
+    CHECK(raster_encoder_bytes_per_line(e) == 3);
+    size_t n = 0;
+    for (size_t y = 0; y < H; y++) {
+        size_t row = raster_encoder_escpos_row(e, grey + y * W, out + n);
+        CHECK(row == (y % 4 == 0 ? 11u : 3u));
+        n += row;
+    }
+    CHECK(raster_encoder_escpos_row(e, grey, out) == 0);
+    raster_encoder_free(e);
+    CHECK(n == sizeof(ESCPOS));
+    CHECK_BYTES(out, ESCPOS, sizeof(ESCPOS));
+}
+
+static void test_tsc(void)
+{
+    uint8_t out[sizeof(TSC)];
+    CHECK(raster_tsc_size(W, H) == sizeof(TSC));
+    CHECK(raster_tsc_encode(grey, W, H, RASTER_DITHER_BAYER4, out) == sizeof(TSC));
+    CHECK_BYTES(out, TSC, sizeof(TSC));
+}
+
+int main(void)
+{
+    make_grey();
+    test_dither_modes();
+    test_escpos();
+    test_tsc();
+    return test_result("test_raster");
+}
@@ -0,0 +1,98 @@
+//
+//  test_raster_simd.c
+//  RNBluetoothEscposPrinter
+//
+//  The NEON / SSE2 kernels against the scalar build of raster.c on random rows. Widths run
+//  past several vector lengths so every tail length is hit, and the buffers start at odd
+//  offsets so the unaligned loads are too.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "scalar_raster.h"
+#include "test.h"
+
+#define MAX 200
+#define OFFSET 3
+
+static void test_luma(void)
+{
+    uint8_t pixels[MAX * 4 + OFFSET], want[MAX + OFFSET], got[MAX + OFFSET];
+    for (size_t count = 0; count <= MAX; count++) {
+        for (int order = RASTER_RGBX; order <= RASTER_BGRX; order++) {
+            size_t at = count % OFFSET;
+            test_fill(pixels, sizeof(pixels));
+            memset(want, 0xAA, sizeof(want));
+            memset(got, 0xAA, sizeof(got));
+            scalar_raster_luma(pixels + at, count, (raster_pixel_order) order, want + at);
+            raster_luma(pixels + at, count, (raster_pixel_order) order, got + at);
+            CHECK_BYTES(got, want, sizeof(got));
+        }
+    }
+    /* the extremes, where a lane could overflow */
+    memset(pixels, 0xFF, sizeof(pixels));
+    raster_luma(pixels, MAX, RASTER_RGBX, got);
+    scalar_raster_luma(pixels, MAX, RASTER_RGBX, want);
+    CHECK_BYTES(got, want, MAX);
+    CHECK(got[0] == 255);
+}
+
+static void test_threshold(void)
+{
+    static const uint8_t THRESHOLDS[] = {0, 1, 127, 128, 200, 254, 255};
+    uint8_t grey[MAX + OFFSET], want[MAX + OFFSET], got[MAX + OFFSET];
+    for (size_t count = 0; count <= MAX; count++) {
+        size_t at = count % OFFSET;
+        test_fill(grey, sizeof(grey));
+        for (size_t i = 0; i < sizeof(THRESHOLDS); i++) {
+            memset(want, 0xAA, sizeof(want));
+            memset(got, 0xAA, sizeof(got));
+            scalar_raster_threshold(grey + at, count, THRESHOLDS[i], want + at);
+            raster_threshold(grey + at, count, THRESHOLDS[i], got + at);
+            CHECK_BYTES(got, want, sizeof(got));
+        }
+    }
+}
+
+static void test_pack(void)
+{
+    uint8_t bits[MAX * 8 + OFFSET], want[MAX + OFFSET], got[MAX + OFFSET];
+    for (size_t nbytes = 0; nbytes <= MAX; nbytes++) {
+        size_t at = nbytes % OFFSET;
+        for (size_t i = 0; i < sizeof(bits); i++) bits[i] = test_rand() & 1;
+        for (int invert = 0; invert <= 1; invert++) {
+            memset(want, 0xAA, sizeof(want));
+            memset(got, 0xAA, sizeof(got));
+            scalar_raster_pack(bits + at, nbytes, invert, want + at);
+            raster_pack(bits + at, nbytes, invert, got + at);
+            CHECK_BYTES(got, want, sizeof(got));
+        }
+    }
+}
+
+static void test_sum(void)
+{
+    uint8_t grey[MAX + OFFSET];
+    for (size_t count = 0; count <= MAX; count++) {
+        size_t at = count % OFFSET;
+        test_fill(grey, sizeof(grey));
+        CHECK(raster_sum(grey + at, count) == scalar_raster_sum(grey + at, count));
+    }
+    /* more than 2^16 bytes of 255, past any 16 bit accumulator */
+    size_t big = 70001;
+    uint8_t *white = malloc(big);
+    if (!white) return;
+    memset(white, 0xFF, big);
+    CHECK(raster_sum(white, big) == 255u * big);
+    CHECK(scalar_raster_sum(white, big) == 255u * big);
+    free(white);
+}
+
+int main(void)
+{
+    test_luma();
+    test_threshold();
+    test_pack();
+    test_sum();
+    return test_result("test_raster_simd");
+}
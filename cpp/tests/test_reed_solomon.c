@@ -0,0 +1,95 @@
+//
+//  test_reed_solomon.c
+//  RNBluetoothEscposPrinter
+//
+//  The LFSR encoder against the polynomial reference in every field ZXing encodes with.
+//
+
+#include <stdlib.h>
+#include "reed_solomon.h"
+#include "reed_solomon_reference.h"
+#include "test.h"
+
+typedef struct {
+    const char *name;
+    int primitive, size, b;
+} field_spec;
+
+static const field_spec FIELDS[] = {
+    {"QR", 0x011D, 256, 0},
+    {"Data Matrix / Aztec 8", 0x012D, 256, 1},
+    {"Aztec 12", 0x1069, 4096, 1},
+    {"Aztec 10", 0x409, 1024, 1},
+    {"Aztec 6 / MaxiCode", 0x43, 64, 1},
+    {"Aztec parameters", 0x13, 16, 1},
+};
+
+static void check_field(const field_spec *spec)
+{
+    reed_solomon_field *field = reed_solomon_field_create(spec->primitive, spec->size, spec->b);
+    CHECK(field != NULL);
+    if (!field) return;
+    int max = spec->size - 1; /* data and check words of one block */
+    int32_t *words = malloc((size_t) max * sizeof(int32_t)), *want = malloc((size_t) max * sizeof(int32_t));
+    uint16_t *generator = malloc((size_t) max * sizeof(uint16_t));
+    int *g = malloc((size_t) (max + 1) * sizeof(int));
+    if (!words || !want || !generator || !g) return;
+
+    for (int round = 0; round < 200; round++) {
+        int limit = max < 600 ? max : 600;
+        int ec_words = 1 + (int) (test_rand() % (uint32_t) (limit < 100 ? limit - 1 : 100));
+        int data_words = 1 + (int) (test_rand() % (uint32_t) (limit - ec_words));
+        if (round == 0) {
+            /* the longest generator the field allows */
+            ec_words = (max < REFERENCE_MAX_DEGREE ? max : REFERENCE_MAX_DEGREE) - 1;
+            data_words = 1;
+        }
+
+        reed_solomon_generator(field, ec_words, generator);
+        reference_generator(spec->primitive, spec->size, spec->b, ec_words, g);
+        int same = 1;
+        for (int i = 0; i < ec_words; i++) same &= field->exp[generator[i]] == g[i + 1];
+        CHECK(same);
+
+        for (int i = 0; i < data_words; i++) {
+            /* runs of zero words take the shortcut in the LFSR */
+            words[i] = round % 4 == 1 && i % 3 ? 0 : (int32_t) (test_rand() % (uint32_t) spec->size);
+        }
+        reed_solomon_encode(field, generator, words, data_words, ec_words);
+        reference_encode(spec->primitive, spec->size, spec->b, words, data_words, ec_words, want);
+        same = 1;
+        for (int i = 0; i < ec_words; i++) same &= words[data_words + i] == want[i];
+        if (!same) fprintf(stderr, "%s: %d data and %d check words differ\n", spec->name, data_words, ec_words);
+        CHECK(same);
+    }
+    free(g);
+    free(generator);
+    free(want);
+    free(words);
+    reed_solomon_field_free(field);
+}
+
+/* "01234567" as QR 1-M, the example of ISO/IEC 18004 annex I */
+static void test_qr_example(void)
+{
+    static const int32_t DATA[16] = {0x10, 0x20, 0x0C, 0x56, 0x61, 0x80, 0xEC, 0x11,
+                                     0xEC, 0x11, 0xEC, 0x11, 0xEC, 0x11, 0xEC, 0x11};
+    static const int32_t EC[10] = {0xA5, 0x24, 0xD4, 0xC1, 0xED, 0x36, 0xC7, 0x87, 0x2C, 0x55};
+    reed_solomon_field *field = reed_solomon_field_create(0x011D, 256, 0);
+    if (!field) return;
+    int32_t words[26];
+    uint16_t generator[10];
+    for (int i = 0; i < 16; i++) words[i] = DATA[i];
+    reed_solomon_generator(field, 10, generator);
+    reed_solomon_encode(field, generator, words, 16, 10);
+    for (int i = 0; i < 10; i++) CHECK(words[16 + i] == EC[i]);
+    reed_solomon_field_free(field);
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof(FIELDS) / sizeof(FIELDS[0]); i++) check_field(&FIELDS[i]);
+    test_qr_example();
+    CHECK(reed_solomon_field_create(0x011D, 100, 0) == NULL);
+    return test_result("test_reed_solomon");
+}
@@ -0,0 +1,107 @@
+//
+//  test_text_encode.c
+//  RNBluetoothEscposPrinter
+//
+//  Every code page against the bytes of the Python codecs the tables are generated from.
+//  GBK is CP936, where € is the single byte 0x80.
+//
+
+#include <string.h>
+#include "text_encode.h"
+#include "test.h"
+
+typedef struct {
+    text_encoding encoding;
+    uint16_t text[8];
+    size_t length;
+    uint8_t bytes[20];
+    size_t size;           /* with '?' for a missing character */
+    size_t skipped_size;   /* with TEXT_FALLBACK_SKIP */
+} golden;
+
+static const golden GOLDEN[] = {
+    {TEXT_ENCODING_UTF8, {0x0041, 0x00e9, 0x20ac, 0x4e2d, 0xd83d, 0xde00}, 6,
+     {0x41, 0xc3, 0xa9, 0xe2, 0x82, 0xac, 0xe4, 0xb8, 0xad, 0xf0, 0x9f, 0x98, 0x80}, 13, 13},
+    {TEXT_ENCODING_GB18030, {0x0041, 0x4e2d, 0x6587, 0x20ac, 0xd83d, 0xde00, 0x00ff, 0x00a4}, 8,
+     {0x41, 0xd6, 0xd0, 0xce, 0xc4, 0xa2, 0xe3, 0x94, 0x39, 0xfc, 0x36, 0x81, 0x30, 0x8b, 0x37, 0xa1, 0xe8}, 17, 17},
+    {TEXT_ENCODING_GBK, {0x0041, 0x4e2d, 0x6587, 0x20ac, 0xd83d, 0xde00}, 6,
+     {0x41, 0xd6, 0xd0, 0xce, 0xc4, 0x80, 0x3f}, 7, 6},
+    {TEXT_ENCODING_BIG5, {0x0041, 0x4e2d, 0x6587, 0x20ac}, 4,
+     {0x41, 0xa4, 0xa4, 0xa4, 0xe5, 0x3f}, 6, 5},
+    {TEXT_ENCODING_CP437, {0x0041, 0x00e9, 0x00a3, 0x00f1, 0x2591, 0x20ac}, 6,
+     {0x41, 0x82, 0x9c, 0xa4, 0xb0, 0x3f}, 6, 5},
+    {TEXT_ENCODING_CP850, {0x0041, 0x00e9, 0x00a3, 0x00f1, 0x20ac, 0x00d8}, 6,
+     {0x41, 0x82, 0x9c, 0xa4, 0x3f, 0x9d}, 6, 5},
+    {TEXT_ENCODING_CP858, {0x0041, 0x00e9, 0x00a3, 0x00f1, 0x20ac, 0x00d8}, 6,
+     {0x41, 0x82, 0x9c, 0xa4, 0xd5, 0x9d}, 6, 6},
+    {TEXT_ENCODING_CP866, {0x0041, 0x041f, 0x0440, 0x0438, 0x0432, 0x0435, 0x0442, 0x20ac}, 8,
+     {0x41, 0x8f, 0xe0, 0xa8, 0xa2, 0xa5, 0xe2, 0x3f}, 8, 7},
+    {TEXT_ENCODING_CP1252, {0x0041, 0x20ac, 0x00e9, 0x0160, 0x2122, 0x4e2d}, 6,
+     {0x41, 0x80, 0xe9, 0x8a, 0x99, 0x3f}, 6, 5},
+};
+
+static void test_golden(void)
+{
+    uint8_t out[64];
+    for (size_t i = 0; i < sizeof(GOLDEN) / sizeof(GOLDEN[0]); i++) {
+        const golden *g = &GOLDEN[i];
+        CHECK(text_encode_size(g->encoding, g->length) >= g->size);
+        memset(out, 0, sizeof(out));
+        size_t n = text_encode(g->encoding, g->text, g->length, '?', out);
+        CHECK(n == g->size);
+        CHECK_BYTES(out, g->bytes, g->size);
+
+        /* the same bytes without the '?' */
+        uint8_t kept[20];
+        size_t k = 0;
+        for (size_t j = 0; j < g->size; j++) {
+            if (g->bytes[j] != '?') kept[k++] = g->bytes[j];
+        }
+        CHECK(k == g->skipped_size);
+        n = text_encode(g->encoding, g->text, g->length, TEXT_FALLBACK_SKIP, out);
+        CHECK(n == g->skipped_size);
+        CHECK_BYTES(out, kept, k);
+    }
+}
+
+static void test_euro(void)
+{
+    static const uint16_t EURO[] = {0x20AC};
+    uint8_t out[8];
+    CHECK(text_encode(TEXT_ENCODING_GBK, EURO, 1, '?', out) == 1 && out[0] == 0x80);
+    CHECK(text_encode(TEXT_ENCODING_GB18030, EURO, 1, '?', out) == 2 && out[0] == 0xA2 && out[1] == 0xE3);
+    CHECK(text_encode(TEXT_ENCODING_CP858, EURO, 1, '?', out) == 1 && out[0] == 0xD5);
+    CHECK(text_encode(TEXT_ENCODING_CP1252, EURO, 1, '?', out) == 1 && out[0] == 0x80);
+}
+
+static void test_surrogates(void)
+{
+    /* a lone high and a lone low surrogate */
+    static const uint16_t TEXT[] = {'a', 0xD800, 'b', 0xDC00};
+    static const uint8_t WANT[] = {'a', '?', 'b', '?'};
+    uint8_t out[16];
+    for (int e = TEXT_ENCODING_UTF8; e <= TEXT_ENCODING_CP1252; e++) {
+        CHECK(text_encode((text_encoding) e, TEXT, 4, '?', out) == 4);
+        CHECK_BYTES(out, WANT, 4);
+    }
+}
+
+static void test_names(void)
+{
+    CHECK(text_encoding_named("gbk") == TEXT_ENCODING_GBK);
+    CHECK(text_encoding_named("GB2312") == TEXT_ENCODING_GBK);
+    CHECK(text_encoding_named("Big5") == TEXT_ENCODING_BIG5);
+    CHECK(text_encoding_named("windows-1252") == TEXT_ENCODING_CP1252);
+    CHECK(text_encoding_named("utf-8") == TEXT_ENCODING_UTF8);
+    CHECK(text_encoding_named("shift_jis") == TEXT_ENCODING_UNKNOWN);
+    CHECK(text_encoding_named(NULL) == TEXT_ENCODING_UNKNOWN);
+}
+
+int main(void)
+{
+    test_golden();
+    test_euro();
+    test_surrogates();
+    test_names();
+    return test_result("test_text_encode");
+}
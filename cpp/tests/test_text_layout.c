@@ -0,0 +1,333 @@
+//
+//  test_text_layout.c
+//  RNBluetoothEscposPrinter
+//
+//  printColumn layout: East Asian Width of wide, zero width and surrogate pair characters,
+//  wrapping, '\n' in a cell and alignment, every layout measured with out NULL first.
+//
+
+#include <string.h>
+#include "text_layout.h"
+#include "test.h"
+
+#define MAX_OUT 2048
+
+static text_column column(const uint16_t *text, size_t length, size_t width, text_align align)
+{
+    text_column c;
+    c.text = text;
+    c.length = length;
+    c.width = width;
+    c.align = align;
+    return c;
+}
+
+/* the ASCII string as UTF-16 */
+static size_t utf16(const char *s, uint16_t *out)
+{
+    size_t n = strlen(s);
+    for (size_t i = 0; i < n; i++) out[i] = (unsigned char) s[i];
+    return n;
+}
+
+/* measures, then writes, the two must agree on the units and the rows */
+static size_t layout(const text_column *columns, size_t count, uint16_t *out, size_t *rows)
+{
+    size_t measured_rows = 0, written_rows = 0;
+    size_t measured = text_layout_columns(columns, count, NULL, &measured_rows);
+    CHECK(measured <= MAX_OUT);
+    if (measured > MAX_OUT) return 0;
+    size_t written = text_layout_columns(columns, count, out, &written_rows);
+    CHECK(written == measured);
+    CHECK(written_rows == measured_rows);
+    *rows = written_rows;
+    return written;
+}
+
+#define CHECK_UNITS(got, n, want) check_units((got), (n), (want), sizeof(want) / sizeof((want)[0]), __LINE__)
+
+static void check_units(const uint16_t *got, size_t n, const uint16_t *want, size_t want_n, int line)
+{
+    if (n != want_n) {
+        fprintf(stderr, "%s:%d: %zu units, expected %zu\n", __FILE__, line, n, want_n);
+        test_failures++;
+        return;
+    }
+    for (size_t i = 0; i < n; i++) {
+        if (got[i] == want[i]) continue;
+        fprintf(stderr, "%s:%d: unit %zu is 0x%04x, expected 0x%04x\n", __FILE__, line, i, got[i], want[i]);
+        test_failures++;
+        return;
+    }
+}
+
+/* for layouts of ASCII only */
+static void check_ascii(const uint16_t *got, size_t n, const char *want, int line)
+{
+    uint16_t units[MAX_OUT];
+    size_t want_n = utf16(want, units);
+    check_units(got, n, units, want_n, line);
+}
+
+static void test_char_width(void)
+{
+    CHECK(text_char_width('A') == 1);
+    CHECK(text_char_width(0x00E9) == 1);      /* é */
+    CHECK(text_char_width(0x0416) == 1);      /* Cyrillic Ж */
+    CHECK(text_char_width(0x4E2D) == 2);      /* 中 */
+    CHECK(text_char_width(0x3042) == 2);      /* hiragana あ */
+    CHECK(text_char_width(0x30A2) == 2);      /* katakana ア */
+    CHECK(text_char_width(0xAC00) == 2);      /* Hangul 가 */
+    CHECK(text_char_width(0xD7A3) == 2);      /* Hangul 힣, the last syllable */
+    CHECK(text_char_width(0x1100) == 2);      /* Hangul leading jamo */
+    CHECK(text_char_width(0xFF21) == 2);      /* fullwidth Ａ */
+    CHECK(text_char_width(0xFF61) == 1);      /* halfwidth ｡ */
+    CHECK(text_char_width(0x1F600) == 2);     /* 😀 */
+    CHECK(text_char_width(0x1F44D) == 2);     /* 👍 */
+    CHECK(text_char_width(0x20000) == 2);     /* CJK extension B */
+    CHECK(text_char_width(0x0301) == 0);      /* combining acute */
+    CHECK(text_char_width(0x1160) == 0);      /* Hangul vowel jamo */
+    CHECK(text_char_width(0x200D) == 0);      /* zero width joiner */
+    CHECK(text_char_width(0x200B) == 0);      /* zero width space */
+    CHECK(text_char_width(0xFE0F) == 0);      /* emoji presentation selector */
+    CHECK(text_char_width(0x1F3FB) == 0);     /* skin tone modifier */
+    CHECK(text_char_width('\n') == 0);
+    CHECK(text_char_width(0x7F) == 0);
+}
+
+static void test_wide_characters(void)
+{
+    /* 中文 and 한국 need 4 columns each, the gap of width 5 */
+    static const uint16_t chinese[] = {0x4E2D, 0x6587};
+    static const uint16_t korean[] = {0xD55C, 0xAD6D};
+    static const uint16_t want[] = {0x4E2D, 0x6587, ' ', 0xD55C, 0xAD6D, ' ', '\n', '\r'};
+    text_column c[2] = {column(chinese, 2, 5, TEXT_ALIGN_LEFT), column(korean, 2, 5, TEXT_ALIGN_LEFT)};
+    uint16_t out[MAX_OUT];
+    size_t rows = 0;
+    size_t n = layout(c, 2, out, &rows);
+    CHECK(rows == 1);
+    CHECK_UNITS(out, n, want);
+
+    /* in 4 columns only one fits a line, they wrap between the characters */
+    static const uint16_t wrapped[] = {0x4E2D, ' ', ' ', '\n', '\r', 0x6587, ' ', ' ', '\n', '\r'};
+    c[0].width = 4;
+    n = layout(c, 1, out, &rows);
+    CHECK(rows == 2);
+    CHECK_UNITS(out, n, wrapped);
+}
+
+static void test_zero_width(void)
+{
+    /* é as e + U+0301 and a family joined by U+200D take their base widths only */
+    static const uint16_t accent[] = {'e', 0x0301, 'x'};
+    static const uint16_t want_accent[] = {'e', 0x0301, 'x', ' ', '\n', '\r'};
+    static const uint16_t family[] = {0xD83D, 0xDC68, 0x200D, 0xD83D, 0xDC69};
+    static const uint16_t want_family[] = {0xD83D, 0xDC68, 0x200D, 0xD83D, 0xDC69, ' ', '\n', '\r'};
+    uint16_t out[MAX_OUT];
+    size_t rows = 0;
+
+    text_column c = column(accent, 3, 3, TEXT_ALIGN_LEFT);
+    size_t n = layout(&c, 1, out, &rows);
+    CHECK(rows == 1);
+    CHECK_UNITS(out, n, want_accent);
+
+    c = column(family, 5, 5, TEXT_ALIGN_LEFT);
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 1);
+    CHECK_UNITS(out, n, want_family);
+}
+
+static void test_surrogate_pairs(void)
+{
+    /* 😀 is one wide character, the line breaks before it, never between its two units */
+    static const uint16_t text[] = {'a', 'b', 0xD83D, 0xDE00, 'c'};
+    static const uint16_t want[] = {'a', 'b', ' ', ' ', '\n', '\r', 0xD83D, 0xDE00, 'c', ' ', '\n', '\r'};
+    uint16_t out[MAX_OUT];
+    size_t rows = 0;
+    text_column c = column(text, 5, 4, TEXT_ALIGN_LEFT);
+    size_t n = layout(&c, 1, out, &rows);
+    CHECK(rows == 2);
+    CHECK_UNITS(out, n, want);
+
+    /* a lone high surrogate is one narrow character */
+    static const uint16_t lone[] = {0xD83D, 'a'};
+    static const uint16_t want_lone[] = {0xD83D, 'a', ' ', '\n', '\r'};
+    c = column(lone, 2, 3, TEXT_ALIGN_LEFT);
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 1);
+    CHECK_UNITS(out, n, want_lone);
+}
+
+static void test_newline_in_cell(void)
+{
+    uint16_t a[16], b[16], out[MAX_OUT];
+    size_t rows = 0;
+    text_column c[2] = {column(a, utf16("ab\ncd", a), 5, TEXT_ALIGN_LEFT),
+                        column(b, utf16("x", b), 3, TEXT_ALIGN_RIGHT)};
+    size_t n = layout(c, 2, out, &rows);
+    CHECK(rows == 2);
+    check_ascii(out, n, "ab    x \n\rcd      \n\r", __LINE__);
+
+    /* an empty line between two '\n' is a row of its own */
+    c[0].length = utf16("ab\n\ncd", a);
+    n = layout(c, 1, out, &rows);
+    CHECK(rows == 3);
+    check_ascii(out, n, "ab   \n\r     \n\rcd   \n\r", __LINE__);
+}
+
+static void test_wrapping(void)
+{
+    uint16_t a[32], out[MAX_OUT];
+    size_t rows = 0;
+
+    /* breaks after spaces, the spaces at the break are dropped */
+    text_column c = column(a, utf16("one two three", a), 8, TEXT_ALIGN_LEFT);
+    size_t n = layout(&c, 1, out, &rows);
+    CHECK(rows == 2);
+    check_ascii(out, n, "one two \n\rthree   \n\r", __LINE__);
+
+    /* a word longer than the column is broken at the column */
+    c = column(a, utf16("abcdefgh", a), 4, TEXT_ALIGN_LEFT);
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 3);
+    check_ascii(out, n, "abc \n\rdef \n\rgh  \n\r", __LINE__);
+
+    /* the long word starts on a line of its own when there is a space before it */
+    c = column(a, utf16("a bcdefg", a), 4, TEXT_ALIGN_LEFT);
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 3);
+    check_ascii(out, n, "a   \n\rbcd \n\refg \n\r", __LINE__);
+}
+
+static void test_wide_in_one_column(void)
+{
+    /* a wide character wider than a 1 column cell still prints, one a row */
+    static const uint16_t text[] = {0x4E2D, 0x6587};
+    static const uint16_t want[] = {0x4E2D, '\n', '\r', 0x6587, '\n', '\r'};
+    uint16_t out[MAX_OUT];
+    size_t rows = 0;
+    text_column c = column(text, 2, 1, TEXT_ALIGN_LEFT);
+    size_t n = layout(&c, 1, out, &rows);
+    CHECK(rows == 2);
+    CHECK_UNITS(out, n, want);
+
+    /* right aligned there is no room to pad either */
+    c.align = TEXT_ALIGN_RIGHT;
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 2);
+    CHECK_UNITS(out, n, want);
+}
+
+static void test_alignment(void)
+{
+    uint16_t a[16], out[MAX_OUT];
+    size_t rows = 0;
+
+    /* 6 columns of content and the gap */
+    text_column c = column(a, utf16("ab", a), 7, TEXT_ALIGN_CENTER);
+    size_t n = layout(&c, 1, out, &rows);
+    check_ascii(out, n, "  ab   \n\r", __LINE__);
+
+    c.align = TEXT_ALIGN_RIGHT;
+    n = layout(&c, 1, out, &rows);
+    check_ascii(out, n, "    ab \n\r", __LINE__);
+
+    /* an odd remainder goes to the right of a centred line */
+    c = column(a, utf16("abc", a), 7, TEXT_ALIGN_CENTER);
+    n = layout(&c, 1, out, &rows);
+    check_ascii(out, n, " abc   \n\r", __LINE__);
+
+    /* by printed columns, not UTF-16 units */
+    static const uint16_t wide[] = {0x4E2D};
+    static const uint16_t want_centre[] = {' ', 0x4E2D, ' ', ' ', ' ', '\n', '\r'};
+    static const uint16_t want_right[] = {' ', ' ', ' ', 0x4E2D, ' ', '\n', '\r'};
+    c = column(wide, 1, 6, TEXT_ALIGN_CENTER);
+    n = layout(&c, 1, out, &rows);
+    CHECK_UNITS(out, n, want_centre);
+    c.align = TEXT_ALIGN_RIGHT;
+    n = layout(&c, 1, out, &rows);
+    CHECK_UNITS(out, n, want_right);
+
+    /* every wrapped line is aligned on its own */
+    c = column(a, utf16("ab cdef", a), 6, TEXT_ALIGN_RIGHT);
+    n = layout(&c, 1, out, &rows);
+    CHECK(rows == 2);
+    check_ascii(out, n, "   ab \n\r cdef \n\r", __LINE__);
+}
+
+static void test_empty(void)
+{
+    uint16_t a[4], out[MAX_OUT];
+    size_t rows = 7;
+    CHECK(text_layout_columns(NULL, 0, NULL, &rows) == 0);
+    CHECK(rows == 0);
+
+    /* an empty cell is blank beside a filled one */
+    text_column c[2] = {column(a, 0, 3, TEXT_ALIGN_LEFT), column(a, utf16("x", a), 3, TEXT_ALIGN_LEFT)};
+    size_t n = layout(c, 2, out, &rows);
+    CHECK(rows == 1);
+    check_ascii(out, n, "   x  \n\r", __LINE__);
+}
+
+/* the printed columns of every row of the output add up to the table width */
+static void check_row_widths(const uint16_t *out, size_t n, size_t rows, size_t width)
+{
+    size_t i = 0, seen = 0;
+    while (i < n) {
+        size_t cols = 0;
+        while (i < n && out[i] != '\n') {
+            uint32_t cp = out[i];
+            if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < n && out[i + 1] >= 0xDC00 && out[i + 1] <= 0xDFFF) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (out[i + 1] - 0xDC00u);
+                i++;
+            }
+            cols += (size_t) text_char_width(cp);
+            i++;
+        }
+        CHECK(cols == width);
+        CHECK(i + 1 < n && out[i + 1] == '\r');
+        i += 2;
+        seen++;
+    }
+    CHECK(seen == rows);
+}
+
+static void test_random(void)
+{
+    /* narrow, space, wide, an emoji pair, a combining mark and '\n' in random cells */
+    static const uint16_t pieces[][2] = {{'a', 0}, {'z', 0}, {' ', 0}, {0x4E2D, 0}, {0xAC00, 0},
+                                         {0xD83D, 0xDE00}, {0x0301, 0}, {'\n', 0}};
+    uint16_t text[3][40], out[MAX_OUT];
+    for (int round = 0; round < 2000; round++) {
+        text_column c[3];
+        size_t width = 0, rows = 0;
+        for (size_t k = 0; k < 3; k++) {
+            size_t len = 0, chars = test_rand() % 16;
+            for (size_t j = 0; j < chars; j++) {
+                const uint16_t *p = pieces[test_rand() % (sizeof(pieces) / sizeof(pieces[0]))];
+                text[k][len++] = p[0];
+                if (p[1]) text[k][len++] = p[1];
+            }
+            /* at least 2 columns of content, a wide character always fits */
+            c[k] = column(text[k], len, 3 + test_rand() % 6, (text_align) (test_rand() % 3));
+            width += c[k].width;
+        }
+        size_t n = layout(c, 3, out, &rows);
+        check_row_widths(out, n, rows, width);
+    }
+}
+
+int main(void)
+{
+    test_char_width();
+    test_wide_characters();
+    test_zero_width();
+    test_surrogate_pairs();
+    test_newline_in_cell();
+    test_wrapping();
+    test_wide_in_one_column();
+    test_alignment();
+    test_empty();
+    test_random();
+    return test_result("test_text_layout");
+}
@@ -0,0 +1,241 @@
+//
+//  text_encode.c
+//  RNBluetoothEscposPrinter
+//
+//  Table driven UTF-16 to ESC/POS code page transcoding.
+//
+
+#include <string.h>
+#include "text_encode.h"
+#include "text_tables.h"
+
+#define GB18030_SUPPLEMENTARY 189000 /* linear index of 0x90308130, U+10000 */
+#define ASCII_MASK 0xFF80FF80FF80FF80ULL
+
+typedef struct {
+    const char *name;
+    text_encoding encoding;
+} text_encoding_name;
+
+static const text_encoding_name encoding_names[] = {
+    {"UTF-8", TEXT_ENCODING_UTF8}, {"UTF8", TEXT_ENCODING_UTF8},
+    {"GB18030", TEXT_ENCODING_GB18030},
+    {"GBK", TEXT_ENCODING_GBK}, {"CP936", TEXT_ENCODING_GBK}, {"GB2312", TEXT_ENCODING_GBK},
+    {"BIG5", TEXT_ENCODING_BIG5}, {"BIG-5", TEXT_ENCODING_BIG5}, {"CP950", TEXT_ENCODING_BIG5},
+    {"CP437", TEXT_ENCODING_CP437}, {"IBM437", TEXT_ENCODING_CP437},
+    {"CP850", TEXT_ENCODING_CP850}, {"IBM850", TEXT_ENCODING_CP850},
+    {"CP858", TEXT_ENCODING_CP858}, {"IBM00858", TEXT_ENCODING_CP858},
+    {"CP866", TEXT_ENCODING_CP866}, {"IBM866", TEXT_ENCODING_CP866},
+    {"CP1252", TEXT_ENCODING_CP1252}, {"WINDOWS-1252", TEXT_ENCODING_CP1252}
+};
+
+static int same_name(const char *a, const char *b)
+{
+    for (; *a && *b; a++, b++) {
+        char ca = (*a >= 'a' && *a <= 'z') ? (char) (*a - 32) : *a;
+        if (ca != *b) return 0;
+    }
+    return *a == *b;
+}
+
+text_encoding text_encoding_named(const char *name)
+{
+    if (!name) return TEXT_ENCODING_UNKNOWN;
+    for (size_t i = 0; i < sizeof(encoding_names) / sizeof(encoding_names[0]); i++) {
+        if (same_name(name, encoding_names[i].name)) return encoding_names[i].encoding;
+    }
+    return TEXT_ENCODING_UNKNOWN;
+}
+
+size_t text_encode_size(text_encoding encoding, size_t length)
+{
+    switch (encoding) {
+        case TEXT_ENCODING_UTF8:
+            return length * 3; /* a surrogate pair is 2 units and 4 bytes */
+        case TEXT_ENCODING_GB18030:
+            return length * 4;
+        case TEXT_ENCODING_GBK:
+        case TEXT_ENCODING_BIG5:
+            return length * 2;
+        case TEXT_ENCODING_UNKNOWN:
+            return 0;
+        default:
+            return length;
+    }
+}
+
+/* the code of cp in a paged table, 0 when there is none */
+static uint32_t paged_index(const text_page *pages, uint32_t cp)
+{
+    const text_page *page = &pages[(cp >> 8) & 0xFF];
+    uint32_t low = cp & 0xFF;
+    if (cp > 0xFFFF || low < page->lo || low > page->hi) return 0xFFFFFFFF;
+    return page->offset + low - page->lo;
+}
+
+/* copies the ASCII units at the start of text, four are tested at once. Returns how many. */
+static size_t ascii_run(const uint16_t *text, size_t length, uint8_t *out)
+{
+    size_t i = 0;
+    while (i + 4 <= length) {
+        uint64_t units;
+        memcpy(&units, text + i, sizeof(units));
+        if (units & ASCII_MASK) break;
+        out[i] = (uint8_t) text[i];
+        out[i + 1] = (uint8_t) text[i + 1];
+        out[i + 2] = (uint8_t) text[i + 2];
+        out[i + 3] = (uint8_t) text[i + 3];
+        i += 4;
+    }
+    while (i < length && text[i] < 0x80) {
+        out[i] = (uint8_t) text[i];
+        i++;
+    }
+    return i;
+}
+
+/* the code point at *i, moves *i past it. 0xFFFFFFFF for a lone surrogate */
+static uint32_t next_code_point(const uint16_t *text, size_t length, size_t *i)
+{
+    uint32_t cp = text[(*i)++];
+    if (cp < 0xD800 || cp > 0xDFFF) return cp;
+    if (cp <= 0xDBFF && *i < length && text[*i] >= 0xDC00 && text[*i] <= 0xDFFF) {
+        return 0x10000 + ((cp - 0xD800) << 10) + (text[(*i)++] - 0xDC00);
+    }
+    return 0xFFFFFFFF;
+}
+
+static size_t put_fallback(int fallback, uint8_t *out)
+{
+    if (fallback < 0) return 0;
+    out[0] = (uint8_t) fallback;
+    return 1;
+}
+
+static size_t gb18030_four(uint32_t cp, uint8_t *out)
+{
+    uint32_t linear;
+    if (cp >= 0x10000) {
+        linear = cp - 0x10000 + GB18030_SUPPLEMENTARY;
+    } else {
+        size_t lo = 0, hi = text_gb_range_count;
+        while (hi - lo > 1) {
+            size_t mid = (lo + hi) / 2;
+            if (text_gb_ranges[mid].cp <= cp) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        linear = text_gb_ranges[lo].linear + (cp - text_gb_ranges[lo].cp);
+    }
+    out[3] = (uint8_t) (0x30 + linear % 10);
+    linear /= 10;
+    out[2] = (uint8_t) (0x81 + linear % 126);
+    linear /= 126;
+    out[1] = (uint8_t) (0x30 + linear % 10);
+    out[0] = (uint8_t) (0x81 + linear / 10);
+    return 4;
+}
+
+static size_t encode_single(const text_page *pages, const uint8_t *codes,
+                            const uint16_t *text, size_t length, int fallback, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < length) {
+        size_t run = ascii_run(text + i, length - i, out + o);
+        i += run;
+        o += run;
+        if (i >= length) break;
+        uint32_t index = paged_index(pages, next_code_point(text, length, &i));
+        if (index != 0xFFFFFFFF && codes[index]) {
+            out[o++] = codes[index];
+        } else {
+            o += put_fallback(fallback, out + o);
+        }
+    }
+    return o;
+}
+
+/* GB18030, GBK and Big5 */
+static size_t encode_double(text_encoding encoding, const text_page *pages, const uint16_t *codes,
+                            const uint16_t *text, size_t length, int fallback, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < length) {
+        size_t run = ascii_run(text + i, length - i, out + o);
+        i += run;
+        o += run;
+        if (i >= length) break;
+        uint32_t cp = next_code_point(text, length, &i);
+        if (encoding == TEXT_ENCODING_GBK && cp == 0x20AC) {
+            /* before the table, which has GB18030's A2E3 */
+            out[o++] = 0x80;
+            continue;
+        }
+        uint32_t index = paged_index(pages, cp);
+        if (index != 0xFFFFFFFF && codes[index]) {
+            out[o] = (uint8_t) (codes[index] >> 8);
+            out[o + 1] = (uint8_t) codes[index];
+            o += 2;
+        } else if (encoding == TEXT_ENCODING_GB18030 && cp != 0xFFFFFFFF) {
+            o += gb18030_four(cp, out + o);
+        } else {
+            o += put_fallback(fallback, out + o);
+        }
+    }
+    return o;
+}
+
+static size_t encode_utf8(const uint16_t *text, size_t length, int fallback, uint8_t *out)
+{
+    size_t i = 0, o = 0;
+    while (i < length) {
+        size_t run = ascii_run(text + i, length - i, out + o);
+        i += run;
+        o += run;
+        if (i >= length) break;
+        uint32_t cp = next_code_point(text, length, &i);
+        if (cp == 0xFFFFFFFF) {
+            o += put_fallback(fallback, out + o);
+        } else if (cp < 0x800) {
+            out[o++] = (uint8_t) (0xC0 | cp >> 6);
+            out[o++] = (uint8_t) (0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out[o++] = (uint8_t) (0xE0 | cp >> 12);
+            out[o++] = (uint8_t) (0x80 | ((cp >> 6) & 0x3F));
+            out[o++] = (uint8_t) (0x80 | (cp & 0x3F));
+        } else {
+            out[o++] = (uint8_t) (0xF0 | cp >> 18);
+            out[o++] = (uint8_t) (0x80 | ((cp >> 12) & 0x3F));
+            out[o++] = (uint8_t) (0x80 | ((cp >> 6) & 0x3F));
+            out[o++] = (uint8_t) (0x80 | (cp & 0x3F));
+        }
+    }
+    return o;
+}
+
+size_t text_encode(text_encoding encoding, const uint16_t *text, size_t length, int fallback, uint8_t *out)
+{
+    switch (encoding) {
+        case TEXT_ENCODING_UTF8:
+            return encode_utf8(text, length, fallback, out);
+        case TEXT_ENCODING_GB18030:
+        case TEXT_ENCODING_GBK:
+            return encode_double(encoding, text_gb_pages, text_gb_codes, text, length, fallback, out);
+        case TEXT_ENCODING_BIG5:
+            return encode_double(encoding, text_big5_pages, text_big5_codes, text, length, fallback, out);
+        case TEXT_ENCODING_CP437:
+            return encode_single(text_cp437_pages, text_cp437_codes, text, length, fallback, out);
+        case TEXT_ENCODING_CP850:
+            return encode_single(text_cp850_pages, text_cp850_codes, text, length, fallback, out);
+        case TEXT_ENCODING_CP858:
+            return encode_single(text_cp858_pages, text_cp858_codes, text, length, fallback, out);
+        case TEXT_ENCODING_CP866:
+            return encode_single(text_cp866_pages, text_cp866_codes, text, length, fallback, out);
+        case TEXT_ENCODING_CP1252:
+            return encode_single(text_cp1252_pages, text_cp1252_codes, text, length, fallback, out);
+        default:
+            return 0;
+    }
+}
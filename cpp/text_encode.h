@@ -0,0 +1,51 @@
+//
+//  text_encode.h
+//  RNBluetoothEscposPrinter
+//
+//  UTF-16 to printer code page transcoding with compiled tables, shared by the iOS and
+//  Android modules instead of the OS charset converters.
+//
+#ifndef ESCPOS_TEXT_ENCODE_H
+#define ESCPOS_TEXT_ENCODE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    TEXT_ENCODING_UNKNOWN = -1,
+    TEXT_ENCODING_UTF8 = 0,
+    TEXT_ENCODING_GB18030 = 1,
+    TEXT_ENCODING_GBK = 2,      /* the two byte part of GB18030, € is 0x80 as in CP936 */
+    TEXT_ENCODING_BIG5 = 3,
+    TEXT_ENCODING_CP437 = 4,
+    TEXT_ENCODING_CP850 = 5,
+    TEXT_ENCODING_CP858 = 6,
+    TEXT_ENCODING_CP866 = 7,
+    TEXT_ENCODING_CP1252 = 8
+} text_encoding;
+
+/* printText's encoding option, e.g. "GBK", "big5", "CP437", "windows-1252". Case is ignored. */
+text_encoding text_encoding_named(const char *name);
+
+/* fallback for text_encode: a character the code page does not have is dropped */
+#define TEXT_FALLBACK_SKIP (-1)
+
+/* the most bytes text_encode writes for length UTF-16 units */
+size_t text_encode_size(text_encoding encoding, size_t length);
+
+/*
+ * Encodes UTF-16 text, runs of ASCII are copied straight through. A character the code page
+ * does not have, or a lone surrogate, is written as the fallback byte (e.g. '?') or dropped
+ * with TEXT_FALLBACK_SKIP. Returns the bytes written.
+ */
+size_t text_encode(text_encoding encoding, const uint16_t *text, size_t length, int fallback, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESCPOS_TEXT_ENCODE_H */
@@ -0,0 +1,223 @@
+//
+//  text_layout.c
+//  RNBluetoothEscposPrinter
+//
+//  East Asian Width measurement and word wrapping for printColumn.
+//
+
+#include <stdlib.h>
+#include "text_layout.h"
+
+typedef struct {
+    uint32_t first;
+    uint32_t last;
+} text_range;
+
+/* East_Asian_Width W and F, Unicode 15, adjacent ranges merged. */
+static const text_range wide_ranges[] = {
+    {0x1100, 0x115F}, {0x231A, 0x231B}, {0x2329, 0x232A}, {0x23E9, 0x23EC}, {0x23F0, 0x23F0},
+    {0x23F3, 0x23F3}, {0x25FD, 0x25FE}, {0x2614, 0x2615}, {0x2648, 0x2653}, {0x267F, 0x267F},
+    {0x2693, 0x2693}, {0x26A1, 0x26A1}, {0x26AA, 0x26AB}, {0x26BD, 0x26BE}, {0x26C4, 0x26C5},
+    {0x26CE, 0x26CE}, {0x26D4, 0x26D4}, {0x26EA, 0x26EA}, {0x26F2, 0x26F3}, {0x26F5, 0x26F5},
+    {0x26FA, 0x26FA}, {0x26FD, 0x26FD}, {0x2705, 0x2705}, {0x270A, 0x270B}, {0x2728, 0x2728},
+    {0x274C, 0x274C}, {0x274E, 0x274E}, {0x2753, 0x2755}, {0x2757, 0x2757}, {0x2795, 0x2797},
+    {0x27B0, 0x27B0}, {0x27BF, 0x27BF}, {0x2B1B, 0x2B1C}, {0x2B50, 0x2B50}, {0x2B55, 0x2B55},
+    {0x2E80, 0x303E}, {0x3041, 0x33FF}, {0x3400, 0x4DBF}, {0x4E00, 0xA4CF}, {0xA960, 0xA97F},
+    {0xAC00, 0xD7A3}, {0xF900, 0xFAFF}, {0xFE10, 0xFE19}, {0xFE30, 0xFE6F}, {0xFF00, 0xFF60},
+    {0xFFE0, 0xFFE6}, {0x16FE0, 0x16FE4}, {0x16FF0, 0x16FF1}, {0x17000, 0x18CD5}, {0x18D00, 0x18D08},
+    {0x1AFF0, 0x1B2FB}, {0x1F004, 0x1F004}, {0x1F0CF, 0x1F0CF}, {0x1F18E, 0x1F18E}, {0x1F191, 0x1F19A},
+    {0x1F200, 0x1F202}, {0x1F210, 0x1F23B}, {0x1F240, 0x1F248}, {0x1F250, 0x1F251}, {0x1F260, 0x1F265},
+    {0x1F300, 0x1F320}, {0x1F32D, 0x1F335}, {0x1F337, 0x1F37C}, {0x1F37E, 0x1F393}, {0x1F3A0, 0x1F3CA},
+    {0x1F3CF, 0x1F3D3}, {0x1F3E0, 0x1F3F0}, {0x1F3F4, 0x1F3F4}, {0x1F3F8, 0x1F3FA}, {0x1F400, 0x1F43E},
+    {0x1F440, 0x1F440}, {0x1F442, 0x1F4FC}, {0x1F4FF, 0x1F53D}, {0x1F54B, 0x1F54E}, {0x1F550, 0x1F567},
+    {0x1F57A, 0x1F57A}, {0x1F595, 0x1F596}, {0x1F5A4, 0x1F5A4}, {0x1F5FB, 0x1F64F}, {0x1F680, 0x1F6C5},
+    {0x1F6CC, 0x1F6CC}, {0x1F6D0, 0x1F6D2}, {0x1F6D5, 0x1F6D7}, {0x1F6DC, 0x1F6DF}, {0x1F6EB, 0x1F6EC},
+    {0x1F6F4, 0x1F6FC}, {0x1F7E0, 0x1F7EB}, {0x1F7F0, 0x1F7F0}, {0x1F90C, 0x1F93A}, {0x1F93C, 0x1F945},
+    {0x1F947, 0x1F9FF}, {0x1FA70, 0x1FAFF}, {0x20000, 0x2FFFD}, {0x30000, 0x3FFFD}
+};
+
+/* Nonspacing marks, joiners and variation selectors that print on the character before them. */
+static const text_range zero_ranges[] = {
+    {0x0300, 0x036F}, {0x0483, 0x0489}, {0x0591, 0x05BD}, {0x05BF, 0x05BF}, {0x05C1, 0x05C2},
+    {0x05C4, 0x05C5}, {0x05C7, 0x05C7}, {0x0610, 0x061A}, {0x064B, 0x065F}, {0x0670, 0x0670},
+    {0x06D6, 0x06DC}, {0x06DF, 0x06E4}, {0x06E7, 0x06E8}, {0x06EA, 0x06ED}, {0x0E31, 0x0E31},
+    {0x0E34, 0x0E3A}, {0x0E47, 0x0E4E}, {0x0EB1, 0x0EB1}, {0x0EB4, 0x0EBC}, {0x0EC8, 0x0ECE},
+    {0x1160, 0x11FF}, {0x1AB0, 0x1AFF}, {0x1DC0, 0x1DFF}, {0x200B, 0x200F}, {0x202A, 0x202E},
+    {0x2060, 0x2064}, {0x20D0, 0x20F0}, {0x302A, 0x302D}, {0x3099, 0x309A}, {0xD7B0, 0xD7FF},
+    {0xFE00, 0xFE0F}, {0xFE20, 0xFE2F}, {0xFEFF, 0xFEFF}, {0x1F3FB, 0x1F3FF}, {0xE0000, 0xE007F},
+    {0xE0100, 0xE01EF}
+};
+
+static int in_ranges(uint32_t cp, const text_range *ranges, size_t count)
+{
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (cp < ranges[mid].first) {
+            hi = mid;
+        } else if (cp > ranges[mid].last) {
+            lo = mid + 1;
+        } else {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int text_char_width(uint32_t cp)
+{
+    if (cp < 0x20 || (cp >= 0x7F && cp < 0xA0)) return 0;
+    if (cp < 0x300) return 1;
+    if (in_ranges(cp, zero_ranges, sizeof(zero_ranges) / sizeof(zero_ranges[0]))) return 0;
+    if (in_ranges(cp, wide_ranges, sizeof(wide_ranges) / sizeof(wide_ranges[0]))) return 2;
+    return 1;
+}
+
+/* the code point at i, returns its UTF-16 units. A lone surrogate counts as one narrow character. */
+static size_t decode(const uint16_t *s, size_t n, size_t i, uint32_t *cp)
+{
+    uint16_t u = s[i];
+    if (u >= 0xD800 && u <= 0xDBFF && i + 1 < n && s[i + 1] >= 0xDC00 && s[i + 1] <= 0xDFFF) {
+        *cp = 0x10000 + (((uint32_t) u - 0xD800) << 10) + (s[i + 1] - 0xDC00);
+        return 2;
+    }
+    *cp = u;
+    return 1;
+}
+
+typedef struct {
+    size_t start;
+    size_t end;
+    size_t next;  /* where the following line starts */
+    size_t cols;
+} text_line;
+
+static size_t skip_spaces(const uint16_t *s, size_t n, size_t i)
+{
+    while (i < n && s[i] == ' ') i++;
+    return i;
+}
+
+/* the line of at most content columns starting at pos */
+static void next_line(const text_column *column, size_t content, size_t pos, text_line *line)
+{
+    const uint16_t *s = column->text;
+    size_t n = column->length;
+    size_t i = pos, cols = 0;
+    size_t brk_end = pos, brk_next = pos, brk_cols = 0; /* last place the line may end */
+
+    line->start = pos;
+    while (i < n) {
+        uint32_t cp;
+        size_t k;
+        int w;
+        if (s[i] == '\n') {
+            line->end = i;
+            line->next = i + 1;
+            line->cols = cols;
+            goto trim;
+        }
+        k = decode(s, n, i, &cp);
+        w = text_char_width(cp);
+        if (s[i] == ' ' || (w == 2 && i > pos)) {
+            brk_end = i;
+            brk_next = i;
+            brk_cols = cols;
+        }
+        if (w > 0 && cols + (size_t) w > content) {
+            if (brk_end > pos) {
+                line->end = brk_end;
+                line->cols = brk_cols;
+                line->next = skip_spaces(s, n, brk_next);
+            } else if (s[i] == ' ') {
+                line->end = i;
+                line->cols = cols;
+                line->next = skip_spaces(s, n, i);
+            } else if (i > pos) {
+                line->end = i;
+                line->cols = cols;
+                line->next = i;
+            } else {
+                /* one character wider than the column */
+                line->end = i + k;
+                line->cols = (size_t) w;
+                line->next = i + k;
+            }
+            goto trim;
+        }
+        cols += (size_t) w;
+        i += k;
+        if (w == 2) {
+            brk_end = i;
+            brk_next = i;
+            brk_cols = cols;
+        }
+    }
+    line->end = n;
+    line->next = n;
+    line->cols = cols;
+trim:
+    while (line->end > line->start && s[line->end - 1] == ' ') {
+        line->end--;
+        line->cols--;
+    }
+}
+
+static size_t put_spaces(uint16_t *out, size_t at, size_t count)
+{
+    if (out) {
+        for (size_t i = 0; i < count; i++) out[at + i] = ' ';
+    }
+    return count;
+}
+
+size_t text_layout_columns(const text_column *columns, size_t count, uint16_t *out, size_t *rows)
+{
+    size_t *pos = calloc(count ? count : 1, sizeof(size_t));
+    size_t written = 0, nrows = 0;
+    if (!pos) return (size_t) -1;
+
+    for (;;) {
+        int more = 0;
+        for (size_t c = 0; c < count; c++) {
+            if (columns[c].width > 0 && pos[c] < columns[c].length) more = 1;
+        }
+        if (!more) break;
+
+        for (size_t c = 0; c < count; c++) {
+            const text_column *column = &columns[c];
+            size_t content = column->width > 1 ? column->width - 1 : column->width;
+            size_t left = 0, fill;
+            text_line line = {pos[c], pos[c], pos[c], 0};
+
+            if (column->width > 0 && pos[c] < column->length) {
+                next_line(column, content, pos[c], &line);
+                pos[c] = line.next;
+            }
+            if (line.cols < content) {
+                if (column->align == TEXT_ALIGN_CENTER) {
+                    left = (content - line.cols) / 2;
+                } else if (column->align == TEXT_ALIGN_RIGHT) {
+                    left = content - line.cols;
+                }
+            }
+            fill = line.cols + left < column->width ? column->width - line.cols - left : 0;
+
+            written += put_spaces(out, written, left);
+            for (size_t i = line.start; i < line.end; i++, written++) {
+                if (out) out[written] = column->text[i];
+            }
+            written += put_spaces(out, written, fill);
+        }
+        if (out) {
+            out[written] = '\n';
+            out[written + 1] = '\r';
+        }
+        written += 2;
+        nrows++;
+    }
+
+    free(pos);
+    if (rows) *rows = nrows;
+    return written;
+}
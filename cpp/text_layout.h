@@ -0,0 +1,49 @@
+//
+//  text_layout.h
+//  RNBluetoothEscposPrinter
+//
+//  Column layout of printColumn, shared by the iOS and Android modules.
+//  Text is UTF-16, as NSString and java.lang.String hold it.
+//
+#ifndef ESCPOS_TEXT_LAYOUT_H
+#define ESCPOS_TEXT_LAYOUT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Printed columns of a code point by its East Asian Width: 2 for Wide and Fullwidth
+ * (CJK, Hangul syllables, kana, emoji), 0 for combining marks, joiners and controls, 1 otherwise.
+ */
+int text_char_width(uint32_t cp);
+
+typedef enum {
+    TEXT_ALIGN_LEFT = 0,
+    TEXT_ALIGN_CENTER = 1,
+    TEXT_ALIGN_RIGHT = 2
+} text_align;
+
+typedef struct {
+    const uint16_t *text;
+    size_t length;   /* UTF-16 units */
+    size_t width;    /* printed columns, the last one is left blank as the gap to the next column */
+    text_align align;
+} text_column;
+
+/*
+ * Lays the columns out side by side. A column wraps after spaces and around wide characters,
+ * a word longer than the column is broken, '\n' starts a new line. Every row is padded to the
+ * sum of the widths and ends with "\n\r".
+ * With out NULL only measures. Returns the UTF-16 units written, (size_t)-1 when out of memory.
+ */
+size_t text_layout_columns(const text_column *columns, size_t count, uint16_t *out, size_t *rows);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ESCPOS_TEXT_LAYOUT_H */
@@ -0,0 +1,38 @@
+//
+//  text_tables.h
+//  RNBluetoothEscposPrinter
+//
+//  Code page tables of text_encode.c, text_tables.c is generated by gen_text_tables.py.
+//
+#ifndef ESCPOS_TEXT_TABLES_H
+#define ESCPOS_TEXT_TABLES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * The code of a BMP code point is codes[offset + low - lo] when its low byte is in lo..hi of
+ * pages[cp >> 8], 0 there or outside means the code page has no such character. lo > hi for
+ * an empty page. Two byte codes have the lead byte high.
+ */
+typedef struct {
+    uint8_t lo;
+    uint8_t hi;
+    uint16_t offset;
+} text_page;
+
+/* BMP code points from cp on are GB18030 four byte sequences from linear on */
+typedef struct {
+    uint16_t cp;
+    uint16_t linear;
+} text_gb_range;
+
+extern const text_page text_cp437_pages[256], text_cp850_pages[256], text_cp858_pages[256],
+        text_cp866_pages[256], text_cp1252_pages[256], text_gb_pages[256], text_big5_pages[256];
+extern const uint8_t text_cp437_codes[], text_cp850_codes[], text_cp858_codes[], text_cp866_codes[], text_cp1252_codes[];
+extern const uint16_t text_gb_codes[], text_big5_codes[];
+
+extern const text_gb_range text_gb_ranges[];
+extern const size_t text_gb_range_count;
+
+#endif /* ESCPOS_TEXT_TABLES_H */
@@ -4,6 +4,74 @@ export interface PrintOptions {
   autoCut?: boolean;
   center?: boolean;
   paperSize?: number;
+  dither?: DitherMode;
+}
+
+export type DitherMode = 'threshold' | 'floyd-steinberg' | 'atkinson' | 'bayer4' | 'bayer8' | 'bayer16';
+
+export interface PrinterProfile {
+  /** Rows per GS v 0 raster command: 1 = one per scanline, 0 = whole image (default 24). */
+  rasterRows?: number;
+  /** The printer renders QR codes / PDF417 from GS ( k, used by symbol mode 'auto' (default false). */
+  nativeQRCode?: boolean;
+  nativePDF417?: boolean;
+}
+
+/** 'native': the printer's GS ( k command, 'raster': an image, 'auto': native when the profile supports it. */
+export type SymbolMode = 'native' | 'raster' | 'auto';
+
+export interface QRCodeOptions {
+  mode?: SymbolMode;
+  /** Dots per module of the native code, 1-16. Defaults to the one closest to size. */
+  moduleSize?: number;
+}
+
+export interface PDF417Options {
+  mode?: SymbolMode;
+  /** Native symbol: data columns (0 = printer decides), module width 2-8, row height 2-8, error correction 0-8. */
+  columns?: number;
+  moduleWidth?: number;
+  rowHeight?: number;
+  errorCorrection?: number;
+  /** Raster width in dots, defaults to the paper width. */
+  width?: number;
+}
+
+export interface PicCacheStats {
+  hits: number;
+  misses: number;
+  /** Recently printed rasters held and their size in bytes. */
+  entries: number;
+  size: number;
+  capacity: number;
+  /** Images kept with registerPic. */
+  registered: number;
+  registeredSize: number;
+}
+
+export interface NvImageOptions {
+  width?: number;
+  dither?: DitherMode;
+  /** Write the image even if the printer already holds it. */
+  force?: boolean;
+}
+
+export type BatchCommand =
+  | 'printerInit' | 'printAndFeed' | 'printerLeftSpace' | 'printerLineSpace' | 'printerUnderLine'
+  | 'printerAlign' | 'setBlob' | 'rotate' | 'printText' | 'printColumn' | 'printPic'
+  | 'printRegisteredPic' | 'printNvImage' | 'printQRCode' | 'printPDF417' | 'printBarCode' | 'openDrawer' | 'cutOnePoint';
+
+/** One printBatch operation: the method name and the arguments it would be called with. */
+export interface BatchOperation {
+  command: BatchCommand;
+  args?: any[];
+}
+
+/** userInfo of an INVALID_BATCH rejection. */
+export interface BatchError {
+  index: number;
+  command: string;
+  code: string;
 }
 
 export interface BluetoothDevice {
@@ -20,12 +88,27 @@ export interface BluetoothManagerType {
   connect(address: string): Promise<void>;
   disconnect(address: string): Promise<void>;
   getConnectedDevice(): Promise<BluetoothDevice | null>;
+  /** Event with { index, total } for every label of BluetoothTscPrinter.printLabels written. */
+  EVENT_LABEL_PRINTED: string;
 }
 
 export interface BluetoothEscposPrinterType {
+  setPrinterProfile(profile: PrinterProfile): void;
   printText(text: string, options?: any): Promise<void>;
   printPic(base64: string, options?: PrintOptions): Promise<void>;
-  printQRCode(content: string, size: number, align?: number): Promise<void>;
+  registerPic(imageId: string, base64: string, options?: PrintOptions): Promise<void>;
+  printRegisteredPic(imageId: string, options?: PrintOptions): Promise<void>;
+  setPicCacheSize(bytes: number): void;
+  clearPicCache(): void;
+  getPicCacheStats(): Promise<PicCacheStats>;
+  /** key: two printable ASCII characters. Resolves false when the printer already holds the image. */
+  uploadNvImage(key: string, base64: string, options?: NvImageOptions): Promise<boolean>;
+  printNvImage(key: string): Promise<void>;
+  deleteNvImage(key: string): Promise<void>;
+  clearNvImages(): Promise<void>;
+  getNvImages(): Promise<string[]>;
+  printQRCode(content: string, size: number, correctionLevel?: number, options?: QRCodeOptions): Promise<void>;
+  printPDF417(content: string, options?: PDF417Options): Promise<void>;
   printBarCode(
     content: string,
     symbology: number,
@@ -35,10 +118,14 @@ export interface BluetoothEscposPrinterType {
     textPosition: number
   ): Promise<void>;
   cutPaper(): Promise<void>;
+  /** Encodes all operations natively and sends them as one write. Rejects with INVALID_BATCH, userInfo: { errors: BatchError[] }. */
+  printBatch(ops: BatchOperation[]): Promise<void>;
   ERROR_CORRECTION: { L: number; M: number; Q: number; H: number };
   BARCODETYPE: Record<string, number>;
   ROTATION: { OFF: number; ON: number };
   ALIGN: { LEFT: number; CENTER: number; RIGHT: number };
+  DITHER: Record<string, DitherMode>;
+  SYMBOL_MODE: { AUTO: SymbolMode; NATIVE: SymbolMode; RASTER: SymbolMode };
 }
 
 export interface BluetoothTscPrinterType {
@@ -53,6 +140,14 @@ export interface BluetoothTscPrinterType {
   PRINT_SPEED: Record<string, number>;
   TEAR: Record<string, string>;
   READABLE: Record<string, number>;
+  DITHER: Record<string, DitherMode>;
+  /** options.sets / options.copies: PRINT sets,copies, both default to 1. */
+  printLabel(options: object): Promise<void>;
+  /** One job for many labels, the setup is sent once. Emits BluetoothManager.EVENT_LABEL_PRINTED per label. */
+  printLabels(labels: object[]): Promise<void>;
+  compileLabelTemplate(templateId: string, options: object): Promise<void>;
+  printLabelTemplate(templateId: string, values?: Record<string, string | number>): Promise<void>;
+  removeLabelTemplate(templateId: string): Promise<void>;
 }
 
 export const BluetoothManager: BluetoothManagerType;
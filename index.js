@@ -113,6 +113,14 @@ BluetoothTscPrinter.READABLE={
   DISABLE:0,
   EANBLE:1
 };
+BluetoothTscPrinter.DITHER = {
+    THRESHOLD:'threshold',
+    FLOYD_STEINBERG:'floyd-steinberg',
+    ATKINSON:'atkinson',
+    BAYER4:'bayer4',
+    BAYER8:'bayer8',
+    BAYER16:'bayer16'
+};
 
 BluetoothEscposPrinter.ERROR_CORRECTION = {
     L:1,
@@ -141,6 +149,19 @@ BluetoothEscposPrinter.ALIGN={
     CENTER:1,
     RIGHT:2
 };
+BluetoothEscposPrinter.DITHER = BluetoothTscPrinter.DITHER;
+BluetoothEscposPrinter.SYMBOL_MODE = {
+    AUTO:'auto',
+    NATIVE:'native',
+    RASTER:'raster'
+};
+
+// the native methods take every argument, options stays optional here
+const printQRCode = BluetoothEscposPrinter.printQRCode;
+BluetoothEscposPrinter.printQRCode = (content, size, correctionLevel, options) =>
+    printQRCode(content, size, correctionLevel, options || null);
+const printPDF417 = BluetoothEscposPrinter.printPDF417;
+BluetoothEscposPrinter.printPDF417 = (content, options) => printPDF417(content, options || null);
 
  module.exports ={
     BluetoothManager,BluetoothEscposPrinter, BluetoothTscPrinter };
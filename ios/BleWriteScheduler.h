@@ -0,0 +1,33 @@
+//
+//  BleWriteScheduler.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+#import <CoreBluetooth/CoreBluetooth.h>
+#import "RNBluetoothManager.h"
+
+/**
+ * Queues payloads for the printer's write characteristic, splits them into chunks
+ * of maximumWriteValueLengthForType: and paces them with the peripheral's flow control
+ * (canSendWriteWithoutResponse / peripheralIsReadyToSendWriteWithoutResponse:, or the
+ * write response when the characteristic only accepts writes with response).
+ * The delegate of a payload is told once its last chunk has been accepted, for writes with
+ * response once the response of the last chunk has arrived.
+ **/
+@interface BleWriteScheduler : NSObject
+@property (strong,nonatomic) CBPeripheral *peripheral;
+@property (strong,nonatomic) CBCharacteristic *characteristic;
+//NO before iOS 11, which has no canSendWriteWithoutResponse: writes go with response when the
+//characteristic takes them, otherwise one chunk every writeInterval.
+@property (nonatomic) BOOL flowControl;
+@property (nonatomic) NSTimeInterval writeInterval;
+-(id)initWithPeripheral:(CBPeripheral *)peripheral;
+-(void)enqueue:(NSData *)data withDelegate:(NSObject<WriteDataToBleDelegate> *)delegate;
+-(BOOL)hasPendingWrites;
+-(void)pump;
+-(void)didWriteWithResponse:(NSError *)error;
+-(void)failAll;
+@end
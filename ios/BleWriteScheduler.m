@@ -0,0 +1,157 @@
+//
+//  BleWriteScheduler.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "BleWriteScheduler.h"
+
+@interface BleWriteJob : NSObject
+@property NSData *data;
+@property NSUInteger offset;
+@property NSObject<WriteDataToBleDelegate> *delegate;
+@end
+
+@implementation BleWriteJob
+@end
+
+@implementation BleWriteScheduler
+{
+    NSMutableArray<BleWriteJob *> *jobs;
+    BOOL pumping;
+    BOOL awaitingResponse;
+    BOOL awaitingInterval;
+}
+
+-(id)initWithPeripheral:(CBPeripheral *)peripheral
+{
+    if(self = [super init]){
+        _peripheral = peripheral;
+        jobs = [[NSMutableArray alloc] init];
+        if (@available(iOS 11.0, *)) {
+            _flowControl = YES;
+        }
+        _writeInterval = 0.02;//a connection interval, every link carries a packet per interval
+    }
+    return self;
+}
+
+-(void)enqueue:(NSData *)data withDelegate:(NSObject<WriteDataToBleDelegate> *)delegate
+{
+    BleWriteJob *job = [[BleWriteJob alloc] init];
+    job.data = data;
+    job.offset = 0;
+    job.delegate = delegate;
+    [jobs addObject:job];
+    [self pump];
+}
+
+-(BOOL)hasPendingWrites
+{
+    return [jobs count]>0;
+}
+
+-(CBCharacteristicWriteType)writeType
+{
+    CBCharacteristicProperties properties = _characteristic.properties;
+    if((properties & CBCharacteristicPropertyWriteWithoutResponse)
+       && (_flowControl || !(properties & CBCharacteristicPropertyWrite))){
+        return CBCharacteristicWriteWithoutResponse;
+    }
+    return CBCharacteristicWriteWithResponse;
+}
+
+-(BOOL)canSend:(CBCharacteristicWriteType)type
+{
+    if(type == CBCharacteristicWriteWithResponse){
+        return !awaitingResponse;
+    }
+    if(!_flowControl){
+        return !awaitingInterval;
+    }
+    if (@available(iOS 11.0, *)) {
+        return _peripheral.canSendWriteWithoutResponse;
+    }
+    return YES;
+}
+
+/**
+ * Without flow control CoreBluetooth drops what the link can not take, so the next chunk
+ * waits for the next connection interval.
+ **/
+-(void)waitInterval
+{
+    awaitingInterval = YES;
+    dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(_writeInterval * NSEC_PER_SEC)), [RNBluetoothManager printQueue], ^{
+        self->awaitingInterval = NO;
+        [self pump];
+    });
+}
+
+/**
+ * Writes as many chunks as the link accepts right now. Called again from
+ * peripheralIsReadyToSendWriteWithoutResponse: or the write response.
+ * Delegates may enqueue from their callback, the loop just picks the new job up.
+ **/
+-(void)pump
+{
+    if(pumping || !_peripheral || !_characteristic) return;
+    pumping = YES;
+    CBCharacteristicWriteType type = [self writeType];
+    NSUInteger mtu = [_peripheral maximumWriteValueLengthForType:type];
+    if(mtu<1) mtu = 20;//ATT default payload
+    while([jobs count]>0 && [self canSend:type]){
+        BleWriteJob *job = [jobs objectAtIndex:0];
+        NSUInteger length = MIN(mtu, [job.data length]-job.offset);
+        if(length>0){
+            NSData *chunk = [job.data subdataWithRange:NSMakeRange(job.offset, length)];
+            [_peripheral writeValue:chunk forCharacteristic:_characteristic type:type];
+            job.offset = job.offset+length;
+            if(type == CBCharacteristicWriteWithResponse){
+                awaitingResponse = YES;
+            }else if(!_flowControl){
+                [self waitInterval];
+            }
+        }
+        //a job written with response is done when the response of its last chunk arrives
+        if(job.offset>=[job.data length] && !awaitingResponse){
+            [jobs removeObjectAtIndex:0];
+            if(job.delegate) [job.delegate didWriteDataToBle:true];
+        }
+    }
+    pumping = NO;
+}
+
+-(void)didWriteWithResponse:(NSError *)error
+{
+    awaitingResponse = NO;
+    if(error){
+        NSLog(@"Error in writing bluetooth: %@",error);
+        //the job the response belongs to is still queued and fails with the rest
+        [self failAll];
+        return;
+    }
+    BleWriteJob *job = [jobs firstObject];
+    if(job && job.offset>=[job.data length]){
+        [jobs removeObjectAtIndex:0];
+        if(job.delegate) [job.delegate didWriteDataToBle:true];
+    }
+    [self pump];
+}
+
+/**
+ * Fails every pending payload, e.g. when the connection is lost.
+ **/
+-(void)failAll
+{
+    NSArray<BleWriteJob *> *failed = [jobs copy];
+    [jobs removeAllObjects];
+    awaitingResponse = NO;
+    for(BleWriteJob *job in failed){
+        if(job.delegate) [job.delegate didWriteDataToBle:false];
+    }
+}
+@end
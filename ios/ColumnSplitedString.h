@@ -1,11 +0,0 @@
-//
-//  ColumnSplitedString.h
-//  RNBluetoothEscposPrinter
-//
-//  Created by januslo on 2018/10/6.
-//  Copyright © 2018年 Facebook. All rights reserved.
-//
-@interface ColumnSplitedString:NSObject
-@property NSInteger shorter;
-@property NSString *str;
-@end
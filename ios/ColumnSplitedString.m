@@ -1,13 +0,0 @@
-//
-//  ColumnSplitedString.m
-//  RNBluetoothEscposPrinter
-//
-//  Created by januslo on 2018/10/6.
-//  Copyright © 2018年 Facebook. All rights reserved.
-//
-
-#import <Foundation/Foundation.h>
-#import "ColumnSplitedString.h"
-
-@implementation ColumnSplitedString
-@end
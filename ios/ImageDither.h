@@ -0,0 +1,26 @@
+//
+//  ImageDither.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+#import "raster.h"
+
+//the dithering itself is done by raster_dither in cpp/, shared with Android.
+typedef NS_ENUM(NSInteger, DitherMode) {
+    DitherThreshold = RASTER_DITHER_THRESHOLD,//global mean threshold, the original behaviour
+    DitherFloydSteinberg = RASTER_DITHER_FLOYD_STEINBERG,
+    DitherAtkinson = RASTER_DITHER_ATKINSON,
+    DitherBayer4 = RASTER_DITHER_BAYER4,
+    DitherBayer8 = RASTER_DITHER_BAYER8,
+    DitherBayer16 = RASTER_DITHER_BAYER16
+};
+
+@interface ImageDither : NSObject
+/**
+ * "threshold","floyd-steinberg","atkinson","bayer4","bayer8","bayer16", unknown names give fallback.
+ **/
++(DitherMode)modeWithName:(NSString *)name fallback:(DitherMode)fallback;
+@end
@@ -0,0 +1,26 @@
+//
+//  ImageDither.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ImageDither.h"
+
+@implementation ImageDither
+
++(DitherMode)modeWithName:(NSString *)name fallback:(DitherMode)fallback
+{
+    if(![name isKindOfClass:[NSString class]]) return fallback;
+    NSDictionary *modes = @{@"threshold":@(DitherThreshold),
+                            @"floyd-steinberg":@(DitherFloydSteinberg),
+                            @"atkinson":@(DitherAtkinson),
+                            @"bayer4":@(DitherBayer4),
+                            @"bayer8":@(DitherBayer8),
+                            @"bayer16":@(DitherBayer16)};
+    NSNumber *mode = [modes objectForKey:[name lowercaseString]];
+    return mode?[mode integerValue]:fallback;
+}
+@end
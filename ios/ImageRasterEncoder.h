@@ -0,0 +1,33 @@
+//
+//  ImageRasterEncoder.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+#import <CoreGraphics/CoreGraphics.h>
+#import "ImageDither.h"
+
+/**
+ * Converts a CGImage to GS v 0 raster commands a band of scanlines at a time.
+ * Only one band of grey pixels is held in memory, the source is scaled while it
+ * is drawn into the band, so the full-size grey/threshold copies are never built.
+ **/
+@interface ImageRasterEncoder : NSObject
+@property (readonly) NSInteger width;
+@property (readonly) NSInteger height;
+@property (readonly) NSInteger bytesPerLine;
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left;
+/**
+ * rows: scanlines per GS v 0 command, 1 is a header for every line, 0 the whole image in one command.
+ **/
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left rowsPerCommand:(NSInteger)rows;
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left rowsPerCommand:(NSInteger)rows dither:(DitherMode)dither;
+-(BOOL)hasMoreBands;
+-(NSData *)nextBand;
+/**
+ * The GS v 0 commands of all bands not encoded yet.
+ **/
+-(NSData *)remainingBands;
+@end
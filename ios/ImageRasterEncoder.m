@@ -0,0 +1,132 @@
+//
+//  ImageRasterEncoder.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "ImageRasterEncoder.h"
+#import "raster.h"
+
+static const NSInteger BAND_ROWS = 24;
+
+@implementation ImageRasterEncoder
+{
+    CGImageRef _image;
+    CGContextRef _context;
+    uint8_t *_band;// grey pixels of one band, lineWidth x BAND_ROWS
+    NSInteger _left;
+    NSInteger _lineWidth;
+    NSInteger _y;// next row to encode
+    raster_encoder *_encoder;
+}
+
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left
+{
+    return [self initWithImage:image width:width paddingLeft:left rowsPerCommand:1];
+}
+
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left rowsPerCommand:(NSInteger)rows
+{
+    return [self initWithImage:image width:width paddingLeft:left rowsPerCommand:rows dither:DitherThreshold];
+}
+
+-(id)initWithImage:(CGImageRef)image width:(NSInteger)width paddingLeft:(NSInteger)left rowsPerCommand:(NSInteger)rows dither:(DitherMode)dither
+{
+    if(self = [super init]){
+        _image = CGImageRetain(image);
+        _width = width;
+        _height = CGImageGetHeight(image)*width/CGImageGetWidth(image);
+        _left = left>0?left:0;
+        _bytesPerLine = (_left+_width+7)/8;
+        _lineWidth = _bytesPerLine*8;
+        _band = malloc(_lineWidth*BAND_ROWS);
+        CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
+        _context = CGBitmapContextCreate(_band, _lineWidth, BAND_ROWS, 8, _lineWidth, colorSpace, kCGImageAlphaNone);
+        CGColorSpaceRelease(colorSpace);
+        CGContextSetInterpolationQuality(_context, kCGInterpolationHigh);
+        CGContextSetShouldAntialias(_context, NO);
+        raster_options options = {0};
+        options.width = _width;
+        options.left = _left;
+        options.dither = (raster_dither_mode)dither;
+        //only the plain threshold needs the first pass over the image.
+        options.threshold = dither==DitherThreshold?[self averageGrey]:0;
+        options.rows_per_command = rows>0?rows:0;
+        _encoder = raster_encoder_create(&options, _height);
+        _y = 0;
+    }
+    return self;
+}
+
+-(void)dealloc
+{
+    CGContextRelease(_context);
+    CGImageRelease(_image);
+    free(_band);
+    raster_encoder_free(_encoder);
+}
+
+/**
+ * Renders the image rows [y, y+BAND_ROWS) into the band buffer, white outside the image.
+ **/
+-(void)drawBandAt:(NSInteger)y
+{
+    CGContextSetGrayFillColor(_context, 1.0, 1.0);
+    CGContextFillRect(_context, CGRectMake(0, 0, _lineWidth, BAND_ROWS));
+    //CoreGraphics counts from the bottom, the band's top edge is image row y.
+    CGContextDrawImage(_context, CGRectMake(_left, BAND_ROWS+y-_height, _width, _height), _image);
+}
+
+/**
+ * First pass for the global mean threshold, only the image area is counted.
+ **/
+-(uint8_t)averageGrey
+{
+    if(_width<1 || _height<1) return 0;
+    uint64_t graytotal = 0;
+    for(NSInteger y=0;y<_height;y+=BAND_ROWS){
+        [self drawBandAt:y];
+        NSInteger rows = MIN(BAND_ROWS, _height-y);
+        for(NSInteger r=0;r<rows;r++){
+            graytotal += raster_sum(_band+r*_lineWidth+_left, _width);
+        }
+    }
+    return (uint8_t)(graytotal/_height/_width);
+}
+
+-(BOOL)hasMoreBands
+{
+    return _encoder && _y<_height;
+}
+
+/**
+ * The GS v 0 commands of the next band, a command may span several bands.
+ **/
+-(NSData *)nextBand
+{
+    NSInteger rows = MIN(BAND_ROWS, _height-_y);
+    if(rows<=0 || !_encoder) return nil;
+    [self drawBandAt:_y];
+    NSMutableData *data = [[NSMutableData alloc] initWithLength:raster_encoder_max_output(_encoder, rows)];
+    uint8_t *out = [data mutableBytes];
+    size_t length = 0;
+    for(NSInteger r=0;r<rows;r++){
+        length += raster_encoder_escpos_row(_encoder, _band+r*_lineWidth+_left, out+length);
+    }
+    [data setLength:length];
+    _y += rows;
+    return data;
+}
+
+-(NSData *)remainingBands
+{
+    NSMutableData *data = [[NSMutableData alloc] init];
+    while([self hasMoreBands]){
+        [data appendData:[self nextBand]];
+    }
+    return data;
+}
+@end
@@ -8,15 +8,58 @@
 
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
+#import <ImageIO/ImageIO.h>
 #import "ImageUtils.h"
+#import "raster.h"
 @implementation ImageUtils : NSObject
-int p0[] = { 0, 0x80 };
-int p1[] = { 0, 0x40 };
-int p2[] = { 0, 0x20 };
-int p3[] = { 0, 0x10 };
-int p4[] = { 0, 0x08 };
-int p5[] = { 0, 0x04 };
-int p6[] = { 0, 0x02 };
+
+/**
+ * Decodes the encoded image data straight to at most the given width (never upscaled),
+ * with the EXIF orientation applied. The caller owns the returned image.
+ **/
++ (CGImageRef)createImageWithData:(NSData *)data maxWidth:(NSInteger)width
+{
+    CGImageSourceRef source = CGImageSourceCreateWithData((__bridge CFDataRef)data, NULL);
+    if(!source) return NULL;
+    NSDictionary *props = CFBridgingRelease(CGImageSourceCopyPropertiesAtIndex(source, 0, NULL));
+    CGFloat imgWidth = [[props objectForKey:(id)kCGImagePropertyPixelWidth] doubleValue];
+    CGFloat imgHeight = [[props objectForKey:(id)kCGImagePropertyPixelHeight] doubleValue];
+    if([[props objectForKey:(id)kCGImagePropertyOrientation] integerValue]>=5){
+        //rotated by 90 degrees, the displayed width is the pixel height.
+        CGFloat t = imgWidth;
+        imgWidth = imgHeight;
+        imgHeight = t;
+    }
+    if(imgWidth<1 || imgHeight<1){
+        CFRelease(source);
+        return NULL;
+    }
+    CGFloat scale = MIN(1.0, width/imgWidth);
+    NSDictionary *options = @{(id)kCGImageSourceCreateThumbnailFromImageAlways:@YES,
+                              (id)kCGImageSourceCreateThumbnailWithTransform:@YES,
+                              (id)kCGImageSourceThumbnailMaxPixelSize:@(ceil(MAX(imgWidth, imgHeight)*scale))};
+    CGImageRef image = CGImageSourceCreateThumbnailAtIndex(source, 0, (__bridge CFDictionaryRef)options);
+    CFRelease(source);
+    return image;
+}
+
+/**
+ * Grey pixels of the image scaled to width x height, transparent areas are white.
+ * The caller frees the buffer.
+ **/
++ (uint8_t *)greyPixelsOfImage:(CGImageRef)image width:(NSInteger)width height:(NSInteger)height
+{
+    uint8_t *grey = (uint8_t *) malloc(width * height);
+    CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceGray();
+    CGContextRef context = CGBitmapContextCreate(grey, width, height, 8, width, colorSpace, kCGImageAlphaNone);
+    CGColorSpaceRelease(colorSpace);
+    CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
+    CGContextSetGrayFillColor(context, 1.0, 1.0);
+    CGContextFillRect(context, CGRectMake(0, 0, width, height));
+    CGContextDrawImage(context, CGRectMake(0, 0, width, height), image);
+    CGContextRelease(context);
+    return grey;
+}
 
 + (UIImage*)imagePadLeft:(NSInteger) left withSource: (UIImage*)source
 {
@@ -36,19 +79,13 @@ int p6[] = { 0, 0x02 };
 
 +(uint8_t *)imageToGreyImage:(UIImage *)image {
     // Create image rectangle with current image width/height
-    int kRed = 1;
-    int kGreen = 2;
-    int kBlue = 4;
-
-    int colors = kGreen | kBlue | kRed;
-
     CGFloat actualWidth = image.size.width;
     CGFloat actualHeight = image.size.height;
     NSLog(@"actual size: %f,%f",actualWidth,actualHeight);
     uint32_t *rgbImage = (uint32_t *) malloc(actualWidth * actualHeight * sizeof(uint32_t));
     CGColorSpaceRef colorSpace = CGColorSpaceCreateDeviceRGB();
     CGContextRef context = CGBitmapContextCreate(rgbImage, actualWidth, actualHeight, 8, actualWidth*4, colorSpace,
-                                                 kCGBitmapByteOrder32Little | kCGImageAlphaNoneSkipLast);
+                                                 kCGBitmapByteOrderDefault | kCGImageAlphaNoneSkipLast);
     CGContextSetInterpolationQuality(context, kCGInterpolationHigh);
     CGContextSetShouldAntialias(context, NO);
     CGContextDrawImage(context, CGRectMake(0, 0, actualWidth, actualHeight), [image CGImage]);
@@ -76,21 +113,10 @@ int p6[] = { 0, 0x02 };
     
     // Return the new grayscale image
     
-     //now convert to grayscale
+     //now convert to grayscale, the bytes are R,G,B,X
     uint8_t *m_imageData = (uint8_t *) malloc(actualWidth * actualHeight);
-   // NSMutableString *toLog = [[NSMutableString alloc] init];
-    for(int y = 0; y < actualHeight; y++) {
-        for(int x = 0; x < actualWidth; x++) {
-            uint32_t rgbPixel=rgbImage[(int)(y*actualWidth+x)];
-            uint32_t sum=0,count=0;
-            if (colors & kRed) {sum += (rgbPixel>>24)&255; count++;}
-            if (colors & kGreen) {sum += (rgbPixel>>16)&255; count++;}
-            if (colors & kBlue) {sum += (rgbPixel>>8)&255; count++;}
-           // [toLog appendFormat:@"pixel:%d,sum:%d,count:%d,val:%d;",rgbPixel,sum,count,(int)(sum/count)];
-            m_imageData[(int)(y*actualWidth+x)]=sum/count;
-           
-        }
-    }
+    raster_luma((const uint8_t *)rgbImage, (size_t)(actualWidth*actualHeight), RASTER_RGBX, m_imageData);
+    free(rgbImage);
     //NSLog(@"m_imageData:%@",toLog);
     return m_imageData;
 //    // Create image rectangle with current image width/height
@@ -145,133 +171,4 @@ int p6[] = { 0, 0x02 };
     NSData* data = (id)CFBridgingRelease(CGDataProviderCopyData(provider));
     return data;
 }
-
-/**
- **Raster Image - $1D $76 $30 m xL xH yL yH d1...dk
- Prints a raster image
- 
- Format:
- Hex       $1D  $76 30  m xL xH yL yH d1...dk
- 
- ASCII     GS   v   %   m xL xH yL yH d1...dk
- 
- Decimal   29  118  48  m xL xH yL yH d1...dk
- 
- Notes:
- When ​standard mode​ is enabled, this command is only executed when there is no data in the print buffer. (Line is empty)
- The defined data (​d​) defines each byte of the raster image. Each bit in every byte defines a pixel. A bit set to 1 is printed and a bit set to 0 is not printed.
- If a raster bit image exceeds one line, the excess data is not printed.
- This command feeds as much paper as is required to print the entire raster bit image, regardless of line spacing defined by 1/6” or 1/8” commands.
- After the raster bit image is printed, the print position goes to the beginning of the line.
- The following commands have no effect on a raster bit image:
- Emphasized
- Double Strike
- Underline
- White/Black Inverse Printing
- Upside-Down Printing
- Rotation
- Left margin
- Print Area Width
- A raster bit image data is printed in the following order:
- d1    d2    …    dx
- dx + 1    dx + 2    …    dx * 2
- .    .    .    .
- …    dk - 2    dk - 1    dk
- Defines and prints a raster bit image using the mode specified by ​m​:
- m    Mode    Width Scalar    Heigh Scalar
- 0, 48    Normal    x1    x1
- 1, 49    Double Width    x2    x1
- 2, 50    Double Height    x1    x2
- 3, 51    Double Width/Height    x2    x2
- xL, xH ​defines the raster bit image in the horizontal direction in ​bytes​ using two-byte number definitions. (​xL + (xH * 256)) Bytes
- yL, yH ​defines the raster bit image in the vertical direction in ​dots​ using two-byte number definitions. (​yL + (yH * 256)) Dots
- d ​ specifies the bit image data in raster format.
- k ​indicates the number of bytes in the bit image. ​k ​is not transmitted and is there for explanation only.
- **/
-+ (NSData *)eachLinePixToCmd:(unsigned char *)src nWidth:(NSInteger) nWidth nHeight:(NSInteger) nHeight nMode:(NSInteger) nMode
-{
-    NSLog(@"SIZE OF SRC: %lu",sizeof(&src));
-    NSInteger nBytesPerLine = (int)nWidth/8;
-    unsigned char * data = malloc(nHeight*(8+nBytesPerLine));
-   // const char* srcData = (const char*)[src bytes];
-    NSInteger k = 0;
-   // NSMutableString *toLog = [[NSMutableString alloc] init];
-    for(int i=0;i<nHeight;i++){
-        NSInteger var10 = i*(8+nBytesPerLine);
-         //GS v 0 m xL xH yL yH d1....dk 打印光栅位图
-                data[var10 + 0] = 29;//GS
-                data[var10 + 1] = 118;//v
-                data[var10 + 2] = 48;//0
-                data[var10 + 3] =  (unsigned char)(nMode & 1);
-                data[var10 + 4] =  (unsigned char)(nBytesPerLine % 256);//xL
-                data[var10 + 5] =  (unsigned char)(nBytesPerLine / 256);//xH
-                data[var10 + 6] = 1;//yL
-                data[var10 + 7] = 0;//yH
-//        for(int l=0;l<8;l++){
-//            NSInteger d =data[var10 + l];
-//            [toLog appendFormat:@"%ld,",(long)d];
-//        }
-        
-        for (int j = 0; j < nBytesPerLine; ++j) {
-            data[var10 + 8 + j] = (int) (p0[src[k]] + p1[src[k + 1]] + p2[src[k + 2]] + p3[src[k + 3]] + p4[src[k + 4]] + p5[src[k + 5]] + p6[src[k + 6]] + src[k + 7]);
-            k =k+8;
-             //  [toLog appendFormat:@"%ld,",(long)data[var10+8+j]];
-        }
-       // [toLog appendString:@"\n\r"];
-    }
-   // NSLog(@"line datas: %@",toLog);
-    return [NSData dataWithBytes:data length:nHeight*(8+nBytesPerLine)];
-}
-
-+(unsigned char *)format_K_threshold:(unsigned char *) orgpixels
-                        width:(NSInteger) xsize height:(NSInteger) ysize
-{
-    unsigned char * despixels = malloc(xsize*ysize);
-    int graytotal = 0;
-    int k = 0;
-    
-    int i;
-    int j;
-    int gray;
-    for(i = 0; i < ysize; ++i) {
-        for(j = 0; j < xsize; ++j) {
-            gray = orgpixels[k] & 255;
-            graytotal += gray;
-            ++k;
-        }
-    }
-    
-    int grayave = graytotal / ysize / xsize;
-    k = 0;
-   // NSMutableString *logStr = [[NSMutableString alloc]init];
-   // int oneCount = 0;
-    for(i = 0; i < ysize; ++i) {
-        for(j = 0; j < xsize; ++j) {
-            gray = orgpixels[k] & 255;
-            if(gray > grayave) {
-                despixels[k] = 0;
-            } else {
-                despixels[k] = 1;
-               // oneCount++;
-            }
-            
-            ++k;
-           // [logStr appendFormat:@"%d,",despixels[k]];
-        }
-    }
-   // NSLog(@"despixels [with 1 count:%d]: %@",oneCount,logStr);
-    return despixels;
-}
-+(NSData *)pixToTscCmd:(uint8_t *)src width:(NSInteger) width
-{
-    int length = (int)width/8;
-    uint8_t * data = malloc(length);
-    int k = 0;
-    for(int j = 0;k<length;++k){
-        data[k] =(uint8_t)(p0[src[j]] + p1[src[j + 1]] + p2[src[j + 2]] + p3[src[j + 3]] + p4[src[j + 4]] + p5[src[j + 5]] + p6[src[j + 6]] + src[j + 7]);
-        j+=8;
-    }
-    return [[NSData alloc] initWithBytes:data length:length];
-}
-
 @end
@@ -0,0 +1,20 @@
+//
+//  LabelBatch.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <React/RCTBridgeModule.h>
+#import "RNBluetoothManager.h"
+
+/**
+ * The labels of one printLabels call. A label is built only when it is about to be written,
+ * DEPTH labels are in the write scheduler at a time so the link does not idle between them.
+ * EVENT_LABEL_PRINTED {index, total} is emitted as each label is written.
+ **/
+@interface LabelBatch : NSObject<WriteDataToBleDelegate>
+-(id)initWithCount:(NSUInteger)total build:(NSData *(^)(NSUInteger index))build
+          resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject;
+-(void)start;
+@end
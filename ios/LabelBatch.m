@@ -0,0 +1,82 @@
+//
+//  LabelBatch.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "LabelBatch.h"
+
+static const NSUInteger DEPTH = 2;
+
+@implementation LabelBatch
+{
+    NSUInteger total;
+    NSUInteger queued;
+    NSUInteger printed;
+    BOOL failed;
+    NSData *(^build)(NSUInteger index);
+    RCTPromiseResolveBlock pendingResolve;
+    RCTPromiseRejectBlock pendingReject;
+}
+
+-(id)initWithCount:(NSUInteger)count build:(NSData *(^)(NSUInteger index))builder
+          resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject
+{
+    if(self = [super init]){
+        total = count;
+        build = builder;
+        pendingResolve = resolve;
+        pendingReject = reject;
+    }
+    return self;
+}
+
+-(void)start
+{
+    if(total == 0){
+        [self finish:YES];
+        return;
+    }
+    while(queued < total && queued < DEPTH){
+        [self enqueueNext];
+    }
+}
+
+-(void)enqueueNext
+{
+    NSData *label = build(queued++);
+    [RNBluetoothManager writeValue:label withDelegate:self];
+}
+
+- (void) didWriteDataToBle: (BOOL)success
+{
+    if(failed) return;
+    if(!success){
+        failed = YES;
+        [self finish:NO];
+        return;
+    }
+    [RNBluetoothManager emitEvent:EVENT_LABEL_PRINTED body:@{@"index":@(printed),@"total":@(total)}];
+    printed++;
+    if(printed == total){
+        [self finish:YES];
+    }else if(queued < total){
+        [self enqueueNext];
+    }
+}
+
+-(void)finish:(BOOL)success
+{
+    if(success){
+        if(pendingResolve) pendingResolve(nil);
+    }else if(pendingReject){
+        pendingReject(@"PRINT_ERROR",@"PRINT_ERROR",nil);
+    }
+    pendingResolve = nil;
+    pendingReject = nil;
+    build = nil;
+}
+@end
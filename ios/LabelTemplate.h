@@ -0,0 +1,29 @@
+//
+//  LabelTemplate.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+#import "RNTscCommand.h"
+
+/**
+ * A label compiled once by compileLabelTemplate: the setup commands (SIZE, GAP, DIRECTION, ...)
+ * and the body from CLS on, images already rasterized. The text, QR code and barcode entries that
+ * name a slot are compiled with empty content, a print copies the slot values in at their offsets.
+ **/
+@interface LabelTemplate : NSObject
+@property NSData *setup;
+@property NSData *body;
+@property BOOL sound;
+/**
+ * The command just added to body ends with the closing quote of its content and "\r\n",
+ * the slot value goes in front of them.
+ **/
+-(void)markSlot:(NSString *)name in:(RNTscCommand *)body defaultValue:(NSString *)value;
+/**
+ * Appends the body with the slot values, a slot without a value keeps the compiled text.
+ **/
+-(void)appendBodyTo:(NSMutableData *)data values:(NSDictionary *)values;
+@end
@@ -0,0 +1,48 @@
+//
+//  LabelTemplate.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import "LabelTemplate.h"
+
+@implementation LabelTemplate
+{
+    NSMutableArray<NSNumber *> *_offsets;
+    NSMutableArray<NSString *> *_names;
+    NSMutableArray<NSData *> *_defaults;
+}
+
+-(instancetype)init
+{
+    if (self = [super init]) {
+        _offsets = [[NSMutableArray alloc] init];
+        _names = [[NSMutableArray alloc] init];
+        _defaults = [[NSMutableArray alloc] init];
+    }
+    return self;
+}
+
+-(void)markSlot:(NSString *)name in:(RNTscCommand *)body defaultValue:(NSString *)value
+{
+    [_offsets addObject:@([body.command length] - 3)];
+    [_names addObject:name];
+    [_defaults addObject:[RNTscCommand encode:value ? value : @""]];
+}
+
+-(void)appendBodyTo:(NSMutableData *)data values:(NSDictionary *)values
+{
+    const uint8_t *bytes = [_body bytes];
+    NSUInteger at = 0;
+    for (NSUInteger i = 0; i < [_offsets count]; i++) {
+        NSUInteger offset = [[_offsets objectAtIndex:i] unsignedIntegerValue];
+        [data appendBytes:bytes + at length:offset - at];
+        id value = [values objectForKey:[_names objectAtIndex:i]];
+        if ([value isKindOfClass:[NSNumber class]]) value = [value stringValue];
+        [data appendData:[value isKindOfClass:[NSString class]] ? [RNTscCommand encode:value] : [_defaults objectAtIndex:i]];
+        at = offset;
+    }
+    [data appendBytes:bytes + at length:[_body length] - at];
+}
+@end
@@ -0,0 +1,22 @@
+//
+//  NvImageStore.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+
+/**
+ * Remembers which NV graphics were stored in which printer, by printer address.
+ * Every key maps to the hash of the image it was defined with, so an unchanged
+ * image is not written to the printer's flash again.
+ **/
+@interface NvImageStore : NSObject
++(instancetype)sharedStore;
+-(NSString *)hashForKey:(NSString *)key address:(NSString *)address;
+-(void)setHash:(NSString *)hash forKey:(NSString *)key address:(NSString *)address;
+-(void)removeKey:(NSString *)key address:(NSString *)address;
+-(void)removeAllForAddress:(NSString *)address;
+-(NSArray<NSString *> *)keysForAddress:(NSString *)address;
+@end
@@ -0,0 +1,76 @@
+//
+//  NvImageStore.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "NvImageStore.h"
+
+static NSString *const DEFAULTS_KEY = @"RNBluetoothEscposPrinter.nvImages";
+
+@implementation NvImageStore
+
++(instancetype)sharedStore
+{
+    static NvImageStore *store;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        store = [[NvImageStore alloc] init];
+    });
+    return store;
+}
+
+/**
+ * address -> {key -> hash}
+ **/
+-(NSMutableDictionary *)printers
+{
+    NSDictionary *stored = [[NSUserDefaults standardUserDefaults] dictionaryForKey:DEFAULTS_KEY];
+    return stored?[stored mutableCopy]:[[NSMutableDictionary alloc] init];
+}
+
+-(void)setImages:(NSDictionary *)images forAddress:(NSString *)address
+{
+    NSMutableDictionary *printers = [self printers];
+    if([images count]>0){
+        [printers setObject:images forKey:address];
+    }else{
+        [printers removeObjectForKey:address];
+    }
+    [[NSUserDefaults standardUserDefaults] setObject:printers forKey:DEFAULTS_KEY];
+}
+
+-(NSString *)hashForKey:(NSString *)key address:(NSString *)address
+{
+    return [[[self printers] objectForKey:address] objectForKey:key];
+}
+
+-(void)setHash:(NSString *)hash forKey:(NSString *)key address:(NSString *)address
+{
+    NSMutableDictionary *images = [[[self printers] objectForKey:address] mutableCopy];
+    if(!images) images = [[NSMutableDictionary alloc] init];
+    [images setObject:hash forKey:key];
+    [self setImages:images forAddress:address];
+}
+
+-(void)removeKey:(NSString *)key address:(NSString *)address
+{
+    NSMutableDictionary *images = [[[self printers] objectForKey:address] mutableCopy];
+    [images removeObjectForKey:key];
+    [self setImages:images forAddress:address];
+}
+
+-(void)removeAllForAddress:(NSString *)address
+{
+    [self setImages:nil forAddress:address];
+}
+
+-(NSArray<NSString *> *)keysForAddress:(NSString *)address
+{
+    NSDictionary *images = [[self printers] objectForKey:address];
+    return images?[images allKeys]:@[];
+}
+@end
@@ -8,10 +8,13 @@
 #import <React/RCTBridgeModule.h>
 #import "RNBluetoothManager.h"
 #import "RNBluetoothEscposPrinter.h"
+#import "ImageRasterEncoder.h"
 @interface PrintImageBleWriteDelegate :NSObject<WriteDataToBleDelegate>
-@property NSData *toPrint;
-@property NSInteger width;
-@property NSInteger now;
+@property ImageRasterEncoder *encoder;
+//already encoded GS v 0 commands, sent in place of the encoder's bands.
+@property NSData *raster;
+//handed the whole raster once the encoder has been drained, e.g. to cache it.
+@property (copy) void (^didEncode)(NSData *raster);
 @property RNBluetoothManager *printer;
 @property RCTPromiseRejectBlock pendingReject;
 @property RCTPromiseResolveBlock pendingResolve;
@@ -9,53 +9,73 @@
 #import <Foundation/Foundation.h>
 #import "PrintImageBleWriteDelegate.h"
 @implementation PrintImageBleWriteDelegate
-
+{
+    NSInteger inFlight;// bands handed to the transport and not yet written
+    BOOL tailSent;
+    BOOL rasterSent;
+    BOOL failed;
+    NSMutableData *encoded;
+}
 
 - (void) didWriteDataToBle: (BOOL)success
 {NSLog(@"PrintImageBleWriteDelete diWriteDataToBle: %d",success?1:0);
-    if(success){
-        if(_now == -1){
-             if(_pendingResolve) {_pendingResolve(nil); _pendingResolve=nil;}
-        }else if(_now>=[_toPrint length]){
-//            ASCII ESC M 0 CR LF
-//            Hex 1B 4D 0 0D 0A
-//            Decimal 27 77 0 13 10
-            unsigned char * initPrinter = malloc(5);
-            initPrinter[0]=27;
-            initPrinter[1]=77;
-            initPrinter[2]=0;
-            initPrinter[3]=13;
-            initPrinter[4]=10;
-            [RNBluetoothManager writeValue:[NSData dataWithBytes:initPrinter length:5] withDelegate:self];
-            _now = -1;
-            [NSThread sleepForTimeInterval:0.01f];
-        }else {
-            [self print];
+    inFlight--;
+    if(failed) return;
+    if(!success){
+        failed = YES;
+        if(_pendingReject){
+            _pendingReject(@"PRINT_IMAGE_FAILED",@"PRINT_IMAGE_FAILED",nil);
+            _pendingReject = nil;
         }
-    }else if(_pendingReject){
-        _pendingReject(@"PRINT_IMAGE_FAILED",@"PRINT_IMAGE_FAILED",nil);
-        _pendingReject = nil;
+        return;
     }
-    
+    if(tailSent && inFlight==0){
+        if(_pendingResolve) {_pendingResolve(nil); _pendingResolve=nil;}
+        return;
+    }
+    [self fill];
 }
 
+/**
+ * Streams the raster band by band, two bands are kept queued so the link never idles
+ * while the next band is encoded.
+ **/
 -(void) print
 {
-    @synchronized (self) {
-     NSInteger sizePerLine = (int)(_width/8);
-   // do{
-//        if(sizePerLine+_now>=[_toPrint length]){
-//            sizePerLine = [_toPrint length] - _now;
-//        }
-       // if(sizePerLine>0){
-            NSData *subData = [_toPrint subdataWithRange:NSMakeRange(_now, sizePerLine)];
-            NSLog(@"Write data:%@",subData);
-            [RNBluetoothManager writeValue:subData withDelegate:self];
-        //}
-        _now = _now+sizePerLine;
-        [NSThread sleepForTimeInterval:0.01f];
-        
+    inFlight = 0;
+    tailSent = NO;
+    rasterSent = NO;
+    failed = NO;
+    encoded = _didEncode?[[NSMutableData alloc] init]:nil;
+    [self fill];
+}
+
+-(void) fill
+{
+    if(!failed && _raster && !rasterSent){
+        rasterSent = YES;
+        inFlight++;
+        [RNBluetoothManager writeValue:_raster withDelegate:self];
+    }
+    while(!failed && inFlight<2 && [_encoder hasMoreBands]){
+        NSData *band = [_encoder nextBand];
+        [encoded appendData:band];
+        inFlight++;
+        [RNBluetoothManager writeValue:band withDelegate:self];
+    }
+    if(_didEncode && _encoder && ![_encoder hasMoreBands]){
+        _didEncode(encoded);
+        _didEncode = nil;
+        encoded = nil;
+    }
+    if(!failed && !tailSent && inFlight==0 && ![_encoder hasMoreBands]){
+//            ASCII ESC M 0 CR LF
+//            Hex 1B 4D 0 0D 0A
+//            Decimal 27 77 0 13 10
+        unsigned char initPrinter[] = {27,77,0,13,10};
+        tailSent = YES;
+        inFlight++;
+        [RNBluetoothManager writeValue:[NSData dataWithBytes:initPrinter length:5] withDelegate:self];
     }
-    //}while(_now<[_toPrint length]);
 }
 @end
@@ -0,0 +1,23 @@
+//
+//  PrinterProfile.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+
+/**
+ * Capabilities of the connected ESC/POS printer, set from javascript with setPrinterProfile.
+ **/
+@interface PrinterProfile : NSObject
+//rows packed under one GS v 0 header: 1 for printers that only take a scanline per command,
+//0 for the whole image in one command.
+@property (nonatomic,assign) NSInteger rasterRows;
+//whether the printer renders QR codes and PDF417 symbols itself from GS ( k,
+//used by the symbol methods in auto mode.
+@property (nonatomic,assign) BOOL nativeQRCode;
+@property (nonatomic,assign) BOOL nativePDF417;
++(instancetype)defaultProfile;
++(instancetype)profileWithOptions:(NSDictionary *)options;
+@end
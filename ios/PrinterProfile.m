@@ -0,0 +1,39 @@
+//
+//  PrinterProfile.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PrinterProfile.h"
+
+@implementation PrinterProfile
+
++(instancetype)defaultProfile
+{
+    PrinterProfile *profile = [[PrinterProfile alloc] init];
+    profile.rasterRows = 24;
+    return profile;
+}
+
+/**
+ * Missing keys keep the default values.
+ **/
++(instancetype)profileWithOptions:(NSDictionary *)options
+{
+    PrinterProfile *profile = [PrinterProfile defaultProfile];
+    if([options objectForKey:@"rasterRows"]){
+        NSInteger rows = [[options valueForKey:@"rasterRows"] integerValue];
+        profile.rasterRows = MAX(0, MIN(rows, 0xffff));
+    }
+    if([options objectForKey:@"nativeQRCode"]){
+        profile.nativeQRCode = [[options valueForKey:@"nativeQRCode"] boolValue];
+    }
+    if([options objectForKey:@"nativePDF417"]){
+        profile.nativePDF417 = [[options valueForKey:@"nativePDF417"] boolValue];
+    }
+    return profile;
+}
+@end
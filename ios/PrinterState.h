@@ -0,0 +1,33 @@
+//
+//  PrinterState.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+
+/**
+ * The print mode the printer is in, as far as the commands built since the connection tell.
+ * The mode commands only append the settings that differ from it, e.g. the GS ! / ESC t / FS & / ESC M
+ * in front of every text is dropped when the previous text used the same options.
+ **/
+@interface PrinterState : NSObject <NSCopying>
+//RNBluetoothManager connectionId the mode was built for, the mode is forgotten on a new connection.
+@property (nonatomic,assign) NSUInteger connectionId;
+//forgets the mode, after a reconnect or a write that may not have reached the printer.
+-(void)invalidate;
+//the power-on mode ESC @ returns to.
+-(void)reset;
+-(void)restore:(PrinterState *)other;
+//GS ! n, ESC t n, FS & (codePage 0) or FS . and ESC M n, only those that change.
+-(void)appendTextSize:(Byte)size codePage:(Byte)codePage font:(Byte)font to:(NSMutableData *)data;
+//ESC G n and ESC E n
+-(void)appendBold:(Byte)bold to:(NSMutableData *)data;
+//ESC - n and FS - n
+-(void)appendUnderline:(Byte)line to:(NSMutableData *)data;
+//ESC a n, 0/48 left, 1/49 center, 2/50 right
+-(void)appendAlign:(Byte)align to:(NSMutableData *)data;
+//ESC M 0 was sent, e.g. after an image
+-(void)didResetFont;
+@end
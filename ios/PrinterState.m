@@ -0,0 +1,122 @@
+//
+//  PrinterState.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PrinterState.h"
+
+static const NSInteger UNKNOWN = -1;
+
+@implementation PrinterState
+{
+    NSInteger _size;
+    NSInteger _codePage;
+    NSInteger _kanji;
+    NSInteger _font;
+    NSInteger _bold;
+    NSInteger _underline;
+    NSInteger _align;
+}
+
+-(id)init
+{
+    if(self = [super init]){
+        [self invalidate];
+    }
+    return self;
+}
+
+-(void)invalidate
+{
+    _size = _codePage = _kanji = _font = _bold = _underline = _align = UNKNOWN;
+}
+
+/**
+ * ESC @ leaves Kanji mode as the printer's memory switches set it, it stays unknown.
+ **/
+-(void)reset
+{
+    _size = _codePage = _font = _bold = _underline = _align = 0;
+    _kanji = UNKNOWN;
+}
+
+-(id)copyWithZone:(NSZone *)zone
+{
+    PrinterState *state = [[PrinterState allocWithZone:zone] init];
+    [state restore:self];
+    return state;
+}
+
+-(void)restore:(PrinterState *)other
+{
+    _connectionId = other->_connectionId;
+    _size = other->_size;
+    _codePage = other->_codePage;
+    _kanji = other->_kanji;
+    _font = other->_font;
+    _bold = other->_bold;
+    _underline = other->_underline;
+    _align = other->_align;
+}
+
+static void append(NSMutableData *data, Byte c1, Byte c2, Byte n)
+{
+    Byte command[] = {c1,c2,n};
+    [data appendBytes:command length:3];
+}
+
+-(void)appendTextSize:(Byte)size codePage:(Byte)codePage font:(Byte)font to:(NSMutableData *)data
+{
+    NSInteger kanji = codePage==0?1:0;
+    if(_size!=size){
+        append(data,0x1d,'!',size);
+        _size = size;
+    }
+    if(_codePage!=codePage){
+        append(data,0x1b,'t',codePage);
+        _codePage = codePage;
+    }
+    if(_kanji!=kanji){
+        Byte command[] = {0x1c,kanji?'&':'.'};
+        [data appendBytes:command length:2];
+        _kanji = kanji;
+    }
+    if(_font!=font){
+        append(data,0x1b,'M',font);
+        _font = font;
+    }
+}
+
+-(void)appendBold:(Byte)bold to:(NSMutableData *)data
+{
+    if(_bold==(bold&1)) return;
+    append(data,0x1b,'G',bold);
+    append(data,0x1b,'E',bold);
+    _bold = bold&1;
+}
+
+-(void)appendUnderline:(Byte)line to:(NSMutableData *)data
+{
+    if(_underline==line) return;
+    append(data,0x1b,45,line);
+    append(data,0x1c,45,line);
+    _underline = line;
+}
+
+-(void)appendAlign:(Byte)align to:(NSMutableData *)data
+{
+    NSInteger value = align>=48?align-48:align;
+    if(_align==value) return;
+    append(data,0x1b,'a',align);
+    _align = value;
+}
+
+-(void)didResetFont
+{
+    _font = 0;
+}
+@end
@@ -0,0 +1,19 @@
+//
+//  PromiseBleWriteDelegate.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <React/RCTBridgeModule.h>
+#import "RNBluetoothManager.h"
+
+/**
+ * Settles the promise of one command once its payload has been written, every write
+ * has its own delegate so commands queued behind each other keep their own promise.
+ **/
+@interface PromiseBleWriteDelegate : NSObject<WriteDataToBleDelegate>
+@property (copy) RCTPromiseResolveBlock pendingResolve;
+@property (copy) RCTPromiseRejectBlock pendingReject;
++(instancetype)delegateWithResolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject;
+@end
@@ -0,0 +1,32 @@
+//
+//  PromiseBleWriteDelegate.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import "PromiseBleWriteDelegate.h"
+
+@implementation PromiseBleWriteDelegate
+
++(instancetype)delegateWithResolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject
+{
+    PromiseBleWriteDelegate *delegate = [[PromiseBleWriteDelegate alloc] init];
+    delegate.pendingResolve = resolve;
+    delegate.pendingReject = reject;
+    return delegate;
+}
+
+- (void) didWriteDataToBle: (BOOL)success
+{
+    if(success){
+        if(_pendingResolve) _pendingResolve(nil);
+    }else if(_pendingReject){
+        _pendingReject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+    }
+    _pendingResolve = nil;
+    _pendingReject = nil;
+}
+@end
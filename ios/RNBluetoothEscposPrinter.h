@@ -1,16 +1,12 @@
-
 #import <React/RCTBridgeModule.h>
 #import "RNBluetoothManager.h";
+#import "PrinterProfile.h"
+#import "PrinterState.h"
 
-@interface RNBluetoothEscposPrinter : NSObject <RCTBridgeModule,WriteDataToBleDelegate>
+@interface RNBluetoothEscposPrinter : NSObject <RCTBridgeModule>
 
 @property (nonatomic,assign) NSInteger deviceWidth;
--(void) textPrint:(NSString *) text
-       inEncoding:(NSString *) encoding
-     withCodePage:(NSInteger) codePage
-       widthTimes:(NSInteger) widthTimes
-      heightTimes:(NSInteger) heightTimes
-         fontType:(NSInteger) fontType
-         delegate:(NSObject<WriteDataToBleDelegate> *) delegate;
+@property (nonatomic,strong) PrinterProfile *profile;
+@property (nonatomic,strong) PrinterState *printerState;
 @end
   
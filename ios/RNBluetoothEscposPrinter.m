@@ -1,13 +1,17 @@
-
 #import <Foundation/Foundation.h>
 #import <UIKit/UIKit.h>
 #import "RNBluetoothManager.h"
 #import "RNBluetoothEscposPrinter.h"
-#import "ColumnSplitedString.h"
-#import "PrintColumnBleWriteDelegate.h"
+#import "PromiseBleWriteDelegate.h"
 #import "ImageUtils.h"
 #import "VZZXingObjC.h"
 #import "PrintImageBleWriteDelegate.h"
+#import "ImageRasterEncoder.h"
+#import "RasterCache.h"
+#import "NvImageStore.h"
+#import "raster.h"
+#import "text_layout.h"
+#import "text_encode.h"
 @implementation RNBluetoothEscposPrinter
 
 int WIDTH_58 = 384;
@@ -35,12 +39,14 @@ Byte A[] = {0x61};//a
 Byte E[] = {0x45};//E
 Byte G[] = {0x47};//G
 
-RCTPromiseResolveBlock pendingResolve;
-RCTPromiseRejectBlock pendingReject;
+//ESC M 0 CR LF, sent after an image
+Byte PIC_TAIL[] = {27,77,0,13,10};
 
 -(id)init {
     if (self = [super init])  {
         self.deviceWidth = WIDTH_58;
+        self.profile = [PrinterProfile defaultProfile];
+        self.printerState = [[PrinterState alloc] init];
     }
     return self;
 }
@@ -48,7 +54,7 @@ RCTPromiseRejectBlock pendingReject;
 
 - (dispatch_queue_t)methodQueue
 {
-    return dispatch_get_main_queue();
+    return [RNBluetoothManager printQueue];
 }
 + (BOOL)requiresMainQueueSetup
 {
@@ -75,6 +81,52 @@ RCT_EXPORT_METHOD(setWidth:(int) width)
     self.deviceWidth = width;
 }
 
+/**
+ * Sets what the connected printer supports, e.g. {rasterRows:24}
+ **/
+RCT_EXPORT_METHOD(setPrinterProfile:(NSDictionary *) options)
+{
+    self.profile = [PrinterProfile profileWithOptions:options];
+}
+
+/**
+ * The printer's mode for the mode commands, forgotten when the printer was reconnected.
+ **/
+-(PrinterState *)mode
+{
+    if(self.printerState.connectionId!=[RNBluetoothManager connectionId]){
+        [self.printerState invalidate];
+        self.printerState.connectionId = [RNBluetoothManager connectionId];
+    }
+    return self.printerState;
+}
+
+/**
+ * Writes one command, the promise is settled once it has been handed to the printer.
+ * An invalid command (nil data) is rejected with code, an empty one (the printer is in
+ * that mode already) is resolved without a write.
+ **/
+-(void)send:(NSData *)data invalid:(NSString *)code
+   resolver:(RCTPromiseResolveBlock)resolve
+   rejecter:(RCTPromiseRejectBlock)reject
+{
+    PrinterState *state = self.printerState;
+    if(!data){
+        reject(code,code,nil);
+    }else if(!RNBluetoothManager.isConnected){
+        [state invalidate];
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+    }else if([data length]==0){
+        resolve(nil);
+    }else{
+        [RNBluetoothManager writeValue:data withDelegate:[PromiseBleWriteDelegate delegateWithResolver:resolve rejecter:^(NSString *code, NSString *message, NSError *error){
+            //the mode commands may not have reached the printer
+            [state invalidate];
+            reject(code,message,error);
+        }]];
+    }
+}
+
 //public void printerInit(final Promise promise){
 //    if(sendDataByte(PrinterCommand.POS_Set_PrtInit())){
 //        promise.resolve(null);
@@ -82,214 +134,241 @@ RCT_EXPORT_METHOD(setWidth:(int) width)
 //        promise.reject("COMMAND_NOT_SEND");
 //    }
 //}
+-(NSData *)initData
+{
+    NSMutableData *data = [[NSMutableData alloc] init];
+    Byte at[] = {'@'};
+    [data appendBytes:ESC length:1];
+    [data appendBytes:at length:1];
+    [[self mode] reset];
+    return data;
+}
 
 RCT_EXPORT_METHOD(printerInit:(RCTPromiseResolveBlock)resolve
                   rejecter:(RCTPromiseRejectBlock)reject)
 {
-    if(RNBluetoothManager.isConnected){
-        NSMutableData *data = [[NSMutableData alloc] init];
-        Byte at[] = {'@'};
-        [data appendBytes:ESC length:1];
-        [data appendBytes:at length:1];
-        pendingResolve = resolve;
-        pendingReject = reject;
-        [RNBluetoothManager writeValue:data withDelegate:self];
-    }else{
-        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
-    }
-    
+    [self send:[self initData] invalid:nil resolver:resolve rejecter:reject];
 }
 
 //{GS, 'L', 0x00 , 0x00 }
-// data[2] = (byte) (left % 100);
-//data[3] = (byte) (left / 100);
+// data[2] = (byte) (left % 0x100);
+//data[3] = (byte) (left / 0x100);
+-(NSData *)leftSpaceData:(NSInteger)sp
+{
+    if(sp>255 || sp<0) return nil;
+    NSMutableData *data = [[NSMutableData alloc] init];
+    Byte left[] = {'L'};
+    Byte sp_up[] = {(sp%256)};
+    Byte sp_down[] = {(sp/256)};
+    [data appendBytes:ESC_GS length:1];
+    [data appendBytes:left length:1];
+    [data appendBytes:sp_up length:1];
+    [data appendBytes:sp_down length:1];
+    return data;
+}
+
 RCT_EXPORT_METHOD(printerLeftSpace:(int) sp
                   withResolver:(RCTPromiseResolveBlock)resolve
                   rejecter:(RCTPromiseRejectBlock)reject)
 {
-    if(sp>255 || sp<0){
-        reject(@"COMMAND_NOT_SEND",@"INVALID_VALUE",nil);
-        return;
-    }
-    
-    if(RNBluetoothManager.isConnected){
-        NSMutableData *data = [[NSMutableData alloc] init];
-        Byte left[] = {'L'};
-        Byte sp_up[] = {(sp%100)};
-        Byte sp_down[] = {(sp/100)};
-        [data appendBytes:ESC_GS length:1];
-        [data appendBytes:left length:1];
-        [data appendBytes:sp_up length:1];
-        [data appendBytes:sp_down length:1];
-        pendingResolve = resolve;
-        pendingReject = reject;
-        [RNBluetoothManager writeValue:data withDelegate:self];
+    [self send:[self leftSpaceData:sp] invalid:@"INVALID_VALUE" resolver:resolve rejecter:reject];
+}
+
+//{ESC, '2'} default, {ESC, '3', n}
+-(NSData *)lineSpaceData:(NSInteger)sp
+{
+    if(sp>255) return nil;
+    NSMutableData *data = [[NSMutableData alloc] init];
+    [data appendBytes:ESC length:1];
+    if(sp>0){
+        Byte command[] = {'3',sp};
+        [data appendBytes:command length:2];
     }else{
-        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        Byte command[] = {'2'};
+        [data appendBytes:command length:1];
     }
+    return data;
+}
+
+//{ESC, 'J', n}
+-(NSData *)feedData:(NSInteger)feed
+{
+    if(feed>255 || feed<0) return nil;
+    Byte command[] = {27,'J',feed};
+    return [NSData dataWithBytes:command length:3];
 }
 
 //{ESC, 45, 0x00 };
 //{FS, 45, 0x00 };
+-(NSData *)underLineData:(NSInteger)sp
+{
+    if(sp<0 || sp>2) return nil;
+    NSMutableData *data = [[NSMutableData alloc] init];
+    [[self mode] appendUnderline:sp to:data];
+    return data;
+}
+
 RCT_EXPORT_METHOD(printerUnderLine:(int)sp withResolver:(RCTPromiseResolveBlock) resolve
                   rejecter:(RCTPromiseRejectBlock) reject)
 {
-    if(sp<0 || sp>2){
-          reject(@"COMMAND_NOT_SEND",@"INVALID_VALUE",nil);
-        return;
-    }
-    if(RNBluetoothManager.isConnected){
-        NSMutableData *data = [[NSMutableData alloc] init];
-        Byte under_line[] = {45};
-        Byte spb[] = {sp};
-        [data appendBytes:ESC length:1];
-        [data appendBytes:under_line length:1];
-        [data appendBytes:spb length:1];
-        [data appendBytes:ESC_FS length:1];
-        [data appendBytes:under_line length:1];
-        [data appendBytes:spb length:1];
-        pendingResolve = resolve;
-        pendingReject = reject;
-        [RNBluetoothManager writeValue:data withDelegate:self];
-    }else{
-        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+    [self send:[self underLineData:sp] invalid:@"INVALID_VALUE" resolver:resolve rejecter:reject];
+}
+
+/**
+ * encoding:'GBK', codepage:0, widthtimes:0, heigthtimes:0, fontType:0, fallback:'?'
+ **/
+-(NSData *)textData:(NSString *)text options:(NSDictionary *)options
+{
+    NSString *encodig = [options valueForKey:@"encoding"];
+    if(!encodig) encodig=@"GBK";
+    //"" drops the characters the code page does not have, otherwise its first (ASCII) character replaces them
+    NSString *fallbackText = [options valueForKey:@"fallback"];
+    int fallback = '?';
+    if([fallbackText isKindOfClass:[NSString class]]){
+        fallback = [fallbackText length]==0 ? TEXT_FALLBACK_SKIP
+                : ([fallbackText characterAtIndex:0]<0x80 ? [fallbackText characterAtIndex:0] : '?');
     }
-    
+    NSInteger codePage = [[options valueForKey:@"codepage"] integerValue];
+    NSInteger widthTimes = [[options valueForKey:@"widthtimes"] integerValue];
+    NSInteger heigthTime = [[options valueForKey:@"heigthtimes"] integerValue];
+    NSInteger fontType = [[options valueForKey:@"fontType"] integerValue];
+    return [self textData:text inEncoding:encodig fallback:fallback withCodePage:codePage widthTimes:widthTimes heightTimes:heigthTime fontType:fontType];
 }
 
 RCT_EXPORT_METHOD(printText:(NSString *) text withOptions:(NSDictionary *) options
                   resolver:(RCTPromiseResolveBlock) resolve rejecter:(RCTPromiseRejectBlock) reject)
-{NSLog(@"printing text...with options: %@",options);
-    if(!RNBluetoothManager.isConnected){
-          reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
-    }else{
-        @try{
-    //encoding:'GBK',
-    //codepage:0,
-    //widthtimes:0,
-    //heigthtimes:0,
-    //fonttype:1
-        NSString *encodig = [options valueForKey:@"encoding"];
-        if(!encodig) encodig=@"GBK";
-            NSInteger codePage = [[options valueForKey:@"codepage"] integerValue];NSLog(@"Got codepage from options: %ld",codePage);
-        if(!codePage) codePage = 0;
-        NSInteger widthTimes = [[options valueForKey:@"widthtimes"] integerValue];
-        if(!widthTimes) widthTimes = 0;
-        NSInteger heigthTime = [[options valueForKey:@"heigthtimes"] integerValue];
-        if(!heigthTime) heigthTime =0;
-        NSInteger fontType = [[options valueForKey:@"fontType"] integerValue];
-        if(!fontType) fontType = 0;
-            pendingResolve = resolve;
-            pendingReject = reject;
-            [self textPrint:text inEncoding:encodig withCodePage:codePage widthTimes:widthTimes heightTimes:heigthTime fontType:fontType delegate:self];
-        }
-        @catch (NSException *e){
-            NSLog(@"print text exception: %@",e);
-            reject(e.name.description,e.name.description,nil);
-        }
+{
+    [self send:[self textData:text options:options] invalid:@"INVALID_PARAMETER" resolver:resolve rejecter:reject];
+}
+
+/**
+ * The text in the printer's code page with the tables of text_encode.c, an encoding without
+ * tables is written as GB18030.
+ **/
+-(NSData *)encodeText:(NSString *)text encoding:(NSString *)encoding fallback:(int)fallback
+{
+    text_encoding textEncoding = text_encoding_named([encoding UTF8String]);
+    if(textEncoding==TEXT_ENCODING_UNKNOWN) textEncoding = TEXT_ENCODING_GB18030;
+    NSUInteger length = [text length];
+    if(length==0) return [NSData data];
+    unichar *chars = malloc(length*sizeof(unichar));
+    uint8_t *out = malloc(text_encode_size(textEncoding, length));
+    if(!chars || !out){
+        free(chars);
+        free(out);
+        return nil;
     }
+    [text getCharacters:chars range:NSMakeRange(0, length)];
+    size_t written = text_encode(textEncoding, chars, length, fallback, out);
+    free(chars);
+    return [NSData dataWithBytesNoCopy:out length:written freeWhenDone:YES];
 }
--(NSStringEncoding) toNSEncoding:(NSString *)encoding
-{NSLog(@"encoding: %@",encoding);
-    NSStringEncoding nsEncoding = CFStringConvertEncodingToNSStringEncoding(kCFStringEncodingGB_18030_2000);
-    if([@"UTF-8" isEqualToString:encoding] || [@"utf-8" isEqualToString:encoding] ){
-        nsEncoding = NSUTF8StringEncoding;
-    }
-    
-    return nsEncoding;
-}
--(void) textPrint:(NSString *) text
-       inEncoding:(NSString *) encoding
-     withCodePage:(NSInteger) codePage
-       widthTimes:(NSInteger) widthTimes
-      heightTimes:(NSInteger) heightTimes
-         fontType:(NSInteger) fontType
-     delegate:(NSObject<WriteDataToBleDelegate> *) delegate
-{
-    Byte *intToWidth[] = {0x00, 0x10, 0x20, 0x30};
-    Byte *intToHeight[] = {0x00, 0x01, 0x02, 0x03};
-    Byte *multTime[] = {intToWidth[widthTimes],intToHeight[heightTimes]};
-    NSData *bytes = [text dataUsingEncoding:[self toNSEncoding:encoding]];
-    NSLog(@"Got bytes length:%lu",[bytes length]);
-    
+
+-(NSData *) textData:(NSString *) text
+          inEncoding:(NSString *) encoding
+            fallback:(int) fallback
+        withCodePage:(NSInteger) codePage
+          widthTimes:(NSInteger) widthTimes
+         heightTimes:(NSInteger) heightTimes
+            fontType:(NSInteger) fontType
+{
+    if(!text || codePage<0 || codePage>255) return nil;
+    Byte intToWidth[] = {0x00, 0x10, 0x20, 0x30};
+    Byte intToHeight[] = {0x00, 0x01, 0x02, 0x03};
+    Byte multTime = intToWidth[MAX(0,MIN(widthTimes,3))] | intToHeight[MAX(0,MIN(heightTimes,3))];
+    NSData *bytes = [self encodeText:text encoding:encoding fallback:fallback];
+    if(!bytes) return nil;
+
     NSMutableData *toSend = [[NSMutableData alloc] init];
-    
-    //gsExclamationMark:{GS, '!', 0x00 };
-    [toSend appendBytes:ESC_GS length:sizeof(ESC_GS)];
-    [toSend appendBytes:SIGN length:sizeof(SIGN)];
-    [toSend appendBytes:multTime length:sizeof(multTime)];
-    //escT:  {ESC, 't', 0x00 };
-    [toSend appendBytes:ESC length:sizeof(ESC)];
-    [toSend appendBytes:T length:sizeof(T)];
-    [toSend appendBytes:&codePage length:sizeof(codePage)];NSLog(@"codepage: %lu",codePage);
-    if(codePage == 0){
-        //FS_and :{FS, '&' };
-        [toSend appendBytes:ESC_FS length:sizeof(ESC_FS)];
-        [toSend appendBytes:AND length:sizeof(AND)];
-    }else{NSLog(@"{FS,46}");
-        //FS_dot: {FS, 46 };
-        NSInteger fourtySix= 46;
-        [toSend appendBytes:ESC_FS length:sizeof(ESC_FS)];
-        [toSend appendBytes:&fourtySix length:sizeof(fourtySix)];
-    }
-//    escM:{ESC, 'M', 0x00 };
-    [toSend appendBytes:ESC length:sizeof(ESC)];
-    [toSend appendBytes:M length:sizeof(M)];
-    [toSend appendBytes:&fontType length:sizeof(fontType)];
+    //GS ! / ESC t / FS & or FS . / ESC M, the ones the printer is not in yet
+    [[self mode] appendTextSize:multTime codePage:codePage font:fontType to:toSend];
     // text data
     [toSend appendData:bytes];
     //LF
    // [toSend appendBytes:&NL length:sizeof(NL)];
-  
-    NSLog(@"Goting to write text : %@",text);
-    NSLog(@"With data: %@",toSend);
-    [RNBluetoothManager writeValue:toSend withDelegate:delegate];
+    return toSend;
+}
+
+//    //取消/选择90度旋转打印
+// public static byte[] ESC_V = new byte[] {ESC, 'V', 0x00 };
+-(NSData *)rotateData:(NSInteger)rotate
+{
+    if(rotate<0 || rotate>1) return nil;
+    NSMutableData *data = [[NSMutableData alloc] init];
+    Byte rotateBytes[] = {rotate};
+    [data appendBytes:ESC length:1];
+    [data appendBytes:V length:1];
+    [data appendBytes:rotateBytes length:1];
+    return data;
 }
 
-RCT_EXPORT_METHOD(rotate:(NSInteger *)rotate
+RCT_EXPORT_METHOD(rotate:(NSInteger)rotate
                   withResolver:(RCTPromiseResolveBlock) resolve rejecter:(RCTPromiseRejectBlock) reject)
 {
-    if(RNBluetoothManager.isConnected){
-        //    //取消/选择90度旋转打印
-       // public static byte[] ESC_V = new byte[] {ESC, 'V', 0x00 };
-        NSMutableData *data = [[NSMutableData alloc] init];
-        Byte rotateBytes[] = {(int)rotate};
-        [data appendBytes:ESC length:1];
-        [data appendBytes:V length:1];
-        [data appendBytes:rotateBytes length:1];
-        pendingReject = reject;
-        pendingResolve = resolve;
-        [RNBluetoothManager writeValue:data withDelegate:self];
-    }else{
-           reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
-    }
-//        if(sendDataByte(PrinterCommand.POS_Set_Rotate(rotate))){
-//            promise.resolve(null);
-//        }else{
-//            promise.reject("COMMAND_NOT_SEND");
-//        }
+    [self send:[self rotateData:rotate] invalid:@"INVALD_PARAMETERS" resolver:resolve rejecter:reject];
 }
 
-RCT_EXPORT_METHOD(printerAlign:(NSInteger *) align
+//{ESC, 'a', 0x00 }
+-(NSData *)alignData:(NSInteger)align
+{
+    if((align < 0 || align > 2) && (align < 48 || align > 50)) return nil;
+    NSMutableData *toSend = [[NSMutableData alloc] init];
+    [[self mode] appendAlign:align to:toSend];
+    return toSend;
+}
+
+RCT_EXPORT_METHOD(printerAlign:(NSInteger) align
                    withResolver:(RCTPromiseResolveBlock) resolve rejecter:(RCTPromiseRejectBlock) reject)
 {
-    if(RNBluetoothManager.isConnected){
-        //if ((align < 0 || align > 2) && (align < 48 || align > 50)) return null;
-        if((align < 0 || align > 2) && (align < 48 || align > 50)){
-             reject(@"INVALD_PARAMETERS",@"INVALD_PARAMETERS",nil);
-        }else{
-            //{ESC, 'a', 0x00 }
-            NSMutableData *toSend = [[NSMutableData alloc] init];
-            [toSend appendBytes:ESC length:sizeof(ESC)];
-            [toSend appendBytes:A length:sizeof(A)];
-            [toSend appendBytes:&align length:sizeof(align)];
-            pendingReject =reject;
-            pendingResolve =resolve;
-            [RNBluetoothManager writeValue:toSend withDelegate:self];
-        }
+    [self send:[self alignData:align] invalid:@"INVALD_PARAMETERS" resolver:resolve rejecter:reject];
+}
+
+/**
+ * The text rows of a table, laid out by text_layout.c and encoded as one printText with the options.
+ **/
+-(NSData *)columnData:(NSArray *)columnWidths aligns:(NSArray *)columnAligns texts:(NSArray *)columnTexts options:(NSDictionary *)options
+{
+    NSUInteger count = [columnWidths count];
+    if(count!=[columnTexts count] || count!=[columnAligns count]) return nil;
+
+    NSUInteger chars = 0;
+    for(NSUInteger i=0;i<count;i++){
+        NSString *text = [columnTexts objectAtIndex:i];
+        if(![text isKindOfClass:[NSString class]] || [[columnWidths objectAtIndex:i] integerValue]<0) return nil;
+        chars += [text length];
+    }
+    // the column texts are laid out straight from one UTF-16 buffer
+    text_column *column = malloc(MAX(count,1)*sizeof(text_column));
+    unichar *buffer = malloc(MAX(chars,1)*sizeof(unichar));
+    if(!column || !buffer){
+        free(column);
+        free(buffer);
+        return nil;
+    }
+    unichar *at = buffer;
+    for(NSUInteger i=0;i<count;i++){
+        NSString *text = [columnTexts objectAtIndex:i];
+        [text getCharacters:at range:NSMakeRange(0, [text length])];
+        column[i].text = at;
+        column[i].length = [text length];
+        column[i].width = (size_t)[[columnWidths objectAtIndex:i] integerValue];
+        column[i].align = (text_align)[[columnAligns objectAtIndex:i] integerValue];
+        at += [text length];
+    }
+
+    NSString *table = nil;
+    size_t rows = 0;
+    size_t length = text_layout_columns(column, count, NULL, &rows);
+    unichar *laidOut = length==(size_t)-1 ? NULL : malloc(MAX(length,1)*sizeof(unichar));
+    if(laidOut && text_layout_columns(column, count, laidOut, &rows)==length){
+        table = [[NSString alloc] initWithCharactersNoCopy:laidOut length:length freeWhenDone:YES];
     }else{
-         reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        free(laidOut);
     }
+    free(column);
+    free(buffer);
+    if(!table) return nil;
+    return [self textData:table options:options];
 }
 
 RCT_EXPORT_METHOD(printColumn:(NSArray *)columnWidths
@@ -299,175 +378,90 @@ RCT_EXPORT_METHOD(printColumn:(NSArray *)columnWidths
                   resolver:(RCTPromiseResolveBlock) resolve
                   rejecter:(RCTPromiseRejectBlock) reject)
 {
-    if(!RNBluetoothManager.isConnected){
-        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
-    }else{
-        @try{
-            NSString *encodig = [options valueForKey:@"encoding"];
-            if(!encodig) encodig=@"GBK";
-            NSInteger codePage = [[options valueForKey:@"codepage"] integerValue];NSLog(@"Got codepage from options: %ld",codePage);
-            if(!codePage) codePage = 0;
-            NSInteger widthTimes = [[options valueForKey:@"widthtimes"] integerValue];
-            if(!widthTimes) widthTimes = 0;
-            NSInteger heigthTime = [[options valueForKey:@"heigthtimes"] integerValue];
-            if(!heigthTime) heigthTime =0;
-            NSInteger fontType = [[options valueForKey:@"fontType"] integerValue];
-            if(!fontType) fontType = 0;
-          /**
-                 * [column1-1,
-                 * column1-2,
-                 * column1-3 ... column1-n]
-                 * ,
-                 *  [column2-1,
-                 * column2-2,
-                 * column2-3 ... column2-n]
-                 *
-                 * ...
-                 *
-                 */
-            NSMutableArray *table =[[NSMutableArray alloc] init];
-            
-                /**splits the column text to few rows and applies the alignment **/
-                int padding = 1;
-                for(int i=0;i< [columnWidths count];i++){
-                    NSInteger width =[[columnWidths objectAtIndex:i ] integerValue] - padding;//1 char padding
-                    NSString *text = [columnTexts objectAtIndex:i]; //String.copyValueOf(columnTexts.getString(i).toCharArray());
-                    NSLog(@"Text in column: %@",text);
-                    NSMutableArray<ColumnSplitedString *> *splited = [[NSMutableArray alloc] init];
-                    //List<ColumnSplitedString> splited = new ArrayList<ColumnSplitedString>();
-                    int shorter = 0;
-                    int counter = 0;
-                   NSMutableString *temp = [[NSMutableString alloc] init];
-                   
-                    for(int c=0;c<[text length];c++){
-                        unichar ch = [text characterAtIndex:c];
-                        int l = (ch>= 0x4e00 && ch <= 0x9fff)?2:1;
-                        if (l==2){
-                            shorter=shorter+1;
-                        }
-                        [temp appendString:[text substringWithRange:NSMakeRange(c, 1)]];
-                        if(counter+l<width){
-                            counter = counter+l;
-                        }else{
-                            ColumnSplitedString *css = [[ColumnSplitedString alloc] init];
-                            css.str = temp;
-                            css.shorter = shorter;
-                            [splited addObject:css];
-                            temp = [[NSMutableString alloc] init];
-                            counter=0;
-                            shorter=0;
-                        }
-                    }
-                    if([temp length]>0) {
-                        ColumnSplitedString *css = [[ColumnSplitedString alloc] init];
-                        css.str = temp;
-                        css.shorter = shorter;
-                        [splited addObject:css];
-                    }
-                    NSInteger align =[[columnAligns objectAtIndex:i] integerValue];
-            
-                    NSMutableArray *formated = [[NSMutableArray alloc] init];
-                    for(ColumnSplitedString *s in splited){
-                        NSMutableString *empty = [[NSMutableString alloc] init];
-                        for(int w=0;w<(width+padding-s.shorter);w++){
-                            [empty appendString:@" "];
-                        }
-                        int startIdx = 0;
-                        NSString *ss = s.str;
-                        if(align == 1 && [ss length]<(width-s.shorter)){
-                            startIdx = (int)(width-s.shorter-[ss length])/2;
-                            if(startIdx+[ss length]>width-s.shorter){
-                                startIdx--;
-                            }
-                            if(startIdx<0){
-                                startIdx=0;
-                            }
-                        }else if(align==2 && [ss length]<(width-s.shorter)){
-                            startIdx =(int)(width - s.shorter-[ss length]);
-                        }
-                        NSInteger length =[ss length];
-//                        if(length+startIdx>[empty length]){
-//                            length = [empty length]-startIdx;
-//                        }
-                        NSLog(@"empty(length: %lu) replace from %d length %lu with str:%@)",[empty length],startIdx,length,ss);
-                        [empty replaceCharactersInRange:NSMakeRange(startIdx, length) withString:ss];
-                        [formated addObject:empty];
-                    }
-                    [table addObject:formated];
-                }
-            
-            /**  try to find the max row count of the table **/
-                NSInteger maxRowCount = 0;
-                for(int i=0;i<[table count]/*column count*/;i++){
-                    NSArray *rows = [table objectAtIndex:i]; // row data in current column
-                    if([rows count]>maxRowCount){
-                        maxRowCount = [rows count];// try to find the max row count;
-                    }
-                }
-            
-                /** loop table again to fill the rows **/
-            NSMutableArray<NSMutableString *> *rowsToPrint = [[NSMutableArray alloc] init];
-                for(int column=0;column<[table count]/*column count*/;column++){
-                    NSArray *rows = [table objectAtIndex:column]; // row data in current column
-                    for(int row=0;row<maxRowCount;row++){
-                        if([rowsToPrint count]<=row || [rowsToPrint objectAtIndex:row] ==nil){
-                           [rowsToPrint setObject:[[NSMutableString alloc] init] atIndexedSubscript:row];
-                        }
-                        if(row<[rows count]){
-                            //got the row of this column
-                            [(NSMutableString *)[rowsToPrint objectAtIndex:row] appendString:[rows objectAtIndex:row]];//.append(rows.get(row));
-                        }else{
-                            NSInteger w = [[columnWidths objectAtIndex:column] integerValue]; //columnWidths.getInt(column);
-                            NSMutableString *empty = [[NSMutableString alloc] init];
-                            for(int i=0;i<w;i++){
-                                [empty appendString:@" "]; //empty.append(" ");
-                            }
-                             [(NSMutableString *)[rowsToPrint objectAtIndex:row] appendString:empty];//Append spaces to ensure the format
-                        }
-                    }
-                }
-            
-                /** loops the rows and print **/
-            PrintColumnBleWriteDelegate *delegate = [[PrintColumnBleWriteDelegate alloc] init];
-            delegate.now = 0;
-            delegate.error = false;
-            delegate.pendingReject = reject;
-            delegate.pendingResolve =resolve;
-            delegate.canceled = false;
-            delegate.encodig = encodig;
-            delegate.widthTimes = widthTimes;
-            delegate.heightTimes = heigthTime;
-            delegate.fontType = fontType;
-            delegate.codePage = codePage;
-            delegate.printer = self;
-            [delegate printColumn:rowsToPrint withMaxcount:maxRowCount];
-        }
-        @catch(NSException *e){
-            NSLog(@"print text exception: %@",[e callStackSymbols]);
-            reject(e.name.description,e.name.description,nil);
-        }
-        
+    @try{
+        [self send:[self columnData:columnWidths aligns:columnAligns texts:columnTexts options:options]
+           invalid:@"COLUMN_WIDTHS_ALIGNS_AND_TEXTS_NOT_MATCH" resolver:resolve rejecter:reject];
+    }
+    @catch(NSException *e){
+        NSLog(@"print column exception: %@",[e callStackSymbols]);
+        reject(e.name.description,e.name.description,nil);
     }
 }
 
-RCT_EXPORT_METHOD(setBlob:(NSInteger) sp
-                  withResolver:(RCTPromiseResolveBlock) resolve
-                  rejecter:(RCTPromiseRejectBlock) reject)
-{
-    //\\    //选择/取消加粗指令
+//\\    //选择/取消加粗指令
 //    public static byte[] ESC_G = new byte[] {ESC, 'G', 0x00 };
 //    public static byte[] ESC_E = new byte[] {ESC, 'E', 0x00 };
+-(NSData *)blobData:(NSInteger)sp
+{
     //E+G
     NSMutableData *toSend = [[NSMutableData alloc] init];
-    [toSend appendBytes:&ESC length:sizeof(ESC)];
-    [toSend appendBytes:&G length:sizeof(G)];
-    [toSend appendBytes:&sp length:sizeof(sp)];
-    [toSend appendBytes:&ESC length:sizeof(ESC)];
-    [toSend appendBytes:&E length:sizeof(E)];
-    [toSend appendBytes:&sp length:sizeof(sp)];
-    pendingReject =reject;
-    pendingResolve = resolve;
-    [RNBluetoothManager writeValue:toSend withDelegate:self];
+    [[self mode] appendBold:sp to:toSend];
+    return toSend;
+}
+
+RCT_EXPORT_METHOD(setBlob:(NSInteger) sp
+                  withResolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    [self send:[self blobData:sp] invalid:nil resolver:resolve rejecter:reject];
+}
+
+/**
+ * The raster also depends on the width, padding, dither and rows per command, they are part of the key.
+ **/
+-(NSString *)rasterKeyForPic:(NSString *)base64encodeStr width:(NSInteger)nWidth paddingLeft:(NSInteger)paddingLeft dither:(DitherMode)dither
+{
+    NSString *params = [NSString stringWithFormat:@"|pic|%ld|%ld|%ld|%ld",(long)nWidth,(long)paddingLeft,(long)dither,(long)self.profile.rasterRows];
+    return [RasterCache keyForContent:base64encodeStr params:params];
+}
+
+-(ImageRasterEncoder *)encoderForPic:(NSString *)base64encodeStr width:(NSInteger)nWidth paddingLeft:(NSInteger)paddingLeft dither:(DitherMode)dither
+{
+    NSData *decoded = [[NSData alloc] initWithBase64EncodedString:base64encodeStr options:0 ];
+    //decode straight to the paper width, the full-size bitmap is never built.
+    CGImageRef image = [ImageUtils createImageWithData:decoded maxWidth:nWidth];
+    if(!image) return nil;
+    ImageRasterEncoder *encoder = [[ImageRasterEncoder alloc] initWithImage:image width:nWidth paddingLeft:paddingLeft
+                                                             rowsPerCommand:self.profile.rasterRows
+                                                                     dither:dither];
+    CGImageRelease(image);
+    return encoder;
+}
+
+/**
+ * Streams the encoder's bands and keeps the whole raster in the cache afterwards,
+ * unless it would not fit anyway.
+ **/
+-(void)cacheRasterOf:(PrintImageBleWriteDelegate *)delegate forKey:(NSString *)key
+{
+    RasterCache *cache = [RasterCache sharedCache];
+    if(delegate.encoder.bytesPerLine*delegate.encoder.height > cache.capacity) return;
+    delegate.didEncode = ^(NSData *raster){
+        [cache setData:raster forKey:key];
+    };
+}
+
+/**
+ * The whole image for printBatch, the raster is encoded at once instead of streamed.
+ **/
+-(NSData *)picData:(NSString *)base64encodeStr options:(NSDictionary *)options
+{
+    NSInteger nWidth = [[options valueForKey:@"width"] integerValue];
+    if(!nWidth) nWidth = _deviceWidth;
+    NSInteger paddingLeft = [[options valueForKey:@"left"] integerValue];
+    DitherMode dither = [ImageDither modeWithName:[options valueForKey:@"dither"] fallback:DitherThreshold];
+    RasterCache *cache = [RasterCache sharedCache];
+    NSString *key = [self rasterKeyForPic:base64encodeStr width:nWidth paddingLeft:paddingLeft dither:dither];
+    NSData *raster = [cache dataForKey:key];
+    if(!raster){
+        raster = [[self encoderForPic:base64encodeStr width:nWidth paddingLeft:paddingLeft dither:dither] remainingBands];
+        if(!raster) return nil;
+        [cache setData:raster forKey:key];
+    }
+    NSMutableData *data = [raster mutableCopy];
+    [data appendBytes:PIC_TAIL length:sizeof(PIC_TAIL)];
+    [[self mode] didResetFont];
+    return data;
 }
 
 RCT_EXPORT_METHOD(printPic:(NSString *) base64encodeStr withOptions:(NSDictionary *) options
@@ -481,31 +475,23 @@ RCT_EXPORT_METHOD(printPic:(NSString *) base64encodeStr withOptions:(NSDictionar
             //TODO:need to handel param "left" in the options.
             NSInteger paddingLeft = [[options valueForKey:@"left"] integerValue];
             if(!paddingLeft) paddingLeft = 0;
-            NSData *decoded = [[NSData alloc] initWithBase64EncodedString:base64encodeStr options:0 ];
-            UIImage *srcImage = [[UIImage alloc] initWithData:decoded scale:1];
-            NSData *jpgData = UIImageJPEGRepresentation(srcImage, 1);
-            UIImage *jpgImage = [[UIImage alloc] initWithData:jpgData];
-            //mBitmap.getHeight() * width / mBitmap.getWidth();
-            NSInteger imgHeight = jpgImage.size.height;
-            NSInteger imagWidth = jpgImage.size.width;
-            NSInteger width = nWidth;//((int)(((nWidth*0.86)+7)/8))*8-7;
-            CGSize size = CGSizeMake(width, imgHeight*width/imagWidth);
-            UIImage *scaled = [ImageUtils imageWithImage:jpgImage scaledToFillSize:size];
-            if(paddingLeft>0){
-                scaled = [ImageUtils imagePadLeft:paddingLeft withSource:scaled];
-                size =[scaled size];
-            }
-            
-            unsigned char * graImage = [ImageUtils imageToGreyImage:scaled];
-            unsigned char * formatedData = [ImageUtils format_K_threshold:graImage width:size.width height:size.height];
-            NSData *dataToPrint = [ImageUtils eachLinePixToCmd:formatedData nWidth:size.width nHeight:size.height nMode:0];
+            DitherMode dither = [ImageDither modeWithName:[options valueForKey:@"dither"] fallback:DitherThreshold];
+            NSString *key = [self rasterKeyForPic:base64encodeStr width:nWidth paddingLeft:paddingLeft dither:dither];
             PrintImageBleWriteDelegate *delegate = [[PrintImageBleWriteDelegate alloc] init];
             delegate.pendingResolve = resolve;
             delegate.pendingReject = reject;
-            delegate.width = width;
-            delegate.toPrint  = dataToPrint;
-            delegate.now = 0;
+            delegate.raster = [[RasterCache sharedCache] dataForKey:key];
+            if(!delegate.raster){
+                delegate.encoder = [self encoderForPic:base64encodeStr width:nWidth paddingLeft:paddingLeft dither:dither];
+                if(!delegate.encoder){
+                    reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+                    return;
+                }
+                [self cacheRasterOf:delegate forKey:key];
+            }
             [delegate print];
+            //the image ends with ESC M 0
+            [[self mode] didResetFont];
         }
         @catch(NSException *e){
             NSLog(@"ERROR IN PRINTING IMG: %@",[e callStackSymbols]);
@@ -516,59 +502,464 @@ RCT_EXPORT_METHOD(printPic:(NSString *) base64encodeStr withOptions:(NSDictionar
     }
 }
 
-RCT_EXPORT_METHOD(printQRCode:(NSString *)content
-                  withSize:(NSInteger) size
-                  correctionLevel:(NSInteger) correctionLevel
-                  andResolver:(RCTPromiseResolveBlock) resolve
+/**
+ * Encodes an image once and keeps it under imageId, e.g. the header logo,
+ * printRegisteredPic then sends it without any image work.
+ **/
+RCT_EXPORT_METHOD(registerPic:(NSString *) imageId withImage:(NSString *) base64encodeStr
+                  options:(NSDictionary *) options
+                  resolver:(RCTPromiseResolveBlock) resolve
                   rejecter:(RCTPromiseRejectBlock) reject)
 {
-    NSLog(@"QRCODE TO PRINT: %@",content);
+    NSInteger nWidth = [[options valueForKey:@"width"] integerValue];
+    if(!nWidth) nWidth = _deviceWidth;
+    NSInteger paddingLeft = [[options valueForKey:@"left"] integerValue];
+    DitherMode dither = [ImageDither modeWithName:[options valueForKey:@"dither"] fallback:DitherThreshold];
+    ImageRasterEncoder *encoder = [self encoderForPic:base64encodeStr width:nWidth paddingLeft:paddingLeft dither:dither];
+    if(!imageId || !encoder){
+        reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
+        return;
+    }
+    [[RasterCache sharedCache] registerData:[encoder remainingBands] forId:imageId];
+    resolve(nil);
+}
+
+-(NSData *)registeredPicData:(NSString *)imageId
+{
+    NSData *raster = [[RasterCache sharedCache] registeredDataForId:imageId];
+    if(!raster) return nil;
+    NSMutableData *data = [raster mutableCopy];
+    [data appendBytes:PIC_TAIL length:sizeof(PIC_TAIL)];
+    [[self mode] didResetFont];
+    return data;
+}
+
+RCT_EXPORT_METHOD(printRegisteredPic:(NSString *) imageId withOptions:(NSDictionary *) options
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    [self send:[self registeredPicData:imageId] invalid:@"IMAGE_NOT_REGISTERED" resolver:resolve rejecter:reject];
+}
+
+/**
+ * Memory cap in bytes of the recently printed images.
+ **/
+RCT_EXPORT_METHOD(setPicCacheSize:(NSInteger) bytes)
+{
+    [RasterCache sharedCache].capacity = bytes>0?bytes:0;
+}
+
+RCT_EXPORT_METHOD(clearPicCache)
+{
+    [[RasterCache sharedCache] removeAll];
+}
+
+RCT_EXPORT_METHOD(getPicCacheStats:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    resolve([[RasterCache sharedCache] stats]);
+}
+
+/**
+ * NV graphics keys are two printable ASCII characters, e.g. "L1".
+ **/
+-(BOOL)isNvKey:(NSString *)key
+{
+    if(!key || [key length]!=2) return NO;
+    for(NSUInteger i=0;i<2;i++){
+        unichar c = [key characterAtIndex:i];
+        if(c<32 || c>126) return NO;
+    }
+    return YES;
+}
+
+/**
+ * Stores an image in the printer's NV graphics memory under key, printNvImage then prints it
+ * with 11 bytes. Resolves NO without writing when the printer already holds the same image,
+ * unless options.force is set. NV memory is flash, avoid redefining images on every receipt.
+ **/
+RCT_EXPORT_METHOD(uploadNvImage:(NSString *) key withImage:(NSString *) base64encodeStr
+                  options:(NSDictionary *) options
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSString *address = [RNBluetoothManager connectedAddress];
+    if(!address){
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        return;
+    }
+    if(![self isNvKey:key]){
+        reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
+        return;
+    }
+    NSInteger nWidth = [[options valueForKey:@"width"] integerValue];
+    if(!nWidth) nWidth = _deviceWidth;
+    DitherMode dither = [ImageDither modeWithName:[options valueForKey:@"dither"] fallback:DitherThreshold];
+    NSString *hash = [RasterCache keyForContent:base64encodeStr params:[NSString stringWithFormat:@"|nv|%ld|%ld",(long)nWidth,(long)dither]];
+    NvImageStore *store = [NvImageStore sharedStore];
+    if(![[options valueForKey:@"force"] boolValue] && [hash isEqualToString:[store hashForKey:key address:address]]){
+        resolve(@NO);
+        return;
+    }
+    NSData *decoded = [[NSData alloc] initWithBase64EncodedString:base64encodeStr options:0 ];
+    CGImageRef image = [ImageUtils createImageWithData:decoded maxWidth:nWidth];
+    if(!image){
+        reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
+        return;
+    }
+    NSInteger height = MAX(1, CGImageGetHeight(image)*nWidth/CGImageGetWidth(image));
+    size_t length = raster_nv_define_size(nWidth, height);
+    if(!length){
+        CGImageRelease(image);
+        reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
+        return;
+    }
+    uint8_t *grey = [ImageUtils greyPixelsOfImage:image width:nWidth height:height];
+    CGImageRelease(image);
+    uint8_t *data = grey?malloc(length):NULL;
+    length = data?raster_nv_define(grey, nWidth, height, (raster_dither_mode)dither, [key characterAtIndex:0], [key characterAtIndex:1], data):0;
+    free(grey);
+    if(!length){
+        //out of memory, nothing was sent so the printer keeps what it had under key
+        free(data);
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        return;
+    }
+    [self send:[NSData dataWithBytesNoCopy:data length:length freeWhenDone:YES] invalid:nil resolver:^(id result){
+        //the hash is recorded only once the define command has been written
+        [store setHash:hash forKey:key address:address];
+        resolve(@YES);
+    } rejecter:reject];
+}
+
+/**
+ * GS ( L pL pH m fn kc1 kc2 x y, fn=69
+ **/
+-(NSData *)nvImageData:(NSString *)key
+{
+    NSString *address = [RNBluetoothManager connectedAddress];
+    if(!address || ![self isNvKey:key] || ![[NvImageStore sharedStore] hashForKey:key address:address]) return nil;
+    uint8_t command[RASTER_NV_PRINT_SIZE];
+    size_t length = raster_nv_print([key characterAtIndex:0], [key characterAtIndex:1], command);
+    return [NSData dataWithBytes:command length:length];
+}
+
+/**
+ * Prints an image stored with uploadNvImage, at the current alignment.
+ **/
+RCT_EXPORT_METHOD(printNvImage:(NSString *) key
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    if(!RNBluetoothManager.isConnected){
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        return;
+    }
+    [self send:[self nvImageData:key] invalid:@"NV_IMAGE_NOT_STORED" resolver:resolve rejecter:reject];
+}
+
+/**
+ * GS ( L pL pH m fn kc1 kc2, fn=66
+ **/
+RCT_EXPORT_METHOD(deleteNvImage:(NSString *) key
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSString *address = [RNBluetoothManager connectedAddress];
+    if(!address){
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+    }else if(![self isNvKey:key]){
+        reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
+    }else{
+        uint8_t command[RASTER_NV_DELETE_SIZE];
+        size_t length = raster_nv_delete([key characterAtIndex:0], [key characterAtIndex:1], command);
+        [self send:[NSData dataWithBytes:command length:length] invalid:nil resolver:^(id result){
+            [[NvImageStore sharedStore] removeKey:key address:address];
+            resolve(nil);
+        } rejecter:reject];
+    }
+}
+
+/**
+ * GS ( L pL pH m fn d1 d2 d3, fn=65 "CLR"
+ **/
+RCT_EXPORT_METHOD(clearNvImages:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSString *address = [RNBluetoothManager connectedAddress];
+    if(!address){
+        reject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
+        return;
+    }
+    uint8_t command[RASTER_NV_DELETE_ALL_SIZE];
+    size_t length = raster_nv_delete_all(command);
+    [self send:[NSData dataWithBytes:command length:length] invalid:nil resolver:^(id result){
+        [[NvImageStore sharedStore] removeAllForAddress:address];
+        resolve(nil);
+    } rejecter:reject];
+}
+
+/**
+ * Keys of the images stored in the connected printer.
+ **/
+RCT_EXPORT_METHOD(getNvImages:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSString *address = [RNBluetoothManager connectedAddress];
+    resolve(address?[[NvImageStore sharedStore] keysForAddress:address]:@[]);
+}
+
+/**
+ * Whether a symbol goes out as the printer's own GS ( k command: options.mode is native,
+ * raster or auto, auto follows what the printer profile supports.
+ **/
+-(BOOL)nativeSymbol:(NSDictionary *)options supported:(BOOL)supported
+{
+    NSString *mode = [options isKindOfClass:[NSDictionary class]]?[options valueForKey:@"mode"]:nil;
+    if([@"native" isEqualToString:mode]) return YES;
+    if([@"raster" isEqualToString:mode]) return NO;
+    return supported;
+}
+
+//GS ( k pL pH cn fn params
+static void appendSymbolFunction(NSMutableData *data, Byte cn, Byte fn, const Byte *params, NSUInteger count)
+{
+    NSUInteger length = count + 2;
+    Byte head[] = {29, '(', 'k', length & 0xff, length >> 8, cn, fn};
+    [data appendBytes:head length:sizeof(head)];
+    [data appendBytes:params length:count];
+}
+
+//GS ( k pL pH cn 80 48 data
+static BOOL appendSymbolStore(NSMutableData *data, Byte cn, NSData *content)
+{
+    NSUInteger length = [content length] + 3;
+    if([content length] == 0 || length > 0xffff) return NO;
+    Byte head[] = {29, '(', 'k', length & 0xff, length >> 8, cn, 80, 48};
+    [data appendBytes:head length:sizeof(head)];
+    [data appendData:content];
+    return YES;
+}
+
+/**
+ * GS ( k QR code, model 2. moduleSize is 1-16 dots, errorCorrection 0-3 for L, M, Q, H.
+ * nil when the content does not fit one command.
+ **/
+-(NSData *)nativeQRCodeData:(NSString *)content moduleSize:(NSInteger)moduleSize errorCorrection:(NSInteger)errorCorrection
+{
+    NSMutableData *data = [[NSMutableData alloc] init];
+    Byte model[] = {50, 0};
+    Byte size[] = {MAX(1, MIN(moduleSize, 16))};
+    Byte level[] = {48 + errorCorrection};
+    Byte print[] = {48};
+    appendSymbolFunction(data, 49, 65, model, sizeof(model));
+    appendSymbolFunction(data, 49, 67, size, sizeof(size));
+    appendSymbolFunction(data, 49, 69, level, sizeof(level));
+    if(!appendSymbolStore(data, 49, [content dataUsingEncoding:NSUTF8StringEncoding])) return nil;
+    appendSymbolFunction(data, 49, 81, print, sizeof(print));
+    return data;
+}
+
+/**
+ * GS ( k PDF417 with columns (0 lets the printer choose), moduleWidth, rowHeight and
+ * errorCorrection (0-8) from options. nil when an option is out of range.
+ **/
+-(NSData *)nativePDF417Data:(NSString *)content options:(NSDictionary *)options
+{
+    NSInteger columns = [options objectForKey:@"columns"]?[[options valueForKey:@"columns"] integerValue]:0;
+    NSInteger moduleWidth = [options objectForKey:@"moduleWidth"]?[[options valueForKey:@"moduleWidth"] integerValue]:3;
+    NSInteger rowHeight = [options objectForKey:@"rowHeight"]?[[options valueForKey:@"rowHeight"] integerValue]:3;
+    NSInteger errorCorrection = [options objectForKey:@"errorCorrection"]?[[options valueForKey:@"errorCorrection"] integerValue]:2;
+    if(columns < 0 || columns > 30 || moduleWidth < 2 || moduleWidth > 8
+       || rowHeight < 2 || rowHeight > 8 || errorCorrection < 0 || errorCorrection > 8) return nil;
+    NSMutableData *data = [[NSMutableData alloc] init];
+    Byte columnsParam[] = {columns};
+    Byte rowsParam[] = {0};//rows as needed
+    Byte widthParam[] = {moduleWidth};
+    Byte heightParam[] = {rowHeight};
+    Byte levelParam[] = {48, 48 + errorCorrection};
+    Byte print[] = {48};
+    appendSymbolFunction(data, 48, 65, columnsParam, sizeof(columnsParam));
+    appendSymbolFunction(data, 48, 66, rowsParam, sizeof(rowsParam));
+    appendSymbolFunction(data, 48, 67, widthParam, sizeof(widthParam));
+    appendSymbolFunction(data, 48, 68, heightParam, sizeof(heightParam));
+    appendSymbolFunction(data, 48, 69, levelParam, sizeof(levelParam));
+    if(!appendSymbolStore(data, 48, [content dataUsingEncoding:NSUTF8StringEncoding])) return nil;
+    appendSymbolFunction(data, 48, 81, print, sizeof(print));
+    return data;
+}
+
+/**
+ * The native QR code command, sized to about size dots unless options.moduleSize is set.
+ * The module size is size over the side of the version the content needs, read from the
+ * capacity tables. When size is below that side the modules are 1 dot and the code prints
+ * larger than size, the smallest the printer can make it.
+ * nil when the symbol goes out as a raster or the content does not fit a QR code.
+ **/
+-(NSData *)nativeQRCodeData:(NSString *)content size:(NSInteger)size correctionLevel:(NSInteger)correctionLevel options:(NSDictionary *)options
+{
+    if(![self nativeSymbol:options supported:self.profile.nativeQRCode]) return nil;
+    VZZXQRCodeErrorCorrectionLevel *level = [self findCorrectionLevel:correctionLevel];
+    NSInteger moduleSize = [options isKindOfClass:[NSDictionary class]]?[[options valueForKey:@"moduleSize"] integerValue]:0;
+    if(moduleSize <= 0){
+        VZZXEncodeHints *hints = [VZZXEncodeHints hints];
+        hints.encoding=NSUTF8StringEncoding;
+        int version = [VZZXQRCodeEncoder versionNumberForContent:content ecLevel:level hints:hints];
+        if(!version) return nil;
+        //17 + 4 * version modules a side, at least 1 dot each
+        moduleSize = MAX(1, size / (17 + 4 * version));
+    }
+    return [self nativeQRCodeData:content moduleSize:moduleSize errorCorrection:level.ordinal];
+}
+
+/**
+ * GS v 0 rows packed straight from the bits of a symbol, every module scale x scale dots,
+ * centred in boxWidth x boxHeight dots.
+ **/
+-(NSData *)symbolRaster:(VZZXBitMatrix *)matrix scale:(NSInteger)scale boxWidth:(NSInteger)boxWidth boxHeight:(NSInteger)boxHeight
+{
+    raster_matrix bits = {(const uint32_t *)matrix.bits, (size_t)matrix.rowSize, (size_t)matrix.width, (size_t)matrix.height};
+    raster_symbol_options options = {0};
+    options.scale = MAX(1, scale);
+    options.width = MAX(0, boxWidth);
+    options.height = MAX(0, boxHeight);
+    options.rows_per_command = (size_t)self.profile.rasterRows;
+    NSMutableData *data = [NSMutableData dataWithLength:raster_symbol_escpos_size(&bits, &options)];
+    [data setLength:raster_symbol_escpos_encode(&bits, &options, data.mutableBytes)];
+    return data;
+}
+
+/**
+ * The QR code as GS v 0 rows, size x size dots, one bit per module until it is packed.
+ **/
+-(NSData *)qrCodeRaster:(NSString *)content size:(NSInteger)size correctionLevel:(NSInteger)correctionLevel
+{
     NSError *error = nil;
     VZZXEncodeHints *hints = [VZZXEncodeHints hints];
     hints.encoding=NSUTF8StringEncoding;
     hints.margin=0;
     hints.errorCorrectionLevel = [self findCorrectionLevel:correctionLevel];
-    
+
     VZZXMultiFormatWriter *writer = [VZZXMultiFormatWriter writer];
     VZZXBitMatrix *result = [writer encode:content
                                   format:kBarcodeFormatQRCode
-                                   width:(int)size
-                                  height:(int)size
+                                   width:0
+                                  height:0
                                     hints:hints
                                    error:&error];
-    if(error || !result){
-        reject(@"ERROR_IN_CREATE_QRCODE",@"ERROR_IN_CREATE_QRCODE",nil);
-    }else{
-        CGImageRef image = [[VZZXImage imageWithMatrix:result] cgimage];
-        uint8_t * graImage = [ImageUtils imageToGreyImage:[UIImage imageWithCGImage:image]];
-        unsigned char * formatedData = [ImageUtils format_K_threshold:graImage width:size height:size];
-        NSData *dataToPrint = [ImageUtils eachLinePixToCmd:formatedData nWidth:size nHeight:size nMode:0];
-        PrintImageBleWriteDelegate *delegate = [[PrintImageBleWriteDelegate alloc] init];
-        delegate.pendingResolve=resolve;
-        delegate.pendingReject = reject;
-        delegate.width = size;
-        delegate.toPrint  = dataToPrint;
-        delegate.now = 0;
-        [delegate print];
+    if(error || !result || result.width < 1) return nil;
+    return [self symbolRaster:result scale:size / result.width boxWidth:size boxHeight:size];
+}
+
+-(NSString *)rasterKeyForQRCode:(NSString *)content size:(NSInteger)size correctionLevel:(NSInteger)correctionLevel
+{
+    return [RasterCache keyForContent:content params:[NSString stringWithFormat:@"|qr|%ld|%ld|%ld",(long)size,(long)correctionLevel,(long)self.profile.rasterRows]];
+}
+
+-(NSData *)qrCodeData:(NSString *)content size:(NSInteger)size correctionLevel:(NSInteger)correctionLevel options:(NSDictionary *)options
+{
+    NSData *command = [self nativeQRCodeData:content size:size correctionLevel:correctionLevel options:options];
+    if(command) return command;
+    RasterCache *cache = [RasterCache sharedCache];
+    NSString *key = [self rasterKeyForQRCode:content size:size correctionLevel:correctionLevel];
+    NSData *raster = [cache dataForKey:key];
+    if(!raster){
+        raster = [self qrCodeRaster:content size:size correctionLevel:correctionLevel];
+        if(!raster) return nil;
+        [cache setData:raster forKey:key];
     }
+    NSMutableData *data = [raster mutableCopy];
+    [data appendBytes:PIC_TAIL length:sizeof(PIC_TAIL)];
+    [[self mode] didResetFont];
+    return data;
 }
 
-RCT_EXPORT_METHOD(printBarCode:(NSString *) str withType:(NSInteger)
-                  nType width:(NSInteger) nWidth heigth:(NSInteger) nHeight
-                  hriFontType:(NSInteger) nHriFontType hriFontPosition:(NSInteger) nHriFontPosition
+/**
+ * options.mode: native sends the printer's GS ( k command, raster an image of the code, auto
+ * (default) the command when the printer profile has nativeQRCode. options.moduleSize sets the
+ * dots per module of the native code, by default the one closest to size. A size smaller than
+ * the code's modules a side prints it at 1 dot a module, larger than size.
+ **/
+RCT_EXPORT_METHOD(printQRCode:(NSString *)content
+                  withSize:(NSInteger) size
+                  correctionLevel:(NSInteger) correctionLevel
+                  options:(NSDictionary *) options
                   andResolver:(RCTPromiseResolveBlock) resolve
                   rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSLog(@"QRCODE TO PRINT: %@",content);
+    NSData *command = [self nativeQRCodeData:content size:size correctionLevel:correctionLevel options:options];
+    if(command){
+        [self send:command invalid:nil resolver:resolve rejecter:reject];
+        return;
+    }
+    NSString *key = [self rasterKeyForQRCode:content size:size correctionLevel:correctionLevel];
+    PrintImageBleWriteDelegate *delegate = [[PrintImageBleWriteDelegate alloc] init];
+    delegate.pendingResolve=resolve;
+    delegate.pendingReject = reject;
+    delegate.raster = [[RasterCache sharedCache] dataForKey:key];
+    if(!delegate.raster){
+        delegate.raster = [self qrCodeRaster:content size:size correctionLevel:correctionLevel];
+        if(!delegate.raster){
+            reject(@"ERROR_IN_CREATE_QRCODE",@"ERROR_IN_CREATE_QRCODE",nil);
+            return;
+        }
+        [[RasterCache sharedCache] setData:delegate.raster forKey:key];
+    }
+    [delegate print];
+    [[self mode] didResetFont];
+}
+
+-(NSData *)pdf417Data:(NSString *)content options:(NSDictionary *)options
+{
+    if(![options isKindOfClass:[NSDictionary class]]) options = nil;
+    if([self nativeSymbol:options supported:self.profile.nativePDF417]){
+        NSData *command = [self nativePDF417Data:content options:options];
+        if(command) return command;
+    }
+    NSError *error = nil;
+    NSInteger width = [options objectForKey:@"width"]?[[options valueForKey:@"width"] integerValue]:self.deviceWidth;
+    VZZXEncodeHints *hints = [VZZXEncodeHints hints];
+    hints.encoding=NSUTF8StringEncoding;
+    hints.margin=0;
+    VZZXBitMatrix *result = [[VZZXMultiFormatWriter writer] encode:content
+                                                          format:kBarcodeFormatPDF417
+                                                            width:0
+                                                          height:0
+                                                           hints:hints
+                                                           error:&error];
+    if(error || !result || result.width < 1) return nil;
+    NSMutableData *data = [[self symbolRaster:result scale:width / result.width boxWidth:0 boxHeight:0] mutableCopy];
+    [data appendBytes:PIC_TAIL length:sizeof(PIC_TAIL)];
+    [[self mode] didResetFont];
+    return data;
+}
+
+/**
+ * options: mode as for printQRCode, following nativePDF417 of the profile, columns,
+ * moduleWidth, rowHeight and errorCorrection (0-8) of the native symbol, width of the raster.
+ **/
+RCT_EXPORT_METHOD(printPDF417:(NSString *)content
+                  options:(NSDictionary *) options
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    [self send:[self pdf417Data:content options:options] invalid:@"ERROR_IN_CREATE_PDF417" resolver:resolve rejecter:reject];
+}
+
+-(NSData *)barCodeData:(NSString *) str withType:(NSInteger)
+                  nType width:(NSInteger) nWidth heigth:(NSInteger) nHeight
+                  hriFontType:(NSInteger) nHriFontType hriFontPosition:(NSInteger) nHriFontPosition
 {
     if (nType < 0x41 | nType > 0x49 | nWidth < 2 | nWidth > 6
         | nHeight < 1 | nHeight > 255 | (!str||[str length]<1))
       {
-          reject(@"INVALID_PARAMETER",@"INVALID_PARAMETER",nil);
-          return;
+          return nil;
       }
-    
+
     NSData *conentData = [str dataUsingEncoding:CFStringConvertEncodingToNSStringEncoding(kCFStringEncodingGB_18030_2000)];
     NSMutableData *toPrint = [[NSMutableData alloc] init];
-    int8_t * command = malloc(16);
+    int8_t command[16];
         command[0] = 29 ;//GS
         command[1] = 119;//W
         command[2] = nWidth;
@@ -587,11 +978,133 @@ RCT_EXPORT_METHOD(printBarCode:(NSString *) str withType:(NSInteger)
         command[15] = [conentData length];
     [toPrint appendBytes:command length:16];
     [toPrint appendData:conentData];
-    
-    pendingReject = reject;
-    pendingResolve = resolve;
-    [RNBluetoothManager writeValue:toPrint withDelegate:self];
+    return toPrint;
+}
+
+RCT_EXPORT_METHOD(printBarCode:(NSString *) str withType:(NSInteger)
+                  nType width:(NSInteger) nWidth heigth:(NSInteger) nHeight
+                  hriFontType:(NSInteger) nHriFontType hriFontPosition:(NSInteger) nHriFontPosition
+                  andResolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    [self send:[self barCodeData:str withType:nType width:nWidth heigth:nHeight hriFontType:nHriFontType hriFontPosition:nHriFontPosition]
+       invalid:@"INVALID_PARAMETER" resolver:resolve rejecter:reject];
+}
+
+//{ESC, 'p', m, t1, t2}
+-(NSData *)drawerData:(NSInteger)nMode time1:(NSInteger)nTime1 time2:(NSInteger)nTime2
+{
+    if(nMode<0 || nMode>1 || nTime1<0 || nTime1>255 || nTime2<0 || nTime2>255) return nil;
+    Byte command[] = {27,'p',nMode,nTime1,nTime2};
+    return [NSData dataWithBytes:command length:5];
+}
+
+//{ESC, 'i'}, same as cutOnePoint on android
+-(NSData *)cutData
+{
+    Byte command[] = {27,'i'};
+    return [NSData dataWithBytes:command length:2];
+}
+
+/**
+ * One operation of printBatch, named after the method it stands for and with the same arguments.
+ * Returns nil and sets code when the operation is invalid.
+ **/
+-(NSData *)batchData:(NSString *)command args:(NSArray *)args error:(NSString **)code
+{
+    *code = @"INVALID_PARAMETER";
+    NSInteger count = [args count];
+    id (^arg)(NSInteger) = ^id(NSInteger i){
+        id value = i<count?[args objectAtIndex:i]:nil;
+        return value==[NSNull null]?nil:value;
+    };
+    if([@"printerInit" isEqualToString:command]){
+        return [self initData];
+    }else if([@"printAndFeed" isEqualToString:command]){
+        return [self feedData:[arg(0) integerValue]];
+    }else if([@"printerLeftSpace" isEqualToString:command]){
+        return [self leftSpaceData:[arg(0) integerValue]];
+    }else if([@"printerLineSpace" isEqualToString:command]){
+        return [self lineSpaceData:[arg(0) integerValue]];
+    }else if([@"printerUnderLine" isEqualToString:command]){
+        return [self underLineData:[arg(0) integerValue]];
+    }else if([@"printerAlign" isEqualToString:command]){
+        return [self alignData:[arg(0) integerValue]];
+    }else if([@"setBlob" isEqualToString:command]){
+        return [self blobData:[arg(0) integerValue]];
+    }else if([@"rotate" isEqualToString:command]){
+        return [self rotateData:[arg(0) integerValue]];
+    }else if([@"printText" isEqualToString:command]){
+        return [self textData:arg(0) options:arg(1)];
+    }else if([@"printColumn" isEqualToString:command]){
+        *code = @"COLUMN_WIDTHS_ALIGNS_AND_TEXTS_NOT_MATCH";
+        return [self columnData:arg(0) aligns:arg(1) texts:arg(2) options:arg(3)];
+    }else if([@"printPic" isEqualToString:command]){
+        return [self picData:arg(0) options:arg(1)];
+    }else if([@"printRegisteredPic" isEqualToString:command]){
+        *code = @"IMAGE_NOT_REGISTERED";
+        return [self registeredPicData:arg(0)];
+    }else if([@"printNvImage" isEqualToString:command]){
+        *code = @"NV_IMAGE_NOT_STORED";
+        return [self nvImageData:arg(0)];
+    }else if([@"printQRCode" isEqualToString:command]){
+        *code = @"ERROR_IN_CREATE_QRCODE";
+        return [self qrCodeData:arg(0) size:[arg(1) integerValue] correctionLevel:[arg(2) integerValue] options:arg(3)];
+    }else if([@"printPDF417" isEqualToString:command]){
+        *code = @"ERROR_IN_CREATE_PDF417";
+        return [self pdf417Data:arg(0) options:arg(1)];
+    }else if([@"printBarCode" isEqualToString:command]){
+        return [self barCodeData:arg(0) withType:[arg(1) integerValue] width:[arg(2) integerValue] heigth:[arg(3) integerValue]
+                     hriFontType:[arg(4) integerValue] hriFontPosition:[arg(5) integerValue]];
+    }else if([@"openDrawer" isEqualToString:command]){
+        return [self drawerData:[arg(0) integerValue] time1:[arg(1) integerValue] time2:[arg(2) integerValue]];
+    }else if([@"cutOnePoint" isEqualToString:command]){
+        return [self cutData];
+    }
+    *code = @"UNKNOWN_COMMAND";
+    return nil;
+}
+
+/**
+ * Encodes a whole receipt, [{command:'printText',args:['Hello\n\r',{}]},...], into one payload
+ * and writes it as a single stream. Nothing is sent when an operation is invalid, the promise is
+ * rejected with INVALID_BATCH and userInfo.errors: [{index,command,code}].
+ **/
+RCT_EXPORT_METHOD(printBatch:(NSArray *) ops
+                  resolver:(RCTPromiseResolveBlock) resolve
+                  rejecter:(RCTPromiseRejectBlock) reject)
+{
+    NSMutableData *data = [[NSMutableData alloc] init];
+    NSMutableArray *errors = [[NSMutableArray alloc] init];
+    PrinterState *before = [[self mode] copy];
+    for(NSInteger i=0;i<[ops count];i++){
+        NSDictionary *op = [ops objectAtIndex:i];
+        NSString *command = [op isKindOfClass:[NSDictionary class]]?[op valueForKey:@"command"]:nil;
+        NSArray *args = [op isKindOfClass:[NSDictionary class]]?[op valueForKey:@"args"]:nil;
+        if(![args isKindOfClass:[NSArray class]]) args = @[];
+        NSString *code = nil;
+        NSData *opData = nil;
+        @try{
+            opData = [self batchData:command args:args error:&code];
+        }
+        @catch(NSException *e){
+            NSLog(@"print batch exception: %@",e);
+            code = @"INVALID_PARAMETER";
+        }
+        if(opData){
+            [data appendData:opData];
+        }else{
+            [errors addObject:@{@"index":@(i),@"command":command?command:@"",@"code":code}];
+        }
+    }
+    if([errors count]>0){
+        [self.printerState restore:before];
+        reject(@"INVALID_BATCH",@"INVALID_BATCH",[NSError errorWithDomain:@"RNBluetoothEscposPrinter" code:0 userInfo:@{@"errors":errors}]);
+        return;
+    }
+    [self send:data invalid:nil resolver:resolve rejecter:reject];
 }
+
 //  L:1,
 //M:0,
 //Q:3,
@@ -612,15 +1125,4 @@ RCT_EXPORT_METHOD(printBarCode:(NSString *) str withType:(NSInteger)
     }
 }
 
-- (void) didWriteDataToBle: (BOOL)success{
-    if(success){
-        pendingResolve(nil);
-    }else{NSLog(@"REJECT<REJECT<REJECT<REJECT<REJECT<");
-        pendingReject(@"COMMAND_NOT_SEND",@"COMMAND_NOT_SEND",nil);
-    }
-    pendingReject = nil;
-    pendingResolve = nil;
-    [NSThread sleepForTimeInterval:0.05f];//slow down
-}
-
 @end
@@ -14,6 +14,8 @@
 - (void) didWriteDataToBle: (BOOL)success;
 @end
 
+extern NSString *EVENT_LABEL_PRINTED;
+
 @interface RNBluetoothManager <CBCentralManagerDelegate,CBPeripheralDelegate> : RCTEventEmitter <RCTBridgeModule>
 @property (strong, nonatomic) CBCentralManager      *centralManager;
 @property (nonatomic,copy) RCTPromiseResolveBlock scanResolveBlock;
@@ -24,6 +26,11 @@
 @property (nonatomic,copy) RCTPromiseRejectBlock connectRejectBlock;
 +(void)writeValue:(NSData *) data withDelegate:(NSObject<WriteDataToBleDelegate> *) delegate;
 +(Boolean)isConnected;
++(NSString *)connectedAddress;
++(NSUInteger)connectionId;
++(dispatch_queue_t)printQueue;
++(void)invalidateWriteCharacteristic;
++(void)emitEvent:(NSString *)name body:(id)body;
 -(void)initSupportServices;
 -(void)callStop;
 @end
@@ -8,6 +8,7 @@
 
 #import <Foundation/Foundation.h>
 #import "RNBluetoothManager.h"
+#import "BleWriteScheduler.h"
 #import <CoreBluetooth/CoreBluetooth.h>
 @implementation RNBluetoothManager
 
@@ -17,31 +18,96 @@ NSString *EVENT_DEVICE_FOUND = @"EVENT_DEVICE_FOUND";
 NSString *EVENT_CONNECTION_LOST = @"EVENT_CONNECTION_LOST";
 NSString *EVENT_UNABLE_CONNECT=@"EVENT_UNABLE_CONNECT";
 NSString *EVENT_CONNECTED=@"EVENT_CONNECTED";
+NSString *EVENT_LABEL_PRINTED=@"EVENT_LABEL_PRINTED";
 static NSArray<CBUUID *> *supportServices = nil;
 static NSDictionary *writeableCharactiscs = nil;
 bool hasListeners;
 static CBPeripheral *connected;
 static RNBluetoothManager *instance;
-static NSObject<WriteDataToBleDelegate> *writeDataDelegate;// delegate of write data resule;
-static NSData *toWrite;
-static NSTimer *timer;
+static dispatch_block_t scanTimeout;
+static BleWriteScheduler *writeScheduler;// owns the write characteristic, resolved once per connection
+static BOOL discoveringCharacteristic;
+static NSUInteger connectionId;
 
 +(Boolean)isConnected{
     return !(connected==nil);
 }
 
++(NSString *)connectedAddress{
+    return connected?connected.identifier.UUIDString:nil;
+}
+
+/**
+ * Changes on every connect and disconnect, a reconnected printer may have been reset.
+ **/
++(NSUInteger)connectionId{
+    return connectionId;
+}
+
+/**
+ * Serial queue shared by the printer modules and the CoreBluetooth callbacks,
+ * keeps image work and writes off the UI thread.
+ **/
++(dispatch_queue_t)printQueue
+{
+    static dispatch_queue_t queue;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        queue = dispatch_queue_create("cn.jystudio.bluetooth.print", DISPATCH_QUEUE_SERIAL);
+    });
+    return queue;
+}
+
 +(void)writeValue:(NSData *) data withDelegate:(NSObject<WriteDataToBleDelegate> *) delegate
 {
     @try{
-        writeDataDelegate = delegate;
-        toWrite = data;
-        connected.delegate = instance;
-        [connected discoverServices:supportServices];
-//    [connected writeValue:data forCharacteristic:[writeableCharactiscs objectForKey:supportServices[0]] type:CBCharacteristicWriteWithoutResponse];
+        if(!writeScheduler || writeScheduler.peripheral != connected){
+            [writeScheduler failAll];
+            writeScheduler = [[BleWriteScheduler alloc] initWithPeripheral:connected];
+            discoveringCharacteristic = NO;
+        }
+        [writeScheduler enqueue:data withDelegate:delegate];
+        if(!writeScheduler.characteristic && !discoveringCharacteristic){
+            discoveringCharacteristic = YES;
+            connected.delegate = instance;
+            [connected discoverServices:supportServices];
+            //Callbacks:
+            //peripheral:didDiscoverServices: -> peripheral:didDiscoverCharacteristicsForService:error:
+        }
     }
     @catch(NSException *e){
         NSLog(@"error in writing data to %@,issue:%@",connected,e);
-        [writeDataDelegate didWriteDataToBle:false];
+        [writeScheduler failAll];
+    }
+}
+
+/**
+ * Drops the cached write characteristic, the next write will look it up again.
+ **/
++(void)invalidateWriteCharacteristic
+{
+    writeScheduler.characteristic = nil;
+    discoveringCharacteristic = NO;
+}
+
+/**
+ * Fails the pending writes and forgets the connection's scheduler.
+ **/
++(void)resetWriteScheduler
+{
+    BleWriteScheduler *scheduler = writeScheduler;
+    writeScheduler = nil;
+    discoveringCharacteristic = NO;
+    [scheduler failAll];
+}
+
+/**
+ * Emits an event of another module through this emitter, dropped while nothing listens.
+ **/
++(void)emitEvent:(NSString *)name body:(id)body
+{
+    if(instance && hasListeners){
+        [instance sendEventWithName:name body:body];
     }
 }
 
@@ -70,6 +136,7 @@ static NSTimer *timer;
      EVENT_CONNECTION_LOST    Emits when device connection lost
      EVENT_UNABLE_CONNECT    Emits when error occurs while trying to connect device
      EVENT_CONNECTED    Emits when device connected
+     EVENT_LABEL_PRINTED    Emits when a label of printLabels has been written
      */
 
     return @{ EVENT_DEVICE_ALREADY_PAIRED: EVENT_DEVICE_ALREADY_PAIRED,
@@ -77,12 +144,13 @@ static NSTimer *timer;
               EVENT_DEVICE_FOUND:EVENT_DEVICE_FOUND,
               EVENT_CONNECTION_LOST:EVENT_CONNECTION_LOST,
               EVENT_UNABLE_CONNECT:EVENT_UNABLE_CONNECT,
-              EVENT_CONNECTED:EVENT_CONNECTED
+              EVENT_CONNECTED:EVENT_CONNECTED,
+              EVENT_LABEL_PRINTED:EVENT_LABEL_PRINTED
               };
 }
 - (dispatch_queue_t)methodQueue
 {
-    return dispatch_get_main_queue();
+    return [RNBluetoothManager printQueue];
 }
 
 + (BOOL)requiresMainQueueSetup
@@ -100,7 +168,8 @@ static NSTimer *timer;
              EVENT_UNABLE_CONNECT,
              EVENT_CONNECTION_LOST,
              EVENT_CONNECTED,
-             EVENT_DEVICE_ALREADY_PAIRED];
+             EVENT_DEVICE_ALREADY_PAIRED,
+             EVENT_LABEL_PRINTED];
 }
 
 
@@ -156,11 +225,15 @@ RCT_EXPORT_METHOD(scanDevices:(RCTPromiseResolveBlock)resolve
         //Callbacks:
         //centralManager:didDiscoverPeripheral:advertisementData:RSSI:
         NSLog(@"Scanning started with services.");
-        if(timer && timer.isValid){
-            [timer invalidate];
-            timer = nil;
+        if(scanTimeout){
+            dispatch_block_cancel(scanTimeout);
+            scanTimeout = nil;
         }
-        timer = [NSTimer scheduledTimerWithTimeInterval:30 target:self selector:@selector(callStop) userInfo:nil repeats:NO];
+        __weak RNBluetoothManager *weakSelf = self;
+        scanTimeout = dispatch_block_create(0, ^{
+            [weakSelf callStop];
+        });
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(30 * NSEC_PER_SEC)), [RNBluetoothManager printQueue], scanTimeout);
     
     }
     @catch(NSException *exception){
@@ -241,9 +314,9 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
             self.scanResolveBlock = nil;
         }
     }
-    if(timer && timer.isValid){
-        [timer invalidate];
-        timer = nil;
+    if(scanTimeout){
+        dispatch_block_cancel(scanTimeout);
+        scanTimeout = nil;
     }
     self.scanRejectBlock = nil;
     self.scanResolveBlock = nil;
@@ -266,10 +339,10 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
             if (![CBCentralManager instancesRespondToSelector:@selector(initWithDelegate:queue:options:)])
             {
                 //for ios version lowser than 7.0
-                self.centralManager = [[CBCentralManager alloc] initWithDelegate:self queue:nil];
+                self.centralManager = [[CBCentralManager alloc] initWithDelegate:self queue:[RNBluetoothManager printQueue]];
             }else
             {
-                self.centralManager = [[CBCentralManager alloc] initWithDelegate:self queue:nil options: nil];
+                self.centralManager = [[CBCentralManager alloc] initWithDelegate:self queue:[RNBluetoothManager printQueue] options: nil];
             }
         }
         if(!instance){
@@ -306,7 +379,9 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
 
 - (void)centralManager:(CBCentralManager *)central didConnectPeripheral:(CBPeripheral *)peripheral{
     NSLog(@"did connected: %@",peripheral);
+    [RNBluetoothManager resetWriteScheduler];
     connected = peripheral;
+    connectionId++;
     NSString *pId = peripheral.identifier.UUIDString;
     if(_waitingConnect && [_waitingConnect isEqualToString: pId] && self.connectResolveBlock){
         NSLog(@"Predefined the support services, stop to looking up services.");
@@ -324,6 +399,8 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
 }
 
 - (void)centralManager:(CBCentralManager *)central didDisconnectPeripheral:(CBPeripheral *)peripheral error:(nullable NSError *)error{
+    [RNBluetoothManager resetWriteScheduler];
+    connectionId++;
     if(!connected && _waitingConnect && [_waitingConnect isEqualToString:peripheral.identifier.UUIDString]){
         if(self.connectRejectBlock){
             RCTPromiseRejectBlock rjBlock = self.connectRejectBlock;
@@ -375,14 +452,32 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
 - (void)peripheral:(CBPeripheral *)peripheral didDiscoverServices:(nullable NSError *)error{
     if (error){
         NSLog(@"扫描外设服务出错：%@-> %@", peripheral.name, [error localizedDescription]);
+        discoveringCharacteristic = NO;
+        [writeScheduler failAll];
         return;
     }
     NSLog(@"扫描到外设服务：%@ -> %@",peripheral.name,peripheral.services);
+    BOOL printerService = NO;
     for (CBService *service in peripheral.services) {
-        [peripheral discoverCharacteristics:nil forService:service];
+        NSString *writeable = [writeableCharactiscs objectForKey:service.UUID];
+        if(writeable){
+            //only the write characteristic is needed, skip the rest of the GATT table.
+            [peripheral discoverCharacteristics:@[[CBUUID UUIDWithString:writeable]] forService:service];
+        }else{
+            [peripheral discoverCharacteristics:nil forService:service];
+        }
+        if([service.UUID.UUIDString isEqualToString:supportServices[0].UUIDString]){
+            printerService = YES;
+        }
          NSLog(@"服务id：%@",service.UUID.UUIDString);
     }
     NSLog(@"开始扫描外设服务的特征 %@...",peripheral.name);
+    if(discoveringCharacteristic && !printerService){
+        //no characteristic callback will come for the writes waiting on it
+        NSLog(@"Printer service not found on: %@",peripheral.name);
+        discoveringCharacteristic = NO;
+        [writeScheduler failAll];
+    }
     
     if(error && self.connectRejectBlock){
         RCTPromiseRejectBlock rjBlock = self.connectRejectBlock;
@@ -411,35 +506,26 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
  *                        they can be retrieved via <i>service</i>'s <code>characteristics</code> property.
  */
 - (void)peripheral:(CBPeripheral *)peripheral didDiscoverCharacteristicsForService:(CBService *)service error:(nullable NSError *)error{
-    if(toWrite && connected
+    if(writeScheduler && connected
        && [connected.identifier.UUIDString isEqualToString:peripheral.identifier.UUIDString]
        && [service.UUID.UUIDString isEqualToString:supportServices[0].UUIDString]){
+        discoveringCharacteristic = NO;
         if(error){
             NSLog(@"Discrover charactoreristics error:%@",error);
-           if(writeDataDelegate)
-           {
-               [writeDataDelegate didWriteDataToBle:false];
-               return;
-           }
+            [writeScheduler failAll];
+            return;
         }
         for(CBCharacteristic *cc in service.characteristics){
             NSLog(@"Characterstic found: %@ in service: %@" ,cc,service.UUID.UUIDString);
             if([cc.UUID.UUIDString isEqualToString:[writeableCharactiscs objectForKey: supportServices[0]]]){
-                @try{
-                    [connected writeValue:toWrite forCharacteristic:cc type:CBCharacteristicWriteWithoutResponse];
-                   if(writeDataDelegate) [writeDataDelegate didWriteDataToBle:true];
-                    if(toWrite){
-                        NSLog(@"Value wrote: %lu",[toWrite length]);
-                    }
-                }
-                @catch(NSException *e){
-                    NSLog(@"ERRO IN WRITE VALUE: %@",e);
-                      [writeDataDelegate didWriteDataToBle:false];
-                }
+                writeScheduler.characteristic = cc;
+                [writeScheduler pump];
             }
         }
-        
-        
+        if(!writeScheduler.characteristic){
+            NSLog(@"Write characteristic not found in service: %@",service.UUID.UUIDString);
+            [writeScheduler failAll];
+        }
     }
     
     if(error){
@@ -545,6 +631,43 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
 //    }
 }
 
+/*!
+ *  @method peripheral:didModifyServices:
+ *
+ *  @param peripheral            The peripheral providing this update.
+ *  @param invalidatedServices    The services that have been invalidated
+ *
+ *  @discussion            This method is invoked when the @link services @/link of <i>peripheral</i> have been changed.
+ *                        The cached write characteristic is dropped if its service is gone.
+ */
+- (void)peripheral:(CBPeripheral *)peripheral didModifyServices:(NSArray<CBService *> *)invalidatedServices{
+    CBCharacteristic *cached = writeScheduler.characteristic;
+    for(CBService *service in invalidatedServices){
+        if(cached && [service.UUID isEqual:cached.service.UUID]){
+            NSLog(@"Write service invalidated: %@",service.UUID.UUIDString);
+            [RNBluetoothManager invalidateWriteCharacteristic];
+            if([writeScheduler hasPendingWrites]){
+                discoveringCharacteristic = YES;
+                [peripheral discoverServices:supportServices];
+            }
+        }
+    }
+}
+
+/*!
+ *  @method peripheralIsReadyToSendWriteWithoutResponse:
+ *
+ *  @param peripheral   The peripheral providing this update.
+ *
+ *  @discussion         This method is invoked after a failed call to @link writeValue:forCharacteristic:type: @/link, when <i>peripheral</i> is again
+ *                      ready to send characteristic value updates.
+ */
+- (void)peripheralIsReadyToSendWriteWithoutResponse:(CBPeripheral *)peripheral{
+    if(writeScheduler && writeScheduler.peripheral == peripheral){
+        [writeScheduler pump];
+    }
+}
+
 /*!
  *  @method peripheral:didWriteValueForCharacteristic:error:
  *
@@ -555,16 +678,8 @@ RCT_EXPORT_METHOD(connect:(NSString *)address
  *  @discussion                This method returns the result of a {@link writeValue:forCharacteristic:type:} call, when the <code>CBCharacteristicWriteWithResponse</code> type is used.
  */
 - (void)peripheral:(CBPeripheral *)peripheral didWriteValueForCharacteristic:(CBCharacteristic *)characteristic error:(nullable NSError *)error{
-    if(error){
-        NSLog(@"Error in writing bluetooth: %@",error);
-        if(writeDataDelegate){
-            [writeDataDelegate didWriteDataToBle:false];
-        }
-    }
-    
-    NSLog(@"Write bluetooth success.");
-    if(writeDataDelegate){
-        [writeDataDelegate didWriteDataToBle:true];
+    if(writeScheduler && writeScheduler.peripheral == peripheral){
+        [writeScheduler didWriteWithResponse:error];
     }
 }
  
@@ -9,6 +9,8 @@
 #import <Foundation/Foundation.h>
 #import "RNBluetoothTscPrinter.h"
 #import "RNTscCommand.h"
+#import "LabelTemplate.h"
+#import "LabelBatch.h"
 #import "RNBluetoothManager.h"
 
 @implementation RNBluetoothTscPrinter
@@ -20,7 +22,7 @@ NSInteger now;
 
 - (dispatch_queue_t)methodQueue
 {
-    return dispatch_get_main_queue();
+    return [RNBluetoothManager printQueue];
 }
 + (BOOL)requiresMainQueueSetup
 {
@@ -28,9 +30,107 @@ NSInteger now;
 }
 
 RCT_EXPORT_MODULE(BluetoothTscPrinter);
+
+/**
+ * Compiled label templates by id.
+ **/
++(NSMutableDictionary<NSString *, LabelTemplate *> *)templates
+{
+    static NSMutableDictionary *templates;
+    static dispatch_once_t once;
+    dispatch_once(&once, ^{
+        templates = [[NSMutableDictionary alloc] init];
+    });
+    return templates;
+}
+
 //printLabel(final ReadableMap options, final Promise promise)
 RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseResolveBlock)resolve
                   rejecter:(RCTPromiseRejectBlock)reject)
+{
+    RNTscCommand *tsc = [[RNTscCommand alloc] init];
+    [self addSetup:tsc options:options];
+    [self addBody:tsc options:options template:nil];
+    [self addPrint:tsc options:options];
+    [self sendLabel:tsc.command resolver:resolve rejecter:reject];
+}
+
+/**
+ * Prints a list of printLabel options as one job. The setup is sent with the first label and
+ * again only when a label's setup differs from the one before, every label is CLS, its body and
+ * PRINT. EVENT_LABEL_PRINTED {index, total} is emitted as each label is written.
+ **/
+RCT_EXPORT_METHOD(printLabels:(NSArray *) labels withResolve:(RCTPromiseResolveBlock)resolve
+                  rejecter:(RCTPromiseRejectBlock)reject)
+{
+    __block NSData *lastSetup = nil;
+    LabelBatch *batch = [[LabelBatch alloc] initWithCount:[labels count] build:^NSData *(NSUInteger index) {
+        NSDictionary *options = [labels objectAtIndex:index];
+        RNTscCommand *tsc = [[RNTscCommand alloc] init];
+        [self addSetup:tsc options:options];
+        if(lastSetup && [lastSetup isEqualToData:tsc.command]){
+            [tsc.command setLength:0];
+        }else{
+            lastSetup = [tsc.command copy];
+        }
+        [self addBody:tsc options:options template:nil];
+        [self addPrint:tsc options:options];
+        return tsc.command;
+    } resolver:resolve rejecter:reject];
+    [batch start];
+}
+
+/**
+ * Compiles the printLabel options once, images included. Text, QR code and barcode entries
+ * with a slot name get their text/code from the values of printLabelTemplate.
+ **/
+RCT_EXPORT_METHOD(compileLabelTemplate:(NSString *)templateId options:(NSDictionary *) options
+                  resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)
+{
+    RNTscCommand *setup = [[RNTscCommand alloc] init];
+    RNTscCommand *body = [[RNTscCommand alloc] init];
+    LabelTemplate *template = [[LabelTemplate alloc] init];
+    [self addSetup:setup options:options];
+    [self addBody:body options:options template:template];
+    template.setup = setup.command;
+    template.body = body.command;
+    template.sound = [[options valueForKey:@"sound"] integerValue] != 0;
+    [[RNBluetoothTscPrinter templates] setObject:template forKey:templateId];
+    resolve(nil);
+}
+
+/**
+ * Prints a compiled label, values maps slot names to their text.
+ **/
+RCT_EXPORT_METHOD(printLabelTemplate:(NSString *)templateId values:(NSDictionary *)values
+                  resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)
+{
+    LabelTemplate *template = [[RNBluetoothTscPrinter templates] objectForKey:templateId];
+    if(!template){
+        reject(@"TEMPLATE_NOT_COMPILED",@"TEMPLATE_NOT_COMPILED",nil);
+        return;
+    }
+    RNTscCommand *tsc = [[RNTscCommand alloc] init];
+    [tsc.command appendData:template.setup];
+    [template appendBodyTo:tsc.command values:[values isKindOfClass:[NSDictionary class]] ? values : nil];
+    [tsc addPrint:1 n:1];
+    if (template.sound) {
+        [tsc addSound:2 interval:100];
+    }
+    [self sendLabel:tsc.command resolver:resolve rejecter:reject];
+}
+
+RCT_EXPORT_METHOD(removeLabelTemplate:(NSString *)templateId
+                  resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject)
+{
+    [[RNBluetoothTscPrinter templates] removeObjectForKey:templateId];
+    resolve(nil);
+}
+
+/**
+ * SIZE, GAP, DIRECTION and the other settings sent before the first CLS.
+ **/
+-(void)addSetup:(RNTscCommand *)tsc options:(NSDictionary *)options
 {
     NSInteger width = [[options valueForKey:@"width"] integerValue];
     NSInteger height = [[options valueForKey:@"height"] integerValue];
@@ -38,17 +138,10 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
     NSInteger home = [[options valueForKey:@"home"] integerValue];
     NSString *tear = [options valueForKey:@"tear"];
     if(!tear || ![@"ON" isEqualToString:tear]) tear = @"OFF";
-    NSArray *texts = [options objectForKey:@"text"];
-    NSArray *qrCodes = [options objectForKey:@"qrcode"];
-    NSArray *barCodes = [options objectForKey:@"barcode"];
-    NSArray *images = [options objectForKey:@"image"];
-    NSArray *reverses = [options objectForKey:@"revers"];
     NSInteger direction = [[options valueForKey:@"direction"] integerValue];
     NSInteger density = [[options valueForKey:@"density"] integerValue];
     NSArray* reference = [options objectForKey:@"reference"];
-    NSInteger sound = [[options valueForKey:@"sound"] integerValue];
     NSInteger speed = [[options valueForKey:@"speed"] integerValue];
-    RNTscCommand *tsc = [[RNTscCommand alloc] init];
     if(speed){
         [tsc addSpeed:[tsc findSpeedValue:speed]];
     }
@@ -71,12 +164,39 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
       [tsc addBackFeed:16];
       [tsc addHome];
     }
+}
+
+/**
+ * PRINT sets,copies and the beep after it, both counts default to 1.
+ **/
+-(void)addPrint:(RNTscCommand *)tsc options:(NSDictionary *)options
+{
+    NSInteger sets = MAX(1, [[options valueForKey:@"sets"] integerValue]);
+    NSInteger copies = MAX(1, [[options valueForKey:@"copies"] integerValue]);
+    [tsc addPrint:sets n:copies];
+    if ([[options valueForKey:@"sound"] integerValue]) {
+        [tsc addSound:2 interval:100];
+    }
+}
+
+/**
+ * CLS and the label content, with slots marked in template when compiling one.
+ **/
+-(void)addBody:(RNTscCommand *)tsc options:(NSDictionary *)options template:(LabelTemplate *)template
+{
+    NSArray *texts = [options objectForKey:@"text"];
+    NSArray *qrCodes = [options objectForKey:@"qrcode"];
+    NSArray *barCodes = [options objectForKey:@"barcode"];
+    NSArray *images = [options objectForKey:@"image"];
+    NSArray *reverses = [options objectForKey:@"revers"];
     [tsc addCls];
 
     //Add Texts
     for(int i=0; texts && i<[texts count];i++){
         NSDictionary * text = [texts objectAtIndex:i];
+        NSString *slot = template ? [text valueForKey:@"slot"] : nil;
         NSString *t = [text valueForKey:@"text"];
+        NSString *content = slot ? @"" : t;
         NSInteger x = [[text valueForKey:@"x"] integerValue];
         NSInteger y = [[text valueForKey:@"y"] integerValue];
         NSString *fontType = [text valueForKey:@"fonttype"];
@@ -85,12 +205,15 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
         NSInteger yscal = [[text valueForKey:@"yscal"] integerValue];
         Boolean bold = [[text valueForKey:@"bold"] boolValue];
 
-        [tsc addText:x y:y fontType:fontType rotation:rotation xscal:xscal yscal:yscal text:t];
+        [tsc addText:x y:y fontType:fontType rotation:rotation xscal:xscal yscal:yscal text:content];
+        if(slot) [template markSlot:slot in:tsc defaultValue:t];
         if(bold){
             [tsc addText:x+1 y:y fontType:fontType
-                rotation:rotation xscal:xscal yscal:yscal  text:t];
+                rotation:rotation xscal:xscal yscal:yscal  text:content];
+            if(slot) [template markSlot:slot in:tsc defaultValue:t];
             [tsc addText:x y:y+1 fontType:fontType
-                rotation:rotation xscal:xscal yscal:yscal  text:t];
+                rotation:rotation xscal:xscal yscal:yscal  text:content];
+            if(slot) [template markSlot:slot in:tsc defaultValue:t];
         }
     }
 
@@ -104,12 +227,14 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
             NSString *image  = [img valueForKey:@"image"];
             NSData *imageData = [[NSData alloc] initWithBase64EncodedString:image options:0];
             UIImage *uiImage = [[UIImage alloc] initWithData:imageData];
-            [tsc addBitmap:x y:y bitmapMode:mode width:imgWidth bitmap:uiImage];
+            DitherMode dither = [ImageDither modeWithName:[img valueForKey:@"dither"] fallback:DitherBayer16];
+            [tsc addBitmap:x y:y bitmapMode:mode width:imgWidth bitmap:uiImage dither:dither];
         }
 
     //QRCode
     for (int i = 0; qrCodes && i < [qrCodes count]; i++) {
         NSDictionary *qr = [qrCodes objectAtIndex:i];
+        NSString *slot = template ? [qr valueForKey:@"slot"] : nil;
         NSInteger x = [[qr valueForKey:@"x"] integerValue];
         NSInteger y = [[qr valueForKey:@"y"] integerValue];
         NSInteger qrWidth = [[qr valueForKey:@"width"] integerValue];
@@ -117,12 +242,14 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
         if(!level)level = @"M";
         NSInteger rotation = [[qr valueForKey:@"rotation"] integerValue];
         NSString *code = [qr valueForKey:@"code"];
-        [tsc addQRCode:x y:y errorCorrectionLevel:level width:qrWidth rotation:rotation code:code];
+        [tsc addQRCode:x y:y errorCorrectionLevel:level width:qrWidth rotation:rotation code:slot ? @"" : code];
+        if(slot) [template markSlot:slot in:tsc defaultValue:code];
     }
 
     //BarCode
    for (int i = 0; barCodes && i < [barCodes count]; i++) {
        NSDictionary *bar = [barCodes objectAtIndex:i];
+       NSString *slot = template ? [bar valueForKey:@"slot"] : nil;
        NSInteger x = [[bar valueForKey:@"x"] integerValue];
        NSInteger y = [[bar valueForKey:@"y"] integerValue];
        NSInteger barWide =[[bar valueForKey:@"wide"] integerValue];
@@ -134,7 +261,8 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
        NSString *code = [bar valueForKey:@"code"];
        NSString *type = [bar valueForKey:@"type"];
        NSInteger readable = [[bar valueForKey:@"readable"] integerValue];
-       [tsc add1DBarcode:x y:y barcodeType:type height:barHeight wide:barWide narrow:narrow readable:readable rotation:rotation content:code];
+       [tsc add1DBarcode:x y:y barcodeType:type height:barHeight wide:barWide narrow:narrow readable:readable rotation:rotation content:slot ? @"" : code];
+       if(slot) [template markSlot:slot in:tsc defaultValue:code];
     }
     for(int i=0; reverses&& i < [reverses count]; i++){
         NSDictionary *area = [reverses objectAtIndex:i];
@@ -144,13 +272,13 @@ RCT_EXPORT_METHOD(printLabel:(NSDictionary *) options withResolve:(RCTPromiseRes
         NSInteger aHeight = [[area valueForKey:@"height"] integerValue];
         [tsc addReverse:ax y:ay xwidth:aWidth yheigth:aHeight];
     }
-    [tsc addPrint:1 n:1];
-    if (sound) {
-        [tsc addSound:2 interval:100];
-    }
+}
+
+-(void)sendLabel:(NSData *)data resolver:(RCTPromiseResolveBlock)resolve rejecter:(RCTPromiseRejectBlock)reject
+{
     _pendingReject = reject;
     _pendingResolve = resolve;
-    toPrint = tsc.command;
+    toPrint = data;
     now = 0;
     [RNBluetoothManager writeValue:toPrint withDelegate:self];
 }
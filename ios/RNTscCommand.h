@@ -7,11 +7,14 @@
 //
 #import <Foundation/Foundation.h>
 #import <React/RCTBridgeModule.h>
+#import "ImageDither.h"
 @interface RNTscCommand : NSObject
 @property NSMutableData *command;
 -(id)init;
 -(id)initWithSize:(NSInteger)width height:(NSInteger) height andGap:(NSInteger)gap;
 -(void)addStrToCommand:(NSString *)str;
+/** the bytes addStrToCommand writes for str */
++(NSData *)encode:(NSString *)str;
 -(void)addGap:(NSInteger)gap;
 -(void)addSize:(NSInteger)width height:(NSInteger) height;
 -(void)addCashdrwer:(NSInteger) m/*0,1*/ t1:(NSInteger) t1 t2:(NSInteger) t2;
@@ -59,6 +62,9 @@
 -(void)addBitmap:(NSInteger) x y:(NSInteger) y
       bitmapMode:(NSInteger) mode width:(NSInteger) nWidth
           bitmap:(UIImage *) b;
+-(void)addBitmap:(NSInteger) x y:(NSInteger) y
+      bitmapMode:(NSInteger) mode width:(NSInteger) nWidth
+          bitmap:(UIImage *) b dither:(DitherMode) dither;
 -(void)addBox:(NSInteger) x y:(NSInteger) y xend:(NSInteger) xend yend:(NSInteger) yend;
 -(void)addErase:(NSInteger) x y:(NSInteger) y xwidth:(NSInteger) xwidth yheigth:(NSInteger) yheight;
 -(void)addReverse:(NSInteger) x y:(NSInteger) y xwidth:(NSInteger) xwidth yheigth:(NSInteger) yheight;
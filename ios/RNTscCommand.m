@@ -23,11 +23,16 @@
     [self addGap:gap];
     return self;
 }
++(NSData *)encode:(NSString *)str
+{
+    //encoding GBK? UTF-8? GB2312?
+    NSData *data = [str dataUsingEncoding:CFStringConvertEncodingToNSStringEncoding(kCFStringEncodingGB_18030_2000)];
+    return data ? data : [NSData data];
+}
 -(void)addStrToCommand:(NSString *)str
 {
     if(str){
-    //encoding GBK? UTF-8? GB2312?
-        [_command appendData:[str dataUsingEncoding:CFStringConvertEncodingToNSStringEncoding(kCFStringEncodingGB_18030_2000)]];
+        [_command appendData:[RNTscCommand encode:str]];
     }
 }
 -(void)addGap:(NSInteger)gap
@@ -160,7 +165,12 @@ code:(NSString *) code
 -(void)addBitmap:(NSInteger) x y:(NSInteger) y
 bitmapMode:(NSInteger) mode width:(NSInteger) nWidth
 bitmap:(UIImage *) b{
-    //todo: NEED TO IMPLEMENT>>>>>>
+    [self addBitmap:x y:y bitmapMode:mode width:nWidth bitmap:b dither:DitherBayer16];
+}
+
+-(void)addBitmap:(NSInteger) x y:(NSInteger) y
+bitmapMode:(NSInteger) mode width:(NSInteger) nWidth
+bitmap:(UIImage *) b dither:(DitherMode) dither{
     if (b) {
         CGFloat imgWidth = b.size.width;
         CGFloat imgHeigth = b.size.height;
@@ -168,9 +178,11 @@ bitmap:(UIImage *) b{
         NSInteger height = imgHeigth * width / imgWidth;
         UIImage *resized = [ImageUtils imageWithImage:b scaledToFillSize:CGSizeMake(width, height)];
         uint8_t * graybits = [ImageUtils imageToGreyImage:resized];
-        NSInteger srcLen = (int)resized.size.width*resized.size.height;
-        NSData *codecontent = [ImageUtils pixToTscCmd:graybits width:srcLen];
-        height = srcLen / width;
+        size_t length = raster_tsc_size(width, height);
+        uint8_t *data = malloc(length);
+        raster_tsc_encode(graybits, width, height, (raster_dither_mode)dither, data);
+        free(graybits);
+        NSData *codecontent = [NSData dataWithBytesNoCopy:data length:length freeWhenDone:YES];
         width /= 8;
         NSString *str =[NSString stringWithFormat:@ "BITMAP %ld,%ld,%ld,%ld,%ld,",
                         x,y,width,height,mode];
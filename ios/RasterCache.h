@@ -0,0 +1,32 @@
+//
+//  RasterCache.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+
+/**
+ * Encoded GS v 0 rasters of printed images, so a repeated logo or QR code skips the
+ * decode/scale/dither work. Recently used entries are kept up to `capacity` bytes,
+ * images registered by id are kept until the cache is cleared.
+ * Only used from the print queue, so there is no locking.
+ **/
+@interface RasterCache : NSObject
+@property (nonatomic,assign) NSUInteger capacity;
+@property (readonly) NSUInteger size;
+@property (readonly) NSUInteger hits;
+@property (readonly) NSUInteger misses;
++(instancetype)sharedCache;
+/**
+ * SHA-1 of the source content and everything else the raster depends on.
+ **/
++(NSString *)keyForContent:(NSString *)content params:(NSString *)params;
+-(NSData *)dataForKey:(NSString *)key;
+-(void)setData:(NSData *)data forKey:(NSString *)key;
+-(NSData *)registeredDataForId:(NSString *)imageId;
+-(void)registerData:(NSData *)data forId:(NSString *)imageId;
+-(void)removeAll;
+-(NSDictionary *)stats;
+@end
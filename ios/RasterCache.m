@@ -0,0 +1,133 @@
+//
+//  RasterCache.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <CommonCrypto/CommonDigest.h>
+#import "RasterCache.h"
+
+static const NSUInteger DEFAULT_CAPACITY = 1024*1024;
+
+@implementation RasterCache
+{
+    NSMutableDictionary<NSString *,NSData *> *entries;
+    NSMutableArray<NSString *> *order;// least recently used first
+    NSMutableDictionary<NSString *,NSData *> *registered;
+}
+
++(instancetype)sharedCache
+{
+    static RasterCache *cache;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        cache = [[RasterCache alloc] init];
+    });
+    return cache;
+}
+
++(NSString *)keyForContent:(NSString *)content params:(NSString *)params
+{
+    NSMutableData *source = [[content dataUsingEncoding:NSUTF8StringEncoding] mutableCopy];
+    [source appendData:[params dataUsingEncoding:NSUTF8StringEncoding]];
+    unsigned char digest[CC_SHA1_DIGEST_LENGTH];
+    CC_SHA1([source bytes], (CC_LONG)[source length], digest);
+    NSMutableString *key = [NSMutableString stringWithCapacity:CC_SHA1_DIGEST_LENGTH*2];
+    for(int i=0;i<CC_SHA1_DIGEST_LENGTH;i++){
+        [key appendFormat:@"%02x",digest[i]];
+    }
+    return key;
+}
+
+-(id)init
+{
+    if(self = [super init]){
+        entries = [[NSMutableDictionary alloc] init];
+        order = [[NSMutableArray alloc] init];
+        registered = [[NSMutableDictionary alloc] init];
+        _capacity = DEFAULT_CAPACITY;
+    }
+    return self;
+}
+
+-(NSData *)dataForKey:(NSString *)key
+{
+    NSData *data = [entries objectForKey:key];
+    if(!data){
+        _misses++;
+        return nil;
+    }
+    _hits++;
+    [order removeObject:key];
+    [order addObject:key];
+    return data;
+}
+
+-(void)setData:(NSData *)data forKey:(NSString *)key
+{
+    [self removeKey:key];
+    if(!data || [data length]>_capacity) return;
+    [entries setObject:data forKey:key];
+    [order addObject:key];
+    _size += [data length];
+    [self trim];
+}
+
+-(void)removeKey:(NSString *)key
+{
+    NSData *old = [entries objectForKey:key];
+    if(!old) return;
+    _size -= [old length];
+    [entries removeObjectForKey:key];
+    [order removeObject:key];
+}
+
+-(void)trim
+{
+    while(_size>_capacity && [order count]>0){
+        [self removeKey:[order objectAtIndex:0]];
+    }
+}
+
+-(void)setCapacity:(NSUInteger)capacity
+{
+    _capacity = capacity;
+    [self trim];
+}
+
+-(NSData *)registeredDataForId:(NSString *)imageId
+{
+    return [registered objectForKey:imageId];
+}
+
+-(void)registerData:(NSData *)data forId:(NSString *)imageId
+{
+    [registered setObject:data forKey:imageId];
+}
+
+-(void)removeAll
+{
+    [entries removeAllObjects];
+    [order removeAllObjects];
+    [registered removeAllObjects];
+    _size = 0;
+}
+
+-(NSDictionary *)stats
+{
+    NSUInteger registeredSize = 0;
+    for(NSData *data in [registered allValues]){
+        registeredSize += [data length];
+    }
+    return @{@"hits":@(_hits),
+             @"misses":@(_misses),
+             @"entries":@([entries count]),
+             @"size":@(_size),
+             @"capacity":@(_capacity),
+             @"registered":@([registered count]),
+             @"registeredSize":@(registeredSize)};
+}
+@end
@@ -0,0 +1,230 @@
+//
+//  BleWriteSchedulerTests.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+//  Throughput of BleWriteScheduler against a FakePeripheral with a given MTU and credit rate:
+//  a 576 dot wide logo arrives whole, in chunks of the MTU, none dropped, at about the rate the
+//  link gives credits back. Built by examplesTests in examples/ios.
+//
+
+#import <XCTest/XCTest.h>
+#import <QuartzCore/QuartzCore.h>
+#import "BleWriteScheduler.h"
+#import "FakePeripheral.h"
+
+/**
+ * What RNBluetoothManager does with the peripheral callbacks of its scheduler.
+ **/
+@interface SchedulerLink : NSObject<CBPeripheralDelegate,WriteDataToBleDelegate>
+@property BleWriteScheduler *scheduler;
+@property NSUInteger settled;
+@property NSUInteger failed;
+@property NSUInteger expected;
+@property XCTestExpectation *done;
+@end
+
+@implementation SchedulerLink
+- (void)peripheralIsReadyToSendWriteWithoutResponse:(CBPeripheral *)peripheral
+{
+    [self.scheduler pump];
+}
+
+- (void)peripheral:(CBPeripheral *)peripheral didWriteValueForCharacteristic:(CBCharacteristic *)characteristic error:(NSError *)error
+{
+    [self.scheduler didWriteWithResponse:error];
+}
+
+- (void) didWriteDataToBle: (BOOL)success
+{
+    self.settled++;
+    if(!success) self.failed++;
+    if(self.settled==self.expected) [self.done fulfill];
+}
+@end
+
+@interface BleWriteSchedulerTests : XCTestCase
+@end
+
+@implementation BleWriteSchedulerTests
+
+- (NSData *)logo
+{
+    //GS v 0 header and 72 bytes a row for 400 rows
+    NSMutableData *data = [NSMutableData dataWithLength:8+72*400];
+    uint8_t *bytes = [data mutableBytes];
+    const uint8_t header[8] = {29,118,48,0,72,0,0x90,0x01};
+    memcpy(bytes, header, 8);
+    uint32_t x = 2463534242u;
+    for(NSUInteger i=8;i<[data length];i++){
+        x ^= x<<13; x ^= x>>17; x ^= x<<5;
+        bytes[i] = (uint8_t)x;
+    }
+    return data;
+}
+
+/**
+ * Writes payload split in parts of part bytes and returns the seconds until the last was accepted.
+ **/
+- (double)send:(NSData *)payload parts:(NSUInteger)part to:(FakePeripheral *)printer
+{
+    return [self send:payload parts:part to:printer flowControl:YES];
+}
+
+/**
+ * flowControl NO behaves as the scheduler does before iOS 11.
+ **/
+- (double)send:(NSData *)payload parts:(NSUInteger)part to:(FakePeripheral *)printer flowControl:(BOOL)flowControl
+{
+    SchedulerLink *link = [[SchedulerLink alloc] init];
+    BleWriteScheduler *scheduler = [[BleWriteScheduler alloc] initWithPeripheral:[printer peripheral]];
+    scheduler.characteristic = [printer writeCharacteristic];
+    scheduler.flowControl = flowControl;
+    link.scheduler = scheduler;
+    link.expected = ([payload length]+part-1)/part;
+    link.done = [self expectationWithDescription:@"payload accepted"];
+    printer.delegate = link;
+    CFTimeInterval start = CACurrentMediaTime();
+    dispatch_async([RNBluetoothManager printQueue], ^{
+        for(NSUInteger at=0;at<[payload length];at+=part){
+            [scheduler enqueue:[payload subdataWithRange:NSMakeRange(at, MIN(part, [payload length]-at))] withDelegate:link];
+        }
+    });
+    [self waitForExpectationsWithTimeout:60 handler:nil];
+    double elapsed = CACurrentMediaTime()-start;
+    XCTAssertEqual(link.failed, 0);
+    XCTAssertFalse([scheduler hasPendingWrites]);
+    return elapsed;
+}
+
+- (void)measureMtu:(NSUInteger)mtu credits:(NSUInteger)credits perSecond:(double)rate withResponse:(BOOL)withResponse
+{
+    NSData *logo = [self logo];
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.mtu = mtu;
+    printer.credits = credits;
+    printer.creditsPerSecond = rate;
+    printer.withResponseOnly = withResponse;
+    //PrintImageBleWriteDelegate hands over bands of 24 rows
+    double elapsed = [self send:logo parts:8+72*24 to:printer];
+    NSUInteger chunks = 0;
+    for(NSUInteger at=0;at<[logo length];at+=8+72*24){
+        NSUInteger part = MIN(8+72*24, [logo length]-at);
+        chunks += (part+mtu-1)/mtu;
+    }
+    double linkSeconds = (withResponse ? chunks : (chunks>credits ? chunks-credits : 0))/rate;
+    NSLog(@"MTU %lu, %lu credits at %.0f/s%@: %lu bytes in %lu writes, %.0f ms, %.0f bytes/s, link limit %.0f ms",
+          (unsigned long)mtu, (unsigned long)credits, rate, withResponse?@" with response":@"",
+          (unsigned long)[logo length], (unsigned long)printer.writes, elapsed*1000, [logo length]/elapsed, linkSeconds*1000);
+    XCTAssertEqualObjects(printer.received, logo);
+    XCTAssertEqual(printer.writes, chunks);
+    XCTAssertEqual(printer.dropped, 0);
+    //no sleeps of its own, only what the link takes plus scheduling
+    XCTAssertLessThan(elapsed, linkSeconds*1.5+0.25);
+}
+
+- (void)testSmallMtu
+{
+    [self measureMtu:20 credits:4 perSecond:2000 withResponse:NO];
+}
+
+- (void)testNegotiatedMtu
+{
+    [self measureMtu:182 credits:8 perSecond:400 withResponse:NO];
+    [self measureMtu:509 credits:8 perSecond:150 withResponse:NO];
+}
+
+- (void)testWithResponse
+{
+    [self measureMtu:182 credits:0 perSecond:200 withResponse:YES];
+}
+
+- (void)testUnlimitedLink
+{
+    NSData *logo = [self logo];
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.mtu = 244;
+    double elapsed = [self send:logo parts:[logo length] to:printer];
+    NSLog(@"MTU 244 without flow control: %.1f ms, %.0f bytes/s", elapsed*1000, [logo length]/elapsed);
+    XCTAssertEqualObjects(printer.received, logo);
+}
+
+- (void)testFailedResponseFailsTheRest
+{
+    //an error in the write response fails what is still queued
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.withResponseOnly = YES;
+    SchedulerLink *link = [[SchedulerLink alloc] init];
+    BleWriteScheduler *scheduler = [[BleWriteScheduler alloc] initWithPeripheral:[printer peripheral]];
+    scheduler.characteristic = [printer writeCharacteristic];
+    link.scheduler = scheduler;
+    link.expected = 3;
+    link.done = [self expectationWithDescription:@"writes settled"];
+    dispatch_async([RNBluetoothManager printQueue], ^{
+        [scheduler enqueue:[NSMutableData dataWithLength:10] withDelegate:link];
+        [scheduler enqueue:[NSMutableData dataWithLength:10] withDelegate:link];
+        [scheduler enqueue:[NSMutableData dataWithLength:10] withDelegate:link];
+        [scheduler didWriteWithResponse:[NSError errorWithDomain:CBATTErrorDomain code:CBATTErrorUnlikelyError userInfo:nil]];
+    });
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    //the first job waited for that response as well
+    XCTAssertEqual(link.failed, 3);
+}
+
+- (void)testWithResponseSettlesOnTheResponse
+{
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.withResponseOnly = YES;
+    printer.creditsPerSecond = 10;
+    SchedulerLink *link = [[SchedulerLink alloc] init];
+    BleWriteScheduler *scheduler = [[BleWriteScheduler alloc] initWithPeripheral:[printer peripheral]];
+    scheduler.characteristic = [printer writeCharacteristic];
+    link.scheduler = scheduler;
+    link.expected = 1;
+    link.done = [self expectationWithDescription:@"write answered"];
+    printer.delegate = link;
+    __block NSUInteger settledBeforeResponse = 1;
+    dispatch_async([RNBluetoothManager printQueue], ^{
+        [scheduler enqueue:[NSMutableData dataWithLength:10] withDelegate:link];
+        settledBeforeResponse = link.settled;
+    });
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    XCTAssertEqual(settledBeforeResponse, 0);
+    XCTAssertEqual(link.failed, 0);
+    XCTAssertEqual(printer.writesWithResponse, 1);
+}
+
+- (void)testWithoutFlowControlWritesWithResponse
+{
+    //before iOS 11 a characteristic that takes both gets writes with response
+    NSData *logo = [self logo];
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.mtu = 182;
+    printer.credits = 4;
+    printer.creditsPerSecond = 2000;
+    [self send:logo parts:8+72*24 to:printer flowControl:NO];
+    XCTAssertEqualObjects(printer.received, logo);
+    XCTAssertEqual(printer.writesWithResponse, printer.writes);
+    XCTAssertEqual(printer.dropped, 0);
+}
+
+- (void)testWithoutFlowControlPacesWrites
+{
+    //before iOS 11 a characteristic without response only gets a chunk every writeInterval
+    NSData *band = [[self logo] subdataWithRange:NSMakeRange(0, 8+72*24)];
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.mtu = 182;
+    printer.credits = 1;
+    printer.creditsPerSecond = 100;
+    printer.withoutResponseOnly = YES;
+    double elapsed = [self send:band parts:[band length] to:printer flowControl:NO];
+    NSUInteger chunks = ([band length]+181)/182;
+    XCTAssertEqualObjects(printer.received, band);
+    XCTAssertEqual(printer.writes, chunks);
+    XCTAssertEqual(printer.writesWithResponse, 0);
+    XCTAssertEqual(printer.dropped, 0);
+    XCTAssertGreaterThanOrEqual(elapsed, (chunks-1)*0.02);
+}
+@end
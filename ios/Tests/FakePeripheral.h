@@ -0,0 +1,49 @@
+//
+//  FakePeripheral.h
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+#import <Foundation/Foundation.h>
+#import <CoreBluetooth/CoreBluetooth.h>
+
+/**
+ * Stands in for a CBPeripheral with the ISSC printer service, handed to the module as
+ * (CBPeripheral *). Answers discovery and writes on the print queue the way CoreBluetooth
+ * calls back, counts the discovery calls and keeps the bytes written.
+ * A write without response takes one of credits, the link gives one back every
+ * 1/creditsPerSecond seconds and then calls peripheralIsReadyToSendWriteWithoutResponse:.
+ **/
+@interface FakePeripheral : NSObject
+@property (weak,nonatomic) id<CBPeripheralDelegate> delegate;
+@property (strong,nonatomic,readonly) NSUUID *identifier;
+@property (strong,nonatomic,readonly) NSString *name;
+@property (strong,nonatomic,readonly) NSArray *services;
+//maximumWriteValueLengthForType:, 20 by default
+@property (nonatomic) NSUInteger mtu;
+//writes without response the link holds, 0 for a link that never runs out
+@property (nonatomic) NSUInteger credits;
+@property (nonatomic) double creditsPerSecond;
+//only CBCharacteristicWriteWithResponse, answered after 1/creditsPerSecond seconds
+@property (nonatomic) BOOL withResponseOnly;
+//only CBCharacteristicWriteWithoutResponse, as some printer modules have
+@property (nonatomic) BOOL withoutResponseOnly;
+@property (nonatomic) BOOL withoutPrinterService;
+@property (nonatomic) BOOL withoutWriteCharacteristic;
+@property (nonatomic,readonly) NSUInteger discoverServicesCalls;
+@property (nonatomic,readonly) NSUInteger discoverCharacteristicsCalls;
+@property (nonatomic,readonly) NSUInteger writes;
+@property (nonatomic,readonly) NSUInteger writesWithResponse;
+//writes without response sent while canSendWriteWithoutResponse was NO, CoreBluetooth drops them
+@property (nonatomic,readonly) NSUInteger dropped;
+@property (strong,nonatomic,readonly) NSMutableData *received;
+-(CBPeripheral *)peripheral;
+//the printer's write characteristic without the discovery, for a BleWriteScheduler of its own
+-(CBCharacteristic *)writeCharacteristic;
+-(BOOL)canSendWriteWithoutResponse;
+-(NSUInteger)maximumWriteValueLengthForType:(CBCharacteristicWriteType)type;
+-(void)discoverServices:(NSArray<CBUUID *> *)serviceUUIDs;
+-(void)discoverCharacteristics:(NSArray<CBUUID *> *)characteristicUUIDs forService:(CBService *)service;
+-(void)writeValue:(NSData *)data forCharacteristic:(CBCharacteristic *)characteristic type:(CBCharacteristicWriteType)type;
+@end
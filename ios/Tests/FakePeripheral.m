@@ -0,0 +1,177 @@
+//
+//  FakePeripheral.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+
+#import "FakePeripheral.h"
+#import "RNBluetoothManager.h"
+
+static NSString *PRINTER_SERVICE = @"49535343-FE7D-4AE5-8FA9-9FAFD205E455";
+static NSString *WRITE_CHARACTERISTIC = @"49535343-8841-43F4-A8D4-ECBE34729BB3";
+
+@interface FakeService : NSObject
+@property CBUUID *UUID;
+@property NSArray *characteristics;
+@end
+
+@implementation FakeService
+@end
+
+@interface FakeCharacteristic : NSObject
+@property CBUUID *UUID;
+@property CBCharacteristicProperties properties;
+@property (weak) FakeService *service;
+@end
+
+@implementation FakeCharacteristic
+@end
+
+@implementation FakePeripheral
+{
+    NSUInteger available;
+    BOOL draining;
+}
+
+-(id)init
+{
+    if(self = [super init]){
+        _identifier = [NSUUID UUID];
+        _name = @"Fake Printer";
+        _mtu = 20;
+        _received = [[NSMutableData alloc] init];
+    }
+    return self;
+}
+
+-(CBPeripheral *)peripheral
+{
+    return (CBPeripheral *)(id)self;
+}
+
+-(void)callback:(dispatch_block_t)block after:(double)seconds
+{
+    if(seconds>0){
+        dispatch_after(dispatch_time(DISPATCH_TIME_NOW, (int64_t)(seconds * NSEC_PER_SEC)), [RNBluetoothManager printQueue], block);
+    }else{
+        dispatch_async([RNBluetoothManager printQueue], block);
+    }
+}
+
+-(void)setCredits:(NSUInteger)credits
+{
+    _credits = credits;
+    available = credits;
+}
+
+-(double)interval
+{
+    return _creditsPerSecond>0 ? 1.0/_creditsPerSecond : 0;
+}
+
+-(void)discoverServices:(NSArray<CBUUID *> *)serviceUUIDs
+{
+    _discoverServicesCalls++;
+    NSMutableArray *services = [[NSMutableArray alloc] init];
+    FakeService *other = [[FakeService alloc] init];
+    other.UUID = [CBUUID UUIDWithString:@"18F0"];
+    [services addObject:other];
+    if(!_withoutPrinterService){
+        FakeService *printer = [[FakeService alloc] init];
+        printer.UUID = [CBUUID UUIDWithString:PRINTER_SERVICE];
+        [services addObject:printer];
+    }
+    _services = services;
+    [self callback:^{
+        [self.delegate peripheral:[self peripheral] didDiscoverServices:nil];
+    } after:0];
+}
+
+-(void)discoverCharacteristics:(NSArray<CBUUID *> *)characteristicUUIDs forService:(CBService *)service
+{
+    _discoverCharacteristicsCalls++;
+    FakeService *fake = (FakeService *)(id)service;
+    if([fake.UUID.UUIDString isEqualToString:PRINTER_SERVICE] && !_withoutWriteCharacteristic){
+        fake.characteristics = @[[self writeCharacteristicOf:fake]];
+    }else{
+        fake.characteristics = @[];
+    }
+    [self callback:^{
+        [self.delegate peripheral:[self peripheral] didDiscoverCharacteristicsForService:service error:nil];
+    } after:0];
+}
+
+-(FakeCharacteristic *)writeCharacteristicOf:(FakeService *)service
+{
+    FakeCharacteristic *write = [[FakeCharacteristic alloc] init];
+    write.UUID = [CBUUID UUIDWithString:WRITE_CHARACTERISTIC];
+    write.properties = _withResponseOnly ? CBCharacteristicPropertyWrite
+        : _withoutResponseOnly ? CBCharacteristicPropertyWriteWithoutResponse
+        : CBCharacteristicPropertyWrite | CBCharacteristicPropertyWriteWithoutResponse;
+    write.service = service;
+    return write;
+}
+
+-(CBCharacteristic *)writeCharacteristic
+{
+    FakeService *printer = [[FakeService alloc] init];
+    printer.UUID = [CBUUID UUIDWithString:PRINTER_SERVICE];
+    FakeCharacteristic *write = [self writeCharacteristicOf:printer];
+    printer.characteristics = @[write];
+    _services = @[printer];
+    return (CBCharacteristic *)(id)write;
+}
+
+-(NSUInteger)maximumWriteValueLengthForType:(CBCharacteristicWriteType)type
+{
+    return _mtu;
+}
+
+-(BOOL)canSendWriteWithoutResponse
+{
+    return _credits==0 || available>0;
+}
+
+/**
+ * Gives a credit back every interval until the link is empty again.
+ **/
+-(void)drain
+{
+    if(draining || available>=_credits) return;
+    draining = YES;
+    [self callback:^{
+        self->draining = NO;
+        self->available++;
+        if(self->available==1){
+            [self.delegate peripheralIsReadyToSendWriteWithoutResponse:[self peripheral]];
+        }
+        [self drain];
+    } after:[self interval]];
+}
+
+-(void)writeValue:(NSData *)data forCharacteristic:(CBCharacteristic *)characteristic type:(CBCharacteristicWriteType)type
+{
+    NSAssert([data length]<=_mtu, @"write of %lu bytes over the MTU", (unsigned long)[data length]);
+    if(type==CBCharacteristicWriteWithResponse){
+        _writes++;
+        _writesWithResponse++;
+        [_received appendData:data];
+        [self callback:^{
+            [self.delegate peripheral:[self peripheral] didWriteValueForCharacteristic:characteristic error:nil];
+        } after:[self interval]];
+        return;
+    }
+    if(![self canSendWriteWithoutResponse]){
+        _dropped++;
+        return;
+    }
+    _writes++;
+    [_received appendData:data];
+    if(_credits>0){
+        available--;
+        [self drain];
+    }
+}
+@end
@@ -0,0 +1,109 @@
+//
+//  PrintQueueStressTests.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+//  Queues 50 printPic jobs of different 576 dot images to a FakePeripheral and measures how long
+//  the main thread goes without running, the decode, dither and writes all belong on the print
+//  queue. Built by examplesTests in examples/ios.
+//
+
+#import <XCTest/XCTest.h>
+#import <UIKit/UIKit.h>
+#import <QuartzCore/QuartzCore.h>
+#import "RNBluetoothManager.h"
+#import "RNBluetoothEscposPrinter.h"
+#import "FakePeripheral.h"
+
+@interface RNBluetoothEscposPrinter (Tests)
+-(void)printPic:(NSString *) base64encodeStr withOptions:(NSDictionary *) options
+       resolver:(RCTPromiseResolveBlock) resolve
+       rejecter:(RCTPromiseRejectBlock) reject;
+@end
+
+@interface PrintQueueStressTests : XCTestCase
+@end
+
+@implementation PrintQueueStressTests
+
+/**
+ * A 576x800 JPEG a job, different each time so none comes from the raster cache.
+ **/
+- (NSString *)image:(NSUInteger)job
+{
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(576, 800), YES, 1);
+    CGContextRef context = UIGraphicsGetCurrentContext();
+    CGFloat grey = (job%10)/10.0;
+    CGContextSetRGBFillColor(context, 1, 1, 1, 1);
+    CGContextFillRect(context, CGRectMake(0, 0, 576, 800));
+    for(NSUInteger i=0;i<40;i++){
+        CGContextSetRGBFillColor(context, grey, (i%7)/7.0, ((i+job)%5)/5.0, 1);
+        CGContextFillEllipseInRect(context, CGRectMake((i*37+job*11)%520, (i*53+job*7)%740, 56+i, 60));
+    }
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+    return [UIImageJPEGRepresentation(image, 0.8) base64EncodedStringWithOptions:0];
+}
+
+- (void)testFiftyImageJobs
+{
+    NSMutableArray<NSString *> *images = [[NSMutableArray alloc] init];
+    for(NSUInteger i=0;i<50;i++){
+        [images addObject:[self image:i]];
+    }
+
+    RNBluetoothManager *manager = [[RNBluetoothManager alloc] init];
+    FakePeripheral *printer = [[FakePeripheral alloc] init];
+    printer.mtu = 182;
+    RNBluetoothEscposPrinter *escpos = [[RNBluetoothEscposPrinter alloc] init];
+    dispatch_sync([RNBluetoothManager printQueue], ^{
+        [manager centralManager:manager.centralManager didConnectPeripheral:[printer peripheral]];
+    });
+
+    //a tick every 5 ms on the main queue, the longest gap between two is the stall
+    __block CFTimeInterval last = CACurrentMediaTime();
+    __block CFTimeInterval longest = 0;
+    dispatch_source_t ticks = dispatch_source_create(DISPATCH_SOURCE_TYPE_TIMER, 0, 0, dispatch_get_main_queue());
+    dispatch_source_set_timer(ticks, DISPATCH_TIME_NOW, 5 * NSEC_PER_MSEC, NSEC_PER_MSEC);
+    dispatch_source_set_event_handler(ticks, ^{
+        CFTimeInterval now = CACurrentMediaTime();
+        longest = MAX(longest, now-last);
+        last = now;
+    });
+    dispatch_resume(ticks);
+
+    __block NSUInteger printed = 0, failed = 0;
+    XCTestExpectation *done = [self expectationWithDescription:@"50 images printed"];
+    void (^settled)(BOOL) = ^(BOOL ok){
+        if(ok) printed++; else failed++;
+        if(printed+failed==50) [done fulfill];
+    };
+    CFTimeInterval start = CACurrentMediaTime();
+    for(NSString *image in images){
+        dispatch_async([RNBluetoothManager printQueue], ^{
+            [escpos printPic:image withOptions:@{@"width":@576} resolver:^(id result){
+                settled(YES);
+            } rejecter:^(NSString *code, NSString *message, NSError *error){
+                settled(NO);
+            }];
+        });
+    }
+    [self waitForExpectationsWithTimeout:120 handler:nil];
+    CFTimeInterval elapsed = CACurrentMediaTime()-start;
+    dispatch_source_cancel(ticks);
+
+    NSLog(@"50 image jobs: %.0f ms, %lu bytes written, longest main thread stall %.1f ms",
+          elapsed*1000, (unsigned long)[printer.received length], (longest-0.005)*1000);
+    XCTAssertEqual(printed, 50);
+    XCTAssertEqual(failed, 0);
+    XCTAssertEqual(printer.discoverServicesCalls, 1);
+    //three frames at 60 Hz, the main thread only runs the ticks
+    XCTAssertLessThan(longest, 0.05);
+
+    dispatch_sync([RNBluetoothManager printQueue], ^{
+        [manager centralManager:manager.centralManager didDisconnectPeripheral:[printer peripheral] error:nil];
+    });
+}
+@end
@@ -0,0 +1,154 @@
+//
+//  RNBluetoothManagerTests.m
+//  RNBluetoothEscposPrinter
+//
+//  Created by jystudio on 2026/10/17.
+//  Copyright © 2026年 Facebook. All rights reserved.
+//
+//  Writes through RNBluetoothManager to a FakePeripheral: the write characteristic is looked up
+//  once per connection, and the writes waiting on it fail when the printer has no such service
+//  or characteristic. Built by examplesTests in examples/ios.
+//
+
+#import <XCTest/XCTest.h>
+#import <QuartzCore/QuartzCore.h>
+#import "RNBluetoothManager.h"
+#import "FakePeripheral.h"
+
+@interface WriteResults : NSObject<WriteDataToBleDelegate>
+@property NSUInteger succeeded;
+@property NSUInteger failed;
+@property NSUInteger expected;
+@property XCTestExpectation *done;
+@end
+
+@implementation WriteResults
+- (void) didWriteDataToBle: (BOOL)success
+{
+    if(success) self.succeeded++; else self.failed++;
+    if(self.succeeded+self.failed==self.expected) [self.done fulfill];
+}
+@end
+
+@interface RNBluetoothManagerTests : XCTestCase
+@end
+
+@implementation RNBluetoothManagerTests
+{
+    RNBluetoothManager *manager;
+    FakePeripheral *printer;
+}
+
+- (void)setUp
+{
+    [super setUp];
+    manager = [[RNBluetoothManager alloc] init];
+    printer = [[FakePeripheral alloc] init];
+    [self connect];
+}
+
+- (void)tearDown
+{
+    dispatch_sync([RNBluetoothManager printQueue], ^{
+        [self->manager centralManager:self->manager.centralManager didDisconnectPeripheral:[self->printer peripheral] error:nil];
+    });
+    [super tearDown];
+}
+
+- (void)connect
+{
+    dispatch_sync([RNBluetoothManager printQueue], ^{
+        //the getter registers the manager as the peripherals' delegate
+        [self->manager centralManager:self->manager.centralManager didConnectPeripheral:[self->printer peripheral]];
+    });
+}
+
+- (void)disconnect
+{
+    dispatch_sync([RNBluetoothManager printQueue], ^{
+        [self->manager centralManager:self->manager.centralManager didDisconnectPeripheral:[self->printer peripheral] error:nil];
+    });
+}
+
+- (WriteResults *)write:(NSArray<NSData *> *)payloads
+{
+    WriteResults *results = [[WriteResults alloc] init];
+    results.expected = [payloads count];
+    results.done = [self expectationWithDescription:@"writes settled"];
+    dispatch_async([RNBluetoothManager printQueue], ^{
+        for(NSData *data in payloads){
+            [RNBluetoothManager writeValue:data withDelegate:results];
+        }
+    });
+    [self waitForExpectationsWithTimeout:5 handler:nil];
+    return results;
+}
+
+- (NSData *)line:(NSUInteger)i
+{
+    return [[NSString stringWithFormat:@"%03lu Item description      x1      12.50\n",(unsigned long)i] dataUsingEncoding:NSASCIIStringEncoding];
+}
+
+- (void)testDiscoversOncePerConnection
+{
+    WriteResults *results = [self write:@[[self line:0],[self line:1],[self line:2]]];
+    XCTAssertEqual(results.succeeded, 3);
+    results = [self write:@[[self line:3]]];
+    XCTAssertEqual(results.succeeded, 1);
+    XCTAssertEqual(printer.discoverServicesCalls, 1);
+    XCTAssertEqual(printer.discoverCharacteristicsCalls, 2);//the printer service and 18F0
+
+    //a new connection looks the characteristic up again
+    [self disconnect];
+    [self connect];
+    results = [self write:@[[self line:4]]];
+    XCTAssertEqual(results.succeeded, 1);
+    XCTAssertEqual(printer.discoverServicesCalls, 2);
+    XCTAssertEqual([printer.received length], 5*[[self line:0] length]);
+}
+
+- (void)testMissingPrinterServiceFailsPendingWrites
+{
+    printer.withoutPrinterService = YES;
+    WriteResults *results = [self write:@[[self line:0],[self line:1]]];
+    XCTAssertEqual(results.failed, 2);
+    XCTAssertEqual([printer.received length], 0);
+
+    //the next write tries the discovery again
+    results = [self write:@[[self line:2]]];
+    XCTAssertEqual(results.failed, 1);
+    XCTAssertEqual(printer.discoverServicesCalls, 2);
+}
+
+- (void)testMissingWriteCharacteristicFailsPendingWrites
+{
+    printer.withoutWriteCharacteristic = YES;
+    WriteResults *results = [self write:@[[self line:0],[self line:1]]];
+    XCTAssertEqual(results.failed, 2);
+    XCTAssertEqual([printer.received length], 0);
+}
+
+/**
+ * A 500 line receipt written a line at a time as printText does, over a link that never
+ * runs out of credits, so the time is the module's own.
+ **/
+- (void)testReceiptThroughput
+{
+    printer.mtu = 182;
+    NSMutableArray<NSData *> *lines = [[NSMutableArray alloc] init];
+    NSUInteger bytes = 0;
+    for(NSUInteger i=0;i<500;i++){
+        [lines addObject:[self line:i]];
+        bytes += [[self line:i] length];
+    }
+    CFTimeInterval start = CACurrentMediaTime();
+    WriteResults *results = [self write:lines];
+    CFTimeInterval elapsed = CACurrentMediaTime()-start;
+    NSLog(@"500 line receipt: %lu bytes in %.1f ms, %.0f bytes/s, %lu service discoveries",
+          (unsigned long)bytes, elapsed*1000, bytes/elapsed, (unsigned long)printer.discoverServicesCalls);
+    XCTAssertEqual(results.succeeded, 500);
+    XCTAssertEqual([printer.received length], bytes);
+    XCTAssertEqual(printer.discoverServicesCalls, 1);
+    XCTAssertEqual(printer.dropped, 0);
+}
+@end
@@ -75,14 +75,7 @@ const NSStringEncoding VZZX_AZTEC_DEFAULT_ENCODING = NSISOLatin1StringEncoding;
 
   VZZXBitMatrix *output = [[VZZXBitMatrix alloc] initWithWidth:outputWidth height:outputHeight];
 
-  for (int inputY = 0, outputY = topPadding; inputY < inputHeight; inputY++, outputY += multiple) {
-    // Write the contents of this row of the barcode
-    for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
-      if ([input getX:inputX y:inputY]) {
-        [output setRegionAtLeft:outputX top:outputY width:multiple height:multiple];
-      }
-    }
-  }
+  [output setScaledMatrix:input left:leftPadding top:topPadding scale:multiple];
   return output;
 }
 
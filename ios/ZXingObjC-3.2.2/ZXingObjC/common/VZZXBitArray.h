@@ -95,6 +95,15 @@
  */
 - (BOOL)isRange:(int)start end:(int)end value:(BOOL)value;
 
+/**
+ * Counts the set bits of a range a word at a time.
+ *
+ * @param start start of range, inclusive.
+ * @param end end of range, exclusive
+ * @return the number of set bits in range
+ */
+- (int)countRange:(int)start end:(int)end;
+
 - (void)appendBit:(BOOL)bit;
 
 /**
@@ -17,6 +17,7 @@
 #import "VZZXBitArray.h"
 #import "VZZXByteArray.h"
 #import "VZZXIntArray.h"
+#import "bit_matrix.h"
 
 @interface VZZXBitArray ()
 
@@ -137,29 +138,7 @@
   if (end < start) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Start greater than end" userInfo:nil];
   }
-  if (end == start) {
-    return;
-  }
-  end--; // will be easier to treat this as the last actually set bit -- inclusive
-  int firstInt = start / 32;
-  int lastInt = end / 32;
-  for (int i = firstInt; i <= lastInt; i++) {
-    int firstBit = i > firstInt ? 0 : start & 0x1F;
-    int lastBit = i < lastInt ? 31 : end & 0x1F;
-    int32_t mask;
-    if (lastBit > 31) {
-        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Bit-shift operand does not support more than 31 bits" userInfo:nil];
-    }
-    if (firstBit == 0 && lastBit == 31) {
-      mask = -1;
-    } else {
-      mask = 0;
-      for (int j = firstBit; j <= lastBit; j++) {
-        mask |= 1 << j;
-      }
-    }
-    _bits[i] |= mask;
-  }
+  bit_set_range((uint32_t *)_bits, start, end);
 }
 
 - (void)clear {
@@ -170,36 +149,15 @@
   if (end < start) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Start greater than end" userInfo:nil];
   }
-  if (end == start) {
-    return YES; // empty range matches
-  }
-  end--; // will be easier to treat this as the last actually set bit -- inclusive
-  int firstInt = start / 32;
-  int lastInt = end / 32;
-  for (int i = firstInt; i <= lastInt; i++) {
-    int firstBit = i > firstInt ? 0 : start & 0x1F;
-    int lastBit = i < lastInt ? 31 : end & 0x1F;
-    int32_t mask;
-    if (lastBit > 31) {
-        @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Bit-shift operand does not support more than 31 bits" userInfo:nil];
-    }
-    if (firstBit == 0 && lastBit == 31) {
-      mask = -1;
-    } else {
-      mask = 0;
-      for (int j = firstBit; j <= lastBit; j++) {
-        mask |= 1 << j;
-      }
-    }
+  // an empty range matches
+  return [self countRange:start end:end] == (value ? end - start : 0);
+}
 
-    // Return false if we're looking for 1s and the masked bits[i] isn't all 1s (that is,
-    // equals the mask, or we're looking for 0s and the masked portion is not all 0s
-    if ((_bits[i] & mask) != (value ? mask : 0)) {
-      return NO;
-    }
+- (int)countRange:(int)start end:(int)end {
+  if (end < start) {
+    @throw [NSException exceptionWithName:NSInvalidArgumentException reason:@"Start greater than end" userInfo:nil];
   }
-
-  return YES;
+  return (int)bit_count_range((const uint32_t *)_bits, start, end);
 }
 
 - (void)appendBit:(BOOL)bit {
@@ -23,7 +23,8 @@
  *
  * Internally the bits are represented in a 1-D array of 32-bit ints. However, each row begins
  * with a new NSInteger. This is done intentionally so that we can copy out a row into a BitArray very
- * efficiently.
+ * efficiently. On 64-bit targets rowSize is rounded up to an even number of ints, the padding
+ * bits are always 0.
  *
  * The ordering of bits is row-major. Within each NSInteger, the least significant bits are used first,
  * meaning they represent lower x values. This is compatible with BitArray's implementation.
@@ -105,6 +106,33 @@
  */
 - (void)setRegionAtLeft:(int)left top:(int)top width:(int)width height:(int)height;
 
+/**
+ * Draws matrix into this one with each module scale x scale bits, its top left module at
+ * (left, top). A row of modules is spread a table lookup at a time and the scale - 1 rows
+ * below it are overwritten with copies.
+ */
+- (void)setScaledMatrix:(VZZXBitMatrix *)matrix left:(int)left top:(int)top scale:(int)scale;
+
+/**
+ * ORs row y into bytes in printer order: the first column is the most significant bit of a byte.
+ *
+ * @param y The row to extract
+ * @param scale Dots per column
+ * @param left Blank dots in front of the first column
+ * @param bytes At least (left + width * scale + 7) / 8 bytes, normally zeroed
+ */
+- (void)rowBytesAtY:(int)y scale:(int)scale left:(int)left bytes:(uint8_t *)bytes;
+
+/**
+ * @return The number of set bits in the region, counted a word at a time
+ */
+- (int)countRegionAtLeft:(int)left top:(int)top width:(int)width height:(int)height;
+
+/**
+ * @return true iff all bits of the region are set, or none are, according to value
+ */
+- (BOOL)isRegionAtLeft:(int)left top:(int)top width:(int)width height:(int)height value:(BOOL)value;
+
 /**
  * A fast method to retrieve one row of data from the matrix as a VZZXBitArray.
  *
@@ -18,6 +18,7 @@
 #import "VZZXBitMatrix.h"
 #import "VZZXBoolArray.h"
 #import "VZZXIntArray.h"
+#import "bit_matrix.h"
 
 @interface VZZXBitMatrix ()
 
@@ -162,13 +163,8 @@
                                    reason:@"input matrix dimensions do not match"
                                  userInfo:nil];
   }
-  VZZXBitArray *rowArray = [[VZZXBitArray alloc] initWithSize:self.width];
-  for (int y = 0; y < self.height; y++) {
-    int offset = y * self.rowSize;
-    int32_t *row = [mask rowAtY:y row:rowArray].bits;
-    for (int x = 0; x < self.rowSize; x++) {
-      self.bits[offset + x] ^= row[x];
-    }
+  for (int i = 0; i < self.bitsSize; i++) {
+    _bits[i] ^= mask.bits[i];
   }
 }
 
@@ -191,31 +187,63 @@
                                  userInfo:nil];
   }
   for (NSUInteger y = top; y < bottom; y++) {
-    NSUInteger offset = y * self.rowSize;
-    for (NSInteger x = left; x < right; x++) {
-      _bits[offset + (x / 32)] |= 1 << (x & 0x1f);
+    bit_set_range((uint32_t *)_bits + y * self.rowSize, left, right);
+  }
+}
+
+- (void)setScaledMatrix:(VZZXBitMatrix *)matrix left:(int)left top:(int)top scale:(int)scale {
+  if (scale < 1 || left < 0 || top < 0 ||
+      left + matrix.width * scale > self.width || top + matrix.height * scale > self.height) {
+    @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                   reason:@"The scaled matrix must fit inside the matrix"
+                                 userInfo:nil];
+  }
+  bit_spread spread;
+  bit_spread_init(&spread, scale, 0);
+  for (int y = 0; y < matrix.height; y++) {
+    uint32_t *first = (uint32_t *)_bits + (top + y * scale) * self.rowSize;
+    bit_spread_row(&spread, (const uint32_t *)matrix.bits + y * matrix.rowSize, matrix.width, left, first);
+    for (int i = 1; i < scale; i++) {
+      memcpy(first + i * self.rowSize, first, self.rowSize * sizeof(int32_t));
     }
   }
 }
 
+- (void)rowBytesAtY:(int)y scale:(int)scale left:(int)left bytes:(uint8_t *)bytes {
+  bit_spread spread;
+  bit_spread_init(&spread, scale, 1);
+  bit_spread_row(&spread, (const uint32_t *)_bits + y * self.rowSize, self.width, left, bytes);
+}
+
+- (int)countRegionAtLeft:(int)left top:(int)top width:(int)aWidth height:(int)aHeight {
+  if (left < 0 || top < 0 || aWidth < 0 || aHeight < 0 ||
+      left + aWidth > self.width || top + aHeight > self.height) {
+    @throw [NSException exceptionWithName:NSInvalidArgumentException
+                                   reason:@"The region must fit inside the matrix"
+                                 userInfo:nil];
+  }
+  return (int)bit_count_region((const uint32_t *)_bits, self.rowSize, left, top, aWidth, aHeight);
+}
+
+- (BOOL)isRegionAtLeft:(int)left top:(int)top width:(int)aWidth height:(int)aHeight value:(BOOL)value {
+  int count = [self countRegionAtLeft:left top:top width:aWidth height:aHeight];
+  return count == (value ? aWidth * aHeight : 0);
+}
+
 - (VZZXBitArray *)rowAtY:(int)y row:(VZZXBitArray *)row {
   if (row == nil || [row size] < self.width) {
     row = [[VZZXBitArray alloc] initWithSize:self.width];
   } else {
     [row clear];
   }
-  int offset = y * self.rowSize;
-  for (int x = 0; x < self.rowSize; x++) {
-    [row setBulk:x * 32 newBits:_bits[offset + x]];
-  }
+  // the row's ints, the padding of a 64 bit row does not fit in the array
+  memcpy(row.bits, _bits + y * self.rowSize, (self.width + 31) / 32 * sizeof(int32_t));
 
   return row;
 }
 
 - (void)setRowAtY:(int)y row:(VZZXBitArray *)row {
-  for (NSUInteger i = 0; i < self.rowSize; i++) {
-    _bits[(y * self.rowSize) + i] = row.bits[i];
-  }
+  memcpy(_bits + y * self.rowSize, row.bits, (self.width + 31) / 32 * sizeof(int32_t));
 }
 
 - (void)rotate180 {
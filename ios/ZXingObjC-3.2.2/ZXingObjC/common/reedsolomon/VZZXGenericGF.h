@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#import "reed_solomon.h"
+
 @class VZZXGenericGFPoly;
 
 /**
@@ -30,6 +32,11 @@
 @property (nonatomic, assign, readonly) int32_t size;
 @property (nonatomic, assign, readonly) int32_t generatorBase;
 
+/**
+ * The exp and log tables as flat arrays, for the Reed-Solomon encoder.
+ */
+@property (nonatomic, assign, readonly) const reed_solomon_field *tables;
+
 + (VZZXGenericGF *)AztecData12;
 + (VZZXGenericGF *)AztecData10;
 + (VZZXGenericGF *)AztecData6;
@@ -52,6 +59,12 @@
  */
 - (id)initWithPrimitive:(int)primitive size:(int)size b:(int)b;
 
+/**
+ * The coefficients of the generator polynomial of the given degree below its leading 1,
+ * as logs. Built once per degree and kept for the life of the field.
+ */
+- (const uint16_t *)generatorLogs:(int)degree;
+
 /**
  * @return the monomial representing coefficient * x^degree
  */
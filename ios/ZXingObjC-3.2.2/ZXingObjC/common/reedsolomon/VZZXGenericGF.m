@@ -20,9 +20,8 @@
 
 @interface VZZXGenericGF ()
 
-@property (nonatomic, assign, readonly) int32_t *expTable;
-@property (nonatomic, assign, readonly) int32_t *logTable;
 @property (nonatomic, assign, readonly) int primitive;
+@property (nonatomic, strong, readonly) NSMutableDictionary *generators;
 
 @end
 
@@ -37,22 +36,11 @@
     _size = size;
     _generatorBase = b;
 
-    _expTable = (int32_t *)calloc(self.size, sizeof(int32_t));
-    _logTable = (int32_t *)calloc(self.size, sizeof(int32_t));
-    int32_t x = 1;
-    for (int i = 0; i < self.size; i++) {
-      _expTable[i] = x;
-      x <<= 1; // we're assuming the generator alpha is 2
-      if (x >= self.size) {
-        x ^= (int32_t)self.primitive;
-        x &= (int32_t)self.size - 1;
-      }
+    _tables = reed_solomon_field_create(primitive, size, b);
+    if (!_tables) {
+      return nil;
     }
-
-    for (int32_t i = 0; i < (int32_t)self.size-1; i++) {
-      _logTable[_expTable[i]] = i;
-    }
-    // logTable[0] == 0 but this should never be used
+    _generators = [NSMutableDictionary dictionary];
     _zero = [[VZZXGenericGFPoly alloc] initWithField:self coefficients:[[VZZXIntArray alloc] initWithLength:1]];
 
     _one = [[VZZXGenericGFPoly alloc] initWithField:self coefficients:[[VZZXIntArray alloc] initWithInts:1, -1]];
@@ -61,6 +49,13 @@
   return self;
 }
 
+- (void)dealloc {
+  if (_tables != NULL) {
+    reed_solomon_field_free((reed_solomon_field *)_tables);
+    _tables = NULL;
+  }
+}
+
 + (VZZXGenericGF *)AztecData12 {
   static VZZXGenericGF *AztecData12 = nil;
   static dispatch_once_t onceToken;
@@ -123,6 +118,18 @@
   return [self AztecData6];
 }
 
+- (const uint16_t *)generatorLogs:(int)degree {
+  @synchronized (self.generators) {
+    NSMutableData *generator = self.generators[@(degree)];
+    if (!generator) {
+      generator = [NSMutableData dataWithLength:degree * sizeof(uint16_t)];
+      reed_solomon_generator(self.tables, degree, (uint16_t *)generator.mutableBytes);
+      self.generators[@(degree)] = generator;
+    }
+    return (const uint16_t *)generator.bytes;
+  }
+}
+
 - (VZZXGenericGFPoly *)buildMonomial:(int)degree coefficient:(int32_t)coefficient {
   if (degree < 0) {
     [NSException raise:NSInvalidArgumentException format:@"Degree must be greater than 0."];
@@ -140,7 +147,7 @@
 }
 
 - (int32_t)exp:(int)a {
-  return _expTable[a];
+  return _tables->exp[a];
 }
 
 - (int32_t)log:(int)a {
@@ -148,7 +155,7 @@
     [NSException raise:NSInvalidArgumentException format:@"Argument must be non-zero."];
   }
 
-  return _logTable[a];
+  return _tables->log[a];
 }
 
 - (int32_t)inverse:(int)a {
@@ -156,7 +163,7 @@
     [NSException raise:NSInvalidArgumentException format:@"Argument must be non-zero."];
   }
 
-  return _expTable[_size - _logTable[a] - 1];
+  return _tables->exp[_size - _tables->log[a] - 1];
 }
 
 - (int32_t)multiply:(int)a b:(int)b {
@@ -164,7 +171,7 @@
     return 0;
   }
 
-  return _expTable[(_logTable[a] + _logTable[b]) % (_size - 1)];
+  return _tables->exp[_tables->log[a] + _tables->log[b]];
 }
 
 - (BOOL)isEqual:(VZZXGenericGF *)object {
@@ -15,13 +15,11 @@
  */
 
 #import "VZZXGenericGF.h"
-#import "VZZXGenericGFPoly.h"
 #import "VZZXIntArray.h"
 #import "VZZXReedSolomonEncoder.h"
 
 @interface VZZXReedSolomonEncoder ()
 
-@property (nonatomic, strong, readonly) NSMutableArray *cachedGenerators;
 @property (nonatomic, strong, readonly) VZZXGenericGF *field;
 
 @end
@@ -31,30 +29,11 @@
 - (id)initWithField:(VZZXGenericGF *)field {
   if (self = [super init]) {
     _field = field;
-    VZZXIntArray *one = [[VZZXIntArray alloc] initWithLength:1];
-    one.array[0] = 1;
-    _cachedGenerators = [NSMutableArray arrayWithObject:[[VZZXGenericGFPoly alloc] initWithField:field coefficients:one]];
   }
 
   return self;
 }
 
-- (VZZXGenericGFPoly *)buildGenerator:(int)degree {
-  if (degree >= self.cachedGenerators.count) {
-    VZZXGenericGFPoly *lastGenerator = self.cachedGenerators[[self.cachedGenerators count] - 1];
-    for (NSUInteger d = [self.cachedGenerators count]; d <= degree; d++) {
-      VZZXIntArray *next = [[VZZXIntArray alloc] initWithLength:2];
-      next.array[0] = 1;
-      next.array[1] = [self.field exp:(int)d - 1 + self.field.generatorBase];
-      VZZXGenericGFPoly *nextGenerator = [lastGenerator multiply:[[VZZXGenericGFPoly alloc] initWithField:self.field coefficients:next]];
-      [self.cachedGenerators addObject:nextGenerator];
-      lastGenerator = nextGenerator;
-    }
-  }
-
-  return (VZZXGenericGFPoly *)self.cachedGenerators[degree];
-}
-
 - (void)encode:(VZZXIntArray *)toEncode ecBytes:(int)ecBytes {
   if (ecBytes == 0) {
     @throw [NSException exceptionWithName:NSInvalidArgumentException
@@ -67,22 +46,8 @@
                                    reason:@"No data bytes provided"
                                  userInfo:nil];
   }
-  VZZXGenericGFPoly *generator = [self buildGenerator:ecBytes];
-  VZZXIntArray *infoCoefficients = [[VZZXIntArray alloc] initWithLength:dataBytes];
-  for (int i = 0; i < dataBytes; i++) {
-    infoCoefficients.array[i] = toEncode.array[i];
-  }
-  VZZXGenericGFPoly *info = [[VZZXGenericGFPoly alloc] initWithField:self.field coefficients:infoCoefficients];
-  info = [info multiplyByMonomial:ecBytes coefficient:1];
-  VZZXGenericGFPoly *remainder = [info divide:generator][1];
-  VZZXIntArray *coefficients = remainder.coefficients;
-  int numZeroCoefficients = ecBytes - coefficients.length;
-  for (int i = 0; i < numZeroCoefficients; i++) {
-    toEncode.array[dataBytes + i] = 0;
-  }
-  for (int i = 0; i < coefficients.length; i++) {
-    toEncode.array[dataBytes + numZeroCoefficients + i] = coefficients.array[i];
-  }
+  // the remainder by the generator, one LFSR step per data word over the field's log tables
+  reed_solomon_encode(self.field.tables, [self.field generatorLogs:ecBytes], toEncode.array, dataBytes, ecBytes);
 }
 
 @end
@@ -14,8 +14,21 @@
  * limitations under the License.
  */
 
+/**
+ * A 2D matrix of bytes, stored row-major in one buffer.
+ */
 @interface VZZXByteMatrix : NSObject
 
+/**
+ * The cells, rowStride bytes from the start of one row to the next. Use it with
+ * VZZXByteMatrixGet/VZZXByteMatrixSet or walk the rows directly in hot loops.
+ */
+@property (nonatomic, assign, readonly) int8_t *bytes;
+@property (nonatomic, assign, readonly) int rowStride;
+
+/**
+ * Pointers to the rows in bytes.
+ */
 @property (nonatomic, assign, readonly) int8_t **array;
 @property (nonatomic, assign, readonly) int height;
 @property (nonatomic, assign, readonly) int width;
@@ -28,3 +41,11 @@
 - (void)clear:(int8_t)value;
 
 @end
+
+static inline int8_t VZZXByteMatrixGet(const int8_t *bytes, int rowStride, int x, int y) {
+  return bytes[y * rowStride + x];
+}
+
+static inline void VZZXByteMatrixSet(int8_t *bytes, int rowStride, int x, int y, int8_t value) {
+  bytes[y * rowStride + x] = value;
+}
@@ -22,10 +22,12 @@
   if (self = [super init]) {
     _width = width;
     _height = height;
+    _rowStride = width;
 
-    _array = (int8_t **)malloc(height * sizeof(int8_t *));
+    _bytes = (int8_t *)malloc(MAX(1, height * width) * sizeof(int8_t));
+    _array = (int8_t **)malloc(MAX(1, height) * sizeof(int8_t *));
     for (int i = 0; i < height; i++) {
-      _array[i] = (int8_t *)malloc(width * sizeof(int8_t));
+      _array[i] = _bytes + i * _rowStride;
     }
     [self clear:0];
   }
@@ -35,36 +37,33 @@
 
 - (void)dealloc {
   if (_array != NULL) {
-    for (int i = 0; i < self.height; i++) {
-      free(_array[i]);
-    }
     free(_array);
     _array = NULL;
   }
+  if (_bytes != NULL) {
+    free(_bytes);
+    _bytes = NULL;
+  }
 }
 
 - (int8_t)getX:(int)x y:(int)y {
-  return self.array[y][x];
+  return _bytes[y * _rowStride + x];
 }
 
 - (void)setX:(int)x y:(int)y byteValue:(int8_t)value {
-  self.array[y][x] = value;
+  _bytes[y * _rowStride + x] = value;
 }
 
 - (void)setX:(int)x y:(int)y intValue:(int)value {
-  self.array[y][x] = (int8_t)value;
+  _bytes[y * _rowStride + x] = (int8_t)value;
 }
 
 - (void)setX:(int)x y:(int)y boolValue:(BOOL)value {
-  self.array[y][x] = (int8_t)value;
+  _bytes[y * _rowStride + x] = (int8_t)value;
 }
 
 - (void)clear:(int8_t)value {
-  for (int y = 0; y < self.height; ++y) {
-    for (int x = 0; x < self.width; ++x) {
-      self.array[y][x] = value;
-    }
-  }
+  memset(_bytes, value, self.height * self.rowStride);
 }
 
 - (NSString *)description {
@@ -23,6 +23,7 @@
 #import "VZZXDataMatrixWriter.h"
 #import "VZZXDimension.h"
 #import "VZZXEncodeHints.h"
+#import "bit_matrix.h"
 
 @implementation VZZXDataMatrixWriter
 
@@ -156,13 +157,11 @@
 
   VZZXBitMatrix *output = [[VZZXBitMatrix alloc] initWithWidth:outputWidth height:outputHeight];
 
-  for (int inputY = 0, outputY = topPadding; inputY < inputHeight; inputY++, outputY += multiple) {
-    for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
-      if ([input getX:inputX y:inputY] == 1) {
-        [output setRegionAtLeft:outputX top:outputY width:multiple height:multiple];
-      }
-    }
+  VZZXBitMatrix *modules = [[VZZXBitMatrix alloc] initWithWidth:inputWidth height:inputHeight];
+  for (int inputY = 0; inputY < inputHeight; inputY++) {
+    bit_pack_cells(input.bytes + inputY * input.rowStride, inputWidth, (uint32_t *)modules.bits + inputY * modules.rowSize);
   }
+  [output setScaledMatrix:modules left:leftPadding top:topPadding scale:multiple];
   return output;
 }
 
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#import "VZZXBitArray.h"
 #import "VZZXBitMatrix.h"
 #import "VZZXBoolArray.h"
 #import "VZZXEncodeHints.h"
@@ -69,9 +70,14 @@
   VZZXBitMatrix *output = [[VZZXBitMatrix alloc] initWithWidth:outputWidth height:outputHeight];
   for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
     if (code.array[inputX]) {
-      [output setRegionAtLeft:outputX top:0 width:multiple height:outputHeight];
+      [output setRegionAtLeft:outputX top:0 width:multiple height:1];
     }
   }
+  // every row of a linear code is the same
+  VZZXBitArray *row = [output rowAtY:0 row:nil];
+  for (int y = 1; y < outputHeight; y++) {
+    [output setRowAtY:y row:row];
+  }
   return output;
 }
 
@@ -21,6 +21,7 @@
 #import "VZZXQRCodeEncoder.h"
 #import "VZZXQRCodeErrorCorrectionLevel.h"
 #import "VZZXQRCodeWriter.h"
+#import "bit_matrix.h"
 
 const int VZZX_QUIET_ZONE_SIZE = 4;
 
@@ -80,13 +81,11 @@ const int VZZX_QUIET_ZONE_SIZE = 4;
 
   VZZXBitMatrix *output = [[VZZXBitMatrix alloc] initWithWidth:outputWidth height:outputHeight];
 
-  for (int inputY = 0, outputY = topPadding; inputY < inputHeight; inputY++, outputY += multiple) {
-    for (int inputX = 0, outputX = leftPadding; inputX < inputWidth; inputX++, outputX += multiple) {
-      if ([input getX:inputX y:inputY] == 1) {
-        [output setRegionAtLeft:outputX top:outputY width:multiple height:multiple];
-      }
-    }
+  VZZXBitMatrix *modules = [[VZZXBitMatrix alloc] initWithWidth:inputWidth height:inputHeight];
+  for (int inputY = 0; inputY < inputHeight; inputY++) {
+    bit_pack_cells(input.bytes + inputY * input.rowStride, inputWidth, (uint32_t *)modules.bits + inputY * modules.rowSize);
   }
+  [output setScaledMatrix:modules left:leftPadding top:topPadding scale:multiple];
 
   return output;
 }
@@ -35,6 +35,12 @@ extern const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING;
 
 + (VZZXQRCode *)encode:(NSString *)content ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel hints:(VZZXEncodeHints *)hints error:(NSError **)error;
 
+/**
+ * The version number encode:ecLevel:hints:error: picks for "content", from the mode, the ECI
+ * header and the capacity tables without building the symbol. 0 when it does not fit version 40.
+ */
++ (int)versionNumberForContent:(NSString *)content ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel hints:(VZZXEncodeHints *)hints;
+
 /**
  * Return the code point of the table used in alphanumeric mode or
  * -1 if there is no corresponding code in the table.
@@ -31,6 +31,8 @@
 #import "VZZXQRCodeMode.h"
 #import "VZZXQRCodeVersion.h"
 #import "VZZXReedSolomonEncoder.h"
+#import "qr_mask.h"
+#import "qr_version.h"
 
 // The original table is defined in the table 5 of JISX0510:2004 (p.19).
 const int VZZX_ALPHANUMERIC_TABLE[] = {
@@ -49,6 +51,9 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
 // The mask penalty calculation is complicated.  See Table 21 of JISX0510:2004 (p.45) for details.
 // Basically it applies four rules and summate all penalties.
 + (int)calculateMaskPenalty:(VZZXByteMatrix *)matrix {
+  if (matrix.width == matrix.height && matrix.rowStride == matrix.width) {
+    return [VZZXQRCodeMaskUtil applyMaskPenalty:(const uint8_t *)matrix.bytes dimension:matrix.width];
+  }
   return [VZZXQRCodeMaskUtil applyMaskPenaltyRule1:matrix]
     + [VZZXQRCodeMaskUtil applyMaskPenaltyRule2:matrix]
     + [VZZXQRCodeMaskUtil applyMaskPenaltyRule3:matrix]
@@ -70,59 +75,43 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
   // multiple modes / segments even if that were more efficient. Twould be nice.
   VZZXQRCodeMode *mode = [self chooseMode:content encoding:encoding];
 
-  // This will store the header information, like mode and
-  // length, as well as "header" segments like an ECI segment.
-  VZZXBitArray *headerBits = [[VZZXBitArray alloc] init];
+  VZZXBitArray *headerAndDataBits = [[VZZXBitArray alloc] init];
 
   // Append ECI segment if applicable
   if ([mode isEqual:[VZZXQRCodeMode byteMode]] && VZZX_DEFAULT_BYTE_MODE_ENCODING != encoding) {
     VZZXCharacterSetECI *eci = [VZZXCharacterSetECI characterSetECIByEncoding:encoding];
     if (eci != nil) {
-      [self appendECI:eci bits:headerBits];
+      [self appendECI:eci bits:headerAndDataBits];
     }
   }
 
   // (With ECI in place,) Write the mode marker
-  [self appendModeInfo:mode bits:headerBits];
-
-  // Collect data within the main segment, separately, to count its size if needed. Don't add it to
-  // main payload yet.
-  VZZXBitArray *dataBits = [[VZZXBitArray alloc] init];
-  if (![self appendBytes:content mode:mode bits:dataBits encoding:encoding error:error]) {
-    return nil;
-  }
-
-  // Hard part: need to know version to know how many bits length takes. But need to know how many
-  // bits it takes to know version. First we take a guess at version by assuming version will be
-  // the minimum, 1:
-
-  int provisionalBitsNeeded = headerBits.size
-    + [mode characterCountBits:[VZZXQRCodeVersion versionForNumber:1]]
-    + dataBits.size;
-  VZZXQRCodeVersion *provisionalVersion = [self chooseVersion:provisionalBitsNeeded ecLevel:ecLevel error:error];
-  if (!provisionalVersion) {
-    return nil;
+  [self appendModeInfo:mode bits:headerAndDataBits];
+
+  // The length of the data bits follows from the number of letters, so the version, which sets
+  // how many bits the length takes, is chosen before anything else is appended.
+  NSData *byteData = nil;
+  int numLetters;
+  if ([mode isEqual:[VZZXQRCodeMode byteMode]]) {
+    byteData = [content dataUsingEncoding:encoding];
+    numLetters = (int)[byteData length];
+  } else {
+    numLetters = (int)[content length];
   }
-
-  // Use that guess to calculate the right version. I am still not sure this works in 100% of cases.
-
-  int bitsNeeded = headerBits.size
-    + [mode characterCountBits:provisionalVersion]
-    + dataBits.size;
-  VZZXQRCodeVersion *version = [self chooseVersion:bitsNeeded ecLevel:ecLevel error:error];
+  VZZXQRCodeVersion *version = [self chooseVersion:headerAndDataBits.size numLetters:numLetters mode:mode ecLevel:ecLevel error:error];
   if (!version) {
     return nil;
   }
 
-  VZZXBitArray *headerAndDataBits = [[VZZXBitArray alloc] init];
-  [headerAndDataBits appendBitArray:headerBits];
-  // Find "length" of main segment and write it
-  int numLetters = [mode isEqual:[VZZXQRCodeMode byteMode]] ? [dataBits sizeInBytes] : (int)[content length];
+  // Write the "length" of the main segment, then its data
   if (![self appendLengthInfo:numLetters version:version mode:mode bits:headerAndDataBits error:error]) {
     return nil;
   }
-  // Put data together into the overall payload
-  [headerAndDataBits appendBitArray:dataBits];
+  if (byteData) {
+    [self appendByteData:byteData bits:headerAndDataBits];
+  } else if (![self appendBytes:content mode:mode bits:headerAndDataBits encoding:encoding error:error]) {
+    return nil;
+  }
 
   VZZXQRCodeECBlocks *ecBlocks = [version ecBlocksForLevel:ecLevel];
   int numDataBytes = version.totalCodewords - ecBlocks.totalECCodewords;
@@ -145,7 +134,7 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
   qrCode.mode = mode;
   qrCode.version = version;
 
-  // Choose the mask pattern and set to "qrCode".
+  // Choose the mask pattern and set it and the matrix, built with it, to "qrCode".
   int dimension = version.dimensionForVersion;
   VZZXByteMatrix *matrix = [[VZZXByteMatrix alloc] initWithWidth:dimension height:dimension];
   int maskPattern = [self chooseMaskPattern:finalBits ecLevel:[qrCode ecLevel] version:[qrCode version] matrix:matrix error:error];
@@ -153,11 +142,6 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
     return nil;
   }
   [qrCode setMaskPattern:maskPattern];
-
-  // Build the matrix and set it to "qrCode".
-  if (![VZZXQRCodeMatrixUtil buildMatrix:finalBits ecLevel:ecLevel version:version maskPattern:maskPattern matrix:matrix error:error]) {
-    return nil;
-  }
   [qrCode setMatrix:matrix];
 
   return qrCode;
@@ -219,38 +203,50 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
   return YES;
 }
 
+// The function patterns and the placement of the data bits do not depend on the mask, so the
+// matrix is built once without one. Each mask pattern is then an XOR over the data cells plus
+// its type information, scored in one pass. "matrix" is left built with the chosen mask.
 + (int)chooseMaskPattern:(VZZXBitArray *)bits ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel version:(VZZXQRCodeVersion *)version matrix:(VZZXByteMatrix *)matrix error:(NSError **)error {
+  int dimension = matrix.width;
+  int numCells = dimension * dimension;
+  NSMutableData *grids = [NSMutableData dataWithLength:3 * numCells];
+  uint8_t *modules = (uint8_t *)grids.mutableBytes;
+  uint8_t *dataCells = modules + numCells;
+  uint8_t *masked = dataCells + numCells;
+  if (![VZZXQRCodeMatrixUtil buildUnmaskedMatrix:bits ecLevel:ecLevel version:version matrix:matrix dataCells:dataCells error:error]) {
+    return -1;
+  }
+  // A new matrix has no padding between rows.
+  memcpy(modules, matrix.bytes, numCells);
+
   int minPenalty = INT_MAX;
   int bestMaskPattern = -1;
-
   for (int maskPattern = 0; maskPattern < VZZX_NUM_MASK_PATTERNS; maskPattern++) {
-    if (![VZZXQRCodeMatrixUtil buildMatrix:bits ecLevel:ecLevel version:version maskPattern:maskPattern matrix:matrix error:error]) {
+    qr_mask_apply(modules, dataCells, dimension, maskPattern, masked);
+    if (![VZZXQRCodeMatrixUtil embedTypeInfo:ecLevel maskPattern:maskPattern cells:masked width:dimension error:error]) {
       return -1;
     }
-    int penalty = [self calculateMaskPenalty:matrix];
+    int penalty = [VZZXQRCodeMaskUtil applyMaskPenalty:masked dimension:dimension];
     if (penalty < minPenalty) {
       minPenalty = penalty;
       bestMaskPattern = maskPattern;
     }
   }
+
+  uint8_t *cells = (uint8_t *)matrix.bytes;
+  qr_mask_apply(modules, dataCells, dimension, bestMaskPattern, cells);
+  if (![VZZXQRCodeMatrixUtil embedTypeInfo:ecLevel maskPattern:bestMaskPattern cells:cells width:dimension error:error]) {
+    return -1;
+  }
   return bestMaskPattern;
 }
 
-+ (VZZXQRCodeVersion *)chooseVersion:(int)numInputBits ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel error:(NSError **)error {
-  // In the following comments, we use numbers of Version 7-H.
-  for (int versionNum = 1; versionNum <= 40; versionNum++) {
-    VZZXQRCodeVersion *version = [VZZXQRCodeVersion versionForNumber:versionNum];
-    // numBytes = 196
-    int numBytes = version.totalCodewords;
-    // getNumECBytes = 130
-    VZZXQRCodeECBlocks *ecBlocks = [version ecBlocksForLevel:ecLevel];
-    int numEcBytes = ecBlocks.totalECCodewords;
-    // getNumDataBytes = 196 - 130 = 66
-    int numDataBytes = numBytes - numEcBytes;
-    int totalInputBytes = (numInputBits + 7) / 8;
-    if (numDataBytes >= totalInputBytes) {
-      return version;
-    }
+// The capacities are constant tables, a binary search over them finds the smallest version that
+// holds the header, the length and numLetters letters of "mode".
++ (VZZXQRCodeVersion *)chooseVersion:(int)headerBits numLetters:(int)numLetters mode:(VZZXQRCodeMode *)mode ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel error:(NSError **)error {
+  int versionNum = qr_version_choose(ecLevel.ordinal, (qr_mode)mode.bits, numLetters, headerBits);
+  if (versionNum > 0) {
+    return [VZZXQRCodeVersion versionForNumber:versionNum];
   }
 
   NSDictionary *userInfo = @{NSLocalizedDescriptionKey: @"Data too big"};
@@ -259,6 +255,26 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
   return nil;
 }
 
++ (int)versionNumberForContent:(NSString *)content ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel hints:(VZZXEncodeHints *)hints {
+  NSStringEncoding encoding = hints == nil ? 0 : hints.encoding;
+  if (encoding == 0) {
+    encoding = VZZX_DEFAULT_BYTE_MODE_ENCODING;
+  }
+  VZZXQRCodeMode *mode = [self chooseMode:content encoding:encoding];
+  // The mode indicator, after a 12 bit ECI segment as encode: appends it
+  int headerBits = 4;
+  int numLetters;
+  if ([mode isEqual:[VZZXQRCodeMode byteMode]]) {
+    if (VZZX_DEFAULT_BYTE_MODE_ENCODING != encoding && [VZZXCharacterSetECI characterSetECIByEncoding:encoding] != nil) {
+      headerBits += 12;
+    }
+    numLetters = (int)[[content dataUsingEncoding:encoding] length];
+  } else {
+    numLetters = (int)[content length];
+  }
+  return qr_version_choose(ecLevel.ordinal, (qr_mode)mode.bits, numLetters, headerBits);
+}
+
 + (int)totalInputBytes:(int)numInputBits version:(VZZXQRCodeVersion *)version mode:(VZZXQRCodeMode *)mode {
   int modeInfoBits = 4;
   int charCountBits = [mode characterCountBits:version];
@@ -522,7 +538,10 @@ const NSStringEncoding VZZX_DEFAULT_BYTE_MODE_ENCODING = NSISOLatin1StringEncodi
 }
 
 + (void)append8BitBytes:(NSString *)content bits:(VZZXBitArray *)bits encoding:(NSStringEncoding)encoding {
-  NSData *data = [content dataUsingEncoding:encoding];
+  [self appendByteData:[content dataUsingEncoding:encoding] bits:bits];
+}
+
++ (void)appendByteData:(NSData *)data bits:(VZZXBitArray *)bits {
   int8_t *bytes = (int8_t *)[data bytes];
 
   for (int i = 0; i < [data length]; ++i) {
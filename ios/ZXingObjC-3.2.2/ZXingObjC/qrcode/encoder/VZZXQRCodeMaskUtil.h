@@ -44,6 +44,12 @@
  */
 + (int)applyMaskPenaltyRule4:(VZZXByteMatrix *)matrix;
 
+/**
+ * The sum of the four penalty rules, computed in one pass over a row-major grid of one byte
+ * per cell, "dimension" cells a side.
+ */
++ (int)applyMaskPenalty:(const uint8_t *)cells dimension:(int)dimension;
+
 /**
  * Return the mask bit for "getMaskPattern" at "x" and "y". See 8.8 of JISX0510:2004 for mask
  * pattern conditions.
@@ -17,6 +17,7 @@
 #import "VZZXByteMatrix.h"
 #import "VZZXQRCode.h"
 #import "VZZXQRCodeMaskUtil.h"
+#import "qr_mask.h"
 
 // Penalty weights from section 6.8.2.1
 const int VZZX_N1 = 3;
@@ -24,6 +25,24 @@ const int VZZX_N2 = 3;
 const int VZZX_N3 = 40;
 const int VZZX_N4 = 10;
 
+static BOOL isWhiteHorizontal(const int8_t *rowArray, int length, int from, int to) {
+  for (int i = from; i < to; i++) {
+    if (i >= 0 && i < length && rowArray[i] == 1) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
+static BOOL isWhiteVertical(const int8_t *bytes, int stride, int length, int col, int from, int to) {
+  for (int i = from; i < to; i++) {
+    if (i >= 0 && i < length && bytes[i * stride + col] == 1) {
+      return NO;
+    }
+  }
+  return YES;
+}
+
 @implementation VZZXQRCodeMaskUtil
 
 + (int)applyMaskPenaltyRule1:(VZZXByteMatrix *)matrix {
@@ -32,14 +51,16 @@ const int VZZX_N4 = 10;
 
 + (int)applyMaskPenaltyRule2:(VZZXByteMatrix *)matrix {
   int penalty = 0;
-  int8_t **array = matrix.array;
+  int stride = matrix.rowStride;
   int width = matrix.width;
   int height = matrix.height;
 
   for (int y = 0; y < height - 1; y++) {
+    const int8_t *row = matrix.bytes + y * stride;
+    const int8_t *below = row + stride;
     for (int x = 0; x < width - 1; x++) {
-      int value = array[y][x];
-      if (value == array[y][x + 1] && value == array[y + 1][x] && value == array[y + 1][x + 1]) {
+      int value = row[x];
+      if (value == row[x + 1] && value == below[x] && value == below[x + 1]) {
         penalty++;
       }
     }
@@ -50,12 +71,13 @@ const int VZZX_N4 = 10;
 
 + (int)applyMaskPenaltyRule3:(VZZXByteMatrix *)matrix {
   int numPenalties = 0;
-  int8_t **array = matrix.array;
+  const int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
   int width = matrix.width;
   int height = matrix.height;
   for (int y = 0; y < height; y++) {
+    const int8_t *arrayY = bytes + y * stride;
     for (int x = 0; x < width; x++) {
-      int8_t *arrayY = array[y];  // We can at least optimize this access
       if (x + 6 < width &&
           arrayY[x] == 1 &&
           arrayY[x +  1] == 0 &&
@@ -64,18 +86,19 @@ const int VZZX_N4 = 10;
           arrayY[x +  4] == 1 &&
           arrayY[x +  5] == 0 &&
           arrayY[x +  6] == 1 &&
-          ([self isWhiteHorizontal:arrayY length:width from:x - 4 to:x] || [self isWhiteHorizontal:arrayY length:width from:x + 7 to:x + 11])) {
+          (isWhiteHorizontal(arrayY, width, x - 4, x) || isWhiteHorizontal(arrayY, width, x + 7, x + 11))) {
         numPenalties++;
       }
+      const int8_t *column = arrayY + x;
       if (y + 6 < height &&
-          array[y][x] == 1  &&
-          array[y +  1][x] == 0  &&
-          array[y +  2][x] == 1  &&
-          array[y +  3][x] == 1  &&
-          array[y +  4][x] == 1  &&
-          array[y +  5][x] == 0  &&
-          array[y +  6][x] == 1 &&
-          ([self isWhiteVertical:array length:width col:x from:y - 4 to:y] || [self isWhiteVertical:array length:height col:x from:y + 7 to:y + 11])) {
+          column[0] == 1  &&
+          column[stride] == 0  &&
+          column[2 * stride] == 1  &&
+          column[3 * stride] == 1  &&
+          column[4 * stride] == 1  &&
+          column[5 * stride] == 0  &&
+          column[6 * stride] == 1 &&
+          (isWhiteVertical(bytes, stride, width, x, y - 4, y) || isWhiteVertical(bytes, stride, height, x, y + 7, y + 11))) {
         numPenalties++;
       }
     }
@@ -83,31 +106,12 @@ const int VZZX_N4 = 10;
   return numPenalties * VZZX_N3;
 }
 
-+ (BOOL)isWhiteHorizontal:(int8_t *)rowArray length:(int)length from:(int)from to:(int)to {
-  for (int i = from; i < to; i++) {
-    if (i >= 0 && i < length && rowArray[i] == 1) {
-      return NO;
-    }
-  }
-  return YES;
-}
-
-+ (BOOL)isWhiteVertical:(int8_t **)array length:(int)length col:(int)col from:(int)from to:(int)to {
-  for (int i = from; i < to; i++) {
-    if (i >= 0 && i < length && array[i][col] == 1) {
-      return NO;
-    }
-  }
-  return YES;
-}
-
 + (int)applyMaskPenaltyRule4:(VZZXByteMatrix *)matrix {
   int numDarkCells = 0;
-  int8_t **array = matrix.array;
   int width = matrix.width;
   int height = matrix.height;
   for (int y = 0; y < height; y++) {
-    int8_t *arrayY = array[y];
+    const int8_t *arrayY = matrix.bytes + y * matrix.rowStride;
     for (int x = 0; x < width; x++) {
       if (arrayY[x] == 1) {
         numDarkCells++;
@@ -119,6 +123,10 @@ const int VZZX_N4 = 10;
   return fivePercentVariances * VZZX_N4;
 }
 
++ (int)applyMaskPenalty:(const uint8_t *)cells dimension:(int)dimension {
+  return qr_mask_penalty(cells, dimension);
+}
+
 + (BOOL)dataMaskBit:(int)maskPattern x:(int)x y:(int)y {
   int intermediate;
   int temp;
@@ -164,12 +172,17 @@ const int VZZX_N4 = 10;
   int penalty = 0;
   int iLimit = isHorizontal ? matrix.height : matrix.width;
   int jLimit = isHorizontal ? matrix.width : matrix.height;
-  int8_t **array = matrix.array;
+  const int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
+  // Step along a row or down a column.
+  int lineStep = isHorizontal ? stride : 1;
+  int cellStep = isHorizontal ? 1 : stride;
   for (int i = 0; i < iLimit; i++) {
+    const int8_t *line = bytes + i * lineStep;
     int numSameBitCells = 0;
     int prevBit = -1;
     for (int j = 0; j < jLimit; j++) {
-      int bit = isHorizontal ? array[i][j] : array[j][i];
+      int bit = line[j * cellStep];
       if (bit == prevBit) {
         numSameBitCells++;
       } else {
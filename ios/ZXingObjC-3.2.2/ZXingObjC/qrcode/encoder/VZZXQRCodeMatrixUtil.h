@@ -25,6 +25,11 @@
 // success, store the result in "matrix" and return true.
 + (BOOL)buildMatrix:(VZZXBitArray *)dataBits ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel version:(VZZXQRCodeVersion *)version maskPattern:(int)maskPattern matrix:(VZZXByteMatrix *)matrix error:(NSError **)error;
 
+// Build the matrix of "dataBits" without a mask, with the type information of mask pattern 0.
+// Store 1 in "dataCells" (width * height bytes, row-major) for each cell that holds a data bit,
+// the cells a mask pattern flips, and 0 for the others. On success, return true.
++ (BOOL)buildUnmaskedMatrix:(VZZXBitArray *)dataBits ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel version:(VZZXQRCodeVersion *)version matrix:(VZZXByteMatrix *)matrix dataCells:(uint8_t *)dataCells error:(NSError **)error;
+
 // Embed basic patterns. On success, modify the matrix and return true.
 // The basic patterns are:
 // - Position detection patterns
@@ -36,6 +41,9 @@
 // Embed type information. On success, modify the matrix.
 + (BOOL)embedTypeInfo:(VZZXQRCodeErrorCorrectionLevel *)ecLevel maskPattern:(int)maskPattern matrix:(VZZXByteMatrix *)matrix error:(NSError **)error;
 
+// Embed type information into a row-major grid of one byte per cell, "width" cells a side.
++ (BOOL)embedTypeInfo:(VZZXQRCodeErrorCorrectionLevel *)ecLevel maskPattern:(int)maskPattern cells:(uint8_t *)cells width:(int)width error:(NSError **)error;
+
 // Embed version information if need be. On success, modify the matrix and return true.
 // See 8.10 of JISX0510:2004 (p.47) for how to embed version information.
 + (BOOL)maybeEmbedVersionInfo:(VZZXQRCodeVersion *)version matrix:(VZZXByteMatrix *)matrix error:(NSError **)error;
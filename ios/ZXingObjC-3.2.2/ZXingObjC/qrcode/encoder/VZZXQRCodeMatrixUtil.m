@@ -137,6 +137,29 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
   return YES;
 }
 
++ (BOOL)buildUnmaskedMatrix:(VZZXBitArray *)dataBits ecLevel:(VZZXQRCodeErrorCorrectionLevel *)ecLevel version:(VZZXQRCodeVersion *)version matrix:(VZZXByteMatrix *)matrix dataCells:(uint8_t *)dataCells error:(NSError **)error {
+  [self clearMatrix:matrix];
+  if (![self embedBasicPatterns:version matrix:matrix error:error]) {
+    return NO;
+  }
+  // The type information is rewritten for each mask pattern, it only needs its cells taken.
+  if (![self embedTypeInfo:ecLevel maskPattern:0 matrix:matrix error:error]) {
+    return NO;
+  }
+  if (![self maybeEmbedVersionInfo:version matrix:matrix error:error]) {
+    return NO;
+  }
+  // The cells still empty are the ones embedDataBits fills.
+  int width = matrix.width;
+  for (int y = 0; y < matrix.height; y++) {
+    const int8_t *row = matrix.bytes + y * matrix.rowStride;
+    for (int x = 0; x < width; x++) {
+      dataCells[y * width + x] = row[x] == -1;
+    }
+  }
+  return [self embedDataBits:dataBits maskPattern:-1 matrix:matrix error:error];
+}
+
 + (BOOL)embedBasicPatterns:(VZZXQRCodeVersion *)version matrix:(VZZXByteMatrix *)matrix error:(NSError **)error {
   // Let's get started with embedding big squares at corners.
   if (![self embedPositionDetectionPatternsAndSeparators:matrix]) {
@@ -163,6 +186,8 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
     return NO;
   }
 
+  int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
   for (int i = 0; i < [typeInfoBits size]; ++i) {
     // Place bits in LSB to MSB order.  LSB (least significant bit) is the last value in
     // "typeInfoBits".
@@ -171,18 +196,38 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
     // Type info bits at the left top corner. See 8.9 of JISX0510:2004 (p.46).
     int x1 = VZZX_TYPE_INFO_COORDINATES[i][0];
     int y1 = VZZX_TYPE_INFO_COORDINATES[i][1];
-    [matrix setX:x1 y:y1 boolValue:bit];
+    VZZXByteMatrixSet(bytes, stride, x1, y1, bit);
 
     if (i < 8) {
       // Right top corner.
       int x2 = [matrix width] - i - 1;
       int y2 = 8;
-      [matrix setX:x2 y:y2 boolValue:bit];
+      VZZXByteMatrixSet(bytes, stride, x2, y2, bit);
     } else {
       // Left bottom corner.
       int x2 = 8;
       int y2 = [matrix height] - 7 + (i - 8);
-      [matrix setX:x2 y:y2 boolValue:bit];
+      VZZXByteMatrixSet(bytes, stride, x2, y2, bit);
+    }
+  }
+
+  return YES;
+}
+
++ (BOOL)embedTypeInfo:(VZZXQRCodeErrorCorrectionLevel *)ecLevel maskPattern:(int)maskPattern cells:(uint8_t *)cells width:(int)width error:(NSError **)error {
+  VZZXBitArray *typeInfoBits = [[VZZXBitArray alloc] init];
+  if (![self makeTypeInfoBits:ecLevel maskPattern:maskPattern bits:typeInfoBits error:error]) {
+    return NO;
+  }
+
+  // The same cells as embedTypeInfo:maskPattern:matrix:error:, the matrix is square.
+  for (int i = 0; i < [typeInfoBits size]; ++i) {
+    uint8_t bit = [typeInfoBits get:[typeInfoBits size] - 1 - i];
+    cells[VZZX_TYPE_INFO_COORDINATES[i][1] * width + VZZX_TYPE_INFO_COORDINATES[i][0]] = bit;
+    if (i < 8) {
+      cells[8 * width + width - i - 1] = bit;
+    } else {
+      cells[(width - 7 + (i - 8)) * width + 8] = bit;
     }
   }
 
@@ -198,6 +243,9 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
     return NO;
   }
 
+  int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
+  int height = matrix.height;
   int bitIndex = 6 * 3 - 1; // It will decrease from 17 to 0.
   for (int i = 0; i < 6; ++i) {
     for (int j = 0; j < 3; ++j) {
@@ -205,9 +253,9 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
       BOOL bit = [versionInfoBits get:bitIndex];
       bitIndex--;
       // Left bottom corner.
-      [matrix setX:i y:[matrix height] - 11 + j boolValue:bit];
+      VZZXByteMatrixSet(bytes, stride, i, height - 11 + j, bit);
       // Right bottom corner.
-      [matrix setX:[matrix height] - 11 + j y:i boolValue:bit];
+      VZZXByteMatrixSet(bytes, stride, height - 11 + j, i, bit);
     }
   }
 
@@ -215,25 +263,29 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
 }
 
 + (BOOL)embedDataBits:(VZZXBitArray *)dataBits maskPattern:(int)maskPattern matrix:(VZZXByteMatrix *)matrix error:(NSError **)error {
+  int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
+  int height = matrix.height;
+  int numBits = [dataBits size];
   int bitIndex = 0;
   int direction = -1;
   // Start from the right bottom cell.
   int x = [matrix width] - 1;
-  int y = [matrix height] - 1;
+  int y = height - 1;
   while (x > 0) {
     // Skip the vertical timing pattern.
     if (x == 6) {
       x -= 1;
     }
-    while (y >= 0 && y < [matrix height]) {
+    while (y >= 0 && y < height) {
       for (int i = 0; i < 2; ++i) {
         int xx = x - i;
         // Skip the cell if it's not empty.
-        if (![self isEmpty:[matrix getX:xx y:y]]) {
+        if (VZZXByteMatrixGet(bytes, stride, xx, y) != -1) {
           continue;
         }
         BOOL bit;
-        if (bitIndex < [dataBits size]) {
+        if (bitIndex < numBits) {
           bit = [dataBits get:bitIndex];
           ++bitIndex;
         } else {
@@ -246,7 +298,7 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
         if (maskPattern != -1 && [VZZXQRCodeMaskUtil dataMaskBit:maskPattern x:xx y:y]) {
           bit = !bit;
         }
-        [matrix setX:xx y:y boolValue:bit];
+        VZZXByteMatrixSet(bytes, stride, xx, y, bit);
       }
       y += direction;
     }
@@ -329,23 +381,20 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
   return YES;
 }
 
-// Check if "value" is empty.
-+ (BOOL)isEmpty:(int)value {
-  return value == -1;
-}
-
 + (void)embedTimingPatterns:(VZZXByteMatrix *)matrix {
   // -8 is for skipping position detection patterns (size 7), and two horizontal/vertical
   // separation patterns (size 1). Thus, 8 = 7 + 1.
+  int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
   for (int i = 8; i < [matrix width] - 8; ++i) {
-    int bit = (i + 1) % 2;
+    int8_t bit = (i + 1) % 2;
     // Horizontal line.
-    if ([self isEmpty:[matrix getX:i y:6]]) {
-      [matrix setX:i y:6 boolValue:bit];
+    if (VZZXByteMatrixGet(bytes, stride, i, 6) == -1) {
+      VZZXByteMatrixSet(bytes, stride, i, 6, bit);
     }
     // Vertical line.
-    if ([self isEmpty:[matrix getX:6 y:i]]) {
-      [matrix setX:6 y:i boolValue:bit];
+    if (VZZXByteMatrixGet(bytes, stride, 6, i) == -1) {
+      VZZXByteMatrixSet(bytes, stride, 6, i, bit);
     }
   }
 }
@@ -361,22 +410,25 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
 }
 
 + (BOOL)embedHorizontalSeparationPattern:(int)xStart yStart:(int)yStart matrix:(VZZXByteMatrix *)matrix {
+  int8_t *row = matrix.bytes + yStart * matrix.rowStride + xStart;
   for (int x = 0; x < 8; ++x) {
-    if (![self isEmpty:[matrix getX:xStart + x y:yStart]]) {
+    if (row[x] != -1) {
       return NO;
     }
-    [matrix setX:xStart + x y:yStart intValue:0];
+    row[x] = 0;
   }
 
   return YES;
 }
 
 + (BOOL)embedVerticalSeparationPattern:(int)xStart yStart:(int)yStart matrix:(VZZXByteMatrix *)matrix {
+  int8_t *bytes = matrix.bytes;
+  int stride = matrix.rowStride;
   for (int y = 0; y < 7; ++y) {
-    if (![self isEmpty:[matrix getX:xStart y:yStart + y]]) {
+    if (VZZXByteMatrixGet(bytes, stride, xStart, yStart + y) != -1) {
       return NO;
     }
-    [matrix setX:xStart y:yStart + y intValue:0];
+    VZZXByteMatrixSet(bytes, stride, xStart, yStart + y, 0);
   }
 
   return YES;
@@ -387,16 +439,18 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
 // C/C++. We should live with the fact.
 + (void)embedPositionAdjustmentPattern:(int)xStart yStart:(int)yStart matrix:(VZZXByteMatrix *)matrix {
   for (int y = 0; y < 5; ++y) {
+    int8_t *row = matrix.bytes + (yStart + y) * matrix.rowStride + xStart;
     for (int x = 0; x < 5; ++x) {
-      [matrix setX:xStart + x y:yStart + y intValue:VZZX_POSITION_ADJUSTMENT_PATTERN[y][x]];
+      row[x] = (int8_t)VZZX_POSITION_ADJUSTMENT_PATTERN[y][x];
     }
   }
 }
 
 + (void)embedPositionDetectionPattern:(int)xStart yStart:(int)yStart matrix:(VZZXByteMatrix *)matrix {
   for (int y = 0; y < 7; ++y) {
+    int8_t *row = matrix.bytes + (yStart + y) * matrix.rowStride + xStart;
     for (int x = 0; x < 7; ++x) {
-      [matrix setX:xStart + x y:yStart + y intValue:VZZX_POSITION_DETECTION_PATTERN[y][x]];
+      row[x] = (int8_t)VZZX_POSITION_DETECTION_PATTERN[y][x];
     }
   }
 }
@@ -454,7 +508,7 @@ const int VZZX_TYPE_INFO_MASK_PATTERN = 0x5412;
         continue;
       }
       // If the cell is unset, we embed the position adjustment pattern here.
-      if ([self isEmpty:[matrix getX:x y:y]]) {
+      if (VZZXByteMatrixGet(matrix.bytes, matrix.rowStride, x, y) == -1) {
         // -2 is necessary since the x/y coordinates point to the center of the pattern, not the
         // left top corner.
         [self embedPositionAdjustmentPattern:x - 2 yStart:y - 2 matrix:matrix];